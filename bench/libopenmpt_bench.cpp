@@ -0,0 +1,305 @@
+/*
+ * libopenmpt_bench.cpp
+ * --------------------
+ * Purpose: libopenmpt rendering throughput benchmark
+ * Notes  : Results are written to stdout as tab-separated values, diagnostics go to stderr.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+/*
+ * Usage: libopenmpt_bench [--seconds N] [--samplerate N] [--chunk-sizes N,N,...] [--filters N,N,...] [--channels N,N,...] [--formats F,F,...] MODULE...
+ *
+ * Every module is rendered for the given duration (default: 60 seconds of audio, looping the module if required)
+ * once for every combination of
+ *  - mixer chunk size (ctl render.mixer.chunk_size, default: all powers of two from 16 to 16384),
+ *  - interpolation filter length (render param RENDER_INTERPOLATIONFILTER_LENGTH, default: 1,2,4,8),
+ *  - number of output channels (default: 1,2,4),
+ *  - output sample format ("int16" or "float", default: both).
+ * The module is read in blocks that are at least as large as the largest chunk size,
+ * so that the chunk size does not depend on the block size.
+ *
+ * For every run, the output contains the rendering throughput and the peak resident set size of the process.
+ * If libopenmpt was built with render statistics, it also contains the time spent in the rendering stages,
+ * the average and highest number of voices mixed per chunk and the number of voices that were skipped because of the voice limit
+ * (otherwise, these columns are -1).
+ * On Linux, the peak resident set size is reset before every run. On other systems, it is the peak of the whole process so far.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <initializer_list>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+#include <libopenmpt/libopenmpt.hpp>
+#include <libopenmpt/libopenmpt_ext.hpp>
+
+enum class sample_format {
+	int16,
+	float32,
+};
+
+struct bench_settings {
+	double seconds = 60.0;
+	std::int32_t samplerate = 48000;
+	std::vector<std::int64_t> chunk_sizes;
+	std::vector<std::int64_t> filters;
+	std::vector<std::int64_t> channels;
+	std::vector<sample_format> formats;
+	std::vector<std::string> filenames;
+};
+
+struct bench_result {
+	std::size_t frames = 0;
+	double seconds = 0.0;
+	std::int64_t peak_rss_kib = -1;
+	double read_note_seconds = -1.0;
+	double mix_seconds = -1.0;
+	double dsp_seconds = -1.0;
+	double plugins_seconds = -1.0;
+	double output_seconds = -1.0;
+	double mixed_voices_per_chunk = -1.0;
+	std::int64_t max_mixed_voices = -1;
+	std::int64_t skipped_voices = -1;
+};
+
+static std::vector<std::string> split( const std::string & str ) {
+	std::vector<std::string> result;
+	std::size_t pos = 0;
+	while ( pos <= str.length() ) {
+		std::size_t end = str.find( ',', pos );
+		if ( end == std::string::npos ) {
+			end = str.length();
+		}
+		result.push_back( str.substr( pos, end - pos ) );
+		pos = end + 1;
+	}
+	return result;
+}
+
+static std::vector<std::int64_t> parse_integers( const std::string & str ) {
+	std::vector<std::int64_t> result;
+	for ( const auto & value : split( str ) ) {
+		result.push_back( std::stoll( value ) );
+	}
+	return result;
+}
+
+static std::vector<sample_format> parse_formats( const std::string & str ) {
+	std::vector<sample_format> result;
+	for ( const auto & value : split( str ) ) {
+		if ( value == "int16" ) {
+			result.push_back( sample_format::int16 );
+		} else if ( value == "float" ) {
+			result.push_back( sample_format::float32 );
+		} else {
+			throw std::invalid_argument( "unknown sample format: " + value );
+		}
+	}
+	return result;
+}
+
+static const char * format_name( sample_format format ) {
+	return ( format == sample_format::int16 ) ? "int16" : "float";
+}
+
+static bench_settings parse_args( int argc, char * argv[] ) {
+	bench_settings settings;
+	for ( int i = 1; i < argc; ++i ) {
+		const std::string arg = argv[i];
+		const bool has_value = ( i + 1 < argc );
+		if ( arg == "--seconds" && has_value ) {
+			settings.seconds = std::stod( argv[++i] );
+		} else if ( arg == "--samplerate" && has_value ) {
+			settings.samplerate = std::stoi( argv[++i] );
+		} else if ( arg == "--chunk-sizes" && has_value ) {
+			settings.chunk_sizes = parse_integers( argv[++i] );
+		} else if ( arg == "--filters" && has_value ) {
+			settings.filters = parse_integers( argv[++i] );
+		} else if ( arg == "--channels" && has_value ) {
+			settings.channels = parse_integers( argv[++i] );
+		} else if ( arg == "--formats" && has_value ) {
+			settings.formats = parse_formats( argv[++i] );
+		} else if ( arg.length() > 1 && arg[0] == '-' ) {
+			throw std::invalid_argument( "unknown option: " + arg );
+		} else {
+			settings.filenames.push_back( arg );
+		}
+	}
+	if ( settings.chunk_sizes.empty() ) {
+		for ( std::int64_t chunk_size = 16; chunk_size <= 16384; chunk_size *= 2 ) {
+			settings.chunk_sizes.push_back( chunk_size );
+		}
+	}
+	if ( settings.filters.empty() ) {
+		settings.filters = { 1, 2, 4, 8 };
+	}
+	if ( settings.channels.empty() ) {
+		settings.channels = { 1, 2, 4 };
+	}
+	if ( settings.formats.empty() ) {
+		settings.formats = { sample_format::int16, sample_format::float32 };
+	}
+	for ( const auto channels : settings.channels ) {
+		if ( channels != 1 && channels != 2 && channels != 4 ) {
+			throw std::invalid_argument( "unsupported number of channels: " + std::to_string( channels ) );
+		}
+	}
+	if ( settings.filenames.empty() || settings.seconds <= 0.0 || settings.samplerate <= 0 ) {
+		throw std::invalid_argument( "Usage: libopenmpt_bench [--seconds N] [--samplerate N] [--chunk-sizes N,N,...] [--filters N,N,...] [--channels N,N,...] [--formats F,F,...] MODULE..." );
+	}
+	return settings;
+}
+
+#if defined(__linux__)
+
+static void reset_peak_rss() {
+	// Supported since Linux 4.0. If it fails, the peak of the whole process is reported.
+	std::ofstream clear_refs( "/proc/self/clear_refs" );
+	clear_refs << "5";
+}
+
+static std::int64_t get_peak_rss_kib() {
+	std::ifstream status( "/proc/self/status" );
+	std::string line;
+	while ( std::getline( status, line ) ) {
+		if ( line.compare( 0, 6, "VmHWM:" ) == 0 ) {
+			return std::stoll( line.substr( 6 ) );
+		}
+	}
+	return -1;
+}
+
+#elif defined(__unix__) || defined(__APPLE__)
+
+static void reset_peak_rss() {
+	return;
+}
+
+static std::int64_t get_peak_rss_kib() {
+	struct rusage usage {};
+	if ( getrusage( RUSAGE_SELF, &usage ) != 0 ) {
+		return -1;
+	}
+#if defined(__APPLE__)
+	return static_cast<std::int64_t>( usage.ru_maxrss ) / 1024;
+#else
+	return static_cast<std::int64_t>( usage.ru_maxrss );
+#endif
+}
+
+#else
+
+static void reset_peak_rss() {
+	return;
+}
+
+static std::int64_t get_peak_rss_kib() {
+	return -1;
+}
+
+#endif
+
+template <typename Tsample>
+static std::size_t read_frames( openmpt::module & mod, std::int32_t samplerate, std::int64_t channels, std::size_t count, Tsample * buffer ) {
+	switch ( channels ) {
+		case 1:
+			return mod.read( samplerate, count, buffer );
+		case 2:
+			return mod.read_interleaved_stereo( samplerate, count, buffer );
+		case 4:
+			return mod.read_interleaved_quad( samplerate, count, buffer );
+	}
+	return 0;
+}
+
+template <typename Tsample>
+static bench_result render( const std::vector<char> & data, const bench_settings & settings, std::int64_t chunk_size, std::int64_t filter, std::int64_t channels ) {
+	reset_peak_rss();
+	openmpt::module_ext mod( data );
+	mod.set_repeat_count( -1 );
+	mod.set_render_param( openmpt::module::RENDER_INTERPOLATIONFILTER_LENGTH, static_cast<std::int32_t>( filter ) );
+	mod.ctl_set_integer( "render.mixer.chunk_size", chunk_size );
+	const auto stats = static_cast<openmpt::ext::render_stats *>( mod.get_interface( openmpt::ext::render_stats_id ) );
+	if ( stats ) {
+		stats->set_render_stats_enabled( true );
+	}
+	const std::size_t buffer_frames = static_cast<std::size_t>( *std::max_element( settings.chunk_sizes.begin(), settings.chunk_sizes.end() ) );
+	std::vector<Tsample> buffer( buffer_frames * static_cast<std::size_t>( channels ) );
+	const std::size_t frames_total = static_cast<std::size_t>( settings.seconds * settings.samplerate );
+	bench_result result;
+	const auto start = std::chrono::steady_clock::now();
+	while ( result.frames < frames_total ) {
+		const std::size_t count = read_frames( mod, settings.samplerate, channels, std::min( buffer_frames, frames_total - result.frames ), buffer.data() );
+		if ( count == 0 ) {
+			break;
+		}
+		result.frames += count;
+	}
+	const auto end = std::chrono::steady_clock::now();
+	result.seconds = std::chrono::duration<double>( end - start ).count();
+	result.peak_rss_kib = get_peak_rss_kib();
+	if ( stats ) {
+		using render_stats = openmpt::ext::render_stats;
+		const auto stage_seconds = [stats]( std::initializer_list<render_stats::stage> stages ) {
+			std::uint64_t nanoseconds = 0;
+			for ( const auto stage : stages ) {
+				nanoseconds += stats->get_stage_nanoseconds( stage );
+			}
+			return nanoseconds * 1e-9;
+		};
+		result.read_note_seconds = stage_seconds( { render_stats::stage_read_note } );
+		result.mix_seconds = stage_seconds( { render_stats::stage_mix, render_stats::stage_opl } );
+		result.dsp_seconds = stage_seconds( { render_stats::stage_reverb, render_stats::stage_global_volume, render_stats::stage_stereo_separation, render_stats::stage_dsp } );
+		result.plugins_seconds = stage_seconds( { render_stats::stage_plugins } );
+		result.output_seconds = stage_seconds( { render_stats::stage_output } );
+		const std::uint64_t chunks = stats->get_stage_calls( openmpt::ext::render_stats::stage_mix );
+		result.mixed_voices_per_chunk = ( chunks > 0 ) ? ( static_cast<double>( stats->get_mixed_voices() ) / chunks ) : 0.0;
+		result.max_mixed_voices = stats->get_max_mixed_voices();
+		result.skipped_voices = static_cast<std::int64_t>( stats->get_skipped_voices() );
+	}
+	return result;
+}
+
+int main( int argc, char * argv[] ) {
+	try {
+		const bench_settings settings = parse_args( argc, argv );
+		std::cerr << "libopenmpt " << openmpt::string::get( "library_version" ) << " (" << openmpt::string::get( "build" ) << ")" << std::endl;
+		std::cout << "file\tchunk_size\tfilter\tchannels\tformat\tframes\tseconds\tframes_per_second\trealtime_factor\tpeak_rss_kib\tread_note_seconds\tmix_seconds\tdsp_seconds\tplugins_seconds\toutput_seconds\tmixed_voices_per_chunk\tmax_mixed_voices\tskipped_voices" << std::endl;
+		for ( const auto & filename : settings.filenames ) {
+			std::ifstream file( filename, std::ios::binary );
+			const std::vector<char> data{ std::istreambuf_iterator<char>( file ), std::istreambuf_iterator<char>() };
+			for ( const auto chunk_size : settings.chunk_sizes ) {
+				for ( const auto filter : settings.filters ) {
+					for ( const auto channels : settings.channels ) {
+						for ( const auto format : settings.formats ) {
+							const bench_result result = ( format == sample_format::int16 ) ? render<std::int16_t>( data, settings, chunk_size, filter, channels ) : render<float>( data, settings, chunk_size, filter, channels );
+							const double frames_per_second = ( result.seconds > 0.0 ) ? ( result.frames / result.seconds ) : 0.0;
+							std::cout << filename << '\t' << chunk_size << '\t' << filter << '\t' << channels << '\t' << format_name( format ) << '\t' << result.frames << '\t';
+							std::cout << std::fixed << std::setprecision( 6 ) << result.seconds << '\t' << std::setprecision( 0 ) << frames_per_second << '\t' << std::setprecision( 2 ) << ( frames_per_second / settings.samplerate ) << '\t';
+							std::cout << result.peak_rss_kib << '\t';
+							std::cout << std::setprecision( 6 ) << result.read_note_seconds << '\t' << result.mix_seconds << '\t' << result.dsp_seconds << '\t' << result.plugins_seconds << '\t' << result.output_seconds << '\t';
+							std::cout << std::setprecision( 2 ) << result.mixed_voices_per_chunk << '\t' << result.max_mixed_voices << '\t' << result.skipped_voices << std::defaultfloat << std::endl;
+						}
+					}
+				}
+			}
+		}
+	} catch ( const std::exception & e ) {
+		std::cerr << "Error: " << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,145 @@
+/*
+ * libopenmpt_bench_playstate.cpp
+ * ------------------------------
+ * Purpose: Microbenchmark for saving and restoring the playback state
+ * Notes  : Results are written to stdout as tab-separated values.
+ *          This uses library internals (CSoundFile::PlayState), so it is linked against the libopenmpt objects instead of the library.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+/*
+ * Usage: libopenmpt_bench_playstate [--iterations N] [--channels N,N,...]
+ *
+ * For every number of pattern channels (default: 4,8,16,32,64,127), the time it takes to
+ *  - copy the complete playback state (which is what seeking did before snapshots were introduced),
+ *  - save a snapshot of the pattern channels only, or of the pattern channels and all playing background (NNA) channels,
+ *  - restore both kinds of snapshots,
+ *  - compute the length of a module with a single empty 64-row pattern (GetLength), and seek to the middle of that pattern
+ * is measured, along with the memory used by the playback state and by the snapshots.
+ * The playback state has as many playing background channels as there are pattern channels (as far as there are enough channels).
+ * The GetLength measurements are dominated by setting up the playback state that is simulated, which is what snapshots and reusing the simulated state speed up.
+ */
+
+#include "common/stdafx.h"
+#include "common/FileReader.h"
+#include "soundlib/Sndfile.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using OpenMPT::CHANNELINDEX;
+using OpenMPT::CSoundFile;
+using OpenMPT::GetLengthTarget;
+using OpenMPT::MAX_BASECHANNELS;
+using OpenMPT::MAX_CHANNELS;
+using OpenMPT::ModChannel;
+
+struct bench_settings {
+	std::size_t iterations = 10000;
+	std::vector<std::int64_t> channels;
+};
+
+static std::vector<std::int64_t> parse_integers( const std::string & str ) {
+	std::vector<std::int64_t> result;
+	std::size_t pos = 0;
+	while ( pos <= str.length() ) {
+		std::size_t end = str.find( ',', pos );
+		if ( end == std::string::npos ) {
+			end = str.length();
+		}
+		result.push_back( std::stoll( str.substr( pos, end - pos ) ) );
+		pos = end + 1;
+	}
+	return result;
+}
+
+static bench_settings parse_args( int argc, char * argv[] ) {
+	bench_settings settings;
+	for ( int i = 1; i < argc; ++i ) {
+		const std::string arg = argv[i];
+		const bool has_value = ( i + 1 < argc );
+		if ( arg == "--iterations" && has_value ) {
+			settings.iterations = static_cast<std::size_t>( std::stoull( argv[++i] ) );
+		} else if ( arg == "--channels" && has_value ) {
+			settings.channels = parse_integers( argv[++i] );
+		} else {
+			throw std::invalid_argument( "Usage: libopenmpt_bench_playstate [--iterations N] [--channels N,N,...]" );
+		}
+	}
+	if ( settings.channels.empty() ) {
+		settings.channels = { 4, 8, 16, 32, 64, 127 };
+	}
+	for ( const auto channels : settings.channels ) {
+		if ( channels < 1 || channels > MAX_BASECHANNELS ) {
+			throw std::invalid_argument( "unsupported number of channels: " + std::to_string( channels ) );
+		}
+	}
+	if ( settings.iterations == 0 ) {
+		throw std::invalid_argument( "the number of iterations must be positive" );
+	}
+	return settings;
+}
+
+template <typename Tfunc>
+static double nanoseconds_per_call( std::size_t iterations, Tfunc && func ) {
+	const auto start = std::chrono::steady_clock::now();
+	for ( std::size_t i = 0; i < iterations; ++i ) {
+		func();
+	}
+	const auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::nano>( end - start ).count() / iterations;
+}
+
+int main( int argc, char * argv[] ) {
+	try {
+		const bench_settings settings = parse_args( argc, argv );
+		std::cout << "channels\tbackground_channels\tplay_state_bytes\tsnapshot_bytes\tsnapshot_background_bytes\tcopy_ns\tsave_ns\tsave_background_ns\trestore_ns\trestore_background_ns\tget_length_ns\tseek_ns" << std::endl;
+		// Too large for the stack
+		auto state = std::make_unique<CSoundFile::PlayState>();
+		auto target = std::make_unique<CSoundFile::PlayState>();
+		for ( const auto channels : settings.channels ) {
+			const auto num_channels = static_cast<CHANNELINDEX>( channels );
+			const auto num_background = std::min( num_channels, static_cast<CHANNELINDEX>( MAX_CHANNELS - num_channels ) );
+			for ( CHANNELINDEX chn = 0; chn < MAX_CHANNELS; ++chn ) {
+				state->Chn[chn] = ModChannel{};
+				if ( chn >= num_channels && chn < num_channels + num_background ) {
+					state->Chn[chn].nLength = 1000;
+				}
+			}
+			CSoundFile::PlayState::Snapshot snapshot, snapshot_background;
+			state->Save( snapshot, num_channels, false );
+			state->Save( snapshot_background, num_channels, true );
+
+			const double copy_ns = nanoseconds_per_call( settings.iterations, [&]() { *target = *state; } );
+			const double save_ns = nanoseconds_per_call( settings.iterations, [&]() { state->Save( snapshot, num_channels, false ); } );
+			const double save_background_ns = nanoseconds_per_call( settings.iterations, [&]() { state->Save( snapshot_background, num_channels, true ); } );
+			const double restore_ns = nanoseconds_per_call( settings.iterations, [&]() { target->Restore( snapshot ); } );
+			const double restore_background_ns = nanoseconds_per_call( settings.iterations, [&]() { target->Restore( snapshot_background ); } );
+
+			auto sndFile = std::make_unique<CSoundFile>();
+			sndFile->Create( OpenMPT::FileReader(), CSoundFile::loadCompleteModule );
+			sndFile->m_nType = OpenMPT::MOD_TYPE_IT;
+			sndFile->m_nChannels = num_channels;
+			sndFile->Patterns.Insert( 0, 64 );
+			sndFile->Order().assign( 1, 0 );
+			const double get_length_ns = nanoseconds_per_call( settings.iterations, [&]() { sndFile->GetLength( OpenMPT::eNoAdjust ); } );
+			const double seek_ns = nanoseconds_per_call( settings.iterations, [&]() { sndFile->GetLength( OpenMPT::eAdjust, GetLengthTarget( 0, 32 ) ); } );
+
+			std::cout << num_channels << '\t' << num_background << '\t' << sizeof( CSoundFile::PlayState ) << '\t' << snapshot.GetMemoryUsage() << '\t' << snapshot_background.GetMemoryUsage() << '\t';
+			std::cout << std::fixed << std::setprecision( 1 ) << copy_ns << '\t' << save_ns << '\t' << save_background_ns << '\t' << restore_ns << '\t' << restore_background_ns << '\t' << get_length_ns << '\t' << seek_ns << std::defaultfloat << std::endl;
+		}
+	} catch ( const std::exception & e ) {
+		std::cerr << "Error: " << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -93,6 +93,7 @@ LOCAL_SRC_FILES += \
 	common/mptPathString.cpp \
 	common/mptRandom.cpp \
 	common/mptStringBuffer.cpp \
+	common/mptThreadPool.cpp \
 	common/mptTime.cpp \
 	common/Profiler.cpp \
 	common/serialization_utils.cpp \
@@ -101,11 +102,13 @@ LOCAL_SRC_FILES += \
 	libopenmpt/libopenmpt_cxx.cpp \
 	libopenmpt/libopenmpt_impl.cpp \
 	libopenmpt/libopenmpt_ext_impl.cpp \
+	libopenmpt/libopenmpt_render_ahead.cpp \
 	soundlib/AudioCriticalSection.cpp \
 	soundlib/ContainerMMCMP.cpp \
 	soundlib/ContainerPP20.cpp \
 	soundlib/ContainerUMX.cpp \
 	soundlib/ContainerXPK.cpp \
+	soundlib/DeferredSamples.cpp \
 	soundlib/Dlsbank.cpp \
 	soundlib/Fastmix.cpp \
 	soundlib/InstrumentExtensions.cpp \
@@ -182,6 +185,7 @@ LOCAL_SRC_FILES += \
 	soundlib/SampleFormatSFZ.cpp \
 	soundlib/SampleFormatVorbis.cpp \
 	soundlib/SampleIO.cpp \
+	soundlib/SharedSamples.cpp \
 	soundlib/Sndfile.cpp \
 	soundlib/Snd_flt.cpp \
 	soundlib/Snd_fx.cpp \
@@ -52,6 +52,7 @@
    "../../libopenmpt/libopenmpt_ext_impl.hpp",
    "../../libopenmpt/libopenmpt_impl.hpp",
    "../../libopenmpt/libopenmpt_internal.h",
+   "../../libopenmpt/libopenmpt_render_ahead.hpp",
    "../../libopenmpt/libopenmpt_stream_callbacks_buffer.h",
    "../../libopenmpt/libopenmpt_stream_callbacks_fd.h",
    "../../libopenmpt/libopenmpt_stream_callbacks_file.h",
@@ -64,6 +65,7 @@
    "../../libopenmpt/libopenmpt_cxx.cpp",
    "../../libopenmpt/libopenmpt_ext_impl.cpp",
    "../../libopenmpt/libopenmpt_impl.cpp",
+   "../../libopenmpt/libopenmpt_render_ahead.cpp",
   }
 	excludes {
 		"../../src/mpt/crypto/**.cpp",
@@ -128,6 +128,9 @@
 // (HACK) Define to build without any plugin support
 //#define NO_PLUGINS
 
+// Disable collection of render statistics (time spent per rendering stage, mixed and skipped voices)
+//#define NO_RENDER_STATS
+
 #endif // MODPLUG_TRACKER
 
 
@@ -164,8 +167,8 @@
 #else
 //#define MPT_ENABLE_CHARSET_LOCALE
 #endif
-// Do not use architecture-specifid intrinsics in library builds. There is just about no codepath which would use it anyway.
-//#define MPT_ENABLE_ARCH_INTRINSICS
+// Architecture-specific intrinsics are only used by code paths that produce bit-identical results to the generic code (e.g. the mixer interpolation kernels).
+#define MPT_ENABLE_ARCH_INTRINSICS
 #if defined(MPT_BUILD_HACK_ARCHIVE_SUPPORT)
 //#define NO_ARCHIVE_SUPPORT
 #else
@@ -176,6 +179,7 @@
 #define NO_EQ
 #define NO_AGC
 //#define NO_PLUGINS
+//#define NO_RENDER_STATS
 
 #endif // LIBOPENMPT_BUILD
 
@@ -235,6 +239,20 @@
 #define MPT_ENABLE_ARCH_INTRINSICS_SSE
 #define MPT_ENABLE_ARCH_INTRINSICS_SSE2
 
+#elif (MPT_COMPILER_GCC || MPT_COMPILER_CLANG) && defined(__i386__) && defined(__SSE2__)
+
+#define MPT_ENABLE_ARCH_X86
+
+#define MPT_ENABLE_ARCH_INTRINSICS_SSE
+#define MPT_ENABLE_ARCH_INTRINSICS_SSE2
+
+#elif (MPT_COMPILER_GCC || MPT_COMPILER_CLANG) && defined(__x86_64__)
+
+#define MPT_ENABLE_ARCH_AMD64
+
+#define MPT_ENABLE_ARCH_INTRINSICS_SSE
+#define MPT_ENABLE_ARCH_INTRINSICS_SSE2
+
 #endif // arch
 #endif // MPT_ENABLE_ARCH_INTRINSICS
 
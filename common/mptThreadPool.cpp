@@ -0,0 +1,189 @@
+/*
+ * mptThreadPool.cpp
+ * -----------------
+ * Purpose: Simple pool of worker threads for splitting work into a fixed number of tasks.
+ * Notes  : On platforms without thread support, all tasks are executed on the calling thread.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#include "stdafx.h"
+#include "mptThreadPool.h"
+
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+#if MPT_THREADPOOL_THREADS
+
+
+ThreadPool::ThreadPool(std::size_t numThreads)
+{
+	m_threads.reserve(numThreads);
+	try
+	{
+		for(std::size_t i = 0; i < numThreads; i++)
+		{
+			m_threads.emplace_back(&ThreadPool::WorkerThread, this);
+		}
+	} catch(...)
+	{
+		// The destructor is not going to run, so stop the threads that have already been started
+		Shutdown();
+		throw;
+	}
+}
+
+
+ThreadPool::~ThreadPool()
+{
+	Shutdown();
+}
+
+
+void ThreadPool::Shutdown()
+{
+	{
+		std::lock_guard<std::mutex> lock{m_mutex};
+		m_shutdown = true;
+	}
+	m_wakeWorkers.notify_all();
+	for(auto &thread : m_threads)
+	{
+		thread.join();
+	}
+}
+
+
+std::size_t ThreadPool::GetNumThreads() const noexcept
+{
+	return m_threads.size();
+}
+
+
+void ThreadPool::RunImpl(std::size_t numTasks, TaskFunc func, void *context)
+{
+	if(numTasks == 0)
+		return;
+	{
+		// Workers that woke up late for the previous call may still be looking at its (finished) task list
+		std::unique_lock<std::mutex> lock{m_mutex};
+		m_wakeCaller.wait(lock, [this] { return m_busyWorkers == 0; });
+		m_func = func;
+		m_context = context;
+		m_numTasks = numTasks;
+		m_nextTask = 0;
+		m_tasksDone = 0;
+		m_exception = nullptr;
+		if(numTasks > 1)
+			m_generation++;
+	}
+	if(numTasks > 1)
+		m_wakeWorkers.notify_all();
+
+	ExecuteTasks();
+
+	std::exception_ptr exception;
+	{
+		// Also wait for workers which did not get any task, so that they cannot pick up tasks from the next call to Run()
+		std::unique_lock<std::mutex> lock{m_mutex};
+		m_wakeCaller.wait(lock, [this] { return m_tasksDone == m_numTasks && m_busyWorkers == 0; });
+		exception = std::move(m_exception);
+		m_exception = nullptr;
+	}
+	if(exception)
+		std::rethrow_exception(exception);
+}
+
+
+void ThreadPool::WorkerThread()
+{
+	uint64 generation = 0;
+	std::unique_lock<std::mutex> lock{m_mutex};
+	while(true)
+	{
+		m_wakeWorkers.wait(lock, [this, generation] { return m_shutdown || m_generation != generation; });
+		if(m_shutdown)
+			return;
+		generation = m_generation;
+		m_busyWorkers++;
+		lock.unlock();
+		ExecuteTasks();
+		lock.lock();
+		m_busyWorkers--;
+		if(m_busyWorkers == 0 && m_tasksDone == m_numTasks)
+			m_wakeCaller.notify_one();
+	}
+}
+
+
+void ThreadPool::ExecuteTasks()
+{
+	std::size_t tasksDone = 0;
+	std::size_t task;
+	while((task = m_nextTask.fetch_add(1)) < m_numTasks)
+	{
+		try
+		{
+			m_func(m_context, task);
+		} catch(...)
+		{
+			std::lock_guard<std::mutex> lock{m_mutex};
+			if(!m_exception)
+				m_exception = std::current_exception();
+		}
+		tasksDone++;
+	}
+	if(tasksDone)
+	{
+		std::lock_guard<std::mutex> lock{m_mutex};
+		m_tasksDone += tasksDone;
+		if(m_tasksDone == m_numTasks && m_busyWorkers == 0)
+			m_wakeCaller.notify_one();
+	}
+}
+
+
+#else // !MPT_THREADPOOL_THREADS
+
+
+ThreadPool::ThreadPool(std::size_t)
+{
+}
+
+
+ThreadPool::~ThreadPool()
+{
+}
+
+
+std::size_t ThreadPool::GetNumThreads() const noexcept
+{
+	return 0;
+}
+
+
+void ThreadPool::RunImpl(std::size_t numTasks, TaskFunc func, void *context)
+{
+	std::exception_ptr exception;
+	for(std::size_t task = 0; task < numTasks; task++)
+	{
+		try
+		{
+			func(context, task);
+		} catch(...)
+		{
+			if(!exception)
+				exception = std::current_exception();
+		}
+	}
+	if(exception)
+		std::rethrow_exception(exception);
+}
+
+
+#endif // MPT_THREADPOOL_THREADS
+
+
+OPENMPT_NAMESPACE_END
@@ -0,0 +1,89 @@
+/*
+ * mptThreadPool.h
+ * ---------------
+ * Purpose: Simple pool of worker threads for splitting work into a fixed number of tasks.
+ * Notes  : On platforms without thread support, all tasks are executed on the calling thread.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#pragma once
+
+#include "openmpt/all/BuildSettings.hpp"
+
+#include "mpt/mutex/mutex.hpp"
+
+#include <exception>
+#include <type_traits>
+#include <vector>
+
+#include <cstddef>
+
+#if MPT_MUTEX_STD
+#define MPT_THREADPOOL_THREADS 1
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#else
+#define MPT_THREADPOOL_THREADS 0
+#endif
+
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+class ThreadPool
+{
+public:
+	// Creates numThreads worker threads. The thread calling Run() also executes tasks,
+	// so a pool with N worker threads processes up to N + 1 tasks in parallel.
+	explicit ThreadPool(std::size_t numThreads);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool &) = delete;
+	ThreadPool &operator=(const ThreadPool &) = delete;
+
+	// Number of worker threads, not including the calling thread
+	std::size_t GetNumThreads() const noexcept;
+
+	// Calls func(task) for each task in [0, numTasks) and returns once all tasks have finished.
+	// Which thread executes which task is unspecified, so tasks must only depend on their task index.
+	// If any task throws, the first exception is rethrown after all tasks have finished.
+	// Must not be called concurrently on the same pool.
+	template <typename Tfunc>
+	void Run(std::size_t numTasks, Tfunc &&func)
+	{
+		using func_t = std::remove_reference_t<Tfunc>;
+		RunImpl(numTasks, [](void *context, std::size_t task) { (*static_cast<func_t *>(context))(task); }, const_cast<std::remove_const_t<func_t> *>(&func));
+	}
+
+private:
+	using TaskFunc = void (*)(void *context, std::size_t task);
+
+	void RunImpl(std::size_t numTasks, TaskFunc func, void *context);
+#if MPT_THREADPOOL_THREADS
+	void Shutdown();
+	void WorkerThread();
+	void ExecuteTasks();
+
+	std::vector<std::thread> m_threads;
+	std::mutex m_mutex;
+	std::condition_variable m_wakeWorkers;
+	std::condition_variable m_wakeCaller;
+	uint64 m_generation = 0;
+	std::size_t m_busyWorkers = 0;
+	std::size_t m_tasksDone = 0;
+	bool m_shutdown = false;
+
+	TaskFunc m_func = nullptr;
+	void *m_context = nullptr;
+	std::size_t m_numTasks = 0;
+	std::atomic<std::size_t> m_nextTask = 0;
+	std::exception_ptr m_exception;
+#endif // MPT_THREADPOOL_THREADS
+};
+
+
+OPENMPT_NAMESPACE_END
@@ -1414,10 +1414,16 @@ LIBOPENMPT_API const char * openmpt_module_highlight_pattern_row_channel( openmp
  * \return A semicolon-separated list containing all supported ctl keys.
  * \remarks Currently supported ctl values are:
  *          - load.skip_samples (boolean): Set to "1" to avoid loading samples into memory
+ *          - load.lazy_samples (boolean): Set to "1" to decode sample data only when a sample is first played. Samples that are going to be played soon are decoded on a background thread if possible. The module data is kept in memory for as long as the module exists. This makes loading faster and uses less memory for samples that are never played. Only supported for IT and MPTM files; other formats are loaded as usual.
+ *          - load.parallel_samples (boolean): Set to "1" to decode sample data on several threads while loading. This makes loading IT, MPTM and MO3 files with many compressed samples faster on systems with multiple CPU cores. Has no effect if load.lazy_samples is enabled.
+ *          - load.share_samples (boolean): Set to "1" to share decoded sample data with other modules that were loaded from the same file data with this ctl enabled. This makes loading such modules faster and reduces memory usage when the same file is loaded several times at once. Has no effect if load.skip_samples is enabled. load.lazy_samples is ignored if this is enabled.
  *          - load.skip_patterns (boolean): Set to "1" to avoid loading patterns into memory
  *          - load.skip_plugins (boolean): Set to "1" to avoid loading plugins
  *          - load.skip_subsongs_init (boolean): Set to "1" to avoid pre-initializing sub-songs. Skipping results in faster module loading but slower seeking.
+ *          - load.parallel_subsongs (boolean): Set to "1" to determine the sub-songs of different sequences on several threads. This makes loading MPTM and MO3 files with many sequences faster on systems with multiple CPU cores. Has no effect if load.skip_subsongs_init is enabled.
  *          - seek.sync_samples (boolean): Set to "0" to not sync sample playback when using openmpt_module_set_position_seconds or openmpt_module_set_position_order_row.
+ *          - seek.index.interval (floatingpoint): Set to a value greater than "0.0" to remember the playback state every this many seconds of song time while seeking with openmpt_module_set_position_seconds. Subsequent seeks within the same sub-song resume from the closest remembered state instead of the sub-song start. Default is "0.0" (disabled).
+ *          - seek.index.max_memory (integer): Maximum amount of memory in bytes that may be used for remembering playback states with seek.index.interval. Default is 16 MiB.
  *          - subsong (integer): The current subsong. Setting it has identical semantics as openmpt_module_select_subsong(), getting it returns the currently selected subsong.
  *          - play.at_end (text): Chooses the behaviour when the end of song is reached. The song end is considered to be reached after the number of reptitions set by openmpt_module_set_repeat_count was played, so if the song is set to repeat infinitely, its end is never considered to be reached.
  *                         - "fadeout": Fades the module out for a short while. Subsequent reads after the fadeout will return 0 rendered frames.
@@ -1432,6 +1438,8 @@ LIBOPENMPT_API const char * openmpt_module_highlight_pattern_row_channel( openmp
  *                    - "a1200": Amiga A1200 filter.
  *                    - "unfiltered": BLEP synthesis without model-specific filters. The LED filter is ignored by this setting. This filter mode is considered to be experimental and might change in the future.
  *          - render.opl.volume_factor (floatingpoint): Set volume factor applied to synthesized OPL sounds, relative to the default OPL volume.
+ *          - render.mixer.threads (integer): Number of threads used for mixing sample voices. Values greater than "1" split the voices of modules with many simultaneously playing voices across multiple threads, and process plugin chains that do not depend on each other in parallel. The output is identical to single-threaded mixing, apart from rounding differences in builds using the floating point mixer. Valid values are "0" to "64", where "0" behaves like "1". Default is "1".
+ *          - render.mixer.chunk_size (integer): Maximum number of frames that are rendered in one go. Larger values reduce the per-chunk processing overhead when reading large blocks of audio, smaller values reduce the size of the mix buffers. Chunks are limited to 512 frames while any plugins are loaded. Valid values are "16" to "16384". Default is "512".
  *          - dither (integer): Set the dither algorithm that is used for the 16 bit versions of openmpt_module_read. Supported values are:
  *                    - 0: No dithering.
  *                    - 1: Default mode. Chosen by OpenMPT code, might change.
@@ -1812,6 +1812,156 @@ static int set_current_tempo2( openmpt_module_ext * mod_ext, double tempo ) {
 
 
 
+#ifndef NO_RENDER_STATS
+
+static openmpt::ext::render_stats::stage to_render_stage( int32_t stage ) {
+	if ( stage < openmpt::ext::render_stats::stage_read_note || stage > openmpt::ext::render_stats::stage_output ) {
+		throw openmpt::exception( "invalid render stage" );
+	}
+	return static_cast< openmpt::ext::render_stats::stage >( stage );
+}
+static int set_render_stats_enabled( openmpt_module_ext * mod_ext, int enable ) {
+	try {
+		openmpt::interface::check_soundfile( mod_ext );
+		mod_ext->impl->set_render_stats_enabled( enable ? true : false );
+		return 1;
+	} catch ( ... ) {
+		openmpt::report_exception( __func__, mod_ext ? &mod_ext->mod : NULL );
+	}
+	return 0;
+}
+static int get_render_stats_enabled( openmpt_module_ext * mod_ext ) {
+	try {
+		openmpt::interface::check_soundfile( mod_ext );
+		return mod_ext->impl->get_render_stats_enabled() ? 1 : 0;
+	} catch ( ... ) {
+		openmpt::report_exception( __func__, mod_ext ? &mod_ext->mod : NULL );
+	}
+	return 0;
+}
+static int reset_render_stats( openmpt_module_ext * mod_ext ) {
+	try {
+		openmpt::interface::check_soundfile( mod_ext );
+		mod_ext->impl->reset_render_stats();
+		return 1;
+	} catch ( ... ) {
+		openmpt::report_exception( __func__, mod_ext ? &mod_ext->mod : NULL );
+	}
+	return 0;
+}
+static uint64_t get_stage_nanoseconds( openmpt_module_ext * mod_ext, int32_t stage ) {
+	try {
+		openmpt::interface::check_soundfile( mod_ext );
+		return mod_ext->impl->get_stage_nanoseconds( to_render_stage( stage ) );
+	} catch ( ... ) {
+		openmpt::report_exception( __func__, mod_ext ? &mod_ext->mod : NULL );
+	}
+	return 0;
+}
+static uint64_t get_stage_calls( openmpt_module_ext * mod_ext, int32_t stage ) {
+	try {
+		openmpt::interface::check_soundfile( mod_ext );
+		return mod_ext->impl->get_stage_calls( to_render_stage( stage ) );
+	} catch ( ... ) {
+		openmpt::report_exception( __func__, mod_ext ? &mod_ext->mod : NULL );
+	}
+	return 0;
+}
+static uint64_t get_mixed_voices( openmpt_module_ext * mod_ext ) {
+	try {
+		openmpt::interface::check_soundfile( mod_ext );
+		return mod_ext->impl->get_mixed_voices();
+	} catch ( ... ) {
+		openmpt::report_exception( __func__, mod_ext ? &mod_ext->mod : NULL );
+	}
+	return 0;
+}
+static int32_t get_max_mixed_voices( openmpt_module_ext * mod_ext ) {
+	try {
+		openmpt::interface::check_soundfile( mod_ext );
+		return mod_ext->impl->get_max_mixed_voices();
+	} catch ( ... ) {
+		openmpt::report_exception( __func__, mod_ext ? &mod_ext->mod : NULL );
+	}
+	return 0;
+}
+static uint64_t get_skipped_voices( openmpt_module_ext * mod_ext ) {
+	try {
+		openmpt::interface::check_soundfile( mod_ext );
+		return mod_ext->impl->get_skipped_voices();
+	} catch ( ... ) {
+		openmpt::report_exception( __func__, mod_ext ? &mod_ext->mod : NULL );
+	}
+	return 0;
+}
+static uint64_t get_skipped_frames( openmpt_module_ext * mod_ext ) {
+	try {
+		openmpt::interface::check_soundfile( mod_ext );
+		return mod_ext->impl->get_skipped_frames();
+	} catch ( ... ) {
+		openmpt::report_exception( __func__, mod_ext ? &mod_ext->mod : NULL );
+	}
+	return 0;
+}
+
+#endif // NO_RENDER_STATS
+
+
+
+#if LIBOPENMPT_RENDER_AHEAD
+
+static int start_render_ahead( openmpt_module_ext * mod_ext, int32_t samplerate, int channels, int32_t frames ) {
+	try {
+		openmpt::interface::check_soundfile( mod_ext );
+		mod_ext->impl->start_render_ahead( samplerate, channels, frames );
+		return 1;
+	} catch ( ... ) {
+		openmpt::report_exception( __func__, mod_ext ? &mod_ext->mod : NULL );
+	}
+	return 0;
+}
+static int stop_render_ahead( openmpt_module_ext * mod_ext ) {
+	try {
+		openmpt::interface::check_soundfile( mod_ext );
+		mod_ext->impl->stop_render_ahead();
+		return 1;
+	} catch ( ... ) {
+		openmpt::report_exception( __func__, mod_ext ? &mod_ext->mod : NULL );
+	}
+	return 0;
+}
+static int is_render_ahead_active( openmpt_module_ext * mod_ext ) {
+	try {
+		openmpt::interface::check_soundfile( mod_ext );
+		return mod_ext->impl->is_render_ahead_active() ? 1 : 0;
+	} catch ( ... ) {
+		openmpt::report_exception( __func__, mod_ext ? &mod_ext->mod : NULL );
+	}
+	return 0;
+}
+static int32_t get_render_ahead_queued_frames( openmpt_module_ext * mod_ext ) {
+	try {
+		openmpt::interface::check_soundfile( mod_ext );
+		return mod_ext->impl->get_render_ahead_queued_frames();
+	} catch ( ... ) {
+		openmpt::report_exception( __func__, mod_ext ? &mod_ext->mod : NULL );
+	}
+	return 0;
+}
+static uint64_t get_render_ahead_underruns( openmpt_module_ext * mod_ext ) {
+	try {
+		openmpt::interface::check_soundfile( mod_ext );
+		return mod_ext->impl->get_render_ahead_underruns();
+	} catch ( ... ) {
+		openmpt::report_exception( __func__, mod_ext ? &mod_ext->mod : NULL );
+	}
+	return 0;
+}
+
+#endif // LIBOPENMPT_RENDER_AHEAD
+
+
+
 /* add stuff here */
 
 
@@ -1877,6 +2027,36 @@ int openmpt_module_ext_get_interface( openmpt_module_ext * mod_ext, const char *
 
 
 
+#ifndef NO_RENDER_STATS
+		} else if ( !std::strcmp( interface_id, LIBOPENMPT_EXT_C_INTERFACE_RENDER_STATS ) && ( interface_size == sizeof( openmpt_module_ext_interface_render_stats ) ) ) {
+			openmpt_module_ext_interface_render_stats * i = static_cast< openmpt_module_ext_interface_render_stats * >( interface );
+			i->set_render_stats_enabled = &set_render_stats_enabled;
+			i->get_render_stats_enabled = &get_render_stats_enabled;
+			i->reset_render_stats = &reset_render_stats;
+			i->get_stage_nanoseconds = &get_stage_nanoseconds;
+			i->get_stage_calls = &get_stage_calls;
+			i->get_mixed_voices = &get_mixed_voices;
+			i->get_max_mixed_voices = &get_max_mixed_voices;
+			i->get_skipped_voices = &get_skipped_voices;
+			i->get_skipped_frames = &get_skipped_frames;
+			result = 1;
+#endif // NO_RENDER_STATS
+
+
+
+#if LIBOPENMPT_RENDER_AHEAD
+		} else if ( !std::strcmp( interface_id, LIBOPENMPT_EXT_C_INTERFACE_RENDER_AHEAD ) && ( interface_size == sizeof( openmpt_module_ext_interface_render_ahead ) ) ) {
+			openmpt_module_ext_interface_render_ahead * i = static_cast< openmpt_module_ext_interface_render_ahead * >( interface );
+			i->start_render_ahead = &start_render_ahead;
+			i->stop_render_ahead = &stop_render_ahead;
+			i->is_render_ahead_active = &is_render_ahead_active;
+			i->get_render_ahead_queued_frames = &get_render_ahead_queued_frames;
+			i->get_render_ahead_underruns = &get_render_ahead_underruns;
+			result = 1;
+#endif // LIBOPENMPT_RENDER_AHEAD
+
+
+
 /* add stuff here */
 
 
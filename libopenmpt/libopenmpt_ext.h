@@ -410,6 +410,171 @@ typedef struct openmpt_module_ext_interface_interactive3 {
 
 
 
+#ifndef LIBOPENMPT_EXT_C_INTERFACE_RENDER_STATS
+#define LIBOPENMPT_EXT_C_INTERFACE_RENDER_STATS "render_stats"
+#endif
+
+/*! Rendering stage */
+#define OPENMPT_MODULE_EXT_INTERFACE_RENDER_STATS_STAGE_READ_NOTE         0
+#define OPENMPT_MODULE_EXT_INTERFACE_RENDER_STATS_STAGE_MIX               1
+#define OPENMPT_MODULE_EXT_INTERFACE_RENDER_STATS_STAGE_OPL               2
+#define OPENMPT_MODULE_EXT_INTERFACE_RENDER_STATS_STAGE_REVERB            3
+#define OPENMPT_MODULE_EXT_INTERFACE_RENDER_STATS_STAGE_PLUGINS           4
+#define OPENMPT_MODULE_EXT_INTERFACE_RENDER_STATS_STAGE_GLOBAL_VOLUME     5
+#define OPENMPT_MODULE_EXT_INTERFACE_RENDER_STATS_STAGE_STEREO_SEPARATION 6
+#define OPENMPT_MODULE_EXT_INTERFACE_RENDER_STATS_STAGE_DSP               7
+#define OPENMPT_MODULE_EXT_INTERFACE_RENDER_STATS_STAGE_OUTPUT            8
+
+/*! Statistics about the work done while rendering, for profiling.
+ *
+ * \remarks This interface is not available if libopenmpt was built without render statistics (NO_RENDER_STATS).
+ * \since 0.8.0
+ */
+typedef struct openmpt_module_ext_interface_render_stats {
+
+	/*! Enable or disable collection of render statistics
+	 *
+	 * \param mod_ext The module handle to work on.
+	 * \param enable 1 to collect statistics in all following render calls. Collecting statistics adds a small overhead to rendering. Default is 0.
+	 * \return 1 on success, 0 on failure.
+	 * \remarks Already collected statistics are kept. Use openmpt_module_ext_interface_render_stats::reset_render_stats to reset them.
+	 * \sa openmpt_module_ext_interface_render_stats::get_render_stats_enabled
+	 */
+	int ( * set_render_stats_enabled ) ( openmpt_module_ext * mod_ext, int enable );
+
+	/*! Get whether render statistics are collected
+	 *
+	 * \param mod_ext The module handle to work on.
+	 * \return 1 if render statistics are collected, 0 otherwise.
+	 * \sa openmpt_module_ext_interface_render_stats::set_render_stats_enabled
+	 */
+	int ( * get_render_stats_enabled ) ( openmpt_module_ext * mod_ext );
+
+	/*! Reset all render statistics to zero
+	 *
+	 * \param mod_ext The module handle to work on.
+	 * \return 1 on success, 0 on failure.
+	 */
+	int ( * reset_render_stats ) ( openmpt_module_ext * mod_ext );
+
+	/*! Get the time spent in a rendering stage
+	 *
+	 * \param mod_ext The module handle to work on.
+	 * \param stage The rendering stage (see OPENMPT_MODULE_EXT_INTERFACE_RENDER_STATS_STAGE_*).
+	 * \return The accumulated time in nanoseconds that was spent in the given stage, or 0 if the stage is invalid.
+	 */
+	uint64_t ( * get_stage_nanoseconds ) ( openmpt_module_ext * mod_ext, int32_t stage );
+
+	/*! Get the number of times a rendering stage was executed
+	 *
+	 * \param mod_ext The module handle to work on.
+	 * \param stage The rendering stage (see OPENMPT_MODULE_EXT_INTERFACE_RENDER_STATS_STAGE_*).
+	 * \return The number of rendered chunks in which the given stage was executed, or 0 if the stage is invalid. Stages that have nothing to do (e.g. OPL synthesis in modules without OPL instruments) are not counted.
+	 * \remarks OPENMPT_MODULE_EXT_INTERFACE_RENDER_STATS_STAGE_MIX is executed once for every rendered chunk.
+	 */
+	uint64_t ( * get_stage_calls ) ( openmpt_module_ext * mod_ext, int32_t stage );
+
+	/*! Get the number of mixed voices
+	 *
+	 * \param mod_ext The module handle to work on.
+	 * \return The number of voices mixed, summed up over all rendered chunks. Divide by the number of calls of OPENMPT_MODULE_EXT_INTERFACE_RENDER_STATS_STAGE_MIX to get the average number of voices per chunk.
+	 */
+	uint64_t ( * get_mixed_voices ) ( openmpt_module_ext * mod_ext );
+
+	/*! Get the highest number of voices mixed in a single chunk
+	 *
+	 * \param mod_ext The module handle to work on.
+	 * \return The highest number of voices mixed in a single chunk.
+	 */
+	int32_t ( * get_max_mixed_voices ) ( openmpt_module_ext * mod_ext );
+
+	/*! Get the number of voices that were not mixed because the voice limit was reached
+	 *
+	 * \param mod_ext The module handle to work on.
+	 * \return The number of voices that were skipped because more voices were playing than the mixer is allowed to mix, summed up over all rendered chunks.
+	 */
+	uint64_t ( * get_skipped_voices ) ( openmpt_module_ext * mod_ext );
+
+	/*! Get the number of sample frames that were not mixed because the voice limit was reached
+	 *
+	 * \param mod_ext The module handle to work on.
+	 * \return The number of sample frames of all skipped voices, in output sample frames.
+	 */
+	uint64_t ( * get_skipped_frames ) ( openmpt_module_ext * mod_ext );
+
+} openmpt_module_ext_interface_render_stats;
+
+
+
+#ifndef LIBOPENMPT_EXT_C_INTERFACE_RENDER_AHEAD
+#define LIBOPENMPT_EXT_C_INTERFACE_RENDER_AHEAD "render_ahead"
+#endif
+
+/*! Render audio ahead of playback on a background thread.
+ *
+ * While rendering ahead is active, the module is rendered on a background thread into a queue, and openmpt_module_read_* only copy already rendered audio out of that queue. They never wait for the background thread and never allocate memory, which makes them suitable for calling from a realtime audio callback.
+ *
+ * \remarks The read functions must be called with the sample rate and number of channels that were passed to openmpt_module_ext_interface_render_ahead::start_render_ahead, otherwise they fail and return 0.
+ * \remarks If the queue runs empty, the read functions output silence and still return the requested number of frames. See openmpt_module_ext_interface_render_ahead::get_render_ahead_underruns.
+ * \remarks The end of the song is reported exactly like without rendering ahead: A read returns fewer frames than requested, and the following read returns 0.
+ * \remarks Seeking (openmpt_module_set_position_seconds, openmpt_module_set_position_order_row, openmpt_module_select_subsong) discards all queued audio.
+ * \remarks Changing ctls, render parameters, the repeat count, or using the interactive interfaces discards all queued audio except for the block that is currently being read (at most a few milliseconds), and the module is rewound to the end of that block. The state of plugins, OPL synthesis, reverb and DSP effects cannot be rewound. If any of them were used for rendering the queued audio, no queued audio is discarded instead, and the change only becomes audible after all queued audio has been read.
+ * \remarks The master gain (OPENMPT_MODULE_RENDER_MASTERGAIN_MILLIBEL) and the dither ctl are applied while reading and take effect immediately without discarding any queued audio.
+ * \remarks openmpt_module_get_position_seconds reports the position of the audio that has been read. The functions that query the current playback state (e.g. openmpt_module_get_current_row, the tempo, speed, and channel VU meters) report the state at the start of the block that is currently being read, so they lag behind the audio that has been read by at most one block.
+ * \remarks The read functions may be called on one thread while all other functions are called on another thread. Functions other than the read functions may block for a short time while the background thread renders a block. Apart from that, the usual libopenmpt thread-safety rules apply.
+ * \remarks This interface is not available if libopenmpt was built without thread support.
+ * \since 0.8.0
+ */
+typedef struct openmpt_module_ext_interface_render_ahead {
+
+	/*! Start rendering ahead on a background thread
+	 *
+	 * \param mod_ext The module handle to work on.
+	 * \param samplerate The sample rate that all following read calls will use. Must be positive.
+	 * \param channels The number of channels that all following read calls will use. Must be 1, 2 or 4.
+	 * \param frames The number of sample frames to render ahead. Must be between 1 and 16777216. The latency of changes that are not applied immediately is bounded by the block size, which is a quarter of this value but at most 512 frames.
+	 * \return 1 on success, 0 on failure.
+	 * \remarks If rendering ahead is already active, it is stopped first.
+	 * \sa openmpt_module_ext_interface_render_ahead::stop_render_ahead
+	 */
+	int ( * start_render_ahead ) ( openmpt_module_ext * mod_ext, int32_t samplerate, int channels, int32_t frames );
+
+	/*! Stop rendering ahead
+	 *
+	 * Stops the background thread and rewinds the module to the position of the audio that has been read, discarding all queued audio. The following read calls render synchronously again. The state of plugins, OPL synthesis, reverb and DSP effects is not rewound.
+	 *
+	 * \param mod_ext The module handle to work on.
+	 * \return 1 on success, 0 on failure.
+	 * \remarks Must not be called concurrently with a read function.
+	 * \sa openmpt_module_ext_interface_render_ahead::start_render_ahead
+	 */
+	int ( * stop_render_ahead ) ( openmpt_module_ext * mod_ext );
+
+	/*! Get whether rendering ahead is active
+	 *
+	 * \param mod_ext The module handle to work on.
+	 * \return 1 if rendering ahead is active, 0 otherwise.
+	 */
+	int ( * is_render_ahead_active ) ( openmpt_module_ext * mod_ext );
+
+	/*! Get the amount of queued audio
+	 *
+	 * \param mod_ext The module handle to work on.
+	 * \return The number of sample frames that have been rendered ahead and not been read yet, or 0 if rendering ahead is not active.
+	 */
+	int32_t ( * get_render_ahead_queued_frames ) ( openmpt_module_ext * mod_ext );
+
+	/*! Get the number of underrun frames
+	 *
+	 * \param mod_ext The module handle to work on.
+	 * \return The number of sample frames of silence that have been output because the queue was empty, since rendering ahead has been started.
+	 */
+	uint64_t ( * get_render_ahead_underruns ) ( openmpt_module_ext * mod_ext );
+
+} openmpt_module_ext_interface_render_ahead;
+
+
+
 /* add stuff here */
 
 
@@ -410,6 +410,162 @@ class interactive3 {
 }; // class interactive3
 
 
+#ifndef LIBOPENMPT_EXT_INTERFACE_RENDER_STATS
+#define LIBOPENMPT_EXT_INTERFACE_RENDER_STATS
+#endif
+
+LIBOPENMPT_DECLARE_EXT_CXX_INTERFACE(render_stats)
+
+/*!
+  Statistics about the work done while rendering, for profiling.
+  \remarks This interface is not available if libopenmpt was built without render statistics (NO_RENDER_STATS).
+  \since 0.8.0
+*/
+class render_stats {
+
+	LIBOPENMPT_EXT_CXX_INTERFACE(render_stats)
+
+	//! Rendering stage
+	enum stage {
+
+		stage_read_note = 0,          //!< Processing of pattern data and channel state
+		stage_mix = 1,                //!< Mixing of sample voices
+		stage_opl = 2,                //!< OPL synthesis
+		stage_reverb = 3,             //!< Built-in reverb
+		stage_plugins = 4,            //!< Mix plugins
+		stage_global_volume = 5,      //!< Global volume applied to the master mix
+		stage_stereo_separation = 6,  //!< Stereo separation
+		stage_dsp = 7,                //!< Built-in DSP effects
+		stage_output = 8              //!< Conversion to the output sample format, including dithering
+
+	}; // enum stage
+
+	//! Enable or disable collection of render statistics
+	/*!
+	  \param enable true to collect statistics in all following render calls. Collecting statistics adds a small overhead to rendering. Default is false.
+	  \remarks Already collected statistics are kept. Use openmpt::ext::render_stats::reset_render_stats to reset them.
+	  \sa openmpt::ext::render_stats::get_render_stats_enabled
+	*/
+	virtual void set_render_stats_enabled( bool enable ) = 0;
+
+	//! Get whether render statistics are collected
+	/*!
+	  \return true if render statistics are collected.
+	  \sa openmpt::ext::render_stats::set_render_stats_enabled
+	*/
+	virtual bool get_render_stats_enabled( ) const = 0;
+
+	//! Reset all render statistics to zero
+	virtual void reset_render_stats( ) = 0;
+
+	//! Get the time spent in a rendering stage
+	/*!
+	  \param s The rendering stage.
+	  \return The accumulated time in nanoseconds that was spent in the given stage.
+	  \throws openmpt::exception Throws an exception derived from openmpt::exception if the stage is invalid.
+	*/
+	virtual std::uint64_t get_stage_nanoseconds( stage s ) const = 0;
+
+	//! Get the number of times a rendering stage was executed
+	/*!
+	  \param s The rendering stage.
+	  \return The number of rendered chunks in which the given stage was executed. Stages that have nothing to do (e.g. OPL synthesis in modules without OPL instruments) are not counted.
+	  \remarks openmpt::ext::render_stats::stage_mix is executed once for every rendered chunk.
+	  \throws openmpt::exception Throws an exception derived from openmpt::exception if the stage is invalid.
+	*/
+	virtual std::uint64_t get_stage_calls( stage s ) const = 0;
+
+	//! Get the number of mixed voices
+	/*!
+	  \return The number of voices mixed, summed up over all rendered chunks. Divide by the number of calls of openmpt::ext::render_stats::stage_mix to get the average number of voices per chunk.
+	*/
+	virtual std::uint64_t get_mixed_voices( ) const = 0;
+
+	//! Get the highest number of voices mixed in a single chunk
+	virtual std::int32_t get_max_mixed_voices( ) const = 0;
+
+	//! Get the number of voices that were not mixed because the voice limit was reached
+	/*!
+	  \return The number of voices that were skipped because more voices were playing than the mixer is allowed to mix, summed up over all rendered chunks.
+	*/
+	virtual std::uint64_t get_skipped_voices( ) const = 0;
+
+	//! Get the number of sample frames that were not mixed because the voice limit was reached
+	/*!
+	  \return The number of sample frames of all skipped voices, in output sample frames.
+	*/
+	virtual std::uint64_t get_skipped_frames( ) const = 0;
+
+}; // class render_stats
+
+
+
+#ifndef LIBOPENMPT_EXT_INTERFACE_RENDER_AHEAD
+#define LIBOPENMPT_EXT_INTERFACE_RENDER_AHEAD
+#endif
+
+LIBOPENMPT_DECLARE_EXT_CXX_INTERFACE(render_ahead)
+
+/*!
+  Render audio ahead of playback on a background thread.
+
+  While rendering ahead is active, the module is rendered on a background thread into a queue, and openmpt::module::read and openmpt::module::read_interleaved_stereo etc. only copy already rendered audio out of that queue. They never wait for the background thread and never allocate memory, which makes them suitable for calling from a realtime audio callback.
+
+  \remarks The read functions must be called with the sample rate and number of channels that were passed to openmpt::ext::render_ahead::start_render_ahead, otherwise they throw an exception.
+  \remarks If the queue runs empty, the read functions output silence and still return the requested number of frames. See openmpt::ext::render_ahead::get_render_ahead_underruns.
+  \remarks The end of the song is reported exactly like without rendering ahead: A read returns fewer frames than requested, and the following read returns 0.
+  \remarks Seeking (openmpt::module::set_position_seconds, openmpt::module::set_position_order_row, openmpt::module::select_subsong) discards all queued audio.
+  \remarks Changing ctls, render parameters, the repeat count, or using the interactive interfaces discards all queued audio except for the block that is currently being read (at most a few milliseconds), and the module is rewound to the end of that block. The state of plugins, OPL synthesis, reverb and DSP effects cannot be rewound. If any of them were used for rendering the queued audio, no queued audio is discarded instead, and the change only becomes audible after all queued audio has been read.
+  \remarks The master gain (openmpt::module::RENDER_MASTERGAIN_MILLIBEL) and the dither ctl are applied while reading and take effect immediately without discarding any queued audio.
+  \remarks openmpt::module::get_position_seconds reports the position of the audio that has been read. The functions that query the current playback state (e.g. openmpt::module::get_current_row, the tempo, speed, and channel VU meters) report the state at the start of the block that is currently being read, so they lag behind the audio that has been read by at most one block.
+  \remarks The read functions may be called on one thread while all other functions are called on another thread. Functions other than the read functions may block for a short time while the background thread renders a block. Apart from that, the usual libopenmpt thread-safety rules apply.
+  \remarks This interface is not available if libopenmpt was built without thread support.
+  \since 0.8.0
+*/
+class render_ahead {
+
+	LIBOPENMPT_EXT_CXX_INTERFACE(render_ahead)
+
+	//! Start rendering ahead on a background thread
+	/*!
+	  \param samplerate The sample rate that all following read calls will use. Must be positive.
+	  \param channels The number of channels that all following read calls will use. Must be 1, 2 or 4.
+	  \param frames The number of sample frames to render ahead. Must be between 1 and 16777216. The latency of changes that are not applied immediately is bounded by the block size, which is a quarter of this value but at most 512 frames.
+	  \throws openmpt::exception Throws an exception derived from openmpt::exception if any parameter is invalid or the background thread cannot be started.
+	  \remarks If rendering ahead is already active, it is stopped first.
+	  \sa openmpt::ext::render_ahead::stop_render_ahead
+	*/
+	virtual void start_render_ahead( std::int32_t samplerate, int channels, std::int32_t frames ) = 0;
+
+	//! Stop rendering ahead
+	/*!
+	  Stops the background thread and rewinds the module to the position of the audio that has been read, discarding all queued audio. The following read calls render synchronously again. The state of plugins, OPL synthesis, reverb and DSP effects is not rewound.
+	  \remarks Must not be called concurrently with a read function.
+	  \sa openmpt::ext::render_ahead::start_render_ahead
+	*/
+	virtual void stop_render_ahead( ) = 0;
+
+	//! Get whether rendering ahead is active
+	/*!
+	  \return true if rendering ahead is active.
+	*/
+	virtual bool is_render_ahead_active( ) const = 0;
+
+	//! Get the amount of queued audio
+	/*!
+	  \return The number of sample frames that have been rendered ahead and not been read yet, or 0 if rendering ahead is not active.
+	*/
+	virtual std::int32_t get_render_ahead_queued_frames( ) const = 0;
+
+	//! Get the number of underrun frames
+	/*!
+	  \return The number of sample frames of silence that have been output because the queue was empty, since rendering ahead has been started.
+	*/
+	virtual std::uint64_t get_render_ahead_underruns( ) const = 0;
+
+}; // class render_ahead
+
+
 
 /* add stuff here */
 
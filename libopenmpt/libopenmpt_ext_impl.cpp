@@ -13,6 +13,9 @@
 #include "libopenmpt_ext.hpp"
 
 #include "libopenmpt_ext_impl.hpp"
+#include "libopenmpt_render_ahead.hpp"
+
+#include <chrono>
 
 #include "mpt/base/saturate_round.hpp"
 
@@ -87,6 +90,14 @@ namespace openmpt {
 			return dynamic_cast< ext::interactive2 * >( this );
 		} else if ( interface_id == ext::interactive3_id ) {
 			return dynamic_cast< ext::interactive3 * >( this );
+#ifndef NO_RENDER_STATS
+		} else if ( interface_id == ext::render_stats_id ) {
+			return dynamic_cast< ext::render_stats * >( this );
+#endif // NO_RENDER_STATS
+#if LIBOPENMPT_RENDER_AHEAD
+		} else if ( interface_id == ext::render_ahead_id ) {
+			return dynamic_cast< ext::render_ahead * >( this );
+#endif // LIBOPENMPT_RENDER_AHEAD
 
 
 
@@ -131,6 +142,7 @@ namespace openmpt {
 		if ( speed < 1 || speed > 65535 ) {
 			throw openmpt::exception("invalid tick count");
 		}
+		const render_ahead_guard guard = splice_render_ahead();
 		m_sndFile->m_PlayState.m_nMusicSpeed = speed;
 	}
 
@@ -138,6 +150,7 @@ namespace openmpt {
 		if ( tempo < 32 || tempo > 512 ) {
 			throw openmpt::exception("invalid tempo");
 		}
+		const render_ahead_guard guard = splice_render_ahead();
 		m_sndFile->m_PlayState.m_nMusicTempo.Set( tempo );
 	}
 
@@ -145,11 +158,13 @@ namespace openmpt {
 		if ( factor <= 0.0 || factor > 4.0 ) {
 			throw openmpt::exception("invalid tempo factor");
 		}
+		const render_ahead_guard guard = splice_render_ahead();
 		m_sndFile->m_nTempoFactor = mpt::saturate_round<uint32_t>( 65536.0 / factor );
 		m_sndFile->RecalculateSamplesPerTick();
 	}
 
 	double module_ext_impl::get_tempo_factor( ) const {
+		const render_ahead_guard guard = lock_render_ahead();
 		return 65536.0 / m_sndFile->m_nTempoFactor;
 	}
 
@@ -157,11 +172,13 @@ namespace openmpt {
 		if ( factor <= 0.0 || factor > 4.0 ) {
 			throw openmpt::exception("invalid pitch factor");
 		}
+		const render_ahead_guard guard = splice_render_ahead();
 		m_sndFile->m_nFreqFactor = mpt::saturate_round<uint32_t>( 65536.0 * factor );
 		m_sndFile->RecalculateSamplesPerTick();
 	}
 
 	double module_ext_impl::get_pitch_factor( ) const {
+		const render_ahead_guard guard = lock_render_ahead();
 		return m_sndFile->m_nFreqFactor / 65536.0;
 	}
 
@@ -169,10 +186,12 @@ namespace openmpt {
 		if ( volume < 0.0 || volume > 1.0 ) {
 			throw openmpt::exception("invalid global volume");
 		}
+		const render_ahead_guard guard = splice_render_ahead();
 		m_sndFile->m_PlayState.m_nGlobalVolume = mpt::saturate_round<uint32_t>( volume * MAX_GLOBAL_VOLUME );
 	}
 
 	double module_ext_impl::get_global_volume( ) const {
+		const render_ahead_guard guard = lock_render_ahead();
 		return m_sndFile->m_PlayState.m_nGlobalVolume / static_cast<double>( MAX_GLOBAL_VOLUME );
 	}
 	
@@ -183,10 +202,12 @@ namespace openmpt {
 		if ( volume < 0.0 || volume > 1.0 ) {
 			throw openmpt::exception("invalid global volume");
 		}
+		const render_ahead_guard guard = splice_render_ahead();
 		m_sndFile->m_PlayState.Chn[channel].nGlobalVol = mpt::saturate_round<std::int32_t>(volume * 64.0);
 	}
 
 	double module_ext_impl::get_channel_volume( std::int32_t channel ) const {
+		const render_ahead_guard guard = lock_render_ahead();
 		if ( channel < 0 || channel >= get_num_channels() ) {
 			throw openmpt::exception("invalid channel");
 		}
@@ -197,6 +218,7 @@ namespace openmpt {
 		if ( channel < 0 || channel >= get_num_channels() ) {
 			throw openmpt::exception("invalid channel");
 		}
+		const render_ahead_guard guard = splice_render_ahead();
 		m_sndFile->ChnSettings[channel].dwFlags.set( OpenMPT::CHN_MUTE | OpenMPT::CHN_SYNCMUTE , mute );
 		m_sndFile->m_PlayState.Chn[channel].dwFlags.set( OpenMPT::CHN_MUTE | OpenMPT::CHN_SYNCMUTE , mute );
 
@@ -208,9 +230,15 @@ namespace openmpt {
 				m_sndFile->m_PlayState.Chn[i].dwFlags.set( OpenMPT::CHN_MUTE | OpenMPT::CHN_SYNCMUTE, mute );
 			}
 		}
+
+		// Muted channels may be skipped entirely by the seek simulation
+		if ( m_SeekIndex ) {
+			m_SeekIndex->Clear();
+		}
 	}
 
 	bool module_ext_impl::get_channel_mute_status( std::int32_t channel ) const {
+		const render_ahead_guard guard = lock_render_ahead();
 		if ( channel < 0 || channel >= get_num_channels() ) {
 			throw openmpt::exception("invalid channel");
 		}
@@ -223,6 +251,7 @@ namespace openmpt {
 		if ( instrument < 0 || instrument >= max_instrument ) {
 			throw openmpt::exception("invalid instrument");
 		}
+		const render_ahead_guard guard = splice_render_ahead();
 		if ( instrument_mode ) {
 			if ( m_sndFile->Instruments[instrument + 1] != nullptr ) {
 				m_sndFile->Instruments[instrument + 1]->dwFlags.set( OpenMPT::INS_MUTE, mute );
@@ -233,6 +262,7 @@ namespace openmpt {
 	}
 
 	bool module_ext_impl::get_instrument_mute_status( std::int32_t instrument ) const {
+		const render_ahead_guard guard = lock_render_ahead();
 		const bool instrument_mode = get_num_instruments() != 0;
 		const std::int32_t max_instrument = instrument_mode ? get_num_instruments() : get_num_samples();
 		if ( instrument < 0 || instrument >= max_instrument ) {
@@ -258,6 +288,7 @@ namespace openmpt {
 		if ( note < OpenMPT::NOTE_MIN || note > OpenMPT::NOTE_MAX ) {
 			throw openmpt::exception("invalid note");
 		}
+		const render_ahead_guard guard = splice_render_ahead();
 
 		// Find a free channel
 		OpenMPT::CHANNELINDEX free_channel = m_sndFile->GetNNAChannel( OpenMPT::CHANNELINDEX_INVALID );
@@ -293,6 +324,7 @@ namespace openmpt {
 		if ( channel < 0 || channel >= OpenMPT::MAX_CHANNELS ) {
 			throw openmpt::exception("invalid channel");
 		}
+		const render_ahead_guard guard = splice_render_ahead();
 		auto & chn = m_sndFile->m_PlayState.Chn[channel];
 		chn.nLength = 0;
 		chn.pCurrentSample = nullptr;
@@ -302,6 +334,7 @@ namespace openmpt {
 		if ( channel < 0 || channel >= OpenMPT::MAX_CHANNELS ) {
 			throw openmpt::exception( "invalid channel" );
 		}
+		const render_ahead_guard guard = splice_render_ahead();
 		auto & chn = m_sndFile->m_PlayState.Chn[channel];
 		chn.dwFlags |= OpenMPT::CHN_KEYOFF;
 	}
@@ -310,6 +343,7 @@ namespace openmpt {
 		if ( channel < 0 || channel >= OpenMPT::MAX_CHANNELS ) {
 			throw openmpt::exception( "invalid channel" );
 		}
+		const render_ahead_guard guard = splice_render_ahead();
 		auto & chn = m_sndFile->m_PlayState.Chn[channel];
 		chn.dwFlags |= OpenMPT::CHN_NOTEFADE;
 	}
@@ -318,11 +352,13 @@ namespace openmpt {
 		if ( channel < 0 || channel >= OpenMPT::MAX_CHANNELS ) {
 			throw openmpt::exception( "invalid channel" );
 		}
+		const render_ahead_guard guard = splice_render_ahead();
 		auto & chn = m_sndFile->m_PlayState.Chn[channel];
 		chn.nPan = mpt::saturate_round<int32_t>( std::clamp( panning, -1.0, 1.0 ) * 128.0 + 128.0 );
 	}
 
 	double module_ext_impl::get_channel_panning( int32_t channel ) {
+		const render_ahead_guard guard = lock_render_ahead();
 		if ( channel < 0 || channel >= OpenMPT::MAX_CHANNELS ) {
 			throw openmpt::exception( "invalid channel" );
 		}
@@ -334,11 +370,13 @@ namespace openmpt {
 		if ( channel < 0 || channel >= OpenMPT::MAX_CHANNELS ) {
 			throw openmpt::exception( "invalid channel" );
 		}
+		const render_ahead_guard guard = splice_render_ahead();
 		auto & chn = m_sndFile->m_PlayState.Chn[channel];
 		chn.microTuning = mpt::saturate_round<int16_t>( finetune * 32768.0 );
 	}
 
 	double module_ext_impl::get_note_finetune( int32_t channel ) {
+		const render_ahead_guard guard = lock_render_ahead();
 		if ( channel < 0 || channel >= OpenMPT::MAX_CHANNELS ) {
 			throw openmpt::exception( "invalid channel" );
 		}
@@ -350,9 +388,122 @@ namespace openmpt {
 		if ( tempo < 32.0 || tempo > 512.0 ) {
 			throw openmpt::exception("invalid tempo");
 		}
+		const render_ahead_guard guard = splice_render_ahead();
 		m_sndFile->m_PlayState.m_nMusicTempo = decltype( m_sndFile->m_PlayState.m_nMusicTempo )( tempo );
 	}
 
+#ifndef NO_RENDER_STATS
+
+	static OpenMPT::RenderStats::Stage to_render_stage( ext::render_stats::stage s ) {
+		static_assert( ext::render_stats::stage_output + 1 == OpenMPT::RenderStats::NumStages );
+		if ( s < ext::render_stats::stage_read_note || s > ext::render_stats::stage_output ) {
+			throw openmpt::exception( "invalid render stage" );
+		}
+		return static_cast< OpenMPT::RenderStats::Stage >( s );
+	}
+
+	void module_ext_impl::set_render_stats_enabled( bool enable ) {
+		const render_ahead_guard guard = lock_render_ahead();
+		m_sndFile->m_collectRenderStats = enable;
+	}
+
+	bool module_ext_impl::get_render_stats_enabled( ) const {
+		const render_ahead_guard guard = lock_render_ahead();
+		return m_sndFile->m_collectRenderStats;
+	}
+
+	void module_ext_impl::reset_render_stats( ) {
+		const render_ahead_guard guard = lock_render_ahead();
+		m_sndFile->m_renderStats = OpenMPT::RenderStats{};
+	}
+
+	std::uint64_t module_ext_impl::get_stage_nanoseconds( stage s ) const {
+		const render_ahead_guard guard = lock_render_ahead();
+		return std::chrono::duration_cast< std::chrono::nanoseconds >( m_sndFile->m_renderStats.time[to_render_stage( s )] ).count();
+	}
+
+	std::uint64_t module_ext_impl::get_stage_calls( stage s ) const {
+		const render_ahead_guard guard = lock_render_ahead();
+		return m_sndFile->m_renderStats.calls[to_render_stage( s )];
+	}
+
+	std::uint64_t module_ext_impl::get_mixed_voices( ) const {
+		const render_ahead_guard guard = lock_render_ahead();
+		return m_sndFile->m_renderStats.mixedVoices;
+	}
+
+	std::int32_t module_ext_impl::get_max_mixed_voices( ) const {
+		const render_ahead_guard guard = lock_render_ahead();
+		return m_sndFile->m_renderStats.maxMixedVoices;
+	}
+
+	std::uint64_t module_ext_impl::get_skipped_voices( ) const {
+		const render_ahead_guard guard = lock_render_ahead();
+		return m_sndFile->m_renderStats.skippedVoices;
+	}
+
+	std::uint64_t module_ext_impl::get_skipped_frames( ) const {
+		const render_ahead_guard guard = lock_render_ahead();
+		return m_sndFile->m_renderStats.skippedFrames;
+	}
+
+#endif // !NO_RENDER_STATS
+
+	// render_ahead
+
+	void module_ext_impl::start_render_ahead( std::int32_t samplerate, int channels, std::int32_t frames ) {
+#if LIBOPENMPT_RENDER_AHEAD
+		if ( samplerate <= 0 ) {
+			throw openmpt::exception("invalid samplerate");
+		}
+		if ( channels != 1 && channels != 2 && channels != 4 ) {
+			throw openmpt::exception("invalid number of channels");
+		}
+		if ( frames <= 0 || static_cast<std::size_t>( frames ) > render_ahead_worker::max_queue_frames ) {
+			throw openmpt::exception("invalid number of frames");
+		}
+		stop_render_ahead();
+		apply_mixer_settings( samplerate, channels );
+		m_render_ahead = std::make_unique<render_ahead_worker>( *this, samplerate, channels, static_cast<std::size_t>( frames ) );
+#else // !LIBOPENMPT_RENDER_AHEAD
+		MPT_UNUSED( samplerate );
+		MPT_UNUSED( channels );
+		MPT_UNUSED( frames );
+		throw openmpt::exception("rendering ahead is not supported");
+#endif // LIBOPENMPT_RENDER_AHEAD
+	}
+
+	void module_ext_impl::stop_render_ahead( ) {
+#if LIBOPENMPT_RENDER_AHEAD
+		if ( m_render_ahead ) {
+			m_render_ahead->stop();
+			m_render_ahead.reset();
+		}
+#endif // LIBOPENMPT_RENDER_AHEAD
+	}
+
+	bool module_ext_impl::is_render_ahead_active( ) const {
+		return m_render_ahead != nullptr;
+	}
+
+	std::int32_t module_ext_impl::get_render_ahead_queued_frames( ) const {
+#if LIBOPENMPT_RENDER_AHEAD
+		if ( m_render_ahead ) {
+			return static_cast<std::int32_t>( m_render_ahead->get_queued_frames() );
+		}
+#endif // LIBOPENMPT_RENDER_AHEAD
+		return 0;
+	}
+
+	std::uint64_t module_ext_impl::get_render_ahead_underruns( ) const {
+#if LIBOPENMPT_RENDER_AHEAD
+		if ( m_render_ahead ) {
+			return m_render_ahead->get_underrun_frames();
+		}
+#endif // LIBOPENMPT_RENDER_AHEAD
+		return 0;
+	}
+
 	/* add stuff here */
 
 
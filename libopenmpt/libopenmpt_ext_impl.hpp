@@ -22,6 +22,10 @@ class module_ext_impl
 	, public ext::interactive
 	, public ext::interactive2
 	, public ext::interactive3
+#ifndef NO_RENDER_STATS
+	, public ext::render_stats
+#endif // !NO_RENDER_STATS
+	, public ext::render_ahead
 
 
 
@@ -115,6 +119,42 @@ public:
 
 	void set_current_tempo2(double tempo) override;
 
+#ifndef NO_RENDER_STATS
+
+	// render_stats
+
+	void set_render_stats_enabled( bool enable ) override;
+
+	bool get_render_stats_enabled( ) const override;
+
+	void reset_render_stats( ) override;
+
+	std::uint64_t get_stage_nanoseconds( stage s ) const override;
+
+	std::uint64_t get_stage_calls( stage s ) const override;
+
+	std::uint64_t get_mixed_voices( ) const override;
+
+	std::int32_t get_max_mixed_voices( ) const override;
+
+	std::uint64_t get_skipped_voices( ) const override;
+
+	std::uint64_t get_skipped_frames( ) const override;
+
+#endif // !NO_RENDER_STATS
+
+	// render_ahead
+
+	void start_render_ahead( std::int32_t samplerate, int channels, std::int32_t frames ) override;
+
+	void stop_render_ahead( ) override;
+
+	bool is_render_ahead_active( ) const override;
+
+	std::int32_t get_render_ahead_queued_frames( ) const override;
+
+	std::uint64_t get_render_ahead_underruns( ) const override;
+
 	/* add stuff here */
 
 }; // class module_ext_impl
@@ -13,6 +13,7 @@
 #include "libopenmpt.hpp"
 
 #include "libopenmpt_impl.hpp"
+#include "libopenmpt_render_ahead.hpp"
 
 #include <algorithm>
 #include <iostream>
@@ -433,11 +434,8 @@ module_impl::subsongs_type module_impl::get_subsongs() const {
 	if ( m_sndFile->Order.GetNumSequences() == 0 ) {
 		throw openmpt::exception("module contains no songs");
 	}
-	for ( OpenMPT::SEQUENCEINDEX seq = 0; seq < m_sndFile->Order.GetNumSequences(); ++seq ) {
-		const std::vector<OpenMPT::GetLengthType> lengths = m_sndFile->GetLength( OpenMPT::eNoAdjust, OpenMPT::GetLengthTarget( true ).StartPos( seq, 0, 0 ) );
-		for ( const auto & l : lengths ) {
-			subsongs.push_back( subsong_data( l.duration, l.startRow, l.startOrder, seq ) );
-		}
+	for ( const auto & song : m_sndFile->GetAllSubSongs( m_ctl_load_parallel_subsongs ) ) {
+		subsongs.push_back( subsong_data( song.duration, song.startRow, song.startOrder, song.sequence ) );
 	}
 	return subsongs;
 }
@@ -459,10 +457,16 @@ void module_impl::ctor( const std::map< std::string, std::string > & ctls ) {
 	m_Gain = 1.0f;
 	m_ctl_play_at_end = song_end_action::fadeout_song;
 	m_ctl_load_skip_samples = false;
+	m_ctl_load_lazy_samples = false;
+	m_ctl_load_parallel_samples = false;
+	m_ctl_load_share_samples = false;
 	m_ctl_load_skip_patterns = false;
 	m_ctl_load_skip_plugins = false;
 	m_ctl_load_skip_subsongs_init = false;
+	m_ctl_load_parallel_subsongs = false;
 	m_ctl_seek_sync_samples = true;
+	m_ctl_seek_index_interval = 0.0;
+	m_ctl_seek_index_max_memory = 16 * 1024 * 1024;
 	// init member variables that correspond to ctls
 	for ( const auto & ctl : ctls ) {
 		ctl_set( ctl.first, ctl.second, false );
@@ -476,6 +480,15 @@ void module_impl::load( const OpenMPT::FileCursor & file, const std::map< std::s
 		if ( m_ctl_load_skip_samples ) {
 			load_flags &= ~OpenMPT::CSoundFile::loadSampleData;
 		}
+		if ( m_ctl_load_lazy_samples ) {
+			load_flags |= OpenMPT::CSoundFile::deferSampleData;
+		}
+		if ( m_ctl_load_parallel_samples ) {
+			load_flags |= OpenMPT::CSoundFile::decodeSamplesInParallel;
+		}
+		if ( m_ctl_load_share_samples ) {
+			load_flags |= OpenMPT::CSoundFile::shareSampleData;
+		}
 		if ( m_ctl_load_skip_patterns ) {
 			load_flags &= ~OpenMPT::CSoundFile::loadPatternData;
 		}
@@ -501,6 +514,14 @@ void module_impl::load( const OpenMPT::FileCursor & file, const std::map< std::s
 		ctl_set( ctl.first, ctl.second, false );
 	}
 }
+OpenMPT::FileCursor module_impl::make_memory_file_cursor( mpt::span< const std::byte > data ) {
+	if ( m_ctl_load_lazy_samples ) {
+		// Deferred samples are decoded from the module data after loading has finished, but the caller only has to keep the data alive while loading.
+		m_file_data.assign( data.begin(), data.end() );
+		data = mpt::as_span( m_file_data );
+	}
+	return mpt::IO::make_FileCursor<OpenMPT::mpt::PathString>( data );
+}
 bool module_impl::is_loaded() const {
 	return m_loaded;
 }
@@ -594,6 +615,69 @@ std::size_t module_impl::read_interleaved_wrapper( std::size_t count, std::size_
 	}
 	return count_read;
 }
+#if LIBOPENMPT_RENDER_AHEAD
+std::size_t module_impl::read_render_ahead( std::int32_t samplerate, std::size_t count, std::int16_t * left, std::int16_t * right, std::int16_t * rear_left, std::int16_t * rear_right ) {
+	std::int16_t * const buffers[4] = { left, right, rear_left, rear_right };
+	const std::size_t channels = valid_channels( buffers, std::size( buffers ) );
+	if ( samplerate != m_render_ahead->get_samplerate() || static_cast<int>( channels ) != m_render_ahead->get_channels() ) {
+		throw openmpt::exception("sample rate or number of channels differs from the one used for rendering ahead");
+	}
+	return m_render_ahead->read( mpt::audio_span_planar<std::int16_t>( buffers, channels, count ) );
+}
+std::size_t module_impl::read_render_ahead( std::int32_t samplerate, std::size_t count, float * left, float * right, float * rear_left, float * rear_right ) {
+	float * const buffers[4] = { left, right, rear_left, rear_right };
+	const std::size_t channels = valid_channels( buffers, std::size( buffers ) );
+	if ( samplerate != m_render_ahead->get_samplerate() || static_cast<int>( channels ) != m_render_ahead->get_channels() ) {
+		throw openmpt::exception("sample rate or number of channels differs from the one used for rendering ahead");
+	}
+	return m_render_ahead->read( mpt::audio_span_planar<float>( buffers, channels, count ) );
+}
+std::size_t module_impl::read_interleaved_render_ahead( std::int32_t samplerate, std::size_t count, std::size_t channels, std::int16_t * interleaved ) {
+	if ( samplerate != m_render_ahead->get_samplerate() || static_cast<int>( channels ) != m_render_ahead->get_channels() ) {
+		throw openmpt::exception("sample rate or number of channels differs from the one used for rendering ahead");
+	}
+	return m_render_ahead->read( mpt::audio_span_interleaved<std::int16_t>( interleaved, channels, count ) );
+}
+std::size_t module_impl::read_interleaved_render_ahead( std::int32_t samplerate, std::size_t count, std::size_t channels, float * interleaved ) {
+	if ( samplerate != m_render_ahead->get_samplerate() || static_cast<int>( channels ) != m_render_ahead->get_channels() ) {
+		throw openmpt::exception("sample rate or number of channels differs from the one used for rendering ahead");
+	}
+	return m_render_ahead->read( mpt::audio_span_interleaved<float>( interleaved, channels, count ) );
+}
+#else // !LIBOPENMPT_RENDER_AHEAD
+std::size_t module_impl::read_render_ahead( std::int32_t samplerate, std::size_t count, std::int16_t * left, std::int16_t * right, std::int16_t * rear_left, std::int16_t * rear_right ) {
+	MPT_UNUSED( samplerate );
+	MPT_UNUSED( left );
+	MPT_UNUSED( right );
+	MPT_UNUSED( rear_left );
+	MPT_UNUSED( rear_right );
+	MPT_ASSERT_NOTREACHED();
+	return count;
+}
+std::size_t module_impl::read_render_ahead( std::int32_t samplerate, std::size_t count, float * left, float * right, float * rear_left, float * rear_right ) {
+	MPT_UNUSED( samplerate );
+	MPT_UNUSED( left );
+	MPT_UNUSED( right );
+	MPT_UNUSED( rear_left );
+	MPT_UNUSED( rear_right );
+	MPT_ASSERT_NOTREACHED();
+	return count;
+}
+std::size_t module_impl::read_interleaved_render_ahead( std::int32_t samplerate, std::size_t count, std::size_t channels, std::int16_t * interleaved ) {
+	MPT_UNUSED( samplerate );
+	MPT_UNUSED( channels );
+	MPT_UNUSED( interleaved );
+	MPT_ASSERT_NOTREACHED();
+	return count;
+}
+std::size_t module_impl::read_interleaved_render_ahead( std::int32_t samplerate, std::size_t count, std::size_t channels, float * interleaved ) {
+	MPT_UNUSED( samplerate );
+	MPT_UNUSED( channels );
+	MPT_UNUSED( interleaved );
+	MPT_ASSERT_NOTREACHED();
+	return count;
+}
+#endif // LIBOPENMPT_RENDER_AHEAD
 
 std::vector<std::string> module_impl::get_supported_extensions() {
 	std::vector<std::string> retval;
@@ -881,44 +965,46 @@ module_impl::module_impl( std::istream & stream, std::unique_ptr<log_interface>
 }
 module_impl::module_impl( const std::vector<std::byte> & data, std::unique_ptr<log_interface> log, const std::map< std::string, std::string > & ctls ) : m_Log(std::move(log)) {
 	ctor( ctls );
-	load( mpt::IO::make_FileCursor<OpenMPT::mpt::PathString>( mpt::as_span( data ) ), ctls );
+	load( make_memory_file_cursor( mpt::as_span( data ) ), ctls );
 	apply_libopenmpt_defaults();
 }
 module_impl::module_impl( const std::vector<std::uint8_t> & data, std::unique_ptr<log_interface> log, const std::map< std::string, std::string > & ctls ) : m_Log(std::move(log)) {
 	ctor( ctls );
-	load( mpt::IO::make_FileCursor<OpenMPT::mpt::PathString>( mpt::as_span( data ) ), ctls );
+	load( make_memory_file_cursor( mpt::byte_cast< mpt::span< const std::byte > >( mpt::as_span( data ) ) ), ctls );
 	apply_libopenmpt_defaults();
 }
 module_impl::module_impl( const std::vector<char> & data, std::unique_ptr<log_interface> log, const std::map< std::string, std::string > & ctls ) : m_Log(std::move(log)) {
 	ctor( ctls );
-	load( mpt::IO::make_FileCursor<OpenMPT::mpt::PathString>( mpt::byte_cast< mpt::span< const std::byte > >( mpt::as_span( data ) ) ), ctls );
+	load( make_memory_file_cursor( mpt::byte_cast< mpt::span< const std::byte > >( mpt::as_span( data ) ) ), ctls );
 	apply_libopenmpt_defaults();
 }
 module_impl::module_impl( const std::byte * data, std::size_t size, std::unique_ptr<log_interface> log, const std::map< std::string, std::string > & ctls ) : m_Log(std::move(log)) {
 	ctor( ctls );
-	load( mpt::IO::make_FileCursor<OpenMPT::mpt::PathString>( mpt::as_span( data, size ) ), ctls );
+	load( make_memory_file_cursor( mpt::as_span( data, size ) ), ctls );
 	apply_libopenmpt_defaults();
 }
 module_impl::module_impl( const std::uint8_t * data, std::size_t size, std::unique_ptr<log_interface> log, const std::map< std::string, std::string > & ctls ) : m_Log(std::move(log)) {
 	ctor( ctls );
-	load( mpt::IO::make_FileCursor<OpenMPT::mpt::PathString>( mpt::as_span( data, size ) ), ctls );
+	load( make_memory_file_cursor( mpt::byte_cast< mpt::span< const std::byte > >( mpt::as_span( data, size ) ) ), ctls );
 	apply_libopenmpt_defaults();
 }
 module_impl::module_impl( const char * data, std::size_t size, std::unique_ptr<log_interface> log, const std::map< std::string, std::string > & ctls ) : m_Log(std::move(log)) {
 	ctor( ctls );
-	load( mpt::IO::make_FileCursor<OpenMPT::mpt::PathString>( mpt::byte_cast< mpt::span< const std::byte > >( mpt::as_span( data, size ) ) ), ctls );
+	load( make_memory_file_cursor( mpt::byte_cast< mpt::span< const std::byte > >( mpt::as_span( data, size ) ) ), ctls );
 	apply_libopenmpt_defaults();
 }
 module_impl::module_impl( const void * data, std::size_t size, std::unique_ptr<log_interface> log, const std::map< std::string, std::string > & ctls ) : m_Log(std::move(log)) {
 	ctor( ctls );
-	load( mpt::IO::make_FileCursor<OpenMPT::mpt::PathString>( mpt::as_span( mpt::void_cast< const std::byte * >( data ), size ) ), ctls );
+	load( make_memory_file_cursor( mpt::as_span( mpt::void_cast< const std::byte * >( data ), size ) ), ctls );
 	apply_libopenmpt_defaults();
 }
 module_impl::~module_impl() {
+	m_render_ahead.reset();
 	m_sndFile->Destroy();
 }
 
 std::int32_t module_impl::get_render_param( int param ) const {
+	const render_ahead_guard guard = lock_render_ahead();
 	std::int32_t result = 0;
 	switch ( param ) {
 		case module::RENDER_MASTERGAIN_MILLIBEL: {
@@ -943,8 +1029,15 @@ void module_impl::set_render_param( int param, std::int32_t value ) {
 	switch ( param ) {
 		case module::RENDER_MASTERGAIN_MILLIBEL: {
 			m_Gain = std::pow( 10.0f, static_cast<float>( value ) * 0.001f * 0.5f );
+#if LIBOPENMPT_RENDER_AHEAD
+			if ( m_render_ahead ) {
+				// Applied while reading, so the queued audio does not need to be rendered again.
+				m_render_ahead->set_gain( m_Gain );
+			}
+#endif // LIBOPENMPT_RENDER_AHEAD
 		} break;
 		case module::RENDER_STEREOSEPARATION_PERCENT: {
+			const render_ahead_guard guard = splice_render_ahead();
 			std::int32_t newvalue = value * OpenMPT::MixerSettings::StereoSeparationScale / 100;
 			if ( newvalue != static_cast<std::int32_t>( m_sndFile->m_MixerSettings.m_nStereoSeparation ) ) {
 				OpenMPT::MixerSettings settings = m_sndFile->m_MixerSettings;
@@ -953,6 +1046,7 @@ void module_impl::set_render_param( int param, std::int32_t value ) {
 			}
 		} break;
 		case module::RENDER_INTERPOLATIONFILTER_LENGTH: {
+			const render_ahead_guard guard = splice_render_ahead();
 			OpenMPT::CResamplerSettings newsettings = m_sndFile->m_Resampler.m_Settings;
 			newsettings.SrcMode = filterlength_to_resamplingmode( value );
 			if ( newsettings != m_sndFile->m_Resampler.m_Settings ) {
@@ -960,6 +1054,7 @@ void module_impl::set_render_param( int param, std::int32_t value ) {
 			}
 		} break;
 		case module::RENDER_VOLUMERAMPING_STRENGTH: {
+			const render_ahead_guard guard = splice_render_ahead();
 			OpenMPT::MixerSettings newsettings = m_sndFile->m_MixerSettings;
 			ramping_to_mixersettings( newsettings, value );
 			if ( m_sndFile->m_MixerSettings.VolumeRampUpMicroseconds != newsettings.VolumeRampUpMicroseconds || m_sndFile->m_MixerSettings.VolumeRampDownMicroseconds != newsettings.VolumeRampDownMicroseconds ) {
@@ -974,6 +1069,9 @@ std::size_t module_impl::read( std::int32_t samplerate, std::size_t count, std::
 	if ( !mono ) {
 		throw openmpt::exception("null pointer");
 	}
+	if ( m_render_ahead ) {
+		return read_render_ahead( samplerate, count, mono, nullptr, nullptr, nullptr );
+	}
 	apply_mixer_settings( samplerate, 1 );
 	count = read_wrapper( count, mono, nullptr, nullptr, nullptr );
 	m_currentPositionSeconds += static_cast<double>( count ) / static_cast<double>( samplerate );
@@ -983,6 +1081,9 @@ std::size_t module_impl::read( std::int32_t samplerate, std::size_t count, std::
 	if ( !left || !right ) {
 		throw openmpt::exception("null pointer");
 	}
+	if ( m_render_ahead ) {
+		return read_render_ahead( samplerate, count, left, right, nullptr, nullptr );
+	}
 	apply_mixer_settings( samplerate, 2 );
 	count = read_wrapper( count, left, right, nullptr, nullptr );
 	m_currentPositionSeconds += static_cast<double>( count ) / static_cast<double>( samplerate );
@@ -992,6 +1093,9 @@ std::size_t module_impl::read( std::int32_t samplerate, std::size_t count, std::
 	if ( !left || !right || !rear_left || !rear_right ) {
 		throw openmpt::exception("null pointer");
 	}
+	if ( m_render_ahead ) {
+		return read_render_ahead( samplerate, count, left, right, rear_left, rear_right );
+	}
 	apply_mixer_settings( samplerate, 4 );
 	count = read_wrapper( count, left, right, rear_left, rear_right );
 	m_currentPositionSeconds += static_cast<double>( count ) / static_cast<double>( samplerate );
@@ -1001,6 +1105,9 @@ std::size_t module_impl::read( std::int32_t samplerate, std::size_t count, float
 	if ( !mono ) {
 		throw openmpt::exception("null pointer");
 	}
+	if ( m_render_ahead ) {
+		return read_render_ahead( samplerate, count, mono, nullptr, nullptr, nullptr );
+	}
 	apply_mixer_settings( samplerate, 1 );
 	count = read_wrapper( count, mono, nullptr, nullptr, nullptr );
 	m_currentPositionSeconds += static_cast<double>( count ) / static_cast<double>( samplerate );
@@ -1010,6 +1117,9 @@ std::size_t module_impl::read( std::int32_t samplerate, std::size_t count, float
 	if ( !left || !right ) {
 		throw openmpt::exception("null pointer");
 	}
+	if ( m_render_ahead ) {
+		return read_render_ahead( samplerate, count, left, right, nullptr, nullptr );
+	}
 	apply_mixer_settings( samplerate, 2 );
 	count = read_wrapper( count, left, right, nullptr, nullptr );
 	m_currentPositionSeconds += static_cast<double>( count ) / static_cast<double>( samplerate );
@@ -1019,6 +1129,9 @@ std::size_t module_impl::read( std::int32_t samplerate, std::size_t count, float
 	if ( !left || !right || !rear_left || !rear_right ) {
 		throw openmpt::exception("null pointer");
 	}
+	if ( m_render_ahead ) {
+		return read_render_ahead( samplerate, count, left, right, rear_left, rear_right );
+	}
 	apply_mixer_settings( samplerate, 4 );
 	count = read_wrapper( count, left, right, rear_left, rear_right );
 	m_currentPositionSeconds += static_cast<double>( count ) / static_cast<double>( samplerate );
@@ -1028,6 +1141,9 @@ std::size_t module_impl::read_interleaved_stereo( std::int32_t samplerate, std::
 	if ( !interleaved_stereo ) {
 		throw openmpt::exception("null pointer");
 	}
+	if ( m_render_ahead ) {
+		return read_interleaved_render_ahead( samplerate, count, 2, interleaved_stereo );
+	}
 	apply_mixer_settings( samplerate, 2 );
 	count = read_interleaved_wrapper( count, 2, interleaved_stereo );
 	m_currentPositionSeconds += static_cast<double>( count ) / static_cast<double>( samplerate );
@@ -1037,6 +1153,9 @@ std::size_t module_impl::read_interleaved_quad( std::int32_t samplerate, std::si
 	if ( !interleaved_quad ) {
 		throw openmpt::exception("null pointer");
 	}
+	if ( m_render_ahead ) {
+		return read_interleaved_render_ahead( samplerate, count, 4, interleaved_quad );
+	}
 	apply_mixer_settings( samplerate, 4 );
 	count = read_interleaved_wrapper( count, 4, interleaved_quad );
 	m_currentPositionSeconds += static_cast<double>( count ) / static_cast<double>( samplerate );
@@ -1046,6 +1165,9 @@ std::size_t module_impl::read_interleaved_stereo( std::int32_t samplerate, std::
 	if ( !interleaved_stereo ) {
 		throw openmpt::exception("null pointer");
 	}
+	if ( m_render_ahead ) {
+		return read_interleaved_render_ahead( samplerate, count, 2, interleaved_stereo );
+	}
 	apply_mixer_settings( samplerate, 2 );
 	count = read_interleaved_wrapper( count, 2, interleaved_stereo );
 	m_currentPositionSeconds += static_cast<double>( count ) / static_cast<double>( samplerate );
@@ -1055,6 +1177,9 @@ std::size_t module_impl::read_interleaved_quad( std::int32_t samplerate, std::si
 	if ( !interleaved_quad ) {
 		throw openmpt::exception("null pointer");
 	}
+	if ( m_render_ahead ) {
+		return read_interleaved_render_ahead( samplerate, count, 4, interleaved_quad );
+	}
 	apply_mixer_settings( samplerate, 4 );
 	count = read_interleaved_wrapper( count, 4, interleaved_quad );
 	m_currentPositionSeconds += static_cast<double>( count ) / static_cast<double>( samplerate );
@@ -1063,6 +1188,7 @@ std::size_t module_impl::read_interleaved_quad( std::int32_t samplerate, std::si
 
 
 double module_impl::get_duration_seconds() const {
+	const render_ahead_guard guard = lock_render_ahead();
 	std::unique_ptr<subsongs_type> subsongs_temp = has_subsongs_inited() ? std::unique_ptr<subsongs_type>() : std::make_unique<subsongs_type>( get_subsongs() );
 	const subsongs_type & subsongs = has_subsongs_inited() ? m_subsongs : *subsongs_temp;
 	if ( m_current_subsong == all_subsongs ) {
@@ -1076,6 +1202,7 @@ double module_impl::get_duration_seconds() const {
 	return subsongs[m_current_subsong].duration;
 }
 void module_impl::select_subsong( std::int32_t subsong ) {
+	const render_ahead_guard guard = flush_render_ahead();
 	std::unique_ptr<subsongs_type> subsongs_temp = has_subsongs_inited() ? std::unique_ptr<subsongs_type>() : std::make_unique<subsongs_type>( get_subsongs() );
 	const subsongs_type & subsongs = has_subsongs_inited() ? m_subsongs : *subsongs_temp;
 	if ( subsong != all_subsongs && ( subsong < 0 || subsong >= static_cast<std::int32_t>( subsongs.size() ) ) ) {
@@ -1094,15 +1221,24 @@ std::int32_t module_impl::get_selected_subsong() const {
 	return m_current_subsong;
 }
 void module_impl::set_repeat_count( std::int32_t repeat_count ) {
+	const render_ahead_guard guard = splice_render_ahead();
 	m_sndFile->SetRepeatCount( repeat_count );
 }
 std::int32_t module_impl::get_repeat_count() const {
+	const render_ahead_guard guard = lock_render_ahead();
 	return m_sndFile->GetRepeatCount();
 }
 double module_impl::get_position_seconds() const {
+#if LIBOPENMPT_RENDER_AHEAD
+	if ( m_render_ahead ) {
+		const render_ahead_guard guard = lock_render_ahead();
+		return m_render_ahead->get_position_seconds();
+	}
+#endif // LIBOPENMPT_RENDER_AHEAD
 	return m_currentPositionSeconds;
 }
 double module_impl::set_position_seconds( double seconds ) {
+	const render_ahead_guard guard = flush_render_ahead();
 	std::unique_ptr<subsongs_type> subsongs_temp = has_subsongs_inited() ? std::unique_ptr<subsongs_type>() : std::make_unique<subsongs_type>( get_subsongs() );
 	const subsongs_type & subsongs = has_subsongs_inited() ? m_subsongs : *subsongs_temp;
 	const subsong_data * subsong = 0;
@@ -1122,7 +1258,7 @@ double module_impl::set_position_seconds( double seconds ) {
 		subsong = &subsongs[m_current_subsong];
 	}
 	m_sndFile->SetCurrentOrder( static_cast<OpenMPT::ORDERINDEX>( subsong->start_order ) );
-	OpenMPT::GetLengthType t = m_sndFile->GetLength( m_ctl_seek_sync_samples ? OpenMPT::eAdjustSamplePositions : OpenMPT::eAdjust, OpenMPT::GetLengthTarget( seconds ).StartPos( static_cast<OpenMPT::SEQUENCEINDEX>( subsong->sequence ), static_cast<OpenMPT::ORDERINDEX>( subsong->start_order ), static_cast<OpenMPT::ROWINDEX>( subsong->start_row ) ) ).back();
+	OpenMPT::GetLengthType t = m_sndFile->GetLength( m_ctl_seek_sync_samples ? OpenMPT::eAdjustSamplePositions : OpenMPT::eAdjust, OpenMPT::GetLengthTarget( seconds ).StartPos( static_cast<OpenMPT::SEQUENCEINDEX>( subsong->sequence ), static_cast<OpenMPT::ORDERINDEX>( subsong->start_order ), static_cast<OpenMPT::ROWINDEX>( subsong->start_row ) ).UseSeekIndex( m_SeekIndex.get() ) ).back();
 	m_sndFile->m_PlayState.m_nNextOrder = m_sndFile->m_PlayState.m_nCurrentOrder = t.targetReached ? t.lastOrder : t.endOrder;
 	m_sndFile->m_PlayState.m_nNextRow = t.targetReached ? t.lastRow : t.endRow;
 	m_sndFile->m_PlayState.m_nTickCount = OpenMPT::CSoundFile::TICKS_ROW_FINISHED;
@@ -1130,6 +1266,7 @@ double module_impl::set_position_seconds( double seconds ) {
 	return m_currentPositionSeconds;
 }
 double module_impl::set_position_order_row( std::int32_t order, std::int32_t row ) {
+	const render_ahead_guard guard = flush_render_ahead();
 	if ( order < 0 || order >= m_sndFile->Order().GetLengthTailTrimmed() ) {
 		return m_currentPositionSeconds;
 	}
@@ -1297,24 +1434,31 @@ std::string module_impl::get_metadata( const std::string & key ) const {
 }
 
 double module_impl::get_current_estimated_bpm() const {
-	return m_sndFile->GetCurrentBPM();
+	const render_ahead_guard guard = lock_render_ahead();
+	return m_sndFile->GetCurrentBPM( audible_state( *this ).play_state() );
 }
 std::int32_t module_impl::get_current_speed() const {
-	return m_sndFile->m_PlayState.m_nMusicSpeed;
+	const render_ahead_guard guard = lock_render_ahead();
+	return audible_state( *this ).play_state().m_nMusicSpeed;
 }
 std::int32_t module_impl::get_current_tempo() const {
-	return static_cast<std::int32_t>( m_sndFile->m_PlayState.m_nMusicTempo.GetInt() );
+	const render_ahead_guard guard = lock_render_ahead();
+	return static_cast<std::int32_t>( audible_state( *this ).play_state().m_nMusicTempo.GetInt() );
 }
 double module_impl::get_current_tempo2() const {
-	return m_sndFile->m_PlayState.m_nMusicTempo.ToDouble();
+	const render_ahead_guard guard = lock_render_ahead();
+	return audible_state( *this ).play_state().m_nMusicTempo.ToDouble();
 }
 std::int32_t module_impl::get_current_order() const {
-	return m_sndFile->GetCurrentOrder();
+	const render_ahead_guard guard = lock_render_ahead();
+	return audible_state( *this ).play_state().m_nCurrentOrder;
 }
 std::int32_t module_impl::get_current_pattern() const {
-	std::int32_t order = m_sndFile->GetCurrentOrder();
+	const render_ahead_guard guard = lock_render_ahead();
+	const OpenMPT::CSoundFile::GlobalPlayState & state = audible_state( *this ).play_state();
+	std::int32_t order = state.m_nCurrentOrder;
 	if ( order < 0 || order >= m_sndFile->Order().GetLengthTailTrimmed() ) {
-		return m_sndFile->GetCurrentPattern();
+		return state.m_nPattern;
 	}
 	std::int32_t pattern = m_sndFile->Order()[order];
 	if ( !m_sndFile->Patterns.IsValidIndex( static_cast<OpenMPT::PATTERNINDEX>( pattern ) ) ) {
@@ -1323,46 +1467,59 @@ std::int32_t module_impl::get_current_pattern() const {
 	return pattern;
 }
 std::int32_t module_impl::get_current_row() const {
-	return m_sndFile->m_PlayState.m_nRow;
+	const render_ahead_guard guard = lock_render_ahead();
+	return audible_state( *this ).play_state().m_nRow;
 }
 std::int32_t module_impl::get_current_playing_channels() const {
-	return m_sndFile->GetMixStat();
+	const render_ahead_guard guard = lock_render_ahead();
+	return audible_state( *this ).mix_stat();
 }
 
 float module_impl::get_current_channel_vu_mono( std::int32_t channel ) const {
+	const render_ahead_guard guard = lock_render_ahead();
 	if ( channel < 0 || channel >= m_sndFile->GetNumChannels() ) {
 		return 0.0f;
 	}
-	const float left = m_sndFile->m_PlayState.Chn[channel].nLeftVU * (1.0f/128.0f);
-	const float right = m_sndFile->m_PlayState.Chn[channel].nRightVU * (1.0f/128.0f);
+	const OpenMPT::ModChannel & chn = audible_state( *this ).channel( static_cast<OpenMPT::CHANNELINDEX>( channel ) );
+	const float left = chn.nLeftVU * (1.0f/128.0f);
+	const float right = chn.nRightVU * (1.0f/128.0f);
 	return std::sqrt(left*left + right*right);
 }
 float module_impl::get_current_channel_vu_left( std::int32_t channel ) const {
+	const render_ahead_guard guard = lock_render_ahead();
 	if ( channel < 0 || channel >= m_sndFile->GetNumChannels() ) {
 		return 0.0f;
 	}
-	return m_sndFile->m_PlayState.Chn[channel].dwFlags[OpenMPT::CHN_SURROUND] ? 0.0f : m_sndFile->m_PlayState.Chn[channel].nLeftVU * (1.0f/128.0f);
+	const OpenMPT::ModChannel & chn = audible_state( *this ).channel( static_cast<OpenMPT::CHANNELINDEX>( channel ) );
+	return chn.dwFlags[OpenMPT::CHN_SURROUND] ? 0.0f : chn.nLeftVU * (1.0f/128.0f);
 }
 float module_impl::get_current_channel_vu_right( std::int32_t channel ) const {
+	const render_ahead_guard guard = lock_render_ahead();
 	if ( channel < 0 || channel >= m_sndFile->GetNumChannels() ) {
 		return 0.0f;
 	}
-	return m_sndFile->m_PlayState.Chn[channel].dwFlags[OpenMPT::CHN_SURROUND] ? 0.0f : m_sndFile->m_PlayState.Chn[channel].nRightVU * (1.0f/128.0f);
+	const OpenMPT::ModChannel & chn = audible_state( *this ).channel( static_cast<OpenMPT::CHANNELINDEX>( channel ) );
+	return chn.dwFlags[OpenMPT::CHN_SURROUND] ? 0.0f : chn.nRightVU * (1.0f/128.0f);
 }
 float module_impl::get_current_channel_vu_rear_left( std::int32_t channel ) const {
+	const render_ahead_guard guard = lock_render_ahead();
 	if ( channel < 0 || channel >= m_sndFile->GetNumChannels() ) {
 		return 0.0f;
 	}
-	return m_sndFile->m_PlayState.Chn[channel].dwFlags[OpenMPT::CHN_SURROUND] ? m_sndFile->m_PlayState.Chn[channel].nLeftVU * (1.0f/128.0f) : 0.0f;
+	const OpenMPT::ModChannel & chn = audible_state( *this ).channel( static_cast<OpenMPT::CHANNELINDEX>( channel ) );
+	return chn.dwFlags[OpenMPT::CHN_SURROUND] ? chn.nLeftVU * (1.0f/128.0f) : 0.0f;
 }
 float module_impl::get_current_channel_vu_rear_right( std::int32_t channel ) const {
+	const render_ahead_guard guard = lock_render_ahead();
 	if ( channel < 0 || channel >= m_sndFile->GetNumChannels() ) {
 		return 0.0f;
 	}
-	return m_sndFile->m_PlayState.Chn[channel].dwFlags[OpenMPT::CHN_SURROUND] ? m_sndFile->m_PlayState.Chn[channel].nRightVU * (1.0f/128.0f) : 0.0f;
+	const OpenMPT::ModChannel & chn = audible_state( *this ).channel( static_cast<OpenMPT::CHANNELINDEX>( channel ) );
+	return chn.dwFlags[OpenMPT::CHN_SURROUND] ? chn.nRightVU * (1.0f/128.0f) : 0.0f;
 }
 
 std::int32_t module_impl::get_num_subsongs() const {
+	const render_ahead_guard guard = lock_render_ahead();
 	std::unique_ptr<subsongs_type> subsongs_temp = has_subsongs_inited() ? std::unique_ptr<subsongs_type>() : std::make_unique<subsongs_type>( get_subsongs() );
 	const subsongs_type & subsongs = has_subsongs_inited() ? m_subsongs : *subsongs_temp;
 	return static_cast<std::int32_t>( subsongs.size() );
@@ -1384,6 +1541,7 @@ std::int32_t module_impl::get_num_samples() const {
 }
 
 std::vector<std::string> module_impl::get_subsong_names() const {
+	const render_ahead_guard guard = lock_render_ahead();
 	std::vector<std::string> retval;
 	std::unique_ptr<subsongs_type> subsongs_temp = has_subsongs_inited() ? std::unique_ptr<subsongs_type>() : std::make_unique<subsongs_type>( get_subsongs() );
 	const subsongs_type & subsongs = has_subsongs_inited() ? m_subsongs : *subsongs_temp;
@@ -1637,10 +1795,16 @@ std::string module_impl::highlight_pattern_row_channel( std::int32_t p, std::int
 std::pair<const module_impl::ctl_info *, const module_impl::ctl_info *> module_impl::get_ctl_infos() const {
 	static constexpr ctl_info ctl_infos[] = {
 		{ "load.skip_samples", ctl_type::boolean },
+		{ "load.lazy_samples", ctl_type::boolean },
+		{ "load.parallel_samples", ctl_type::boolean },
+		{ "load.share_samples", ctl_type::boolean },
 		{ "load.skip_patterns", ctl_type::boolean },
 		{ "load.skip_plugins", ctl_type::boolean },
 		{ "load.skip_subsongs_init", ctl_type::boolean },
+		{ "load.parallel_subsongs", ctl_type::boolean },
 		{ "seek.sync_samples", ctl_type::boolean },
+		{ "seek.index.interval", ctl_type::floatingpoint },
+		{ "seek.index.max_memory", ctl_type::integer },
 		{ "subsong", ctl_type::integer },
 		{ "play.tempo_factor", ctl_type::floatingpoint },
 		{ "play.pitch_factor", ctl_type::floatingpoint },
@@ -1648,6 +1812,8 @@ std::pair<const module_impl::ctl_info *, const module_impl::ctl_info *> module_i
 		{ "render.resampler.emulate_amiga", ctl_type::boolean },
 		{ "render.resampler.emulate_amiga_type", ctl_type::text },
 		{ "render.opl.volume_factor", ctl_type::floatingpoint },
+		{ "render.mixer.threads", ctl_type::integer },
+		{ "render.mixer.chunk_size", ctl_type::integer },
 		{ "dither", ctl_type::integer }
 	};
 	return std::make_pair(std::begin(ctl_infos), std::end(ctl_infos));
@@ -1705,6 +1871,7 @@ std::string module_impl::ctl_get( std::string ctl, bool throw_if_unknown ) const
 	return result;
 }
 bool module_impl::ctl_get_boolean( std::string_view ctl, bool throw_if_unknown ) const {
+	const render_ahead_guard guard = lock_render_ahead();
 	if ( !ctl.empty() ) {
 		// cppcheck false-positive
 		// cppcheck-suppress containerOutOfBounds
@@ -1735,12 +1902,20 @@ bool module_impl::ctl_get_boolean( std::string_view ctl, bool throw_if_unknown )
 		throw openmpt::exception("empty ctl");
 	} else if ( ctl == "load.skip_samples" || ctl == "load_skip_samples" ) {
 		return m_ctl_load_skip_samples;
+	} else if ( ctl == "load.lazy_samples" ) {
+		return m_ctl_load_lazy_samples;
+	} else if ( ctl == "load.parallel_samples" ) {
+		return m_ctl_load_parallel_samples;
+	} else if ( ctl == "load.share_samples" ) {
+		return m_ctl_load_share_samples;
 	} else if ( ctl == "load.skip_patterns" || ctl == "load_skip_patterns" ) {
 		return m_ctl_load_skip_patterns;
 	} else if ( ctl == "load.skip_plugins" ) {
 		return m_ctl_load_skip_plugins;
 	} else if ( ctl == "load.skip_subsongs_init" ) {
 		return m_ctl_load_skip_subsongs_init;
+	} else if ( ctl == "load.parallel_subsongs" ) {
+		return m_ctl_load_parallel_subsongs;
 	} else if ( ctl == "seek.sync_samples" ) {
 		return m_ctl_seek_sync_samples;
 	} else if ( ctl == "render.resampler.emulate_amiga" ) {
@@ -1751,6 +1926,7 @@ bool module_impl::ctl_get_boolean( std::string_view ctl, bool throw_if_unknown )
 	}
 }
 std::int64_t module_impl::ctl_get_integer( std::string_view ctl, bool throw_if_unknown ) const {
+	const render_ahead_guard guard = lock_render_ahead();
 	if ( !ctl.empty() ) {
 		// cppcheck false-positive
 		// cppcheck-suppress containerOutOfBounds
@@ -1779,9 +1955,20 @@ std::int64_t module_impl::ctl_get_integer( std::string_view ctl, bool throw_if_u
 	}
 	if ( ctl == "" ) {
 		throw openmpt::exception("empty ctl");
+	} else if ( ctl == "seek.index.max_memory" ) {
+		return m_ctl_seek_index_max_memory;
 	} else if ( ctl == "subsong" ) {
 		return get_selected_subsong();
+	} else if ( ctl == "render.mixer.threads" ) {
+		return m_sndFile->m_MixerSettings.NumMixThreads;
+	} else if ( ctl == "render.mixer.chunk_size" ) {
+		return m_sndFile->m_MixerSettings.MixChunkSize;
 	} else if ( ctl == "dither" ) {
+#if LIBOPENMPT_RENDER_AHEAD
+		if ( m_render_ahead ) {
+			return static_cast<std::int64_t>( m_render_ahead->get_dither() );
+		}
+#endif // LIBOPENMPT_RENDER_AHEAD
 		return static_cast<std::int64_t>( m_Dithers->GetMode() );
 	} else {
 		MPT_ASSERT_NOTREACHED();
@@ -1789,6 +1976,7 @@ std::int64_t module_impl::ctl_get_integer( std::string_view ctl, bool throw_if_u
 	}
 }
 double module_impl::ctl_get_floatingpoint( std::string_view ctl, bool throw_if_unknown ) const {
+	const render_ahead_guard guard = lock_render_ahead();
 	if ( !ctl.empty() ) {
 		// cppcheck false-positive
 		// cppcheck-suppress containerOutOfBounds
@@ -1817,6 +2005,8 @@ double module_impl::ctl_get_floatingpoint( std::string_view ctl, bool throw_if_u
 	}
 	if ( ctl == "" ) {
 		throw openmpt::exception("empty ctl");
+	} else if ( ctl == "seek.index.interval" ) {
+		return m_ctl_seek_index_interval;
 	} else if ( ctl == "play.tempo_factor" ) {
 		if ( !is_loaded() ) {
 			return 1.0;
@@ -1835,6 +2025,7 @@ double module_impl::ctl_get_floatingpoint( std::string_view ctl, bool throw_if_u
 	}
 }
 std::string module_impl::ctl_get_text( std::string_view ctl, bool throw_if_unknown ) const {
+	const render_ahead_guard guard = lock_render_ahead();
 	if ( !ctl.empty() ) {
 		// cppcheck false-positive
 		// cppcheck-suppress containerOutOfBounds
@@ -1954,16 +2145,25 @@ void module_impl::ctl_set_boolean( std::string_view ctl, bool value, bool throw_
 			return;
 		}
 	}
+	const render_ahead_guard guard = splice_render_ahead();
 	if ( ctl == "" ) {
 		throw openmpt::exception("empty ctl: := " + mpt::format_value_default<std::string>( value ) );
 	} else if ( ctl == "load.skip_samples" || ctl == "load_skip_samples" ) {
 		m_ctl_load_skip_samples = value;
+	} else if ( ctl == "load.lazy_samples" ) {
+		m_ctl_load_lazy_samples = value;
+	} else if ( ctl == "load.parallel_samples" ) {
+		m_ctl_load_parallel_samples = value;
+	} else if ( ctl == "load.share_samples" ) {
+		m_ctl_load_share_samples = value;
 	} else if ( ctl == "load.skip_patterns" || ctl == "load_skip_patterns" ) {
 		m_ctl_load_skip_patterns = value;
 	} else if ( ctl == "load.skip_plugins" ) {
 		m_ctl_load_skip_plugins = value;
 	} else if ( ctl == "load.skip_subsongs_init" ) {
 		m_ctl_load_skip_subsongs_init = value;
+	} else if ( ctl == "load.parallel_subsongs" ) {
+		m_ctl_load_parallel_subsongs = value;
 	} else if ( ctl == "seek.sync_samples" ) {
 		m_ctl_seek_sync_samples = value;
 	} else if ( ctl == "render.resampler.emulate_amiga" ) {
@@ -2005,15 +2205,51 @@ void module_impl::ctl_set_integer( std::string_view ctl, std::int64_t value, boo
 		}
 	}
 
+	const render_ahead_guard guard = splice_render_ahead();
 	if ( ctl == "" ) {
 		throw openmpt::exception("empty ctl: := " + mpt::format_value_default<std::string>( value ) );
+	} else if ( ctl == "seek.index.max_memory" ) {
+		if ( value < 0 ) {
+			throw openmpt::exception("invalid seek index memory limit");
+		}
+		m_ctl_seek_index_max_memory = value;
+		if ( m_SeekIndex ) {
+			m_SeekIndex->SetMaxMemory( mpt::saturate_cast<std::size_t>( value ) );
+		}
 	} else if ( ctl == "subsong" ) {
 		select_subsong( mpt::saturate_cast<std::int32_t>( value ) );
+	} else if ( ctl == "render.mixer.threads" ) {
+		if ( value < 0 || value > OpenMPT::MixerSettings::MaxMixThreads ) {
+			throw openmpt::exception("invalid number of mixer threads");
+		}
+		const std::uint32_t threads = mpt::saturate_cast<std::uint32_t>( value );
+		if ( threads != m_sndFile->m_MixerSettings.NumMixThreads ) {
+			OpenMPT::MixerSettings settings = m_sndFile->m_MixerSettings;
+			settings.NumMixThreads = threads;
+			m_sndFile->SetMixerSettings( settings );
+		}
+	} else if ( ctl == "render.mixer.chunk_size" ) {
+		if ( value < OpenMPT::MixerSettings::MinMixChunkSize || value > OpenMPT::MixerSettings::MaxMixChunkSize ) {
+			throw openmpt::exception("invalid mixer chunk size");
+		}
+		const std::uint32_t chunk_size = static_cast<std::uint32_t>( value );
+		if ( chunk_size != m_sndFile->m_MixerSettings.MixChunkSize ) {
+			OpenMPT::MixerSettings settings = m_sndFile->m_MixerSettings;
+			settings.MixChunkSize = chunk_size;
+			m_sndFile->SetMixerSettings( settings );
+		}
 	} else if ( ctl == "dither" ) {
 		std::size_t dither = mpt::saturate_cast<std::size_t>( value );
 		if ( dither >= OpenMPT::DithersOpenMPT::GetNumDithers() ) {
 			dither = OpenMPT::DithersOpenMPT::GetDefaultDither();
 		}
+#if LIBOPENMPT_RENDER_AHEAD
+		if ( m_render_ahead ) {
+			// The dither state belongs to the reading thread.
+			m_render_ahead->set_dither( dither );
+			return;
+		}
+#endif // LIBOPENMPT_RENDER_AHEAD
 		m_Dithers->SetMode( dither );
 	} else {
 		MPT_ASSERT_NOTREACHED();
@@ -2044,8 +2280,21 @@ void module_impl::ctl_set_floatingpoint( std::string_view ctl, double value, boo
 		}
 	}
 
+	const render_ahead_guard guard = splice_render_ahead();
 	if ( ctl == "" ) {
 		throw openmpt::exception("empty ctl: := " + mpt::format_value_default<std::string>( value ) );
+	} else if ( ctl == "seek.index.interval" ) {
+		if ( value < 0.0 ) {
+			throw openmpt::exception("invalid seek index interval");
+		}
+		m_ctl_seek_index_interval = value;
+		if ( value == 0.0 ) {
+			m_SeekIndex.reset();
+		} else if ( m_SeekIndex ) {
+			m_SeekIndex->SetInterval( value );
+		} else {
+			m_SeekIndex = std::make_unique<OpenMPT::SeekIndex>( value, mpt::saturate_cast<std::size_t>( m_ctl_seek_index_max_memory ) );
+		}
 	} else if ( ctl == "play.tempo_factor" ) {
 		if ( !is_loaded() ) {
 			return;
@@ -2097,6 +2346,7 @@ void module_impl::ctl_set_text( std::string_view ctl, std::string_view value, bo
 		}
 	}
 
+	const render_ahead_guard guard = splice_render_ahead();
 	if ( ctl == "" ) {
 		throw openmpt::exception("empty ctl: := " + std::string( value ) );
 	} else if ( ctl == "play.at_end" ) {
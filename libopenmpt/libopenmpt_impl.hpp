@@ -13,9 +13,20 @@
 #include "libopenmpt_internal.h"
 #include "libopenmpt.hpp"
 
+#include "mpt/base/span.hpp"
+#include "mpt/mutex/mutex.hpp"
+
+#include <cstddef>
 #include <iosfwd>
 #include <memory>
 #include <utility>
+#include <vector>
+
+#if MPT_MUTEX_STD
+#define LIBOPENMPT_RENDER_AHEAD 1
+#else
+#define LIBOPENMPT_RENDER_AHEAD 0
+#endif
 
 #if defined(_MSC_VER)
 #pragma warning(push)
@@ -53,6 +64,7 @@ using PathString = mpt::BasicPathString<mpt::Utf8PathTraits, false>;
 } // namespace mpt
 using FileCursor = detail::FileCursor<mpt::IO::FileCursorTraitsFileData, mpt::IO::FileCursorFilenameTraits<mpt::PathString>>;
 class CSoundFile;
+class SeekIndex;
 struct DithersWrapperOpenMPT;
 } // namespace OpenMPT
 
@@ -135,6 +147,8 @@ protected:
 	std::unique_ptr<log_forwarder> m_LogForwarder;
 	std::int32_t m_current_subsong;
 	double m_currentPositionSeconds;
+	// Copy of the module data for deferred sample decoding (load.lazy_samples), if it was loaded from memory owned by the caller. Must outlive m_sndFile.
+	std::vector<std::byte> m_file_data;
 	std::unique_ptr<OpenMPT::CSoundFile> m_sndFile;
 	bool m_loaded;
 	bool m_mixer_initialized;
@@ -144,10 +158,21 @@ protected:
 	song_end_action m_ctl_play_at_end;
 	amiga_filter_type m_ctl_render_resampler_emulate_amiga_type = amiga_filter_type::auto_filter;
 	bool m_ctl_load_skip_samples;
+	bool m_ctl_load_lazy_samples;
+	bool m_ctl_load_parallel_samples;
+	bool m_ctl_load_share_samples;
 	bool m_ctl_load_skip_patterns;
 	bool m_ctl_load_skip_plugins;
 	bool m_ctl_load_skip_subsongs_init;
+	bool m_ctl_load_parallel_subsongs;
 	bool m_ctl_seek_sync_samples;
+	double m_ctl_seek_index_interval;
+	std::int64_t m_ctl_seek_index_max_memory;
+	std::unique_ptr<OpenMPT::SeekIndex> m_SeekIndex;
+	class render_ahead_worker;
+	class render_ahead_guard;
+	class audible_state;
+	std::unique_ptr<render_ahead_worker> m_render_ahead;
 	std::vector<std::string> m_loaderMessages;
 public:
 	void PushToCSoundFileLog( const std::string & text ) const;
@@ -161,11 +186,19 @@ protected:
 	bool has_subsongs_inited() const;
 	void ctor( const std::map< std::string, std::string > & ctls );
 	void load( const OpenMPT::FileCursor & file, const std::map< std::string, std::string > & ctls );
+	OpenMPT::FileCursor make_memory_file_cursor( mpt::span< const std::byte > data );
 	bool is_loaded() const;
 	std::size_t read_wrapper( std::size_t count, std::int16_t * left, std::int16_t * right, std::int16_t * rear_left, std::int16_t * rear_right );
 	std::size_t read_wrapper( std::size_t count, float * left, float * right, float * rear_left, float * rear_right );
 	std::size_t read_interleaved_wrapper( std::size_t count, std::size_t channels, std::int16_t * interleaved );
 	std::size_t read_interleaved_wrapper( std::size_t count, std::size_t channels, float * interleaved );
+	std::size_t read_render_ahead( std::int32_t samplerate, std::size_t count, std::int16_t * left, std::int16_t * right, std::int16_t * rear_left, std::int16_t * rear_right );
+	std::size_t read_render_ahead( std::int32_t samplerate, std::size_t count, float * left, float * right, float * rear_left, float * rear_right );
+	std::size_t read_interleaved_render_ahead( std::int32_t samplerate, std::size_t count, std::size_t channels, std::int16_t * interleaved );
+	std::size_t read_interleaved_render_ahead( std::int32_t samplerate, std::size_t count, std::size_t channels, float * interleaved );
+	render_ahead_guard lock_render_ahead() const;
+	render_ahead_guard splice_render_ahead();
+	render_ahead_guard flush_render_ahead();
 	std::string get_message_instruments() const;
 	std::string get_message_samples() const;
 	std::pair< std::string, std::string > format_and_highlight_pattern_row_channel_command( std::int32_t p, std::int32_t r, std::int32_t c, int command ) const;
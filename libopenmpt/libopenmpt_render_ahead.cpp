@@ -0,0 +1,487 @@
+/*
+ * libopenmpt_render_ahead.cpp
+ * ---------------------------
+ * Purpose: libopenmpt private interface - rendering ahead of playback on a background thread
+ * Notes  : (currently none)
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+#include "common/stdafx.h"
+
+#include "libopenmpt_internal.h"
+#include "libopenmpt.hpp"
+
+#include "libopenmpt_impl.hpp"
+#include "libopenmpt_render_ahead.hpp"
+
+#include <algorithm>
+
+#include "mpt/audio/span.hpp"
+
+#include "common/Dither.h"
+#include "soundlib/AudioReadTarget.h"
+#include "soundlib/Sndfile.h"
+
+// assume OPENMPT_NAMESPACE is OpenMPT
+
+namespace openmpt {
+
+#if LIBOPENMPT_RENDER_AHEAD
+
+// Writes rendered audio to the queue, starting at a given queue position
+class module_impl::render_ahead_worker::queue_target : public OpenMPT::IAudioTarget {
+private:
+	render_ahead_worker & m_worker;
+	std::uint32_t m_position;
+public:
+	queue_target( render_ahead_worker & worker, std::uint32_t position ) : m_worker( worker ), m_position( position ) { }
+	void Process( mpt::audio_span_interleaved<OpenMPT::MixSampleInt> buffer ) override {
+		write( buffer );
+	}
+	void Process( mpt::audio_span_interleaved<OpenMPT::MixSampleFloat> buffer ) override {
+		write( buffer );
+	}
+private:
+	template <typename Tsample>
+	void write( mpt::audio_span_interleaved<Tsample> buffer ) {
+		if constexpr ( std::is_same<Tsample, OpenMPT::mixsample_t>::value ) {
+			MPT_ASSERT( buffer.size_channels() == static_cast<std::size_t>( m_worker.m_channels ) );
+			const std::size_t channels = buffer.size_channels();
+			std::size_t frames_done = 0;
+			while ( frames_done < buffer.size_frames() ) {
+				const std::size_t offset = m_position & m_worker.m_queue_mask;
+				const std::size_t frames = std::min( buffer.size_frames() - frames_done, static_cast<std::size_t>( m_worker.m_queue_mask ) + 1 - offset );
+				std::copy( buffer.data() + frames_done * channels, buffer.data() + ( frames_done + frames ) * channels, m_worker.m_queue.data() + offset * channels );
+				frames_done += frames;
+				m_position += static_cast<std::uint32_t>( frames );
+			}
+		} else {
+			MPT_UNUSED( buffer );
+			MPT_ASSERT_NOTREACHED();
+		}
+	}
+}; // class queue_target
+
+// Used for fast-forwarding the module after rewinding it to the start of a block
+class module_impl::render_ahead_worker::discard_target : public OpenMPT::IAudioTarget {
+public:
+	void Process( mpt::audio_span_interleaved<OpenMPT::MixSampleInt> ) override { }
+	void Process( mpt::audio_span_interleaved<OpenMPT::MixSampleFloat> ) override { }
+}; // class discard_target
+
+static std::size_t next_power_of_two( std::size_t value ) {
+	std::size_t result = 1;
+	while ( result < value ) {
+		result *= 2;
+	}
+	return result;
+}
+
+// Plugins, OPL synthesis, reverb and DSP effects keep state that is not part of the playback state snapshots.
+// Audio that has been rendered through them must not be rendered again, as that would advance their state twice.
+static bool has_unrewindable_state( const OpenMPT::CSoundFile & sndFile ) {
+	if ( sndFile.m_opl || sndFile.m_MixerSettings.DSPMask ) {
+		return true;
+	}
+#ifndef NO_REVERB
+	if ( sndFile.m_Reverb.IsActive() ) {
+		return true;
+	}
+#endif // NO_REVERB
+#ifndef NO_PLUGINS
+	for ( const auto & plugin : sndFile.m_MixPlugins ) {
+		if ( plugin.pMixPlugin ) {
+			return true;
+		}
+	}
+#endif // NO_PLUGINS
+	return false;
+}
+
+module_impl::render_ahead_worker::render_ahead_worker( module_impl & module, std::int32_t samplerate, int channels, std::size_t queue_frames )
+	: m_module( module )
+	, m_samplerate( samplerate )
+	, m_channels( channels )
+	, m_queue_frames( queue_frames )
+	, m_block_frames( std::clamp( queue_frames / 4, std::size_t( 1 ), std::size_t( MIXBUFFERSIZE ) ) )
+	, m_queue( next_power_of_two( queue_frames ) * channels )
+	, m_queue_mask( static_cast<std::uint32_t>( next_power_of_two( queue_frames ) - 1 ) )
+	, m_gain( module.m_Gain )
+	, m_dither( module.m_Dithers->GetMode() )
+	, m_scratch( m_block_frames * channels )
+	, m_poll_interval( std::max( std::int64_t( 1000 ), static_cast<std::int64_t>( m_block_frames ) * 500000 / samplerate ) )
+{
+	MPT_ASSERT( queue_frames > 0 && queue_frames <= max_queue_frames );
+	// Avoid an underrun on the first read.
+	render_block();
+	m_thread = std::thread( [this]() { worker_thread(); } );
+}
+
+module_impl::render_ahead_worker::~render_ahead_worker() {
+	if ( m_thread.joinable() ) {
+		{
+			std::lock_guard<std::mutex> lock( m_wake_mutex );
+			m_stop_requested = true;
+			m_wake_pending = true;
+		}
+		m_wake_condition.notify_one();
+		m_thread.join();
+	}
+}
+
+std::unique_lock<std::recursive_mutex> module_impl::render_ahead_worker::lock() const {
+	return std::unique_lock<std::recursive_mutex>( m_render_mutex );
+}
+
+void module_impl::render_ahead_worker::worker_thread() {
+	while ( !m_stop_requested ) {
+		bool rendered = false;
+		bool reader_busy = false;
+		{
+			std::lock_guard<std::recursive_mutex> lock( m_render_mutex );
+			if ( m_stop_requested ) {
+				break;
+			}
+			reader_busy = reader_holds_discarded_frames();
+			if ( !reader_busy ) {
+				try {
+					rendered = render_block();
+				} catch ( ... ) {
+					// Nothing sensible can be done here. The consumer will see an underrun.
+					rendered = false;
+				}
+			}
+		}
+		if ( reader_busy ) {
+			// The consumer copies at most one block, so it will be done very soon. Nobody else waits for this, as the lock is not held.
+			std::this_thread::yield();
+		} else if ( !rendered ) {
+			std::unique_lock<std::mutex> lock( m_wake_mutex );
+			m_wake_condition.wait_for( lock, m_poll_interval, [this]() { return m_wake_pending; } );
+			m_wake_pending = false;
+		}
+	}
+}
+
+void module_impl::render_ahead_worker::wake() {
+	{
+		std::lock_guard<std::mutex> lock( m_wake_mutex );
+		m_wake_pending = true;
+	}
+	m_wake_condition.notify_one();
+}
+
+std::size_t module_impl::render_ahead_worker::render( OpenMPT::IAudioTarget & target, std::size_t frames ) {
+	OpenMPT::CSoundFile & sndFile = *m_module.m_sndFile;
+	sndFile.ResetMixStat();
+	sndFile.m_bIsRendering = ( m_module.m_ctl_play_at_end != song_end_action::fadeout_song );
+	const std::size_t count = sndFile.Read( static_cast<OpenMPT::CSoundFile::samplecount_t>( frames ), target );
+	m_module.m_currentPositionSeconds += static_cast<double>( count ) / static_cast<double>( m_samplerate );
+	return count;
+}
+
+bool module_impl::render_ahead_worker::render_block() {
+	MPT_ASSERT( !reader_holds_discarded_frames() );
+	OpenMPT::CSoundFile & sndFile = *m_module.m_sndFile;
+	std::uint64_t state = m_state.load();
+	const std::uint32_t write_pos = write_position( state );
+	if ( m_queue_frames - ( write_pos - read_position( state ) ) < m_block_frames ) {
+		return false;
+	}
+
+	block new_block;
+	if ( !m_spare_blocks.empty() ) {
+		new_block = std::move( m_spare_blocks.back() );
+		m_spare_blocks.pop_back();
+	}
+	new_block.start = write_pos;
+	new_block.position_seconds = m_module.m_currentPositionSeconds;
+	new_block.song_flags = sndFile.m_SongFlags;
+	sndFile.m_PlayState.Save( new_block.state, sndFile.GetNumChannels(), true );
+	sndFile.SaveResumeState( new_block.resume_state );
+
+	queue_target target( *this, write_pos );
+	const std::size_t count = render( target, m_block_frames );
+	if ( count == 0 ) {
+		m_spare_blocks.push_back( std::move( new_block ) );
+		// End of song. There can only be one pending end marker, so wait until the consumer has reached the previous one.
+		const std::uint64_t marker = m_end_marker.load();
+		if ( marker & end_pending ) {
+			return false;
+		}
+		m_end_marker = ( ( marker >> 33 ) + 1 ) << 33 | end_pending | write_pos;
+		if ( m_module.m_ctl_play_at_end == song_end_action::continue_song ) {
+			// Same as synchronous rendering: The song or loop restarts after the end has been reported.
+			sndFile.m_SongFlags.reset( OpenMPT::SONG_ENDREACHED );
+		}
+		return true;
+	}
+	new_block.frames = static_cast<std::uint32_t>( count );
+	new_block.rewindable = !has_unrewindable_state( sndFile );
+	m_blocks.push_back( std::move( new_block ) );
+
+	// Publish the new frames. The consumer may advance the read position at the same time.
+	while ( !m_state.compare_exchange_weak( state, make_state( read_position( state ), write_pos + static_cast<std::uint32_t>( count ) ) ) ) {
+	}
+
+	// Blocks that have been read completely are no longer needed for rewinding.
+	const std::uint32_t read_pos = read_position( state );
+	while ( !m_blocks.empty() && read_pos - m_blocks.front().start >= m_blocks.front().frames && static_cast<std::int32_t>( read_pos - m_blocks.front().start ) >= 0 ) {
+		m_spare_blocks.push_back( std::move( m_blocks.front() ) );
+		m_blocks.pop_front();
+	}
+	return true;
+}
+
+std::deque<module_impl::render_ahead_worker::block>::const_iterator module_impl::render_ahead_worker::find_block( std::uint32_t position ) const {
+	return std::find_if( m_blocks.begin(), m_blocks.end(), [position]( const block & b ) { return position - b.start < b.frames; } );
+}
+
+bool module_impl::render_ahead_worker::reader_holds_discarded_frames() const {
+	// The consumer may still be copying frames that were discarded by the last cut. They must not be overwritten before it is done.
+	return ( m_cut_reader_sequence & 1 ) && m_reader_sequence.load() == m_cut_reader_sequence;
+}
+
+void module_impl::render_ahead_worker::cut( cut_mode mode ) {
+	OpenMPT::CSoundFile & sndFile = *m_module.m_sndFile;
+	const bool at_read_position = ( mode != cut_mode::splice );
+	std::uint64_t state = m_state.load();
+	std::uint32_t cut_pos = 0;
+	bool rewind = true;
+	while ( true ) {
+		const std::uint32_t read_pos = read_position( state );
+		const std::uint32_t write_pos = write_position( state );
+		if ( at_read_position ) {
+			cut_pos = read_pos;
+		} else {
+			const auto current_block = find_block( read_pos );
+			cut_pos = ( current_block != m_blocks.end() ) ? current_block->start + current_block->frames : write_pos;
+		}
+		rewind = std::all_of( find_block( cut_pos ), m_blocks.cend(), []( const block & b ) { return b.rewindable; } );
+		if ( !rewind && mode == cut_mode::splice ) {
+			// Keep all queued audio instead. The change only becomes audible after it.
+			cut_pos = write_pos;
+		}
+		if ( cut_pos == write_pos ) {
+			// Nothing to discard, the module is already at the cut position.
+			break;
+		}
+		if ( m_state.compare_exchange_weak( state, make_state( read_pos, cut_pos ) ) ) {
+			break;
+		}
+	}
+	// Only the worker thread writes to the queue, so the caller does not need to wait for the consumer here.
+	m_cut_reader_sequence = m_reader_sequence.load();
+
+	const std::uint64_t marker = m_end_marker.load();
+	if ( ( marker & end_pending ) && ( at_read_position || static_cast<std::int32_t>( static_cast<std::uint32_t>( marker ) - cut_pos ) > 0 ) ) {
+		// The consumer could not have reached this marker yet, otherwise it would not be pending anymore.
+		std::uint64_t expected = marker;
+		m_end_marker.compare_exchange_strong( expected, marker & ~end_pending );
+	}
+
+	const auto cut_block = find_block( cut_pos );
+	if ( cut_block != m_blocks.end() ) {
+		sndFile.m_PlayState.Restore( cut_block->state );
+		sndFile.RestoreResumeState( cut_block->resume_state );
+		sndFile.m_SongFlags = cut_block->song_flags;
+		m_module.m_currentPositionSeconds = cut_block->position_seconds;
+		// When flushing, the module is about to be repositioned, so it may as well stay at the start of the block instead of rendering the discarded part of the block again.
+		const std::uint32_t skip_frames = ( rewind || mode == cut_mode::stop ) ? cut_pos - cut_block->start : 0;
+		const auto first_removed = m_blocks.begin() + std::distance( m_blocks.cbegin(), cut_block );
+		std::move( first_removed, m_blocks.end(), std::back_inserter( m_spare_blocks ) );
+		m_blocks.erase( first_removed, m_blocks.end() );
+		discard_target target;
+		std::size_t frames_left = skip_frames;
+		while ( frames_left > 0 ) {
+			const std::size_t count = render( target, frames_left );
+			if ( count == 0 ) {
+				break;
+			}
+			frames_left -= count;
+		}
+	}
+	wake();
+}
+
+void module_impl::render_ahead_worker::splice() {
+	cut( cut_mode::splice );
+}
+
+void module_impl::render_ahead_worker::flush() {
+	cut( cut_mode::flush );
+}
+
+void module_impl::render_ahead_worker::stop() {
+	{
+		std::lock_guard<std::mutex> lock( m_wake_mutex );
+		m_stop_requested = true;
+		m_wake_pending = true;
+	}
+	m_wake_condition.notify_one();
+	m_thread.join();
+	const auto guard = lock();
+	const std::uint64_t marker = m_end_marker.load();
+	const bool end_pending_at_read_pos = ( marker & end_pending ) && static_cast<std::uint32_t>( marker ) == read_position( m_state.load() );
+	// The module must continue exactly at the audio that has been read, even if that renders some audio through plugins etc. again.
+	cut( cut_mode::stop );
+	if ( end_pending_at_read_pos ) {
+		// Let the next synchronous read report the end of the song.
+		m_module.m_sndFile->m_SongFlags.set( OpenMPT::SONG_ENDREACHED );
+	}
+	apply_dither();
+}
+
+double module_impl::render_ahead_worker::get_position_seconds() const {
+	const std::uint32_t read_pos = read_position( m_state.load() );
+	const auto current_block = find_block( read_pos );
+	if ( current_block == m_blocks.end() ) {
+		return m_module.m_currentPositionSeconds;
+	}
+	return current_block->position_seconds + static_cast<double>( read_pos - current_block->start ) / static_cast<double>( m_samplerate );
+}
+
+const OpenMPT::CSoundFile::PlayState::Snapshot * module_impl::render_ahead_worker::get_audible_state() const {
+	const auto current_block = find_block( read_position( m_state.load() ) );
+	return ( current_block != m_blocks.end() ) ? &current_block->state : nullptr;
+}
+
+OpenMPT::CHANNELINDEX module_impl::render_ahead_worker::get_audible_mix_stat() const {
+	const auto current_block = find_block( read_position( m_state.load() ) );
+	return ( current_block != m_blocks.end() ) ? current_block->resume_state.mixStat : m_module.m_sndFile->GetMixStat();
+}
+
+void module_impl::render_ahead_worker::set_gain( float gain ) {
+	m_gain = gain;
+}
+
+void module_impl::render_ahead_worker::set_dither( std::size_t dither ) {
+	m_dither = dither;
+	m_dither_changes++;
+}
+
+std::size_t module_impl::render_ahead_worker::get_dither() const {
+	return m_dither;
+}
+
+void module_impl::render_ahead_worker::apply_dither() {
+	const std::uint32_t changes = m_dither_changes.load();
+	if ( changes != m_applied_dither_changes ) {
+		m_module.m_Dithers->SetMode( m_dither.load() );
+		m_applied_dither_changes = changes;
+	}
+}
+
+std::size_t module_impl::render_ahead_worker::get_queued_frames() const {
+	const std::uint64_t state = m_state.load();
+	return write_position( state ) - read_position( state );
+}
+
+std::uint64_t module_impl::render_ahead_worker::get_underrun_frames() const {
+	return m_underrun_frames;
+}
+
+std::size_t module_impl::render_ahead_worker::dequeue( std::size_t max_frames, bool consume_end, bool & end_of_song ) {
+	end_of_song = false;
+	m_reader_sequence++;
+	std::uint64_t state = m_state.load();
+	const std::uint32_t read_pos = read_position( state );
+	std::uint32_t frames = std::min( static_cast<std::uint32_t>( max_frames ), write_position( state ) - read_pos );
+	// The end marker must be loaded after the write position, so that frames following a new marker cannot be mistaken for frames preceding it.
+	const std::uint64_t marker = m_end_marker.load();
+	if ( marker & end_pending ) {
+		const std::uint32_t frames_to_end = static_cast<std::uint32_t>( marker ) - read_pos;
+		if ( frames_to_end <= frames ) {
+			frames = frames_to_end;
+			if ( frames == 0 ) {
+				end_of_song = true;
+				if ( consume_end ) {
+					std::uint64_t expected = marker;
+					m_end_marker.compare_exchange_strong( expected, marker & ~end_pending );
+				}
+			}
+		}
+	}
+	const std::size_t channels = m_channels;
+	std::size_t frames_copied = 0;
+	while ( frames_copied < frames ) {
+		const std::size_t offset = ( read_pos + frames_copied ) & m_queue_mask;
+		const std::size_t count = std::min( static_cast<std::size_t>( frames ) - frames_copied, static_cast<std::size_t>( m_queue_mask ) + 1 - offset );
+		std::copy( m_queue.data() + offset * channels, m_queue.data() + ( offset + count ) * channels, m_scratch.data() + frames_copied * channels );
+		frames_copied += count;
+	}
+	// If the queued audio has been cut in the meantime, only the frames before the cut are valid.
+	// They cannot have been overwritten yet, as the worker does not render after a cut before we are done.
+	while ( frames > 0 && !m_state.compare_exchange_weak( state, make_state( read_pos + frames, write_position( state ) ) ) ) {
+		frames = std::min( frames, write_position( state ) - read_pos );
+	}
+	m_reader_sequence++;
+	return frames;
+}
+
+#endif // LIBOPENMPT_RENDER_AHEAD
+
+module_impl::render_ahead_guard module_impl::lock_render_ahead() const {
+#if LIBOPENMPT_RENDER_AHEAD
+	if ( m_render_ahead ) {
+		return render_ahead_guard( m_render_ahead->lock() );
+	}
+#endif // LIBOPENMPT_RENDER_AHEAD
+	return render_ahead_guard();
+}
+
+const OpenMPT::CSoundFile::GlobalPlayState & module_impl::audible_state::play_state() const {
+#if LIBOPENMPT_RENDER_AHEAD
+	if ( m_module.m_render_ahead ) {
+		if ( const auto state = m_module.m_render_ahead->get_audible_state() ) {
+			return state->GetGlobalState();
+		}
+	}
+#endif // LIBOPENMPT_RENDER_AHEAD
+	return m_module.m_sndFile->m_PlayState;
+}
+
+const OpenMPT::ModChannel & module_impl::audible_state::channel( OpenMPT::CHANNELINDEX channel ) const {
+#if LIBOPENMPT_RENDER_AHEAD
+	if ( m_module.m_render_ahead ) {
+		if ( const auto state = m_module.m_render_ahead->get_audible_state(); state && channel < state->GetNumPatternChannels() ) {
+			return state->GetPatternChannel( channel );
+		}
+	}
+#endif // LIBOPENMPT_RENDER_AHEAD
+	return m_module.m_sndFile->m_PlayState.Chn[channel];
+}
+
+OpenMPT::CHANNELINDEX module_impl::audible_state::mix_stat() const {
+#if LIBOPENMPT_RENDER_AHEAD
+	if ( m_module.m_render_ahead ) {
+		return m_module.m_render_ahead->get_audible_mix_stat();
+	}
+#endif // LIBOPENMPT_RENDER_AHEAD
+	return m_module.m_sndFile->GetMixStat();
+}
+
+module_impl::render_ahead_guard module_impl::splice_render_ahead() {
+#if LIBOPENMPT_RENDER_AHEAD
+	if ( m_render_ahead ) {
+		render_ahead_guard guard( m_render_ahead->lock() );
+		m_render_ahead->splice();
+		return guard;
+	}
+#endif // LIBOPENMPT_RENDER_AHEAD
+	return render_ahead_guard();
+}
+
+module_impl::render_ahead_guard module_impl::flush_render_ahead() {
+#if LIBOPENMPT_RENDER_AHEAD
+	if ( m_render_ahead ) {
+		render_ahead_guard guard( m_render_ahead->lock() );
+		m_render_ahead->flush();
+		return guard;
+	}
+#endif // LIBOPENMPT_RENDER_AHEAD
+	return render_ahead_guard();
+}
+
+} // namespace openmpt
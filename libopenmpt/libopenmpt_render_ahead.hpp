@@ -0,0 +1,206 @@
+/*
+ * libopenmpt_render_ahead.hpp
+ * ---------------------------
+ * Purpose: libopenmpt private interface - rendering ahead of playback on a background thread
+ * Notes  : This is not a public header. Do NOT ship in distributions dev packages.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+#ifndef LIBOPENMPT_RENDER_AHEAD_HPP
+#define LIBOPENMPT_RENDER_AHEAD_HPP
+
+#include "libopenmpt_internal.h"
+#include "libopenmpt_impl.hpp"
+
+#if LIBOPENMPT_RENDER_AHEAD
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "soundlib/AudioReadTarget.h"
+
+#endif // LIBOPENMPT_RENDER_AHEAD
+
+#include "soundlib/Sndfile.h"
+
+namespace openmpt {
+
+// Keeps the worker thread from rendering while the module is accessed from another thread.
+class module_impl::render_ahead_guard {
+public:
+	render_ahead_guard() = default;
+#if LIBOPENMPT_RENDER_AHEAD
+	explicit render_ahead_guard( std::unique_lock<std::recursive_mutex> lock ) : m_lock( std::move( lock ) ) { }
+private:
+	std::unique_lock<std::recursive_mutex> m_lock;
+#else // !LIBOPENMPT_RENDER_AHEAD
+	// Not trivial, so that guard variables do not cause unused variable warnings.
+	~render_ahead_guard() { }
+#endif // LIBOPENMPT_RENDER_AHEAD
+}; // class render_ahead_guard
+
+// The playback state that belongs to the audio that is currently being read. While rendering ahead, the module itself is further ahead.
+// Must only be used with the lock returned by lock_render_ahead() held.
+class module_impl::audible_state {
+public:
+	explicit audible_state( const module_impl & module ) : m_module( module ) { }
+	const OpenMPT::CSoundFile::GlobalPlayState & play_state() const;
+	const OpenMPT::ModChannel & channel( OpenMPT::CHANNELINDEX channel ) const;
+	OpenMPT::CHANNELINDEX mix_stat() const;
+private:
+	const module_impl & m_module;
+}; // class audible_state
+
+#if LIBOPENMPT_RENDER_AHEAD
+
+// Renders the module on a background thread into a single-producer single-consumer queue of mixed (not yet converted) audio.
+// The reading side never waits or allocates memory. Gain and dithering are applied while reading, so the output is identical to synchronous rendering.
+// All functions except read(), get_queued_frames() and get_underrun_frames() must be called with the lock returned by lock() held.
+class module_impl::render_ahead_worker {
+public:
+	static constexpr std::size_t max_queue_frames = 1u << 24;
+
+	render_ahead_worker( module_impl & module, std::int32_t samplerate, int channels, std::size_t queue_frames );
+	// Stops the worker thread without rewinding the module, see stop().
+	~render_ahead_worker();
+
+	std::int32_t get_samplerate() const { return m_samplerate; }
+	int get_channels() const { return m_channels; }
+
+	// Consumer side, may be called concurrently with all other functions.
+	template <typename Taudio_span>
+	std::size_t read( Taudio_span buffer );
+	std::size_t get_queued_frames() const;
+	std::uint64_t get_underrun_frames() const;
+
+	std::unique_lock<std::recursive_mutex> lock() const;
+
+	// Discard the queued audio that follows the block that is currently being read, and rewind the module to the end of that block.
+	// If the queued audio was rendered through state that cannot be rewound, nothing is discarded, and the module stays at the end of the queued audio.
+	void splice();
+	// Discard all queued audio and rewind the module to the audible position, so that it can be repositioned.
+	// If the queued audio was rendered through state that cannot be rewound, the module is only rewound to the start of the block that is currently being read.
+	void flush();
+	// Stop the worker thread and rewind the module to the audible position. Must not be called concurrently with read().
+	void stop();
+
+	double get_position_seconds() const;
+	// Playback state at the read position, i.e. the state before rendering the block that is currently being read.
+	// Returns nullptr if nothing is queued, as the module itself is at the read position then.
+	const OpenMPT::CSoundFile::PlayState::Snapshot * get_audible_state() const;
+	// Number of voices that were mixed in the block preceding the read position.
+	OpenMPT::CHANNELINDEX get_audible_mix_stat() const;
+	void set_gain( float gain );
+	void set_dither( std::size_t dither );
+	std::size_t get_dither() const;
+
+private:
+	struct block {
+		std::uint32_t start = 0;  // Queue position of the first frame
+		std::uint32_t frames = 0;
+		double position_seconds = 0.0;
+		OpenMPT::FlagSet<OpenMPT::SongFlags> song_flags;
+		OpenMPT::CSoundFile::PlayState::Snapshot state;  // Playback state before rendering the block
+		OpenMPT::CSoundFile::ResumeState resume_state;  // Mixer and row visitor state before rendering the block, including the number of voices mixed in the previous block
+		bool rewindable = true;  // Rendering the block did not advance any state that is not part of the snapshots
+	};
+	enum class cut_mode {
+		splice,
+		flush,
+		stop,
+	};
+	class queue_target;
+	class discard_target;
+
+	// Read and write positions are packed into one word, so that the consumer and a splice can never disagree about which frames are valid.
+	static constexpr std::uint64_t make_state( std::uint32_t read_pos, std::uint32_t write_pos ) { return ( static_cast<std::uint64_t>( write_pos ) << 32 ) | read_pos; }
+	static constexpr std::uint32_t read_position( std::uint64_t state ) { return static_cast<std::uint32_t>( state ); }
+	static constexpr std::uint32_t write_position( std::uint64_t state ) { return static_cast<std::uint32_t>( state >> 32 ); }
+	// The end of song marker: position in the low 32 bits, followed by a pending flag and a generation counter
+	static constexpr std::uint64_t end_pending = std::uint64_t( 1 ) << 32;
+
+	void worker_thread();
+	bool render_block();
+	std::size_t render( OpenMPT::IAudioTarget & target, std::size_t frames );
+	void cut( cut_mode mode );
+	bool reader_holds_discarded_frames() const;
+	void wake();
+	std::deque<block>::const_iterator find_block( std::uint32_t position ) const;
+	std::size_t dequeue( std::size_t max_frames, bool consume_end, bool & end_of_song );
+	void apply_dither();
+
+	module_impl & m_module;
+	const std::int32_t m_samplerate;
+	const int m_channels;
+	const std::size_t m_queue_frames;
+	const std::size_t m_block_frames;
+	std::vector<OpenMPT::mixsample_t> m_queue;  // Power of two number of frames, at least m_queue_frames
+	std::uint32_t m_queue_mask;
+	std::atomic<std::uint64_t> m_state{ 0 };
+	std::atomic<std::uint64_t> m_end_marker{ 0 };
+	std::atomic<std::uint32_t> m_reader_sequence{ 0 };  // Odd while the consumer copies frames out of the queue
+	std::atomic<std::uint64_t> m_underrun_frames{ 0 };
+	std::atomic<float> m_gain;
+	std::atomic<std::size_t> m_dither;
+	std::atomic<std::uint32_t> m_dither_changes{ 0 };
+
+	// Consumer state
+	std::vector<OpenMPT::mixsample_t> m_scratch;
+	std::uint32_t m_applied_dither_changes = 0;
+
+	// Worker state, protected by m_render_mutex
+	mutable std::recursive_mutex m_render_mutex;
+	std::deque<block> m_blocks;
+	std::vector<block> m_spare_blocks;
+	std::uint32_t m_cut_reader_sequence = 0;  // Consumer sequence at the time of the last cut, see reader_holds_discarded_frames()
+
+	std::mutex m_wake_mutex;
+	std::condition_variable m_wake_condition;
+	bool m_wake_pending = false;
+	std::atomic<bool> m_stop_requested{ false };
+	const std::chrono::microseconds m_poll_interval;
+	std::thread m_thread;
+}; // class render_ahead_worker
+
+template <typename Taudio_span>
+inline std::size_t module_impl::render_ahead_worker::read( Taudio_span buffer ) {
+	apply_dither();
+	OpenMPT::AudioTargetBufferWithGain<Taudio_span> target( buffer, *m_module.m_Dithers, m_gain );
+	const std::size_t count = buffer.size_frames();
+	std::size_t count_read = 0;
+	while ( count_read < count ) {
+		const std::size_t frames_wanted = std::min( count - count_read, m_block_frames );
+		bool end_of_song = false;
+		std::size_t frames = dequeue( frames_wanted, count_read == 0, end_of_song );
+		if ( end_of_song ) {
+			break;
+		}
+		if ( frames == 0 ) {
+			// Underrun: Output silence instead of waiting for the worker thread.
+			std::fill( m_scratch.begin(), m_scratch.begin() + frames_wanted * m_channels, OpenMPT::mixsample_t( 0 ) );
+			frames = frames_wanted;
+			m_underrun_frames += frames;
+		}
+		target.Process( mpt::audio_span_interleaved<OpenMPT::mixsample_t>( m_scratch.data(), m_channels, frames ) );
+		count_read += frames;
+	}
+	return count_read;
+}
+
+#else // !LIBOPENMPT_RENDER_AHEAD
+
+class module_impl::render_ahead_worker {
+}; // class render_ahead_worker
+
+#endif // LIBOPENMPT_RENDER_AHEAD
+
+} // namespace openmpt
+
+#endif // LIBOPENMPT_RENDER_AHEAD_HPP
@@ -564,8 +564,9 @@ protected:
 				{
 					if(chn.pModSample == nullptr)
 						continue;
-					SAMPLEINDEX smp = static_cast<SAMPLEINDEX>(std::distance<const ModSample *>(&sndFile.GetSample(0), chn.pModSample));
-					m_samplesUsed[smp] = true;
+					const SAMPLEINDEX smp = sndFile.GetSampleIndex(chn.pModSample);
+					if(smp < m_samplesUsed.size())
+						m_samplesUsed[smp] = true;
 				}
 				m_patternsToAnalyze.erase(sndFile.m_PlayState.m_nPattern);
 
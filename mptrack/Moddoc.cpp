@@ -184,6 +184,7 @@ BOOL CModDoc::OnNewDocument()
 	m_SndFile.ChangeModTypeTo(CTrackApp::GetDefaultDocType());
 
 	theApp.GetDefaultMidiMacro(m_SndFile.m_MidiCfg);
+	m_SndFile.UpdateCompiledMIDIMacros();
 	m_SndFile.m_SongFlags.set((SONG_LINEARSLIDES | SONG_ISAMIGA) & m_SndFile.GetModSpecifications().songFlags);
 
 	ReinitRecordState();
@@ -635,7 +636,7 @@ void CModDoc::InitializeMod()
 			m_SndFile.Patterns.Insert(0, 64);
 		}
 
-		Clear(m_SndFile.m_szNames);
+		m_SndFile.m_szNames.reset();
 
 		m_SndFile.m_PlayState.m_nMusicTempo.Set(125);
 		m_SndFile.m_nDefaultTempo.Set(125);
@@ -2286,7 +2287,10 @@ void CModDoc::OnSetupZxxMacros()
 	{
 		if(m_SndFile.m_MidiCfg != dlg.m_MidiCfg)
 		{
+			CriticalSection cs;
 			m_SndFile.m_MidiCfg = dlg.m_MidiCfg;
+			m_SndFile.UpdateCompiledMIDIMacros();
+			cs.Leave();
 			SetModified();
 		}
 	}
@@ -2916,7 +2920,9 @@ void CModDoc::LearnMacro(int macroToSet, PlugParamIndex paramToUse)
 	// Set new macro
 	if(paramToUse < 384)
 	{
+		CriticalSection cs;
 		m_SndFile.m_MidiCfg.CreateParameteredMacro(macroToSet, kSFxPlugParam, paramToUse);
+		m_SndFile.UpdateCompiledMIDIMacros();
 	} else
 	{
 		CString message;
@@ -43,9 +43,11 @@ static const char * const license =
 
 #include "mpt/base/check_platform.hpp"
 #include "mpt/base/detect.hpp"
+#include "mpt/mutex/mutex.hpp"
 
 #include <algorithm>
 #include <deque>
+#include <exception>
 #include <fstream>
 #include <iostream>
 #include <iterator>
@@ -61,6 +63,12 @@ static const char * const license =
 #include <string>
 #include <vector>
 
+#if MPT_MUTEX_STD
+#include <atomic>
+#include <system_error>
+#include <thread>
+#endif
+
 #include <cassert>
 #include <cmath>
 #include <cstdint>
@@ -308,6 +316,7 @@ static concat_stream<mpt::ustring> & operator << ( concat_stream<mpt::ustring> &
 	s << MPT_USTRING("Standard output: ") << flags.use_stdout << lf;
 	s << MPT_USTRING("Output filename: ") << mpt::transcode<mpt::ustring>( flags.output_filename ) << lf;
 	s << MPT_USTRING("Force overwrite output file: ") << flags.force_overwrite << lf;
+	s << MPT_USTRING("Jobs: ") << flags.jobs << lf;
 	s << MPT_USTRING("Ctls: ") << ctls_to_string( flags.ctls ) << lf;
 	s << lf;
 	s << MPT_USTRING("Files: ") << lf;
@@ -614,6 +623,7 @@ static void show_help( textout & log, bool longhelp = false, bool man_version =
 		log << MPT_USTRING("     --output-type t        Use output format t when writing to a individual PCM files (only applies to --render mode) [default: ") << mpt::transcode<mpt::ustring>( commandlineflags().output_extension ) << MPT_USTRING("]") << lf;
 		log << MPT_USTRING(" -o, --output f             Write PCM output to file f instead of streaming to audio device (only applies to --ui and --batch modes) [default: ") << mpt::transcode<mpt::ustring>( commandlineflags().output_filename ) << MPT_USTRING("]") << lf;
 		log << MPT_USTRING("     --force                Force overwriting of output file [default: ") << commandlineflags().force_overwrite << MPT_USTRING("]") << lf;
+		log << MPT_USTRING("     --jobs n               Render n files concurrently (only applies to --render mode) [default: ") << commandlineflags().jobs << MPT_USTRING("]") << lf;
 		log << lf;
 		log << MPT_USTRING("     --                     Interpret further arguments as filenames") << lf;
 		log << lf;
@@ -1535,23 +1545,43 @@ static void render_file( commandlineflags & flags, const mpt::native_path & file
 
 	try {
 
-		std::optional<mpt::IO::ifstream> optional_file_stream;
-		std::uint64_t filesize = 0;
 		bool use_stdin = ( filename == MPT_NATIVE_PATH("-") );
+		// Large regular files are loaded from a memory mapping, which avoids copying the file contents through a stream.
+		// Everything else, and any file that cannot be mapped, is read through a stream instead.
+		std::optional<mpt::IO::FileMapping> optional_file_mapping;
 		if ( !use_stdin ) {
+			optional_file_mapping.emplace( filename );
+			if ( !optional_file_mapping->IsValid() ) {
+				optional_file_mapping.reset();
+			}
+		}
+		std::optional<mpt::IO::ifstream> optional_file_stream;
+		std::uint64_t filesize = 0;
+		if ( optional_file_mapping ) {
+			filesize = optional_file_mapping->GetView().size();
+		} else if ( !use_stdin ) {
 			optional_file_stream.emplace( filename, std::ios::binary );
 			std::istream & file_stream = *optional_file_stream;
 			file_stream.seekg( 0, std::ios::end );
 			filesize = file_stream.tellg();
 			file_stream.seekg( 0, std::ios::beg );
 		}
-		std::istream & data_stream = use_stdin ? std::cin : *optional_file_stream;
-		if ( data_stream.fail() ) {
-			throw exception( MPT_USTRING("file open error") );
-		}
 
 		{
-			openmpt::module mod( data_stream, silentlog, flags.ctls );
+			std::optional<openmpt::module> optional_mod;
+			if ( optional_file_mapping ) {
+				optional_mod.emplace( optional_file_mapping->GetView().data(), optional_file_mapping->GetView().size(), silentlog, flags.ctls );
+				// libopenmpt only reads from the memory passed to the constructor while loading.
+				// Unmap right away so that truncating the file during playback cannot fault.
+				optional_file_mapping.reset();
+			} else {
+				std::istream & data_stream = use_stdin ? std::cin : *optional_file_stream;
+				if ( data_stream.fail() ) {
+					throw exception( MPT_USTRING("file open error") );
+				}
+				optional_mod.emplace( data_stream, silentlog, flags.ctls );
+			}
+			openmpt::module & mod = *optional_mod;
 			mod.select_subsong( flags.subsong );
 			silentlog.str( std::string() ); // clear, loader messages get stored to get_metadata( "warnings" ) by libopenmpt internally
 			render_mod_file( flags, filename, filesize, mod, log, audio_stream );
@@ -1662,6 +1692,68 @@ static void render_files( commandlineflags & flags, textout & log, write_buffers
 }
 
 
+static void render_file_to_file( commandlineflags & flags, const mpt::native_path & filename, textout & log ) {
+	flags.apply_default_buffer_sizes();
+	file_audio_stream_raii file_audio_stream( flags, filename + MPT_NATIVE_PATH(".") + flags.output_extension, log );
+	render_file( flags, filename, log, file_audio_stream );
+}
+
+#if MPT_MUTEX_STD
+
+static void render_files_to_files_parallel( const commandlineflags & flags, textout & log ) {
+	std::atomic<std::size_t> next_file{ 0 };
+	mpt::mutex log_mutex;
+	std::exception_ptr first_error;
+	auto worker = [&]() {
+		commandlineflags job_flags = flags;
+		while ( true ) {
+			const std::size_t index = next_file++;
+			if ( index >= flags.filenames.size() ) {
+				break;
+			}
+			// Collect all output of a file and write it in one go, so that the output of concurrently rendered files does not get mixed up.
+			textout_buffered job_log;
+			bool failed = false;
+			try {
+				job_flags.playlist_index = index;
+				render_file_to_file( job_flags, flags.filenames[index], job_log );
+			} catch ( ... ) {
+				failed = true;
+				mpt::lock_guard<mpt::mutex> guard( log_mutex );
+				if ( !first_error ) {
+					first_error = std::current_exception();
+				}
+			}
+			if ( failed ) {
+				// like in sequential mode, do not start rendering any further files
+				next_file = flags.filenames.size();
+			}
+			mpt::lock_guard<mpt::mutex> guard( log_mutex );
+			log << job_log.take();
+			log.writeout();
+		}
+	};
+	std::vector<std::thread> threads;
+	const std::size_t num_threads = std::min( flags.jobs, flags.filenames.size() );
+	for ( std::size_t i = 1; i < num_threads; ++i ) {
+		try {
+			threads.emplace_back( worker );
+		} catch ( const std::system_error & ) {
+			break;
+		}
+	}
+	// the calling thread renders files, too
+	worker();
+	for ( auto & thread : threads ) {
+		thread.join();
+	}
+	if ( first_error ) {
+		std::rethrow_exception( first_error );
+	}
+}
+
+#endif // MPT_MUTEX_STD
+
 static bool parse_playlist( commandlineflags & flags, mpt::native_path filename, concat_stream<mpt::ustring> & log ) {
 	bool is_playlist = false;
 	bool m3u8 = false;
@@ -1961,6 +2053,9 @@ static void parse_openmpt123( commandlineflags & flags, const std::vector<mpt::u
 				++i;
 			} else if ( arg == MPT_USTRING("--force") ) {
 				flags.force_overwrite = true;
+			} else if ( arg == MPT_USTRING("--jobs") && nextarg != MPT_USTRING("") ) {
+				mpt::parse_into( flags.jobs, nextarg );
+				++i;
 			} else if ( arg == MPT_USTRING("--output-type") && nextarg != MPT_USTRING("") ) {
 				flags.output_extension = mpt::transcode<mpt::native_path>( nextarg );
 				++i;
@@ -2376,10 +2471,14 @@ static int main( int argc, char * argv [] ) {
 				}
 			} break;
 			case Mode::Render: {
+#if MPT_MUTEX_STD
+				if ( flags.jobs > 1 && flags.filenames.size() > 1 ) {
+					render_files_to_files_parallel( flags, log );
+					break;
+				}
+#endif // MPT_MUTEX_STD
 				for ( const auto & filename : flags.filenames ) {
-					flags.apply_default_buffer_sizes();
-					file_audio_stream_raii file_audio_stream( flags, filename + MPT_NATIVE_PATH(".") + flags.output_extension, log );
-					render_file( flags, filename, log, file_audio_stream );
+					render_file_to_file( flags, filename, log );
 					flags.playlist_index++;
 				}
 			} break;
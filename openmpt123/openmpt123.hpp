@@ -24,6 +24,7 @@
 #include "mpt/format/message.hpp"
 #include "mpt/format/message_macros.hpp"
 #include "mpt/format/simple.hpp"
+#include "mpt/io_file/filemapping.hpp"
 #include "mpt/io_file/fstream.hpp"
 #include "mpt/parse/parse.hpp"
 #include "mpt/path/native_path.hpp"
@@ -179,6 +180,24 @@ public:
 	}
 };
 
+class textout_buffered : public textout {
+public:
+	textout_buffered() {
+		return;
+	}
+	virtual ~textout_buffered() {
+		return;
+	}
+public:
+	void writeout() override {
+		// keep everything until take() is called
+		return;
+	}
+	mpt::ustring take() {
+		return pop();
+	}
+};
+
 class textout_ostream : public textout {
 private:
 	std::ostream & s;
@@ -445,6 +464,7 @@ struct commandlineflags {
 	mpt::native_path output_filename;
 	mpt::native_path output_extension;
 	bool force_overwrite;
+	std::size_t jobs;
 	bool paused;
 	mpt::ustring warnings;
 	void apply_default_buffer_sizes() {
@@ -559,6 +579,7 @@ struct commandlineflags {
 		playlist_index = 0;
 		output_extension = MPT_NATIVE_PATH("auto");
 		force_overwrite = false;
+		jobs = 1;
 		paused = false;
 	}
 	void check_and_sanitize() {
@@ -664,6 +685,16 @@ struct commandlineflags {
 		if ( mode == Mode::Render && !output_filename.empty() ) {
 			throw args_error_exception();
 		}
+		if ( jobs < 1 ) {
+			jobs = 1;
+		}
+		if ( mode != Mode::Render && jobs != 1 ) {
+			throw args_error_exception();
+		}
+		if ( jobs > 1 ) {
+			// progress of concurrently rendered files cannot be shown in a single status line
+			show_progress = false;
+		}
 		if ( mode != Mode::Render && !output_filename.empty() ) {
 			output_extension = get_extension( output_filename );
 		}
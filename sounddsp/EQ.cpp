@@ -94,13 +94,104 @@ static void EQFilter(Tbuf & buf, const std::array<EQBANDSETTINGS, MAX_EQ_BANDS>
 }
 
 
+#if defined(MPT_ENABLE_ARCH_INTRINSICS_SSE)
+
+// Same as EQFilter, but filters all channels in parallel, one channel per vector lane.
+// The arithmetic operations are performed in the same order as in EQFilter, so the results are identical.
+template <std::size_t channels, typename Tbuf>
+static void EQFilterSSE(Tbuf &buf, const std::array<EQBANDSETTINGS, MAX_EQ_BANDS> &bands, std::array<std::array<EQBANDSTATE, MAX_EQ_BANDS>, MAX_EQ_CHANNELS> &states)
+{
+	static_assert(channels <= 4);
+	constexpr std::size_t blockSize = 64;
+	// Unused lanes stay zero
+	alignas(16) std::array<float, 4 * blockSize> block{};
+	for(std::size_t offset = 0; offset < buf.size_frames(); offset += blockSize)
+	{
+		const std::size_t count = std::min(blockSize, buf.size_frames() - offset);
+		for(std::size_t frame = 0; frame < count; ++frame)
+		{
+			for(std::size_t channel = 0; channel < channels; ++channel)
+			{
+				block[frame * 4 + channel] = mix_sample_cast<float>(buf(channel, offset + frame));
+			}
+		}
+		for(std::size_t b = 0; b < std::size(bands); ++b)
+		{
+			const EQBANDSETTINGS &band = bands[b];
+			if(band.Gain == 1.0f)
+				continue;
+			alignas(16) std::array<float, 4> x1{}, x2{}, y1{}, y2{};
+			for(std::size_t channel = 0; channel < channels; ++channel)
+			{
+				x1[channel] = states[channel][b].x1;
+				x2[channel] = states[channel][b].x2;
+				y1[channel] = states[channel][b].y1;
+				y2[channel] = states[channel][b].y2;
+			}
+			const __m128 a0 = _mm_set1_ps(band.a0), a1 = _mm_set1_ps(band.a1), a2 = _mm_set1_ps(band.a2);
+			const __m128 b1 = _mm_set1_ps(band.b1), b2 = _mm_set1_ps(band.b2);
+			__m128 vx1 = _mm_load_ps(x1.data()), vx2 = _mm_load_ps(x2.data());
+			__m128 vy1 = _mm_load_ps(y1.data()), vy2 = _mm_load_ps(y2.data());
+			for(std::size_t frame = 0; frame < count; ++frame)
+			{
+				const __m128 x = _mm_load_ps(&block[frame * 4]);
+				__m128 y = _mm_add_ps(_mm_mul_ps(a1, vx1), _mm_mul_ps(a2, vx2));
+				y = _mm_add_ps(y, _mm_mul_ps(a0, x));
+				y = _mm_add_ps(y, _mm_mul_ps(b1, vy1));
+				y = _mm_add_ps(y, _mm_mul_ps(b2, vy2));
+				vx2 = vx1;
+				vy2 = vy1;
+				vx1 = x;
+				vy1 = y;
+				_mm_store_ps(&block[frame * 4], y);
+			}
+			_mm_store_ps(x1.data(), vx1);
+			_mm_store_ps(x2.data(), vx2);
+			_mm_store_ps(y1.data(), vy1);
+			_mm_store_ps(y2.data(), vy2);
+			for(std::size_t channel = 0; channel < channels; ++channel)
+			{
+				states[channel][b] = EQBANDSTATE{x1[channel], x2[channel], y1[channel], y2[channel]};
+			}
+		}
+		for(std::size_t frame = 0; frame < count; ++frame)
+		{
+			for(std::size_t channel = 0; channel < channels; ++channel)
+			{
+				buf(channel, offset + frame) = mix_sample_cast<typename Tbuf::sample_type>(block[frame * 4 + channel]);
+			}
+		}
+	}
+}
+
+#endif
+
+
+template <std::size_t channels, typename Tbuf>
+static void EQFilter(Tbuf &buf, const std::array<EQBANDSETTINGS, MAX_EQ_BANDS> &bands, std::array<std::array<EQBANDSTATE, MAX_EQ_BANDS>, MAX_EQ_CHANNELS> &states, bool useSSE)
+{
+#if defined(MPT_ENABLE_ARCH_INTRINSICS_SSE)
+	if(useSSE)
+	{
+		EQFilterSSE<channels>(buf, bands, states);
+		return;
+	}
+#else
+	MPT_UNUSED(useSSE);
+#endif
+	EQFilter<channels>(buf, bands, states);
+}
+
+
 template <typename TMixSample>
 void CEQ::ProcessTemplate(TMixSample *frontBuffer, TMixSample *rearBuffer, std::size_t countFrames, std::size_t numChannels)
 {
+	bool useSSE = false;
 #if defined(MPT_ENABLE_ARCH_INTRINSICS_SSE)
 	unsigned int old_csr = 0;
 	if(CPU::HasFeatureSet(CPU::feature::sse) && CPU::HasModesEnabled(CPU::mode::xmm128sse))
 	{
+		useSSE = m_allowSIMD;
 		old_csr = _mm_getcsr();
 		_mm_setcsr((old_csr & ~(_MM_DENORMALS_ZERO_MASK | _MM_FLUSH_ZERO_MASK)) | _MM_DENORMALS_ZERO_ON | _MM_FLUSH_ZERO_ON);
 	}
@@ -108,16 +199,16 @@ void CEQ::ProcessTemplate(TMixSample *frontBuffer, TMixSample *rearBuffer, std::
 	if(numChannels == 1)
 	{
 		mpt::audio_span_interleaved<TMixSample> buf{ frontBuffer, 1, countFrames };
-		EQFilter<1>(buf, m_Bands, m_ChannelState);
+		EQFilter<1>(buf, m_Bands, m_ChannelState, useSSE);
 	} else if(numChannels == 2)
 	{
 		mpt::audio_span_interleaved<TMixSample> buf{ frontBuffer, 2, countFrames };
-		EQFilter<2>(buf, m_Bands, m_ChannelState);
+		EQFilter<2>(buf, m_Bands, m_ChannelState, useSSE);
 	} else if(numChannels == 4)
 	{
 		std::array<TMixSample*, 4> buffers = { &frontBuffer[0], &frontBuffer[1], &rearBuffer[0], &rearBuffer[1] };
 		mpt::audio_span_planar_strided<TMixSample> buf{ buffers.data(), 4, countFrames, 2 };
-		EQFilter<4>(buf, m_Bands, m_ChannelState);
+		EQFilter<4>(buf, m_Bands, m_ChannelState, useSSE);
 	}
 #if defined(MPT_ENABLE_ARCH_INTRINSICS_SSE)
 	if(CPU::HasFeatureSet(CPU::feature::sse) && CPU::HasModesEnabled(CPU::mode::xmm128sse))
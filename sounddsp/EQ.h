@@ -51,6 +51,7 @@ class CEQ
 private:
 	std::array<std::array<EQBANDSTATE, MAX_EQ_BANDS>, MAX_EQ_CHANNELS> m_ChannelState;
 	std::array<EQBANDSETTINGS, MAX_EQ_BANDS> m_Bands;
+	bool m_allowSIMD = true;
 	template <typename TMixSample>
 	void ProcessTemplate(TMixSample *frontBuffer, TMixSample *rearBuffer, std::size_t countFrames, std::size_t numChannels);
 public:
@@ -59,6 +60,8 @@ public:
 	void Process(MixSampleInt *frontBuffer, MixSampleInt *rearBuffer, std::size_t countFrames, std::size_t numChannels);
 	void Process(MixSampleFloat *frontBuffer, MixSampleFloat *rearBuffer, std::size_t countFrames, std::size_t numChannels);
 	void SetEQGains(const uint32 *pGains, const uint32 *pFreqs, bool bReset, uint32 MixingFreq);
+	// The SIMD code path produces the same output as the generic code. Disallowing it is only useful for verifying this.
+	void AllowSIMD(bool allow) noexcept { m_allowSIMD = allow; }
 };
 
 #endif // !NO_EQ
@@ -13,13 +13,20 @@
 
 #ifndef NO_REVERB
 #include "Reverb.h"
+
+// The SSE2 code paths produce bit-identical results to the generic code,
+// so that the output does not depend on the host CPU.
 #if defined(MPT_ENABLE_ARCH_INTRINSICS_SSE2)
+#define MPT_REVERB_SSE2
+#endif
+
+#if defined(MPT_REVERB_SSE2)
 #include "../common/mptCPU.h"
 #endif
 #include "../soundlib/MixerLoops.h"
 #include "mpt/base/numbers.hpp"
 
-#if defined(MPT_ENABLE_ARCH_INTRINSICS_SSE2)
+#if defined(MPT_REVERB_SSE2)
 #include <emmintrin.h>
 #endif
 
@@ -32,7 +39,7 @@ OPENMPT_NAMESPACE_BEGIN
 #ifndef NO_REVERB
 
 
-#if defined(MPT_ENABLE_ARCH_INTRINSICS_SSE2)
+#if defined(MPT_REVERB_SSE2)
 // Load two 32-bit values
 static MPT_FORCEINLINE __m128i Load64SSE(const int32 *x) { return _mm_loadl_epi64(reinterpret_cast<const __m128i *>(x)); }
 // Load four 16-bit values
@@ -40,9 +47,42 @@ static MPT_FORCEINLINE __m128i Load64SSE(const LR16 (&x)[2]) { return _mm_loadl_
 // Store two 32-bit or four 16-bit values from register
 static MPT_FORCEINLINE void Store64SSE(int32 *dst, __m128i src) { return _mm_storel_epi64(reinterpret_cast<__m128i *>(dst), src); }
 static MPT_FORCEINLINE void Store64SSE(LR16 (&dst)[2], __m128i src) { return _mm_storel_epi64(&reinterpret_cast<__m128i &>(dst), src); }
+
+// Signed 16-bit multiplication returning (a * b) / 65536, i.e. rounded towards zero like the generic code.
+// _mm_mulhi_epi16 alone rounds towards negative infinity, so negative products with a fractional part need to be corrected.
+static MPT_FORCEINLINE __m128i MulHiTruncSSE(__m128i a, __m128i b)
+{
+	const __m128i hi = _mm_mulhi_epi16(a, b);
+	const __m128i hasFraction = _mm_xor_si128(_mm_cmpeq_epi16(_mm_mullo_epi16(a, b), _mm_setzero_si128()), _mm_set1_epi16(-1));
+	return _mm_sub_epi16(hi, _mm_and_si128(hasFraction, _mm_srai_epi16(hi, 15)));
+}
+
+// Signed 32-bit division by (1 << shift), rounded towards zero like the generic code
+template <int shift>
+static MPT_FORCEINLINE __m128i DivPow2SSE(__m128i x)
+{
+	return _mm_srai_epi32(_mm_add_epi32(x, _mm_srli_epi32(_mm_srai_epi32(x, 31), 32 - shift)), shift);
+}
+
+// Signed 16-bit division by (1 << shift), rounded towards zero like the generic code
+template <int shift>
+static MPT_FORCEINLINE __m128i DivPow2Epi16SSE(__m128i x)
+{
+	return _mm_srai_epi16(_mm_add_epi16(x, _mm_srli_epi16(_mm_srai_epi16(x, 15), 16 - shift)), shift);
+}
 #endif
 
 
+bool CReverb::UseSSE2() const noexcept
+{
+#if defined(MPT_REVERB_SSE2)
+	return m_allowSIMD && CPU::HasFeatureSet(CPU::feature::sse2) && CPU::HasModesEnabled(CPU::mode::xmm128sse);
+#else
+	return false;
+#endif
+}
+
+
 CReverb::CReverb()
 {
 	// Reverb mix buffers
@@ -246,7 +286,7 @@ static void I3dl2_to_Generic(
 }
 
 
-void CReverb::Shutdown(MixSampleInt &gnRvbROfsVol, MixSampleInt &gnRvbLOfsVol)
+void CReverb::Shutdown(mixsample_t &gnRvbROfsVol, mixsample_t &gnRvbLOfsVol)
 {
 	gnReverbSend = false;
 
@@ -273,7 +313,7 @@ void CReverb::Shutdown(MixSampleInt &gnRvbROfsVol, MixSampleInt &gnRvbLOfsVol)
 }
 
 
-void CReverb::Initialize(bool bReset, MixSampleInt &gnRvbROfsVol, MixSampleInt &gnRvbLOfsVol, uint32 MixingFreq)
+void CReverb::Initialize(bool bReset, mixsample_t &gnRvbROfsVol, mixsample_t &gnRvbLOfsVol, uint32 MixingFreq)
 {
 	if (m_Settings.m_nReverbType >= NUM_REVERBTYPES) m_Settings.m_nReverbType = 0;
 	const SNDMIX_REVERB_PROPERTIES *rvbPreset = &ReverbPresets[m_Settings.m_nReverbType].first;
@@ -381,7 +421,7 @@ void CReverb::Initialize(bool bReset, MixSampleInt &gnRvbROfsVol, MixSampleInt &
 }
 
 
-void CReverb::TouchReverbSendBuffer(MixSampleInt *MixReverbBuffer, MixSampleInt &gnRvbROfsVol, MixSampleInt &gnRvbLOfsVol, uint32 nSamples)
+void CReverb::TouchReverbSendBuffer(mixsample_t *MixReverbBuffer, mixsample_t &gnRvbROfsVol, mixsample_t &gnRvbLOfsVol, uint32 nSamples)
 {
 	if(!gnReverbSend)
 	{ // and we did not clear the buffer yet, do it now because we will get new data
@@ -392,7 +432,7 @@ void CReverb::TouchReverbSendBuffer(MixSampleInt *MixReverbBuffer, MixSampleInt
 
 
 // Reverb
-void CReverb::Process(MixSampleInt *MixSoundBuffer, MixSampleInt *MixReverbBuffer, MixSampleInt &gnRvbROfsVol, MixSampleInt &gnRvbLOfsVol, uint32 nSamples)
+void CReverb::Process(mixsample_t *MixSoundBuffer, mixsample_t *MixReverbBuffer, mixsample_t &gnRvbROfsVol, mixsample_t &gnRvbLOfsVol, uint32 nSamples)
 {
 	if((!gnReverbSend) && (!gnReverbSamples))
 	{ // no data is sent to reverb and reverb decayed completely
@@ -403,6 +443,40 @@ void CReverb::Process(MixSampleInt *MixSoundBuffer, MixSampleInt *MixReverbBuffe
 		StereoFill(MixReverbBuffer, nSamples, gnRvbROfsVol, gnRvbLOfsVol);
 	}
 
+	// The delay lines are too short for processing arbitrarily large blocks at once
+	for(uint32 offset = 0; offset < nSamples; offset += MIXBUFFERSIZE)
+	{
+		const uint32 count = std::min(nSamples - offset, uint32(MIXBUFFERSIZE));
+#ifdef MPT_INTMIXER
+		ProcessFixed(MixSoundBuffer + offset * 2, MixReverbBuffer + offset * 2, count);
+#else
+		for(uint32 i = 0; i < count * 2; i++)
+		{
+			m_fixedSendBuffer[i] = mpt::saturate_round<int32>(MixReverbBuffer[offset * 2 + i] * MIXING_SCALEF);
+			m_fixedOutBuffer[i] = 0;
+		}
+		ProcessFixed(m_fixedOutBuffer, m_fixedSendBuffer, count);
+		for(uint32 i = 0; i < count * 2; i++)
+		{
+			MixSoundBuffer[offset * 2 + i] += static_cast<mixsample_t>(m_fixedOutBuffer[i]) * (1.0f / MIXING_SCALEF);
+		}
+#endif
+	}
+
+	// Automatically shut down if needed
+	if(gnReverbSend) gnReverbSamples = gnReverbDecaySamples; // reset decay counter
+	else if(gnReverbSamples > nSamples) gnReverbSamples -= nSamples; // decay
+	else // decayed
+	{
+		Shutdown(gnRvbROfsVol, gnRvbLOfsVol);
+		gnReverbSamples = 0;
+	}
+	gnReverbSend = false; // no input data in MixReverbBuffer
+}
+
+
+void CReverb::ProcessFixed(int32 *MixSoundBuffer, int32 *MixReverbBuffer, uint32 nSamples)
+{
 	uint32 nIn, nOut;
 	// Dynamically adjust reverb master gains
 	int32 lMasterGain;
@@ -457,15 +531,6 @@ void CReverb::Process(MixSampleInt *MixSoundBuffer, MixSampleInt *MixReverbBuffe
 	g_RefDelay.nDelayPos = (g_RefDelay.nDelayPos - nOut + nIn) & SNDMIX_REFLECTIONS_DELAY_MASK;
 	// Upsample 2x
 	ReverbProcessPostFiltering1x(MixReverbBuffer, MixSoundBuffer, nSamples);
-	// Automatically shut down if needed
-	if(gnReverbSend) gnReverbSamples = gnReverbDecaySamples; // reset decay counter
-	else if(gnReverbSamples > nSamples) gnReverbSamples -= nSamples; // decay
-	else // decayed
-	{
-		Shutdown(gnRvbROfsVol, gnRvbLOfsVol);
-		gnReverbSamples = 0;
-	}
-	gnReverbSend = false; // no input data in MixReverbBuffer
 }
 
 
@@ -591,8 +656,8 @@ void CReverb::ReverbProcessPostFiltering2x(const int32 * MPT_RESTRICT pRvb, int3
 // Stereo Add + DC removal
 void CReverb::ReverbProcessPostFiltering1x(const int32 * MPT_RESTRICT pRvb, int32 * MPT_RESTRICT pDry, uint32 nSamples)
 {
-#if defined(MPT_ENABLE_ARCH_INTRINSICS_SSE2)
-	if(CPU::HasFeatureSet(CPU::feature::sse2) && CPU::HasModesEnabled(CPU::mode::xmm128sse))
+#if defined(MPT_REVERB_SSE2)
+	if(UseSSE2())
 	{
 		__m128i nDCRRvb_Y1 = Load64SSE(gnDCRRvb_Y1);
 		__m128i nDCRRvb_X1 = Load64SSE(gnDCRRvb_X1);
@@ -603,9 +668,9 @@ void CReverb::ReverbProcessPostFiltering1x(const int32 * MPT_RESTRICT pRvb, int3
 			pRvb += 2;
 			// x(n-1) - x(n)
 			__m128i diff = _mm_sub_epi32(nDCRRvb_X1, in);
-			nDCRRvb_X1 = _mm_add_epi32(nDCRRvb_Y1, _mm_sub_epi32(_mm_srai_epi32(diff, DCR_AMOUNT + 1), diff));
+			nDCRRvb_X1 = _mm_add_epi32(nDCRRvb_Y1, _mm_sub_epi32(DivPow2SSE<DCR_AMOUNT + 1>(diff), diff));
 			__m128i out = _mm_add_epi32(Load64SSE(pDry), nDCRRvb_X1);
-			nDCRRvb_Y1 = _mm_sub_epi32(nDCRRvb_X1, _mm_srai_epi32(nDCRRvb_X1, DCR_AMOUNT));
+			nDCRRvb_Y1 = _mm_sub_epi32(nDCRRvb_X1, DivPow2SSE<DCR_AMOUNT>(nDCRRvb_X1));
 			nDCRRvb_X1 = in;
 			Store64SSE(pDry, out);
 			pDry += 2;
@@ -653,22 +718,23 @@ void CReverb::ReverbProcessPostFiltering1x(const int32 * MPT_RESTRICT pRvb, int3
 
 void CReverb::ReverbDCRemoval(int32 * MPT_RESTRICT pBuffer, uint32 nSamples)
 {
-#if defined(MPT_ENABLE_ARCH_INTRINSICS_SSE2)
-	if(CPU::HasFeatureSet(CPU::feature::sse2) && CPU::HasModesEnabled(CPU::mode::xmm128sse))
+#if defined(MPT_REVERB_SSE2)
+	if(UseSSE2())
 	{
 		__m128i nDCRRvb_Y1 = Load64SSE(gnDCRRvb_Y1);
 		__m128i nDCRRvb_X1 = Load64SSE(gnDCRRvb_X1);
+		__m128i in = _mm_setzero_si128();
 		while(nSamples--)
 		{
-			__m128i in = Load64SSE(pBuffer);
+			in = Load64SSE(pBuffer);
 			__m128i diff = _mm_sub_epi32(nDCRRvb_X1, in);
-			__m128i out = _mm_add_epi32(nDCRRvb_Y1, _mm_sub_epi32(_mm_srai_epi32(diff, DCR_AMOUNT + 1), diff));
+			__m128i out = _mm_add_epi32(nDCRRvb_Y1, _mm_sub_epi32(DivPow2SSE<DCR_AMOUNT + 1>(diff), diff));
 			Store64SSE(pBuffer, out);
 			pBuffer += 2;
-			nDCRRvb_Y1 = _mm_sub_epi32(out, _mm_srai_epi32(out, DCR_AMOUNT));
+			nDCRRvb_Y1 = _mm_sub_epi32(out, DivPow2SSE<DCR_AMOUNT>(out));
 			nDCRRvb_X1 = in;
 		}
-		Store64SSE(gnDCRRvb_X1, nDCRRvb_X1);
+		Store64SSE(gnDCRRvb_X1, in);
 		Store64SSE(gnDCRRvb_Y1, nDCRRvb_Y1);
 		return;
 	}
@@ -714,12 +780,12 @@ void CReverb::ReverbDCRemoval(int32 * MPT_RESTRICT pBuffer, uint32 nSamples)
 // Save some typing
 static MPT_FORCEINLINE int32 Clamp16(int32 x) { return Clamp(x, std::numeric_limits<int16>::min(), std::numeric_limits<int16>::max()); }
 
-void CReverb::ProcessPreDelay(SWRvbRefDelay * MPT_RESTRICT pPreDelay, const int32 * MPT_RESTRICT pIn, uint32 nSamples)
+void CReverb::ProcessPreDelay(SWRvbRefDelay * MPT_RESTRICT pPreDelay, const int32 * MPT_RESTRICT pIn, uint32 nSamples) const
 {
 	uint32 preDifPos = pPreDelay->nPreDifPos;
 	uint32 delayPos = pPreDelay->nDelayPos - 1;
-#if defined(MPT_ENABLE_ARCH_INTRINSICS_SSE2)
-	if(CPU::HasFeatureSet(CPU::feature::sse2) && CPU::HasModesEnabled(CPU::mode::xmm128sse))
+#if defined(MPT_REVERB_SSE2)
+	if(UseSSE2())
 	{
 		__m128i coeffs = _mm_cvtsi32_si128(pPreDelay->nCoeffs.lr);
 		__m128i history = _mm_cvtsi32_si128(pPreDelay->History.lr);
@@ -730,15 +796,15 @@ void CReverb::ProcessPreDelay(SWRvbRefDelay * MPT_RESTRICT pPreDelay, const int3
 			__m128i inSat = _mm_packs_epi32(in32, in32);	// [ r | l | r | l ] (16-bit saturated)
 			pIn += 2;
 			// Low-pass
-			__m128i lp = _mm_mulhi_epi16(_mm_subs_epi16(history, inSat), coeffs);
+			__m128i lp = MulHiTruncSSE(_mm_subs_epi16(history, inSat), coeffs);
 			__m128i preDif = _mm_cvtsi32_si128(pPreDelay->PreDifBuffer[preDifPos].lr);
 			history = _mm_adds_epi16(_mm_adds_epi16(lp, lp), inSat);
 			// Pre-Diffusion
 			preDifPos = (preDifPos + 1) & SNDMIX_PREDIFFUSION_DELAY_MASK;
 			delayPos = (delayPos + 1) & SNDMIX_REFLECTIONS_DELAY_MASK;
-			__m128i preDif2 = _mm_subs_epi16(history, _mm_mulhi_epi16(preDif, preDifCoeffs));
+			__m128i preDif2 = _mm_subs_epi16(history, MulHiTruncSSE(preDif, preDifCoeffs));
 			pPreDelay->PreDifBuffer[preDifPos].lr = _mm_cvtsi128_si32(preDif2);
-			pPreDelay->RefDelayBuffer[delayPos].lr = _mm_cvtsi128_si32(_mm_adds_epi16(_mm_mulhi_epi16(preDifCoeffs, preDif2), preDif));
+			pPreDelay->RefDelayBuffer[delayPos].lr = _mm_cvtsi128_si32(_mm_adds_epi16(MulHiTruncSSE(preDifCoeffs, preDif2), preDif));
 		}
 		pPreDelay->nPreDifPos = preDifPos;
 		pPreDelay->History.lr = _mm_cvtsi128_si32(history);
@@ -788,10 +854,10 @@ void CReverb::ProcessPreDelay(SWRvbRefDelay * MPT_RESTRICT pPreDelay, const int3
 //	- apply reflections master gain and accumulate in the given output
 //
 
-void CReverb::ProcessReflections(SWRvbRefDelay * MPT_RESTRICT pPreDelay, LR16 * MPT_RESTRICT pRefOut, int32 * MPT_RESTRICT pOut, uint32 nSamples)
+void CReverb::ProcessReflections(SWRvbRefDelay * MPT_RESTRICT pPreDelay, LR16 * MPT_RESTRICT pRefOut, int32 * MPT_RESTRICT pOut, uint32 nSamples) const
 {
-#if defined(MPT_ENABLE_ARCH_INTRINSICS_SSE2)
-	if(CPU::HasFeatureSet(CPU::feature::sse2) && CPU::HasModesEnabled(CPU::mode::xmm128sse))
+#if defined(MPT_REVERB_SSE2)
+	if(UseSSE2())
 	{
 		union
 		{
@@ -808,7 +874,8 @@ void CReverb::ProcessReflections(SWRvbRefDelay * MPT_RESTRICT pPreDelay, LR16 *
 		__m128i gain56 = _mm_unpacklo_epi64(Load64SSE(pPreDelay->Reflections[4].Gains), Load64SSE(pPreDelay->Reflections[5].Gains));
 		__m128i gain78 = _mm_unpacklo_epi64(Load64SSE(pPreDelay->Reflections[6].Gains), Load64SSE(pPreDelay->Reflections[7].Gains));
 		// For 28-bit final output: 16+15-3 = 28
-		__m128i refGain = _mm_srai_epi32(_mm_set_epi32(0, 0, pPreDelay->ReflectionsGain.c.r, pPreDelay->ReflectionsGain.c.l), 3);
+		const int16 gain = pPreDelay->ReflectionsGain.c.l / (1 << 3);
+		__m128i refGain = _mm_set_epi16(0, 0, 0, 0, 0, gain, 0, gain);
 		__m128i delayInc = _mm_set1_epi16(1), delayMask = _mm_set1_epi16(SNDMIX_REFLECTIONS_DELAY_MASK);
 		while(nSamples--)
 		{
@@ -818,16 +885,19 @@ void CReverb::ProcessReflections(SWRvbRefDelay * MPT_RESTRICT pPreDelay, LR16 *
 			__m128i ref34 = _mm_set_epi32(refDelayBuffer[pos.i[3]].lr, refDelayBuffer[pos.i[3]].lr, refDelayBuffer[pos.i[2]].lr, refDelayBuffer[pos.i[2]].lr);
 			__m128i ref56 = _mm_set_epi32(refDelayBuffer[pos.i[5]].lr, refDelayBuffer[pos.i[5]].lr, refDelayBuffer[pos.i[4]].lr, refDelayBuffer[pos.i[4]].lr);
 			__m128i ref78 = _mm_set_epi32(0,                           0,                           refDelayBuffer[pos.i[6]].lr, refDelayBuffer[pos.i[6]].lr);
-			// First stage
+			// First stage, saturated to 16-bit
 			__m128i refOut1 = _mm_add_epi32(_mm_madd_epi16(ref12, gain12), _mm_madd_epi16(ref34, gain34));
-			refOut1 = _mm_srai_epi32(_mm_add_epi32(refOut1, _mm_shuffle_epi32(refOut1, _MM_SHUFFLE(1, 0, 3, 2))), 15);
+			refOut1 = DivPow2SSE<15>(_mm_add_epi32(refOut1, _mm_shuffle_epi32(refOut1, _MM_SHUFFLE(1, 0, 3, 2))));
+			refOut1 = _mm_packs_epi32(refOut1, refOut1);
+			refOut1 = _mm_srai_epi32(_mm_unpacklo_epi16(refOut1, refOut1), 16);
 
 			// Second stage
 			__m128i refOut2 = _mm_add_epi32(_mm_madd_epi16(ref56, gain56), _mm_madd_epi16(ref78, gain78));
-			refOut2 = _mm_srai_epi32(_mm_add_epi32(refOut2, _mm_shuffle_epi32(refOut2, _MM_SHUFFLE(1, 0, 3, 2))), 15);
+			refOut2 = DivPow2SSE<15>(_mm_add_epi32(refOut2, _mm_shuffle_epi32(refOut2, _MM_SHUFFLE(1, 0, 3, 2))));
 
-			// Saturate to 16-bit and sum stages
-			__m128i refOut = _mm_adds_epi16(_mm_packs_epi32(refOut1, refOut1), _mm_packs_epi32(refOut2, refOut2));
+			// Sum stages and saturate to 16-bit
+			__m128i refOut = _mm_add_epi32(refOut1, refOut2);
+			refOut = _mm_packs_epi32(refOut, refOut);
 			pRefOut->lr = _mm_cvtsi128_si32(refOut);
 			pRefOut++;
 
@@ -880,13 +950,13 @@ void CReverb::ProcessReflections(SWRvbRefDelay * MPT_RESTRICT pPreDelay, LR16 *
 // Late reverberation (with SW reflections)
 //
 
-void CReverb::ProcessLateReverb(SWLateReverb * MPT_RESTRICT pReverb, LR16 * MPT_RESTRICT pRefOut, int32 * MPT_RESTRICT pMixOut, uint32 nSamples)
+void CReverb::ProcessLateReverb(SWLateReverb * MPT_RESTRICT pReverb, LR16 * MPT_RESTRICT pRefOut, int32 * MPT_RESTRICT pMixOut, uint32 nSamples) const
 {
 	// Calculate delay line offset from current delay position
 	#define DELAY_OFFSET(x) ((delayPos - (x)) & RVBDLY_MASK)
 
-#if defined(MPT_ENABLE_ARCH_INTRINSICS_SSE2)
-	if(CPU::HasFeatureSet(CPU::feature::sse2) && CPU::HasModesEnabled(CPU::mode::xmm128sse))
+#if defined(MPT_REVERB_SSE2)
+	if(UseSSE2())
 	{
 		int delayPos = pReverb->nDelayPos & RVBDLY_MASK;
 		__m128i rvbOutGains = Load64SSE(pReverb->RvbOutGains);
@@ -911,17 +981,17 @@ void CReverb::ProcessLateReverb(SWLateReverb * MPT_RESTRICT pReverb, LR16 * MPT_
 			uint16 diff2R = pReverb->Diffusion2[DELAY_OFFSET(RVBDIF2R_LEN)].c.r;
 			int32 diffusion2 = diff2L | (diff2R << 16);	// diffusion2 history
 
-			__m128i lpDecay = _mm_mulhi_epi16(_mm_subs_epi16(lpHistory, delay2), decayLP);
+			__m128i lpDecay = MulHiTruncSSE(_mm_subs_epi16(lpHistory, delay2), decayLP);
 			lpHistory = _mm_adds_epi16(_mm_adds_epi16(lpDecay, lpDecay), delay2);	// Low-passed decay
 
 			// Apply decay gain
-			__m128i histDecay = _mm_srai_epi32(_mm_madd_epi16(Load64SSE(pReverb->nDecayDC), lpHistory), 15);
+			__m128i histDecay = DivPow2SSE<15>(_mm_madd_epi16(Load64SSE(pReverb->nDecayDC), lpHistory));
 			__m128i histDecayPacked = _mm_shuffle_epi32(_mm_packs_epi32(histDecay, histDecay), _MM_SHUFFLE(2, 0, 2, 0));
-			__m128i histDecayIn = _mm_adds_epi16(_mm_shuffle_epi32(_mm_packs_epi32(histDecay, histDecay), _MM_SHUFFLE(2, 0, 2, 0)), _mm_srai_epi16(_mm_unpacklo_epi32(refIn, refIn), 2));
-			__m128i histDecayInDiff = _mm_subs_epi16(histDecayIn, _mm_mulhi_epi16(_mm_cvtsi32_si128(diffusion1), difCoeffs));
+			__m128i histDecayIn = _mm_adds_epi16(histDecayPacked, DivPow2Epi16SSE<2>(_mm_unpacklo_epi32(refIn, refIn)));
+			__m128i histDecayInDiff = _mm_subs_epi16(histDecayIn, MulHiTruncSSE(_mm_cvtsi32_si128(diffusion1), difCoeffs));
 			pReverb->Diffusion1[delayPos].lr = _mm_cvtsi128_si32(histDecayInDiff);
 
-			__m128i delay1Out = _mm_adds_epi16(_mm_mulhi_epi16(difCoeffs, histDecayInDiff), _mm_cvtsi32_si128(diffusion1));
+			__m128i delay1Out = _mm_adds_epi16(MulHiTruncSSE(difCoeffs, histDecayInDiff), _mm_cvtsi32_si128(diffusion1));
 			// Insert the diffusion output in the reverb delay line
 			pReverb->Delay1[delayPos].lr = _mm_cvtsi128_si32(delay1Out);
 			__m128i histDecayInDelay = _mm_adds_epi16(histDecayIn, _mm_unpacklo_epi32(delay1Out, delay1Out));
@@ -931,19 +1001,19 @@ void CReverb::ProcessLateReverb(SWLateReverb * MPT_RESTRICT pReverb, LR16 * MPT_
 				_mm_cvtsi32_si128(pReverb->Delay1[DELAY_OFFSET(RVBDLY1L_LEN)].lr),
 				_mm_cvtsi32_si128(pReverb->Delay1[DELAY_OFFSET(RVBDLY1R_LEN)].lr));
 
-			__m128i delay1Gains = _mm_srai_epi32(_mm_madd_epi16(delay1, Load64SSE(pReverb->Dif2InGains)), 15);
+			__m128i delay1Gains = DivPow2SSE<15>(_mm_madd_epi16(delay1, Load64SSE(pReverb->Dif2InGains)));
 			__m128i delay1GainsSat = _mm_shuffle_epi32(_mm_packs_epi32(delay1Gains, delay1Gains), _MM_SHUFFLE(2, 0, 2, 0));
 			__m128i histDelay1 = _mm_subs_epi16(_mm_adds_epi16(histDecayInDelay, delay1), delay1GainsSat);	// accumulate with reverb output
-			__m128i diff2out = _mm_subs_epi16(delay1GainsSat, _mm_mulhi_epi16(_mm_cvtsi32_si128(diffusion2), difCoeffs));
-			__m128i diff2outCoeffs = _mm_mulhi_epi16(difCoeffs, diff2out);
+			__m128i diff2out = _mm_subs_epi16(delay1GainsSat, MulHiTruncSSE(_mm_cvtsi32_si128(diffusion2), difCoeffs));
+			__m128i diff2outCoeffs = MulHiTruncSSE(difCoeffs, diff2out);
 			pReverb->Diffusion2[delayPos].lr = _mm_cvtsi128_si32(diff2out);
 
 			__m128i mixOut = Load64SSE(pMixOut);
 			__m128i delay2out = _mm_adds_epi16(diff2outCoeffs, _mm_cvtsi32_si128(diffusion2));
 			pReverb->Delay2[delayPos].lr = _mm_cvtsi128_si32(delay2out);
 			delayPos = (delayPos + 1) & RVBDLY_MASK;
-			// Accumulate with reverb output
-			__m128i out = _mm_add_epi32(_mm_madd_epi16(_mm_adds_epi16(histDelay1, delay2out), rvbOutGains), mixOut);
+			// Accumulate with reverb output: The left output uses the delay line output, the right output only the diffuser output
+			__m128i out = _mm_add_epi32(_mm_madd_epi16(_mm_adds_epi16(histDelay1, _mm_unpacklo_epi32(delay2out, diff2outCoeffs)), rvbOutGains), mixOut);
 			Store64SSE(pMixOut, out);
 			pMixOut += 2;
 		}
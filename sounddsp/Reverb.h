@@ -155,24 +155,39 @@ private:
 	int g_nLastRvbOut_xr = 0;
 	int32 gnDCRRvb_Y1[2] = { 0, 0 };
 	int32 gnDCRRvb_X1[2] = { 0, 0 };
+	bool m_allowSIMD = true;
 
 	// Reverb mix buffers
 	SWRvbRefDelay g_RefDelay;
 	SWLateReverb g_LateReverb;
 
+#ifndef MPT_INTMIXER
+	// The reverb is implemented in fixed point; these buffers hold the converted floating point mix
+	int32 m_fixedSendBuffer[MIXBUFFERSIZE * 2];
+	int32 m_fixedOutBuffer[MIXBUFFERSIZE * 2];
+#endif
+
 public:
 	CReverb();
 public:
-	void Initialize(bool bReset, MixSampleInt &gnRvbROfsVol, MixSampleInt &gnRvbLOfsVol, uint32 MixingFreq);
+	void Initialize(bool bReset, mixsample_t &gnRvbROfsVol, mixsample_t &gnRvbLOfsVol, uint32 MixingFreq);
 
 	// can be called multiple times or never (if no data is sent to reverb)
-	void TouchReverbSendBuffer(MixSampleInt *MixReverbBuffer, MixSampleInt &gnRvbROfsVol, MixSampleInt &gnRvbLOfsVol, uint32 nSamples);
+	void TouchReverbSendBuffer(mixsample_t *MixReverbBuffer, mixsample_t &gnRvbROfsVol, mixsample_t &gnRvbLOfsVol, uint32 nSamples);
 
 	// call once after all data has been sent.
-	void Process(MixSampleInt *MixSoundBuffer, MixSampleInt *MixReverbBuffer, MixSampleInt &gnRvbROfsVol, MixSampleInt &gnRvbLOfsVol, uint32 nSamples);
+	void Process(mixsample_t *MixSoundBuffer, mixsample_t *MixReverbBuffer, mixsample_t &gnRvbROfsVol, mixsample_t &gnRvbLOfsVol, uint32 nSamples);
+
+	// The SIMD code paths produce the same output as the generic code. Disallowing them is only useful for verifying this.
+	void AllowSIMD(bool allow) noexcept { m_allowSIMD = allow; }
+
+	// Data has been sent to the reverb recently, and it has not decayed completely yet
+	bool IsActive() const noexcept { return gnReverbSend || gnReverbSamples != 0; }
 
 private:
-	void Shutdown(MixSampleInt &gnRvbROfsVol, MixSampleInt &gnRvbLOfsVol);
+	void Shutdown(mixsample_t &gnRvbROfsVol, mixsample_t &gnRvbLOfsVol);
+	// Reverb processing in fixed point
+	void ProcessFixed(int32 *MixSoundBuffer, int32 *MixReverbBuffer, uint32 nSamples);
 	// Pre/Post resampling and filtering
 	uint32 ReverbProcessPreFiltering1x(int32 *pWet, uint32 nSamples);
 	uint32 ReverbProcessPreFiltering2x(int32 *pWet, uint32 nSamples);
@@ -181,11 +196,12 @@ private:
 	void ReverbDCRemoval(int32 *pBuffer, uint32 nSamples);
 	void ReverbDryMix(int32 *pDry, int32 *pWet, int lDryVol, uint32 nSamples);
 	// Process pre-diffusion and pre-delay
-	static void ProcessPreDelay(SWRvbRefDelay *pPreDelay, const int32 *pIn, uint32 nSamples);
+	void ProcessPreDelay(SWRvbRefDelay *pPreDelay, const int32 *pIn, uint32 nSamples) const;
 	// Process reflections
-	static void ProcessReflections(SWRvbRefDelay *pPreDelay, LR16 *pRefOut, int32 *pMixOut, uint32 nSamples);
+	void ProcessReflections(SWRvbRefDelay *pPreDelay, LR16 *pRefOut, int32 *pMixOut, uint32 nSamples) const;
 	// Process Late Reverb (SW Reflections): stereo reflections output, 32-bit reverb output, SW reverb gain
-	static void ProcessLateReverb(SWLateReverb *pReverb, LR16 *pRefOut, int32 *pMixOut, uint32 nSamples);
+	void ProcessLateReverb(SWLateReverb *pReverb, LR16 *pRefOut, int32 *pMixOut, uint32 nSamples) const;
+	bool UseSSE2() const noexcept;
 };
 
 
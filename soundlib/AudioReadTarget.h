@@ -44,9 +44,74 @@ public:
 		return;
 	}
 	std::size_t GetRenderedCount() const { return countRendered; }
+protected:
+	// Returns true if the output buffer has a format that ProcessWithGain() can handle with the optimized conversion functions.
+	bool HasOptimizedConversion(const mpt::audio_span_interleaved<MixSampleInt> &buffer) const
+	{
+		using sample_type = typename Taudio_span::sample_type;
+		if constexpr(std::is_same<sample_type, int16>::value || std::is_same<sample_type, float>::value)
+		{
+			if constexpr(std::is_same<Taudio_span, mpt::audio_span_planar<sample_type>>::value)
+				return true;
+			else if constexpr(std::is_same<Taudio_span, mpt::audio_span_interleaved<sample_type>>::value)
+				return outputBuffer.size_channels() == buffer.size_channels();
+		}
+		MPT_UNUSED(buffer);
+		return false;
+	}
+	// Gain is applied in 16.16 fixed point before dithering for integer output, and in floating point after conversion for float output.
+	// Only valid if HasOptimizedConversion() returns true.
+	void ProcessWithGain(mpt::audio_span_interleaved<MixSampleInt> buffer, MixSampleFloat gainFactor)
+	{
+		using sample_type = typename Taudio_span::sample_type;
+		MPT_ASSERT(HasOptimizedConversion(buffer));
+		const std::size_t channels = buffer.size_channels(), frames = buffer.size_frames();
+		if constexpr(std::is_same<sample_type, int16>::value)
+		{
+			const int32 gainFactor16_16 = mpt::saturate_round<int32>(gainFactor * (1 << 16));
+			std::visit(
+				[&](auto &ditherInstance)
+				{
+					constexpr bool noDither = std::is_same<std::decay_t<decltype(ditherInstance)>, MultiChannelDither<Dither_None>>::value;
+					if(noDither && gainFactor16_16 == (1 << 16))
+						return;
+					// The dither noise must be generated in the same order as before, so this cannot be vectorized.
+					// no clipping prevention is done here
+					for(std::size_t frame = 0; frame < frames; ++frame)
+					{
+						for(std::size_t channel = 0; channel < channels; ++channel)
+						{
+							MixSampleInt sample = buffer(channel, frame);
+							if(gainFactor16_16 != (1 << 16))
+								sample = Util::muldiv(sample, gainFactor16_16, 1 << 16);
+							buffer(channel, frame) = ditherInstance.template process<16>(channel, sample);
+						}
+					}
+				},
+				dithers.Variant()
+			);
+			if constexpr(std::is_same<Taudio_span, mpt::audio_span_planar<sample_type>>::value)
+				ConvertMixToInt16Planar(buffer.data(), outputBuffer.data_planar(), channels, frames, countRendered);
+			else
+				ConvertMixToInt16(buffer.data(), outputBuffer.data() + countRendered * channels, channels * frames);
+		} else if constexpr(std::is_same<sample_type, float>::value)
+		{
+			// No dithering for floating point output
+			if constexpr(std::is_same<Taudio_span, mpt::audio_span_planar<sample_type>>::value)
+				ConvertMixToFloatPlanar(buffer.data(), outputBuffer.data_planar(), channels, frames, countRendered, gainFactor);
+			else
+				ConvertMixToFloat(buffer.data(), outputBuffer.data() + countRendered * channels, channels * frames, gainFactor);
+		}
+		countRendered += frames;
+	}
 public:
 	void Process(mpt::audio_span_interleaved<MixSampleInt> buffer) override
 	{
+		if(HasOptimizedConversion(buffer))
+		{
+			ProcessWithGain(buffer, MixSampleFloat(1.0));
+			return;
+		}
 		std::visit(
 			[&](auto &ditherInstance)
 			{
@@ -88,6 +153,11 @@ public:
 public:
 	void Process(mpt::audio_span_interleaved<MixSampleInt> buffer) override
 	{
+		if(Tbase::HasOptimizedConversion(buffer))
+		{
+			Tbase::ProcessWithGain(buffer, gainFactor);
+			return;
+		}
 		const std::size_t countRendered_ = Tbase::GetRenderedCount();
 		if constexpr(!std::is_floating_point<typename Taudio_span::sample_type>::value)
 		{
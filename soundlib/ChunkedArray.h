@@ -0,0 +1,135 @@
+/*
+ * ChunkedArray.h
+ * --------------
+ * Purpose: Fixed-size array whose storage is only allocated for the parts that are actually used.
+ * Notes  : Storage is allocated in chunks on the first access of any element in that chunk
+ *          and is kept until the container is destroyed, so element addresses remain stable and unique.
+ *          Allocating a chunk is thread-safe, i.e. several mixer threads may touch the same chunk.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#pragma once
+
+#include "openmpt/all/BuildSettings.hpp"
+
+#include <array>
+#include <atomic>
+#include <functional>
+
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+template <typename T, std::size_t N, std::size_t chunkSize = 32>
+class ChunkedArray
+{
+public:
+	static constexpr std::size_t numChunks = (N + chunkSize - 1) / chunkSize;
+
+	ChunkedArray() = default;
+	ChunkedArray(const ChunkedArray &) = delete;
+	ChunkedArray &operator=(const ChunkedArray &) = delete;
+
+	~ChunkedArray()
+	{
+		for(auto &chunk : m_chunks)
+		{
+			delete[] chunk.load(std::memory_order_relaxed);
+		}
+	}
+
+	static constexpr std::size_t size() noexcept { return N; }
+
+	// Access allocates the chunk containing the element if necessary.
+	T &operator[](std::size_t index)
+	{
+		return GetElement(index);
+	}
+
+	// Const access allocates as well: Allocating an element does not change its observable value,
+	// but the player keeps pointers to const elements (e.g. ModChannel::pModSample), which must be distinct and point into this container.
+	const T &operator[](std::size_t index) const
+	{
+		return GetElement(index);
+	}
+
+	// Index of an element of this container, or size() if the pointer does not point into this container.
+	std::size_t IndexOf(const T *element) const noexcept
+	{
+		for(std::size_t c = 0; c < numChunks; c++)
+		{
+			const T *chunk = m_chunks[c].load(std::memory_order_acquire);
+			if(chunk && std::greater_equal<const T *>{}(element, chunk) && std::less<const T *>{}(element, chunk + chunkSize))
+			{
+				return c * chunkSize + static_cast<std::size_t>(element - chunk);
+			}
+		}
+		return N;
+	}
+
+	// Call func(T &) for every element in an allocated chunk, i.e. every element that may differ from a default-constructed element.
+	template <typename Func>
+	void ForEachAllocated(Func &&func)
+	{
+		for(auto &c : m_chunks)
+		{
+			T *chunk = c.load(std::memory_order_acquire);
+			if(!chunk)
+				continue;
+			for(std::size_t i = 0; i < chunkSize; i++)
+			{
+				func(chunk[i]);
+			}
+		}
+	}
+
+	// Reset all elements to their default value. Allocated chunks are kept.
+	void reset()
+	{
+		ForEachAllocated([](T &elem) { elem = T{}; });
+	}
+
+	// Number of bytes allocated for element storage
+	std::size_t GetAllocatedSize() const noexcept
+	{
+		std::size_t size = 0;
+		for(const auto &chunk : m_chunks)
+		{
+			if(chunk.load(std::memory_order_relaxed))
+				size += sizeof(T) * chunkSize;
+		}
+		return size;
+	}
+
+protected:
+	T &GetElement(std::size_t index) const
+	{
+		MPT_ASSERT(index < N);
+		T *chunk = m_chunks[index / chunkSize].load(std::memory_order_acquire);
+		if(!chunk)
+		{
+			chunk = AllocateChunk(index / chunkSize);
+		}
+		return chunk[index % chunkSize];
+	}
+
+	T *AllocateChunk(std::size_t c) const
+	{
+		T *newChunk = new T[chunkSize]{};
+		T *expected = nullptr;
+		if(!m_chunks[c].compare_exchange_strong(expected, newChunk, std::memory_order_acq_rel, std::memory_order_acquire))
+		{
+			// Another thread was faster
+			delete[] newChunk;
+			return expected;
+		}
+		return newChunk;
+	}
+
+	mutable std::array<std::atomic<T *>, numChunks> m_chunks = {};
+};
+
+
+OPENMPT_NAMESPACE_END
@@ -0,0 +1,257 @@
+/*
+ * DeferredSamples.cpp
+ * -------------------
+ * Purpose: Sample data that is only decoded once it is needed for playback.
+ * Notes  : Samples that are going to be played soon can be decoded on a background thread.
+ *          Alternatively, all samples can be decoded at once on a thread pool at the end of loading.
+ *          The background thread never touches the CSoundFile; it only decodes into private copies of the sample headers.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#include "stdafx.h"
+#include "DeferredSamples.h"
+
+#include "mpt/out_of_memory/out_of_memory.hpp"
+
+#include <algorithm>
+
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+DeferredSamples::~DeferredSamples()
+{
+#if MPT_THREADPOOL_THREADS
+	StopWorkerThread();
+#endif // MPT_THREADPOOL_THREADS
+	for(auto &[smp, entry] : m_samples)
+	{
+		if(entry.state == State::Done)
+			entry.sample.FreeSample();
+	}
+}
+
+
+FileReader DeferredSamples::PinFile(FileReader file, std::unique_ptr<std::vector<char>> fileData)
+{
+	MPT_ASSERT(m_samples.empty());
+	m_samples.clear();
+	m_pinnedFile = FileReader{};
+	m_pinnedFileView = FileReader::PinnedView{};
+	m_fileData = std::move(fileData);
+	file.Rewind();
+	// The view refers to the existing file data if it is in memory (this includes the cache of unseekable streams).
+	// Reading from a seekable file stream is not thread-safe, so in that case the view contains a copy of the file.
+	m_pinnedFileView = file.GetPinnedView();
+	m_pinnedFile = file;
+	FileReader::shared_filename_type filename;
+	if(const auto originalFilename = file.GetOptionalFileName(); originalFilename)
+		filename = std::make_shared<mpt::PathString>(*originalFilename);
+	return FileReader(m_pinnedFileView.span(), std::move(filename));
+}
+
+
+void DeferredSamples::Add(SAMPLEINDEX smp, const SampleIO &sampleIO, FileReader file)
+{
+	Remove(smp);
+#if MPT_THREADPOOL_THREADS
+	std::lock_guard<std::mutex> lock{m_mutex};
+#endif // MPT_THREADPOOL_THREADS
+	Entry &entry = m_samples[smp];
+	entry.file = std::move(file);
+	entry.sampleIO = sampleIO;
+}
+
+
+void DeferredSamples::Remove(SAMPLEINDEX smp)
+{
+#if MPT_THREADPOOL_THREADS
+	std::unique_lock<std::mutex> lock{m_mutex};
+	auto entry = m_samples.find(smp);
+	if(entry == m_samples.end())
+		return;
+	m_sampleDone.wait(lock, [&entry] { return entry->second.state != State::Decoding; });
+	m_queue.erase(std::remove(m_queue.begin(), m_queue.end(), smp), m_queue.end());
+#else
+	auto entry = m_samples.find(smp);
+	if(entry == m_samples.end())
+		return;
+#endif // MPT_THREADPOOL_THREADS
+	if(entry->second.state == State::Done)
+		entry->second.sample.FreeSample();
+	m_samples.erase(entry);
+}
+
+
+bool DeferredSamples::Contains(SAMPLEINDEX smp) const
+{
+#if MPT_THREADPOOL_THREADS
+	std::lock_guard<std::mutex> lock{m_mutex};
+#endif // MPT_THREADPOOL_THREADS
+	return m_samples.count(smp) != 0;
+}
+
+
+bool DeferredSamples::empty() const
+{
+#if MPT_THREADPOOL_THREADS
+	std::lock_guard<std::mutex> lock{m_mutex};
+#endif // MPT_THREADPOOL_THREADS
+	return m_samples.empty();
+}
+
+
+bool DeferredSamples::IsDecoded(SAMPLEINDEX smp) const
+{
+#if MPT_THREADPOOL_THREADS
+	std::lock_guard<std::mutex> lock{m_mutex};
+#endif // MPT_THREADPOOL_THREADS
+	const auto entry = m_samples.find(smp);
+	return entry != m_samples.end() && entry->second.state == State::Done;
+}
+
+
+bool DeferredSamples::Prefetch(SAMPLEINDEX smp, const ModSample &header)
+{
+#if MPT_THREADPOOL_THREADS
+	std::lock_guard<std::mutex> lock{m_mutex};
+	auto entry = m_samples.find(smp);
+	if(entry == m_samples.end() || entry->second.state != State::Pending)
+		return true;
+	entry->second.state = State::Queued;
+	entry->second.sample = header;
+	m_queue.push_back(smp);
+	if(!m_thread.joinable())
+		m_thread = std::thread(&DeferredSamples::WorkerThread, this);
+	m_wakeWorker.notify_one();
+	return true;
+#else
+	MPT_UNUSED(smp);
+	MPT_UNUSED(header);
+	return false;
+#endif // MPT_THREADPOOL_THREADS
+}
+
+
+ModSample DeferredSamples::Decode(SAMPLEINDEX smp, const ModSample &header)
+{
+#if MPT_THREADPOOL_THREADS
+	std::unique_lock<std::mutex> lock{m_mutex};
+	auto entry = m_samples.find(smp);
+	if(entry == m_samples.end())
+		return header;
+	m_sampleDone.wait(lock, [&entry] { return entry->second.state != State::Decoding; });
+	if(entry->second.state == State::Done)
+	{
+		ModSample sample = entry->second.sample;
+		m_samples.erase(entry);
+		return sample;
+	}
+	m_queue.erase(std::remove(m_queue.begin(), m_queue.end(), smp), m_queue.end());
+	const Entry pending = std::move(entry->second);
+	m_samples.erase(entry);
+	lock.unlock();
+	return DecodeSample(pending, header);
+#else
+	auto entry = m_samples.find(smp);
+	if(entry == m_samples.end())
+		return header;
+	const Entry pending = std::move(entry->second);
+	m_samples.erase(entry);
+	return DecodeSample(pending, header);
+#endif // MPT_THREADPOOL_THREADS
+}
+
+
+void DeferredSamples::DecodeAll(const ChunkedArray<ModSample, MAX_SAMPLES> &headers, ThreadPool *threadPool)
+{
+#if MPT_THREADPOOL_THREADS
+	StopWorkerThread();
+#endif // MPT_THREADPOOL_THREADS
+	std::vector<std::pair<Entry *, const ModSample *>> pending;
+	for(auto &[smp, entry] : m_samples)
+	{
+		if(entry.state != State::Done && smp < headers.size())
+			pending.emplace_back(&entry, &headers[smp]);
+	}
+	// Start with the biggest samples so that all threads finish at roughly the same time
+	std::stable_sort(pending.begin(), pending.end(), [](const auto &l, const auto &r) { return l.second->GetSampleSizeInBytes() > r.second->GetSampleSizeInBytes(); });
+	const auto decodeTask = [&pending](std::size_t task)
+	{
+		auto [entry, header] = pending[task];
+		entry->sample = DecodeSample(*entry, *header);
+		entry->state = State::Done;
+	};
+	if(threadPool)
+	{
+		threadPool->Run(pending.size(), decodeTask);
+	} else
+	{
+		for(std::size_t task = 0; task < pending.size(); task++)
+			decodeTask(task);
+	}
+}
+
+
+ModSample DeferredSamples::DecodeSample(const Entry &entry, const ModSample &header)
+{
+	ModSample sample = header;
+	sample.pData.pSample = nullptr;
+	FileReader file = entry.file;
+	try
+	{
+		entry.sampleIO.ReadSample(sample, file);
+	} catch(mpt::out_of_memory e)
+	{
+		mpt::delete_out_of_memory(e);
+		sample.FreeSample();
+	}
+	return sample;
+}
+
+
+#if MPT_THREADPOOL_THREADS
+
+void DeferredSamples::WorkerThread()
+{
+	std::unique_lock<std::mutex> lock{m_mutex};
+	while(true)
+	{
+		m_wakeWorker.wait(lock, [this] { return m_shutdown || !m_queue.empty(); });
+		if(m_shutdown)
+			return;
+		const SAMPLEINDEX smp = m_queue.front();
+		m_queue.pop_front();
+		auto entry = m_samples.find(smp);
+		if(entry == m_samples.end() || entry->second.state != State::Queued)
+			continue;
+		// The entry cannot be removed while we are decoding it
+		entry->second.state = State::Decoding;
+		lock.unlock();
+		ModSample sample = DecodeSample(entry->second, entry->second.sample);
+		lock.lock();
+		entry->second.sample = sample;
+		entry->second.state = State::Done;
+		m_sampleDone.notify_all();
+	}
+}
+
+
+void DeferredSamples::StopWorkerThread()
+{
+	if(!m_thread.joinable())
+		return;
+	{
+		std::lock_guard<std::mutex> lock{m_mutex};
+		m_shutdown = true;
+	}
+	m_wakeWorker.notify_one();
+	m_thread.join();
+}
+
+#endif // MPT_THREADPOOL_THREADS
+
+
+OPENMPT_NAMESPACE_END
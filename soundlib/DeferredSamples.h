@@ -0,0 +1,109 @@
+/*
+ * DeferredSamples.h
+ * -----------------
+ * Purpose: Sample data that is only decoded once it is needed for playback.
+ * Notes  : Samples that are going to be played soon can be decoded on a background thread.
+ *          Alternatively, all samples can be decoded at once on a thread pool at the end of loading.
+ *          The background thread never touches the CSoundFile; it only decodes into private copies of the sample headers.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#pragma once
+
+#include "openmpt/all/BuildSettings.hpp"
+
+#include "../common/FileReader.h"
+#include "../common/mptThreadPool.h"
+#include "ChunkedArray.h"
+#include "ModSample.h"
+#include "SampleIO.h"
+#include "Snd_defs.h"
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <vector>
+
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+class DeferredSamples
+{
+public:
+	DeferredSamples() = default;
+	~DeferredSamples();
+
+	DeferredSamples(const DeferredSamples &) = delete;
+	DeferredSamples &operator=(const DeferredSamples &) = delete;
+
+	// Keep a reference to the module file data, so that deferred samples can be decoded later and from several threads.
+	// Files that are already in memory are not copied, so that memory must stay valid for as long as there are deferred samples.
+	// Seekable streams cannot be read from several threads, so their contents are copied.
+	// If the file data is owned by the caller (e.g. an unpacked container), fileData must be the buffer that file refers to, and it is kept alive here.
+	// Returns a FileReader for the pinned data, which is what the loaders should read from.
+	FileReader PinFile(FileReader file, std::unique_ptr<std::vector<char>> fileData = nullptr);
+
+	// Remember where the sample data is stored. The FileReader must have been derived from PinFile().
+	void Add(SAMPLEINDEX smp, const SampleIO &sampleIO, FileReader file);
+	// Forget about a sample, e.g. because it is being replaced.
+	void Remove(SAMPLEINDEX smp);
+
+	bool Contains(SAMPLEINDEX smp) const;
+	bool empty() const;
+	// Returns true if the background thread has finished decoding the sample, i.e. Decode() will not have to wait or decode anything.
+	bool IsDecoded(SAMPLEINDEX smp) const;
+
+	// Start decoding the sample on the background thread, if it has not been decoded yet.
+	// header must contain the sample properties that were set up by the loader.
+	// Returns false if there is no background thread, i.e. the sample can only be decoded by calling Decode().
+	bool Prefetch(SAMPLEINDEX smp, const ModSample &header);
+	// Get the decoded sample: Waits for the background thread if it is currently decoding this sample, or decodes it right away if has not been started yet.
+	// Returns a copy of header with the sample data filled in. The caller takes ownership of the sample data.
+	// The sample is no longer deferred afterwards, even if decoding failed.
+	ModSample Decode(SAMPLEINDEX smp, const ModSample &header);
+	// Decode all samples that have not been decoded yet, using the thread pool if there is one.
+	// headers must contain the sample properties set up by the loader, indexed by sample number. Use Decode() to obtain the results.
+	void DecodeAll(const ChunkedArray<ModSample, MAX_SAMPLES> &headers, ThreadPool *threadPool);
+
+protected:
+	enum class State
+	{
+		Pending,
+		Queued,
+		Decoding,
+		Done,
+	};
+
+	struct Entry
+	{
+		FileReader file;
+		SampleIO sampleIO;
+		State state = State::Pending;
+		ModSample sample;  // Sample header while queued, decoded sample when done
+	};
+
+	static ModSample DecodeSample(const Entry &entry, const ModSample &header);
+
+	std::unique_ptr<std::vector<char>> m_fileData;
+	FileReader m_pinnedFile;
+	FileReader::PinnedView m_pinnedFileView;
+	std::map<SAMPLEINDEX, Entry> m_samples;
+
+#if MPT_THREADPOOL_THREADS
+	void WorkerThread();
+	void StopWorkerThread();
+
+	std::thread m_thread;
+	mutable std::mutex m_mutex;
+	std::condition_variable m_wakeWorker;
+	std::condition_variable m_sampleDone;
+	std::deque<SAMPLEINDEX> m_queue;
+	bool m_shutdown = false;
+#endif // MPT_THREADPOOL_THREADS
+};
+
+
+OPENMPT_NAMESPACE_END
@@ -1,3 +1,5 @@
+#include <cstdio>
+#include <cstdlib>
 /*
  * Fastmix.cpp
  * -----------
@@ -21,8 +23,10 @@
 #include "MixerLoops.h"
 #include "MixFuncTable.h"
 #include "plugins/PlugInterface.h"
+#include "../common/mptThreadPool.h"
 #include <cfloat>  // For FLT_EPSILON
 #include <algorithm>
+#include <array>
 
 
 OPENMPT_NAMESPACE_BEGIN
@@ -305,18 +309,67 @@ struct MixLoopState
 // Render count * number of channels samples
 void CSoundFile::CreateStereoMix(int count)
 {
-	mixsample_t *pOfsL, *pOfsR;
-
 	if(!count)
 		return;
 
 	// Resetting sound buffer
-	StereoFill(MixSoundBuffer, count, m_dryROfsVol, m_dryLOfsVol);
+	StereoFill(MixSoundBuffer.data(), count, m_dryROfsVol, m_dryLOfsVol);
 	if(m_MixerSettings.gnChannels > 2)
-		StereoFill(MixRearBuffer, count, m_surroundROfsVol, m_surroundLOfsVol);
+		StereoFill(MixRearBuffer.data(), count, m_surroundROfsVol, m_surroundLOfsVol);
+
+	CHANNELINDEX nchmixed = 0, nchskipped = 0;
+
+	if(m_mixThreadPool)
+	{
+		nchmixed = CreateStereoMixParallel(count, nchskipped);
+	} else
+	{
+		for(uint32 nChn = 0; nChn < m_nMixChannels; nChn++)
+		{
+			ModChannel &chn = m_PlayState.Chn[m_PlayState.ChnMix[nChn]];
+
+			if(!chn.pCurrentSample && !chn.nLOfs && !chn.nROfs)
+				continue;
+
+			const MixTarget target = GetMixTarget(m_PlayState.ChnMix[nChn], count);
+			const bool tooManyChannels = nchmixed >= m_MixerSettings.m_nMaxMixChannels;
+			if(tooManyChannels)
+				nchskipped++;
+			if(MixChannel(chn, target.buffer, *target.ofsR, *target.ofsL, count, tooManyChannels))
+			{
+				nchmixed++;
+#ifndef NO_PLUGINS
+				if(target.plugin)
+					m_MixPlugins[target.plugin - 1].pMixPlugin->ResetSilence();
+#endif // NO_PLUGINS
+			}
+		}
+	}
+	m_nMixStat = std::max(m_nMixStat, nchmixed);
+
+#ifndef NO_RENDER_STATS
+	if(m_collectRenderStats)
+	{
+		m_renderStats.mixedVoices += nchmixed;
+		m_renderStats.skippedVoices += nchskipped;
+		m_renderStats.skippedFrames += static_cast<uint64>(nchskipped) * count;
+		m_renderStats.maxMixedVoices = std::max(m_renderStats.maxMixedVoices, nchmixed);
+	}
+#endif // NO_RENDER_STATS
+}
 
-	CHANNELINDEX nchmixed = 0;
 
+// Mix all active voices using the mixer thread pool.
+// Every task mixes a fixed range of voices into its own private buffers, which are then summed up in task order.
+// With the fixed point mixer, the result is identical to mixing on a single thread.
+// With the floating point mixer, the result only depends on the number of threads, not on thread scheduling.
+// Returns the number of mixed voices. numSkipped receives the number of voices that were not mixed because of the voice limit.
+CHANNELINDEX CSoundFile::CreateStereoMixParallel(int count, CHANNELINDEX &numSkipped)
+{
+	// Determine the target buffers of all voices first, in the same order as the single-threaded mixer,
+	// as this also prepares the reverb and plugin input buffers.
+	m_mixTargets.clear();
+	m_mixVoices.clear();
 	for(uint32 nChn = 0; nChn < m_nMixChannels; nChn++)
 	{
 		ModChannel &chn = m_PlayState.Chn[m_PlayState.ChnMix[nChn]];
@@ -324,219 +377,583 @@ void CSoundFile::CreateStereoMix(int count)
 		if(!chn.pCurrentSample && !chn.nLOfs && !chn.nROfs)
 			continue;
 
-		pOfsR = &m_dryROfsVol;
-		pOfsL = &m_dryLOfsVol;
+		const MixTarget target = GetMixTarget(m_PlayState.ChnMix[nChn], count);
+		const auto existingTarget = std::find_if(m_mixTargets.begin(), m_mixTargets.end(), [&target](const MixTarget &other) { return other.buffer == target.buffer; });
+		const uint16 targetIndex = static_cast<uint16>(std::distance(m_mixTargets.begin(), existingTarget));
+		if(existingTarget == m_mixTargets.end())
+			m_mixTargets.push_back(target);
+		m_mixVoices.push_back({&chn, target.plugin, targetIndex, false});
+	}
 
-		uint32 functionNdx = MixFuncTable::ResamplingModeToMixFlags(static_cast<ResamplingMode>(chn.resamplingMode));
-		if(chn.dwFlags[CHN_16BIT]) functionNdx |= MixFuncTable::ndx16Bit;
-		if(chn.dwFlags[CHN_STEREO]) functionNdx |= MixFuncTable::ndxStereo;
-#ifndef NO_FILTER
-		if(chn.dwFlags[CHN_FILTER]) functionNdx |= MixFuncTable::ndxFilter;
+	// Splitting up a small number of voices is not worth the synchronization overhead.
+	// If there are more voices than we are allowed to mix, the outcome depends on the voice order, so mix them one after another.
+	constexpr std::size_t MinVoicesPerTask = 4;
+	const std::size_t numTasks = std::min(static_cast<std::size_t>(m_MixerSettings.NumMixThreads), m_mixVoices.size() / MinVoicesPerTask);
+	bool mixSingleThreaded = numTasks < 2 || m_mixVoices.size() > m_MixerSettings.m_nMaxMixChannels;
+#ifdef MODPLUG_TRACKER
+	// Sample play length detection is not thread-safe
+	mixSingleThreaded = mixSingleThreaded || (m_SamplePlayLengths != nullptr);
 #endif
+	CHANNELINDEX nchmixed = 0;
+	numSkipped = 0;
+	if(mixSingleThreaded)
+	{
+		for(auto &voice : m_mixVoices)
+		{
+			const MixTarget &target = m_mixTargets[voice.target];
+			const bool tooManyChannels = nchmixed >= m_MixerSettings.m_nMaxMixChannels;
+			if(tooManyChannels)
+				numSkipped++;
+			voice.mixed = MixChannel(*voice.chn, target.buffer, *target.ofsR, *target.ofsL, count, tooManyChannels);
+			if(voice.mixed)
+				nchmixed++;
+		}
+	} else
+	{
+		const std::size_t numTargets = m_mixTargets.size();
+		const std::size_t bufferSize = count * 2;
+		m_mixThreadBuffer.resize(numTasks * numTargets * bufferSize);
+		m_mixThreadOfs.resize(numTasks * numTargets * 2);
+		m_mixThreadTargetUsed.assign(numTasks * numTargets, 0);
 
-		mixsample_t *pbuffer = MixSoundBuffer;
-#ifndef NO_REVERB
-		if(((m_MixerSettings.DSPMask & SNDDSP_REVERB) && !chn.dwFlags[CHN_NOREVERB]) || chn.dwFlags[CHN_REVERB])
+		m_mixThreadPool->Run(numTasks, [this, numTasks, numTargets, bufferSize, count](std::size_t task)
 		{
-			m_Reverb.TouchReverbSendBuffer(ReverbSendBuffer, m_RvbROfsVol, m_RvbLOfsVol, count);
-			pbuffer = ReverbSendBuffer;
-			pOfsR = &m_RvbROfsVol;
-			pOfsL = &m_RvbLOfsVol;
+			const std::size_t firstVoice = m_mixVoices.size() * task / numTasks, lastVoice = m_mixVoices.size() * (task + 1) / numTasks;
+			for(std::size_t v = firstVoice; v < lastVoice; v++)
+			{
+				MixVoice &voice = m_mixVoices[v];
+				const std::size_t slot = task * numTargets + voice.target;
+				mixsample_t *buffer = m_mixThreadBuffer.data() + slot * bufferSize;
+				mixsample_t *ofs = m_mixThreadOfs.data() + slot * 2;
+				if(!m_mixThreadTargetUsed[slot])
+				{
+					std::fill(buffer, buffer + bufferSize, mixsample_t(0));
+					ofs[0] = ofs[1] = 0;
+					m_mixThreadTargetUsed[slot] = 1;
+				}
+				// We never get here with more voices than allowed
+				voice.mixed = MixChannel(*voice.chn, buffer, ofs[0], ofs[1], count, false);
+			}
+		});
+
+		for(std::size_t t = 0; t < numTargets; t++)
+		{
+			const MixTarget &target = m_mixTargets[t];
+			for(std::size_t task = 0; task < numTasks; task++)
+			{
+				const std::size_t slot = task * numTargets + t;
+				if(!m_mixThreadTargetUsed[slot])
+					continue;
+				const mixsample_t *buffer = m_mixThreadBuffer.data() + slot * bufferSize;
+				for(std::size_t i = 0; i < bufferSize; i++)
+				{
+					target.buffer[i] += buffer[i];
+				}
+				*target.ofsR += m_mixThreadOfs[slot * 2];
+				*target.ofsL += m_mixThreadOfs[slot * 2 + 1];
+			}
 		}
-#endif
-		if(chn.dwFlags[CHN_SURROUND] && m_MixerSettings.gnChannels > 2)
+		for(const auto &voice : m_mixVoices)
 		{
-			pbuffer = MixRearBuffer;
-			pOfsR = &m_surroundROfsVol;
-			pOfsL = &m_surroundLOfsVol;
+			if(voice.mixed)
+				nchmixed++;
 		}
+	}
 
-		//Look for plugins associated with this implicit tracker channel.
 #ifndef NO_PLUGINS
-		PLUGINDEX nMixPlugin = GetBestPlugin(m_PlayState, m_PlayState.ChnMix[nChn], PrioritiseInstrument, RespectMutes);
+	for(const auto &voice : m_mixVoices)
+	{
+		if(voice.mixed && voice.plugin)
+			m_MixPlugins[voice.plugin - 1].pMixPlugin->ResetSilence();
+	}
+#endif // NO_PLUGINS
+	return nchmixed;
+}
 
-		if ((nMixPlugin > 0) && (nMixPlugin <= MAX_MIXPLUGINS) && m_MixPlugins[nMixPlugin - 1].pMixPlugin != nullptr)
+
+// Find the buffer that a voice should be mixed into and the plugin it is routed to, and prepare the buffer if necessary
+CSoundFile::MixTarget CSoundFile::GetMixTarget(CHANNELINDEX nChn, int count)
+{
+	const ModChannel &chn = m_PlayState.Chn[nChn];
+	mixsample_t *pOfsL, *pOfsR;
+	PLUGINDEX plugin = 0;
+
+	pOfsR = &m_dryROfsVol;
+	pOfsL = &m_dryLOfsVol;
+
+	mixsample_t *pbuffer = MixSoundBuffer.data();
+#ifndef NO_REVERB
+	if(((m_MixerSettings.DSPMask & SNDDSP_REVERB) && !chn.dwFlags[CHN_NOREVERB]) || chn.dwFlags[CHN_REVERB])
+	{
+		m_Reverb.TouchReverbSendBuffer(ReverbSendBuffer.data(), m_RvbROfsVol, m_RvbLOfsVol, count);
+		pbuffer = ReverbSendBuffer.data();
+		pOfsR = &m_RvbROfsVol;
+		pOfsL = &m_RvbLOfsVol;
+	}
+#endif
+	if(chn.dwFlags[CHN_SURROUND] && m_MixerSettings.gnChannels > 2)
+	{
+		pbuffer = MixRearBuffer.data();
+		pOfsR = &m_surroundROfsVol;
+		pOfsL = &m_surroundLOfsVol;
+	}
+
+	//Look for plugins associated with this implicit tracker channel.
+#ifndef NO_PLUGINS
+	PLUGINDEX nMixPlugin = GetBestPlugin(m_PlayState, nChn, PrioritiseInstrument, RespectMutes);
+
+	if ((nMixPlugin > 0) && (nMixPlugin <= MAX_MIXPLUGINS) && m_MixPlugins[nMixPlugin - 1].pMixPlugin != nullptr)
+	{
+		plugin = nMixPlugin;
+		// Render into plugin buffer instead of global buffer
+		SNDMIXPLUGINSTATE &mixState = m_MixPlugins[nMixPlugin - 1].pMixPlugin->m_MixState;
+		if (mixState.pMixBuffer)
 		{
-			// Render into plugin buffer instead of global buffer
-			SNDMIXPLUGINSTATE &mixState = m_MixPlugins[nMixPlugin - 1].pMixPlugin->m_MixState;
-			if (mixState.pMixBuffer)
+			pbuffer = mixState.pMixBuffer;
+			pOfsR = &mixState.nVolDecayR;
+			pOfsL = &mixState.nVolDecayL;
+			if (!(mixState.dwFlags & SNDMIXPLUGINSTATE::psfMixReady))
 			{
-				pbuffer = mixState.pMixBuffer;
-				pOfsR = &mixState.nVolDecayR;
-				pOfsL = &mixState.nVolDecayL;
-				if (!(mixState.dwFlags & SNDMIXPLUGINSTATE::psfMixReady))
-				{
-					StereoFill(pbuffer, count, *pOfsR, *pOfsL);
-					mixState.dwFlags |= SNDMIXPLUGINSTATE::psfMixReady;
-				}
+				StereoFill(pbuffer, count, *pOfsR, *pOfsL);
+				mixState.dwFlags |= SNDMIXPLUGINSTATE::psfMixReady;
 			}
 		}
+	}
 #endif // NO_PLUGINS
+	return {pbuffer, pOfsR, pOfsL, plugin};
+}
 
-		if(chn.isPaused)
+
+// Mix a single voice into the given buffer. Returns true if the voice was actually mixed.
+bool CSoundFile::MixChannel(ModChannel &chn, mixsample_t *pbuffer, mixsample_t &ofsR, mixsample_t &ofsL, int count, bool tooManyChannels) const
+{
+	const MixFuncInterface *mixFunctions = MixFuncTable::GetFunctions();
+	uint32 functionNdx = MixFuncTable::ResamplingModeToMixFlags(static_cast<ResamplingMode>(chn.resamplingMode));
+	if(chn.dwFlags[CHN_16BIT]) functionNdx |= MixFuncTable::ndx16Bit;
+	if(chn.dwFlags[CHN_STEREO]) functionNdx |= MixFuncTable::ndxStereo;
+#ifndef NO_FILTER
+	if(chn.dwFlags[CHN_FILTER]) functionNdx |= MixFuncTable::ndxFilter;
+#endif
+
+	if(chn.isPaused)
+	{
+		EndChannelOfs(chn, pbuffer, count);
+		ofsR += chn.nROfs;
+		ofsL += chn.nLOfs;
+		chn.nROfs = chn.nLOfs = 0;
+		return false;
+	}
+
+	MixLoopState mixLoopState(*this, chn);
+
+	////////////////////////////////////////////////////
+	bool naddmix = false;
+	int nsamples = count;
+	// Keep mixing this sample until the buffer is filled.
+	do
+	{
+		uint32 nrampsamples = nsamples;
+		int32 nSmpCount;
+		if(chn.nRampLength > 0)
 		{
-			EndChannelOfs(chn, pbuffer, count);
-			*pOfsR += chn.nROfs;
-			*pOfsL += chn.nLOfs;
-			chn.nROfs = chn.nLOfs = 0;
-			continue;
+			if (nrampsamples > chn.nRampLength) nrampsamples = chn.nRampLength;
 		}
 
-		MixLoopState mixLoopState(*this, chn);
+		if((nSmpCount = mixLoopState.GetSampleCount(chn, nrampsamples)) <= 0)
+		{
+			// Stopping the channel
+			chn.pCurrentSample = nullptr;
+			chn.nLength = 0;
+			chn.position.Set(0);
+			chn.nRampLength = 0;
+			EndChannelOfs(chn, pbuffer, nsamples);
+			ofsR += chn.nROfs;
+			ofsL += chn.nLOfs;
+			chn.nROfs = chn.nLOfs = 0;
+			chn.dwFlags.reset(CHN_PINGPONGFLAG);
+			break;
+		}
 
-		////////////////////////////////////////////////////
-		CHANNELINDEX naddmix = 0;
-		int nsamples = count;
-		// Keep mixing this sample until the buffer is filled.
-		do
+		// Should we mix this channel ?
+		if(tooManyChannels													// Too many channels
+			|| (!chn.nRampLength && !(chn.leftVol | chn.rightVol)))		// Channel is completely silent
 		{
-			uint32 nrampsamples = nsamples;
-			int32 nSmpCount;
-			if(chn.nRampLength > 0)
+			chn.position += chn.increment * nSmpCount;
+			chn.nROfs = chn.nLOfs = 0;
+			pbuffer += nSmpCount * 2;
+			naddmix = false;
+		}
+#ifdef MODPLUG_TRACKER
+		else if(m_SamplePlayLengths != nullptr)
+		{
+			// Detecting the longest play time for each sample for optimization
+			SmpLength pos = chn.position.GetUInt();
+			chn.position += chn.increment * nSmpCount;
+			if(!chn.increment.IsNegative())
 			{
-				if (nrampsamples > chn.nRampLength) nrampsamples = chn.nRampLength;
+				pos = chn.position.GetUInt();
 			}
-
-			if((nSmpCount = mixLoopState.GetSampleCount(chn, nrampsamples)) <= 0)
+			const SAMPLEINDEX smp = GetSampleIndex(chn.pModSample);
+			if(smp < m_SamplePlayLengths->size())
 			{
-				// Stopping the channel
-				chn.pCurrentSample = nullptr;
-				chn.nLength = 0;
-				chn.position.Set(0);
-				chn.nRampLength = 0;
-				EndChannelOfs(chn, pbuffer, nsamples);
-				*pOfsR += chn.nROfs;
-				*pOfsL += chn.nLOfs;
-				chn.nROfs = chn.nLOfs = 0;
-				chn.dwFlags.reset(CHN_PINGPONGFLAG);
-				break;
+				(*m_SamplePlayLengths)[smp] = std::max((*m_SamplePlayLengths)[smp], pos);
 			}
+		}
+#endif
+		else
+		{
+			// Do mixing
+			mixsample_t *pbufmax = pbuffer + (nSmpCount * 2);
+			chn.nROfs = -*(pbufmax - 2);
+			chn.nLOfs = -*(pbufmax - 1);
+
+#ifdef MPT_BUILD_DEBUG
+			SamplePosition targetpos = chn.position + chn.increment * nSmpCount;
+#endif
+			mixFunctions[functionNdx | (chn.nRampLength ? MixFuncTable::ndxRamp : 0)](chn, m_Resampler, pbuffer, nSmpCount);
+#ifdef MPT_BUILD_DEBUG
+			MPT_ASSERT(chn.position.GetUInt() == targetpos.GetUInt());
+#endif
 
-			// Should we mix this channel ?
-			if((nchmixed >= m_MixerSettings.m_nMaxMixChannels)				// Too many channels
-				|| (!chn.nRampLength && !(chn.leftVol | chn.rightVol)))		// Channel is completely silent
+			chn.nROfs += *(pbufmax - 2);
+			chn.nLOfs += *(pbufmax - 1);
+			pbuffer = pbufmax;
+			naddmix = true;
+		}
+
+		nsamples -= nSmpCount;
+		if (chn.nRampLength)
+		{
+			if (chn.nRampLength <= static_cast<uint32>(nSmpCount))
+			{
+				// Ramping is done
+				chn.nRampLength = 0;
+				chn.leftVol = chn.newLeftVol;
+				chn.rightVol = chn.newRightVol;
+				chn.rightRamp = chn.leftRamp = 0;
+				if(chn.dwFlags[CHN_NOTEFADE] && !chn.nFadeOutVol)
+				{
+					chn.nLength = 0;
+					chn.pCurrentSample = nullptr;
+				}
+			} else
 			{
-				chn.position += chn.increment * nSmpCount;
-				chn.nROfs = chn.nLOfs = 0;
-				pbuffer += nSmpCount * 2;
-				naddmix = 0;
+				chn.nRampLength -= nSmpCount;
 			}
+		}
+
+		const bool pastLoopEnd = chn.position.GetUInt() >= chn.nLoopEnd && chn.dwFlags[CHN_LOOP];
+		const bool pastSampleEnd = chn.position.GetUInt() >= chn.nLength && !chn.dwFlags[CHN_LOOP] && chn.nLength && !chn.nMasterChn;
+		const bool doSampleSwap = m_playBehaviour[kMODSampleSwap] && chn.nNewIns && chn.nNewIns <= GetNumSamples() && chn.pModSample != &Samples[chn.nNewIns];
+		if(getenv("DBGMIX") && (&chn - m_PlayState.Chn != 1) && (&chn - m_PlayState.Chn != 2) && (&chn - m_PlayState.Chn != 3)) fprintf(stderr, "pass c=%d t=%d pos=%u n=%d len=%u lend=%u lstart=%u loop=%d ramp=%u swap=%d newins=%d\n", (int)(&chn - m_PlayState.Chn), (int)m_PlayState.m_nBufferCount, chn.position.GetUInt(), nSmpCount, chn.nLength, chn.nLoopEnd, chn.nLoopStart, (int)chn.dwFlags[CHN_LOOP], chn.nRampLength, (int)doSampleSwap, (int)chn.nNewIns);
+		if((pastLoopEnd || pastSampleEnd) && doSampleSwap)
+		{
+			// ProTracker compatibility: Instrument changes without a note do not happen instantly, but rather when the sample loop has finished playing.
+			// Test case: PTInstrSwap.mod, PTSwapNoLoop.mod
 #ifdef MODPLUG_TRACKER
-			else if(m_SamplePlayLengths != nullptr)
+			if(m_SamplePlayLengths != nullptr)
 			{
-				// Detecting the longest play time for each sample for optimization
-				SmpLength pos = chn.position.GetUInt();
-				chn.position += chn.increment * nSmpCount;
-				if(!chn.increment.IsNegative())
-				{
-					pos = chn.position.GetUInt();
-				}
-				size_t smp = std::distance(static_cast<const ModSample*>(static_cast<std::decay<decltype(Samples)>::type>(Samples)), chn.pModSample);
+				// Even if the sample was playing at zero volume, we need to retain its full length for correct sample swap timing
+				const SAMPLEINDEX smp = GetSampleIndex(chn.pModSample);
 				if(smp < m_SamplePlayLengths->size())
 				{
-					(*m_SamplePlayLengths)[smp] = std::max((*m_SamplePlayLengths)[smp], pos);
+					(*m_SamplePlayLengths)[smp] = std::max((*m_SamplePlayLengths)[smp], std::min(chn.nLength, chn.position.GetUInt()));
 				}
 			}
 #endif
-			else
+			const ModSample &smp = Samples[chn.nNewIns];
+			chn.pModSample = &smp;
+			chn.pCurrentSample = smp.samplev();
+			chn.dwFlags = (chn.dwFlags & CHN_CHANNELFLAGS) | smp.uFlags;
+			chn.nLength = smp.uFlags[CHN_LOOP] ? smp.nLoopEnd : 0; // non-looping sample continue in oneshot mode (i.e. they will most probably just play silence)
+			chn.nLoopStart = smp.nLoopStart;
+			chn.nLoopEnd = smp.nLoopEnd;
+			chn.position.SetInt(chn.nLoopStart);
+			mixLoopState.UpdateLookaheadPointers(chn);
+			if(!chn.pCurrentSample)
 			{
-				// Do mixing
-				mixsample_t *pbufmax = pbuffer + (nSmpCount * 2);
-				chn.nROfs = -*(pbufmax - 2);
-				chn.nLOfs = -*(pbufmax - 1);
+				break;
+			}
+		} else if(pastLoopEnd && !doSampleSwap && m_playBehaviour[kMODOneShotLoops] && chn.nLoopStart == 0)
+		{
+			// ProTracker "oneshot" loops (if loop start is 0, play the whole sample once and then repeat until loop end)
+			chn.position.SetInt(0);
+			chn.nLoopEnd = chn.nLength = chn.pModSample->nLoopEnd;
+		}
+	} while(nsamples > 0);
 
-#ifdef MPT_BUILD_DEBUG
-				SamplePosition targetpos = chn.position + chn.increment * nSmpCount;
-#endif
-				MixFuncTable::Functions[functionNdx | (chn.nRampLength ? MixFuncTable::ndxRamp : 0)](chn, m_Resampler, pbuffer, nSmpCount);
-#ifdef MPT_BUILD_DEBUG
-				MPT_ASSERT(chn.position.GetUInt() == targetpos.GetUInt());
-#endif
+	// Restore sample pointer in case it got changed through loop wrap-around
+	chn.pCurrentSample = mixLoopState.samplePointer;
+	return naddmix;
+}
 
-				chn.nROfs += *(pbufmax - 2);
-				chn.nLOfs += *(pbufmax - 1);
-				pbuffer = pbufmax;
-				naddmix = 1;
+
+#ifndef NO_PLUGINS
+
+// Check if the plugin routing has changed since the plugin schedule was compiled.
+bool CSoundFile::IsPluginScheduleValid() const
+{
+	if(m_pluginScheduleDirty)
+		return false;
+	for(const auto &entry : m_pluginSchedule)
+	{
+		const SNDMIXPLUGIN &plugin = m_MixPlugins[entry.slot];
+		if(plugin.pMixPlugin != entry.plugin || plugin.Info.dwOutputRouting != entry.outputRouting || plugin.IsMasterEffect() != entry.masterEffect)
+			return false;
+	}
+	return true;
+}
+
+
+// Compile the plugin routing into the list of plugins that need to be processed (in slot order, which is also their topological order,
+// as plugins can only be routed into plugins in higher slots), and find plugin chains that do not depend on any other plugins.
+// Such a chain consists of all plugins that end up being routed into the same plugin, which in turn is routed to the master mix.
+// All plugins of a chain except for that last plugin can be processed independently from other chains.
+// Chains containing master effects are not independent, as they are processed in the middle of the master mix.
+void CSoundFile::UpdatePluginSchedule()
+{
+	m_pluginSchedule.clear();
+	m_pluginChainEntries.clear();
+	m_pluginChainStart.clear();
+	m_pluginScheduleDirty = false;
+
+	std::array<bool, MAX_MIXPLUGINS> hasPluginInput{};
+	for(PLUGINDEX plug = 0; plug < MAX_MIXPLUGINS; plug++)
+	{
+		const SNDMIXPLUGIN &plugin = m_MixPlugins[plug];
+		const PLUGINDEX output = plugin.GetOutputPlugin();
+		if(output > plug && output < MAX_MIXPLUGINS)
+			hasPluginInput[output] = true;
+		// Slots without a plugin can still count as an input for other plugins
+		if(plugin.pMixPlugin != nullptr || output < MAX_MIXPLUGINS)
+			m_pluginSchedule.push_back({plugin.pMixPlugin, plugin.Info.dwOutputRouting, plug, plugin.IsMasterEffect(), hasPluginInput[plug], false});
+	}
+
+	const auto IsProcessed = [this](PLUGINDEX plug)
+	{
+		const IMixPlugin *mixPlug = m_MixPlugins[plug].pMixPlugin;
+		return mixPlug != nullptr && mixPlug->m_MixState.pMixBuffer != nullptr && mixPlug->m_mixBuffer.Ok();
+	};
+
+	// Master effects wake up all plugins they are routed into, so those cannot be part of an independent chain.
+	std::array<bool, MAX_MIXPLUGINS> afterMasterEffect{};
+	for(const auto &entry : m_pluginSchedule)
+	{
+		const PLUGINDEX output = m_MixPlugins[entry.slot].GetOutputPlugin();
+		if(entry.masterEffect)
+			afterMasterEffect[entry.slot] = true;
+		if(afterMasterEffect[entry.slot] && output > entry.slot && output < MAX_MIXPLUGINS)
+			afterMasterEffect[output] = true;
+	}
+
+	// Find the last plugin of each plugin's chain. Plugins are routed into higher slots, so go backwards.
+	std::array<PLUGINDEX, MAX_MIXPLUGINS> chainEnd;
+	std::array<bool, MAX_MIXPLUGINS> chainIsIndependent;
+	for(auto entry = m_pluginSchedule.rbegin(); entry != m_pluginSchedule.rend(); entry++)
+	{
+		const PLUGINDEX plug = entry->slot;
+		chainEnd[plug] = plug;
+		chainIsIndependent[plug] = true;
+		if(!IsProcessed(plug))
+			continue;
+		const SNDMIXPLUGIN &plugin = m_MixPlugins[plug];
+		const PLUGINDEX output = plugin.GetOutputPlugin();
+		if(!plugin.IsOutputToMaster() && output > plug && output < MAX_MIXPLUGINS && IsProcessed(output))
+			chainEnd[plug] = chainEnd[output];
+		if(afterMasterEffect[plug])
+			chainIsIndependent[chainEnd[plug]] = false;
+	}
+
+	for(const auto &last : m_pluginSchedule)
+	{
+		if(chainEnd[last.slot] != last.slot || !chainIsIndependent[last.slot] || !IsProcessed(last.slot))
+			continue;
+		const std::size_t chainStart = m_pluginChainEntries.size();
+		for(std::size_t i = 0; i < m_pluginSchedule.size() && m_pluginSchedule[i].slot < last.slot; i++)
+		{
+			if(chainEnd[m_pluginSchedule[i].slot] == last.slot && IsProcessed(m_pluginSchedule[i].slot))
+			{
+				m_pluginSchedule[i].inParallelChain = true;
+				m_pluginChainEntries.push_back(static_cast<uint16>(i));
+			}
+		}
+		if(m_pluginChainEntries.size() > chainStart)
+			m_pluginChainStart.push_back(static_cast<uint16>(chainStart));
+	}
+	if(!m_pluginChainStart.empty())
+		m_pluginChainStart.push_back(static_cast<uint16>(m_pluginChainEntries.size()));
+}
+
+
+// Process all independent plugin chains using the mixer thread pool.
+// The result is identical to processing them on a single thread, as every plugin only writes to buffers of its own chain.
+void CSoundFile::ProcessPluginChains(uint32 nCount, bool positionChanged)
+{
+	const std::size_t numChains = m_pluginChainStart.size() - 1;
+	m_mixThreadPool->Run(numChains, [this, nCount, positionChanged](std::size_t chain)
+	{
+		// The master mix is never touched by plugins in independent chains
+		float *pMixL = MixFloatBuffer[0].data();
+		float *pMixR = MixFloatBuffer[1].data();
+		for(std::size_t i = m_pluginChainStart[chain]; i < m_pluginChainStart[chain + 1]; i++)
+		{
+			ProcessPlugin(m_pluginSchedule[m_pluginChainEntries[i]], pMixL, pMixR, nCount, false, positionChanged);
+		}
+	});
+}
+
+
+// Process a single plugin. pMixL / pMixR point to the current master mix buffer and are updated by master effects.
+void CSoundFile::ProcessPlugin(const PluginScheduleEntry &entry, float *&pMixL, float *&pMixR, uint32 nCount, bool masterHasInput, bool positionChanged)
+{
+	const PLUGINDEX plug = entry.slot;
+	SNDMIXPLUGIN &plugin = m_MixPlugins[plug];
+	if(plugin.pMixPlugin == nullptr
+		|| plugin.pMixPlugin->m_MixState.pMixBuffer == nullptr
+		|| !plugin.pMixPlugin->m_mixBuffer.Ok())
+	{
+		return;
+	}
+
+	IMixPlugin *pObject = plugin.pMixPlugin;
+	if(!plugin.IsMasterEffect() && !plugin.pMixPlugin->ShouldProcessSilence() && !(plugin.pMixPlugin->m_MixState.dwFlags & SNDMIXPLUGINSTATE::psfHasInput))
+	{
+		// If plugin has no inputs and isn't a master plugin, we shouldn't let it process silence if possible.
+		// I have yet to encounter a VST plugin which actually sets this flag.
+		if(!entry.hasPluginInput)
+		{
+			return;
+		}
+	}
+
+	bool isMasterMix = false;
+	float *plugInputL = pObject->m_mixBuffer.GetInputBuffer(0);
+	float *plugInputR = pObject->m_mixBuffer.GetInputBuffer(1);
+
+	if (pMixL == plugInputL)
+	{
+		isMasterMix = true;
+		pMixL = MixFloatBuffer[0].data();
+		pMixR = MixFloatBuffer[1].data();
+	}
+	SNDMIXPLUGINSTATE &state = plugin.pMixPlugin->m_MixState;
+	float *pOutL = pMixL;
+	float *pOutR = pMixR;
+
+	if (!plugin.IsOutputToMaster())
+	{
+		PLUGINDEX nOutput = plugin.GetOutputPlugin();
+		if(nOutput > plug && nOutput < MAX_MIXPLUGINS
+			&& m_MixPlugins[nOutput].pMixPlugin != nullptr)
+		{
+			IMixPlugin *outPlugin = m_MixPlugins[nOutput].pMixPlugin;
+			if(!(state.dwFlags & SNDMIXPLUGINSTATE::psfSilenceBypass)) outPlugin->ResetSilence();
+
+			if(outPlugin->m_mixBuffer.Ok())
+			{
+				pOutL = outPlugin->m_mixBuffer.GetInputBuffer(0);
+				pOutR = outPlugin->m_mixBuffer.GetInputBuffer(1);
 			}
+		}
+	}
+
+	/*
+	if (plugin.multiRouting) {
+		int nOutput=0;
+		for (int nOutput=0; nOutput < plugin.nOutputs / 2; nOutput++) {
+			destinationPlug = plugin.multiRoutingDestinations[nOutput];
+			pOutState = m_MixPlugins[destinationPlug].pMixState;
+			pOutputs[2 * nOutput] = plugInputL;
+			pOutputs[2 * (nOutput + 1)] = plugInputR;
+		}
+
+	}*/
 
-			nsamples -= nSmpCount;
-			if (chn.nRampLength)
+	if (plugin.IsMasterEffect())
+	{
+		if (!isMasterMix)
+		{
+			float *pInL = plugInputL;
+			float *pInR = plugInputR;
+			for (uint32 i=0; i<nCount; i++)
 			{
-				if (chn.nRampLength <= static_cast<uint32>(nSmpCount))
-				{
-					// Ramping is done
-					chn.nRampLength = 0;
-					chn.leftVol = chn.newLeftVol;
-					chn.rightVol = chn.newRightVol;
-					chn.rightRamp = chn.leftRamp = 0;
-					if(chn.dwFlags[CHN_NOTEFADE] && !chn.nFadeOutVol)
-					{
-						chn.nLength = 0;
-						chn.pCurrentSample = nullptr;
-					}
-				} else
-				{
-					chn.nRampLength -= nSmpCount;
-				}
+				pInL[i] += pMixL[i];
+				pInR[i] += pMixR[i];
+				pMixL[i] = 0;
+				pMixR[i] = 0;
 			}
+		}
+		pMixL = pOutL;
+		pMixR = pOutR;
 
-			const bool pastLoopEnd = chn.position.GetUInt() >= chn.nLoopEnd && chn.dwFlags[CHN_LOOP];
-			const bool pastSampleEnd = chn.position.GetUInt() >= chn.nLength && !chn.dwFlags[CHN_LOOP] && chn.nLength && !chn.nMasterChn;
-			const bool doSampleSwap = m_playBehaviour[kMODSampleSwap] && chn.nNewIns && chn.nNewIns <= GetNumSamples() && chn.pModSample != &Samples[chn.nNewIns];
-			if((pastLoopEnd || pastSampleEnd) && doSampleSwap)
+		if(masterHasInput)
+		{
+			// Samples or plugins are being rendered, so turn off auto-bypass for this master effect.
+			if(plugin.pMixPlugin != nullptr) plugin.pMixPlugin->ResetSilence();
+			SNDMIXPLUGIN *chain = &plugin;
+			PLUGINDEX out = chain->GetOutputPlugin(), prevOut = plug;
+			while(out > prevOut && out < MAX_MIXPLUGINS)
 			{
-				// ProTracker compatibility: Instrument changes without a note do not happen instantly, but rather when the sample loop has finished playing.
-				// Test case: PTInstrSwap.mod, PTSwapNoLoop.mod
-#ifdef MODPLUG_TRACKER
-				if(m_SamplePlayLengths != nullptr)
+				chain = &m_MixPlugins[out];
+				prevOut = out;
+				out = chain->GetOutputPlugin();
+				if(chain->pMixPlugin)
 				{
-					// Even if the sample was playing at zero volume, we need to retain its full length for correct sample swap timing
-					size_t smp = std::distance(static_cast<const ModSample *>(static_cast<std::decay<decltype(Samples)>::type>(Samples)), chn.pModSample);
-					if(smp < m_SamplePlayLengths->size())
-					{
-						(*m_SamplePlayLengths)[smp] = std::max((*m_SamplePlayLengths)[smp], std::min(chn.nLength, chn.position.GetUInt()));
-					}
+					chain->pMixPlugin->ResetSilence();
 				}
-#endif
-				const ModSample &smp = Samples[chn.nNewIns];
-				chn.pModSample = &smp;
-				chn.pCurrentSample = smp.samplev();
-				chn.dwFlags = (chn.dwFlags & CHN_CHANNELFLAGS) | smp.uFlags;
-				chn.nLength = smp.uFlags[CHN_LOOP] ? smp.nLoopEnd : 0; // non-looping sample continue in oneshot mode (i.e. they will most probably just play silence)
-				chn.nLoopStart = smp.nLoopStart;
-				chn.nLoopEnd = smp.nLoopEnd;
-				chn.position.SetInt(chn.nLoopStart);
-				mixLoopState.UpdateLookaheadPointers(chn);
-				if(!chn.pCurrentSample)
+			}
+		}
+	}
+
+	if(plugin.IsBypassed() || (plugin.IsAutoSuspendable() && (state.dwFlags & SNDMIXPLUGINSTATE::psfSilenceBypass)))
+	{
+		const float * const pInL = plugInputL;
+		const float * const pInR = plugInputR;
+		for (uint32 i=0; i<nCount; i++)
+		{
+			pOutL[i] += pInL[i];
+			pOutR[i] += pInR[i];
+		}
+	} else
+	{
+		if(positionChanged)
+			pObject->PositionChanged();
+		pObject->Process(pOutL, pOutR, nCount);
+
+		state.inputSilenceCount += nCount;
+		if(plugin.IsAutoSuspendable() && pObject->GetNumOutputChannels() > 0 && state.inputSilenceCount >= m_MixerSettings.gdwMixingFreq * 4)
+		{
+			bool isSilent = true;
+			for(uint32 i = 0; i < nCount; i++)
+			{
+				if(pOutL[i] >= FLT_EPSILON || pOutL[i] <= -FLT_EPSILON
+					|| pOutR[i] >= FLT_EPSILON || pOutR[i] <= -FLT_EPSILON)
 				{
+					isSilent = false;
 					break;
 				}
-			} else if(pastLoopEnd && !doSampleSwap && m_playBehaviour[kMODOneShotLoops] && chn.nLoopStart == 0)
+			}
+			if(isSilent)
 			{
-				// ProTracker "oneshot" loops (if loop start is 0, play the whole sample once and then repeat until loop end)
-				chn.position.SetInt(0);
-				chn.nLoopEnd = chn.nLength = chn.pModSample->nLoopEnd;
+				state.dwFlags |= SNDMIXPLUGINSTATE::psfSilenceBypass;
+			} else
+			{
+				state.inputSilenceCount = 0;
 			}
-		} while(nsamples > 0);
-
-		// Restore sample pointer in case it got changed through loop wrap-around
-		chn.pCurrentSample = mixLoopState.samplePointer;
-		nchmixed += naddmix;
-	
-#ifndef NO_PLUGINS
-		if(naddmix && nMixPlugin > 0 && nMixPlugin <= MAX_MIXPLUGINS && m_MixPlugins[nMixPlugin - 1].pMixPlugin)
-		{
-			m_MixPlugins[nMixPlugin - 1].pMixPlugin->ResetSilence();
 		}
-#endif // NO_PLUGINS
 	}
-	m_nMixStat = std::max(m_nMixStat, nchmixed);
+	state.dwFlags &= ~SNDMIXPLUGINSTATE::psfHasInput;
 }
 
+#endif // NO_PLUGINS
+
 
 void CSoundFile::ProcessPlugins(uint32 nCount)
 {
 #ifndef NO_PLUGINS
+	if(!IsPluginScheduleValid())
+		UpdatePluginSchedule();
+
 	// If any sample channels are active or any plugin has some input, possibly suspended master plugins need to be woken up.
 	bool masterHasInput = (m_nMixStat > 0);
 
@@ -546,9 +963,9 @@ void CSoundFile::ProcessPlugins(uint32 nCount)
 #endif // MPT_INTMIXER
 
 	// Setup float inputs from samples
-	for(PLUGINDEX plug = 0; plug < MAX_MIXPLUGINS; plug++)
+	for(const auto &entry : m_pluginSchedule)
 	{
-		SNDMIXPLUGIN &plugin = m_MixPlugins[plug];
+		SNDMIXPLUGIN &plugin = m_MixPlugins[entry.slot];
 		if(plugin.pMixPlugin != nullptr
 			&& plugin.pMixPlugin->m_MixState.pMixBuffer != nullptr
 			&& plugin.pMixPlugin->m_mixBuffer.Ok())
@@ -599,166 +1016,34 @@ void CSoundFile::ProcessPlugins(uint32 nCount)
 	}
 	// Convert mix buffer
 #ifdef MPT_INTMIXER
-	StereoMixToFloat(MixSoundBuffer, MixFloatBuffer[0], MixFloatBuffer[1], nCount, IntToFloat);
+	StereoMixToFloat(MixSoundBuffer.data(), MixFloatBuffer[0].data(), MixFloatBuffer[1].data(), nCount, IntToFloat);
 #else
-	DeinterleaveStereo(MixSoundBuffer, MixFloatBuffer[0], MixFloatBuffer[1], nCount);
+	DeinterleaveStereo(MixSoundBuffer.data(), MixFloatBuffer[0].data(), MixFloatBuffer[1].data(), nCount);
 #endif // MPT_INTMIXER
-	float *pMixL = MixFloatBuffer[0];
-	float *pMixR = MixFloatBuffer[1];
+	float *pMixL = MixFloatBuffer[0].data();
+	float *pMixR = MixFloatBuffer[1].data();
 
 	const bool positionChanged = HasPositionChanged();
 
+#ifdef MODPLUG_TRACKER
+	// VST plugins may call back into the host, which is not prepared for being called from several threads at once.
+	const bool processChains = false;
+#else
+	const bool processChains = m_mixThreadPool && m_pluginChainStart.size() > 2;
+#endif // MODPLUG_TRACKER
+	if(processChains)
+		ProcessPluginChains(nCount, positionChanged);
+
 	// Process Plugins
-	for(PLUGINDEX plug = 0; plug < MAX_MIXPLUGINS; plug++)
+	for(const auto &entry : m_pluginSchedule)
 	{
-		SNDMIXPLUGIN &plugin = m_MixPlugins[plug];
-		if (plugin.pMixPlugin != nullptr
-			&& plugin.pMixPlugin->m_MixState.pMixBuffer != nullptr
-			&& plugin.pMixPlugin->m_mixBuffer.Ok())
-		{
-			IMixPlugin *pObject = plugin.pMixPlugin;
-			if(!plugin.IsMasterEffect() && !plugin.pMixPlugin->ShouldProcessSilence() && !(plugin.pMixPlugin->m_MixState.dwFlags & SNDMIXPLUGINSTATE::psfHasInput))
-			{
-				// If plugin has no inputs and isn't a master plugin, we shouldn't let it process silence if possible.
-				// I have yet to encounter a VST plugin which actually sets this flag.
-				bool hasInput = false;
-				for(PLUGINDEX inPlug = 0; inPlug < plug; inPlug++)
-				{
-					if(m_MixPlugins[inPlug].GetOutputPlugin() == plug)
-					{
-						hasInput = true;
-						break;
-					}
-				}
-				if(!hasInput)
-				{
-					continue;
-				}
-			}
-
-			bool isMasterMix = false;
-			float *plugInputL = pObject->m_mixBuffer.GetInputBuffer(0);
-			float *plugInputR = pObject->m_mixBuffer.GetInputBuffer(1);
-
-			if (pMixL == plugInputL)
-			{
-				isMasterMix = true;
-				pMixL = MixFloatBuffer[0];
-				pMixR = MixFloatBuffer[1];
-			}
-			SNDMIXPLUGINSTATE &state = plugin.pMixPlugin->m_MixState;
-			float *pOutL = pMixL;
-			float *pOutR = pMixR;
-
-			if (!plugin.IsOutputToMaster())
-			{
-				PLUGINDEX nOutput = plugin.GetOutputPlugin();
-				if(nOutput > plug && nOutput < MAX_MIXPLUGINS
-					&& m_MixPlugins[nOutput].pMixPlugin != nullptr)
-				{
-					IMixPlugin *outPlugin = m_MixPlugins[nOutput].pMixPlugin;
-					if(!(state.dwFlags & SNDMIXPLUGINSTATE::psfSilenceBypass)) outPlugin->ResetSilence();
-
-					if(outPlugin->m_mixBuffer.Ok())
-					{
-						pOutL = outPlugin->m_mixBuffer.GetInputBuffer(0);
-						pOutR = outPlugin->m_mixBuffer.GetInputBuffer(1);
-					}
-				}
-			}
-
-			/*
-			if (plugin.multiRouting) {
-				int nOutput=0;
-				for (int nOutput=0; nOutput < plugin.nOutputs / 2; nOutput++) {
-					destinationPlug = plugin.multiRoutingDestinations[nOutput];
-					pOutState = m_MixPlugins[destinationPlug].pMixState;
-					pOutputs[2 * nOutput] = plugInputL;
-					pOutputs[2 * (nOutput + 1)] = plugInputR;
-				}
-
-			}*/
-
-			if (plugin.IsMasterEffect())
-			{
-				if (!isMasterMix)
-				{
-					float *pInL = plugInputL;
-					float *pInR = plugInputR;
-					for (uint32 i=0; i<nCount; i++)
-					{
-						pInL[i] += pMixL[i];
-						pInR[i] += pMixR[i];
-						pMixL[i] = 0;
-						pMixR[i] = 0;
-					}
-				}
-				pMixL = pOutL;
-				pMixR = pOutR;
-
-				if(masterHasInput)
-				{
-					// Samples or plugins are being rendered, so turn off auto-bypass for this master effect.
-					if(plugin.pMixPlugin != nullptr) plugin.pMixPlugin->ResetSilence();
-					SNDMIXPLUGIN *chain = &plugin;
-					PLUGINDEX out = chain->GetOutputPlugin(), prevOut = plug;
-					while(out > prevOut && out < MAX_MIXPLUGINS)
-					{
-						chain = &m_MixPlugins[out];
-						prevOut = out;
-						out = chain->GetOutputPlugin();
-						if(chain->pMixPlugin)
-						{
-							chain->pMixPlugin->ResetSilence();
-						}
-					}
-				}
-			}
-
-			if(plugin.IsBypassed() || (plugin.IsAutoSuspendable() && (state.dwFlags & SNDMIXPLUGINSTATE::psfSilenceBypass)))
-			{
-				const float * const pInL = plugInputL;
-				const float * const pInR = plugInputR;
-				for (uint32 i=0; i<nCount; i++)
-				{
-					pOutL[i] += pInL[i];
-					pOutR[i] += pInR[i];
-				}
-			} else
-			{
-				if(positionChanged)
-					pObject->PositionChanged();
-				pObject->Process(pOutL, pOutR, nCount);
-
-				state.inputSilenceCount += nCount;
-				if(plugin.IsAutoSuspendable() && pObject->GetNumOutputChannels() > 0 && state.inputSilenceCount >= m_MixerSettings.gdwMixingFreq * 4)
-				{
-					bool isSilent = true;
-					for(uint32 i = 0; i < nCount; i++)
-					{
-						if(pOutL[i] >= FLT_EPSILON || pOutL[i] <= -FLT_EPSILON
-							|| pOutR[i] >= FLT_EPSILON || pOutR[i] <= -FLT_EPSILON)
-						{
-							isSilent = false;
-							break;
-						}
-					}
-					if(isSilent)
-					{
-						state.dwFlags |= SNDMIXPLUGINSTATE::psfSilenceBypass;
-					} else
-					{
-						state.inputSilenceCount = 0;
-					}
-				}
-			}
-			state.dwFlags &= ~SNDMIXPLUGINSTATE::psfHasInput;
-		}
+		if(!processChains || !entry.inParallelChain)
+			ProcessPlugin(entry, pMixL, pMixR, nCount, masterHasInput, positionChanged);
 	}
 #ifdef MPT_INTMIXER
-	FloatToStereoMix(pMixL, pMixR, MixSoundBuffer, nCount, FloatToInt);
+	FloatToStereoMix(pMixL, pMixR, MixSoundBuffer.data(), nCount, FloatToInt);
 #else
-	InterleaveStereo(pMixL, pMixR, MixSoundBuffer, nCount);
+	InterleaveStereo(pMixL, pMixR, MixSoundBuffer.data(), nCount);
 #endif // MPT_INTMIXER
 
 #else
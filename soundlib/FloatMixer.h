@@ -14,12 +14,17 @@
 
 #include "MixerInterface.h"
 #include "Resampler.h"
+#include "Paula.h"
 
 OPENMPT_NAMESPACE_BEGIN
 
 template<int channelsOut, int channelsIn, typename out, typename in, int int2float>
 struct IntToFloatTraits : public MixerTraits<channelsOut, channelsIn, out, in>
 {
+	using base_t = MixerTraits<channelsOut, channelsIn, out, in>;
+	using input_t = typename base_t::input_t;
+	using output_t = typename base_t::output_t;
+
 	static_assert(std::numeric_limits<input_t>::is_integer, "Input must be integer");
 	static_assert(!std::numeric_limits<output_t>::is_integer, "Output must be floating point");
 
@@ -38,6 +43,73 @@ using Int16SToFloatS  = IntToFloatTraits<2, 2, mixsample_t, int16, -int16_min>;
 //////////////////////////////////////////////////////////////////////////
 // Interpolation templates
 
+
+template<class Traits>
+struct AmigaBlepInterpolation
+{
+	SamplePosition subIncrement;
+	Paula::State &paula;
+	const Paula::BlepArray &WinSincIntegral;
+	const int numSteps;
+	unsigned int remainingSamples = 0;
+
+	MPT_FORCEINLINE AmigaBlepInterpolation(ModChannel &chn, const CResampler &resampler, unsigned int numSamples)
+		: paula{chn.paulaState}
+		, WinSincIntegral{resampler.Tables().blepTables.GetAmigaTable(resampler.m_Settings.emulateAmiga, chn.dwFlags[CHN_AMIGAFILTER])}
+		, numSteps{chn.paulaState.numSteps}
+	{
+		if(numSteps)
+		{
+			subIncrement = chn.increment / numSteps;
+			// May we read past the start or end of sample if we do partial sample increments?
+			// If that's the case, don't apply any sub increments on the source sample if we reached the last output sample
+			const int32 targetPos = (chn.position + chn.increment * numSamples).GetInt();
+			if(static_cast<SmpLength>(targetPos) > chn.nLength)
+				remainingSamples = numSamples;
+		}
+	}
+
+	// Paula is fed with the same 14-bit input as in the fixed point mixer
+	static MPT_FORCEINLINE int16 PaulaInput(const typename Traits::input_t * const MPT_RESTRICT inBuffer, const int32 posInt)
+	{
+		int32 inSample = 0;
+		for(int32 i = 0; i < Traits::numChannelsIn; i++)
+			inSample += static_cast<int32>(inBuffer[posInt + i]) * (1 << (16 - sizeof(typename Traits::input_t) * 8));
+		return static_cast<int16>(inSample / (4 * Traits::numChannelsIn));
+	}
+
+	MPT_FORCEINLINE void operator() (typename Traits::outbuf_t &outSample, const typename Traits::input_t * const MPT_RESTRICT inBuffer, const uint32 posLo)
+	{
+		if(--remainingSamples == 0)
+			subIncrement = {};
+
+		SamplePosition pos(0, posLo);
+		// First, process steps of full length (one Amiga clock interval)
+		for(int step = numSteps; step > 0; step--)
+		{
+			paula.InputSample(PaulaInput(inBuffer, pos.GetInt() * Traits::numChannelsIn));
+			paula.Clock(Paula::MINIMUM_INTERVAL);
+			pos += subIncrement;
+		}
+		paula.remainder += paula.stepRemainder;
+
+		// Now, process any remaining integer clock amount < MINIMUM_INTERVAL
+		uint32 remainClocks = paula.remainder.GetInt();
+		if(remainClocks)
+		{
+			paula.InputSample(PaulaInput(inBuffer, pos.GetInt() * Traits::numChannelsIn));
+			paula.Clock(remainClocks);
+			paula.remainder.RemoveInt();
+		}
+
+		// Undo the blep table scale and the 14-bit input reduction
+		const typename Traits::output_t out = static_cast<typename Traits::output_t>(paula.OutputSample(WinSincIntegral)) * (4.0f / (1 << Paula::BLEP_SCALE) / 32768.0f);
+		for(int i = 0; i < Traits::numChannelsOut; i++)
+			outSample[i] = out;
+	}
+};
+
+
 template<class Traits>
 struct LinearInterpolation
 {
@@ -62,12 +134,17 @@ struct LinearInterpolation
 template<class Traits>
 struct FastSincInterpolation
 {
-	MPT_FORCEINLINE FastSincInterpolation(const ModChannel &, const CResampler &, unsigned int) { }
+	const typename Traits::output_t *fastSinc;
+
+	MPT_FORCEINLINE FastSincInterpolation(const ModChannel &, const CResampler &resampler, unsigned int)
+	{
+		fastSinc = resampler.Tables().FastSincTablef;
+	}
 
 	MPT_FORCEINLINE void operator() (typename Traits::outbuf_t &outSample, const typename Traits::input_t * const inBuffer, const uint32 posLo)
 	{
 		static_assert(static_cast<int>(Traits::numChannelsIn) <= static_cast<int>(Traits::numChannelsOut), "Too many input channels");
-		const typename Traits::output_t *lut = CResampler::FastSincTablef + ((posLo >> 22) & 0x3FC);
+		const typename Traits::output_t *lut = fastSinc + ((posLo >> 22) & 0x3FC);
 
 		for(int i = 0; i < Traits::numChannelsIn; i++)
 		{
@@ -88,8 +165,8 @@ struct PolyphaseInterpolation
 
 	MPT_FORCEINLINE PolyphaseInterpolation(const ModChannel &chn, const CResampler &resampler, unsigned int)
 	{
-		sinc = (((chn.increment > SamplePosition(0x130000000ll)) || (chn.increment < -SamplePosition(-0x130000000ll))) ?
-			(((chn.increment > SamplePosition(0x180000000ll)) || (chn.increment < SamplePosition(-0x180000000ll))) ? resampler.gDownsample2x : resampler.gDownsample13x) : resampler.gKaiserSinc);
+		sinc = (((chn.increment > SamplePosition(0x130000000ll)) || (chn.increment < SamplePosition(-0x130000000ll))) ?
+			(((chn.increment > SamplePosition(0x180000000ll)) || (chn.increment < SamplePosition(-0x180000000ll))) ? resampler.Tables().gDownsample2x : resampler.Tables().gDownsample13x) : resampler.Tables().gKaiserSinc);
 	}
 
 	MPT_FORCEINLINE void operator() (typename Traits::outbuf_t &outSample, const typename Traits::input_t * const inBuffer, const uint32 posLo)
@@ -120,7 +197,7 @@ struct FIRFilterInterpolation
 
 	MPT_FORCEINLINE FIRFilterInterpolation(const ModChannel &, const CResampler &resampler, unsigned int)
 	{
-		WFIRlut = resampler.m_WindowedFIR.lut;
+		WFIRlut = resampler.WindowedFIR().lut;
 	}
 
 	MPT_FORCEINLINE void operator() (typename Traits::outbuf_t &outSample, const typename Traits::input_t * const inBuffer, const uint32 posLo)
@@ -154,8 +231,8 @@ struct NoRamp
 
 	MPT_FORCEINLINE NoRamp(const ModChannel &chn)
 	{
-		lVol = static_cast<Traits::output_t>(chn.leftVol) * (1.0f / 4096.0f);
-		rVol = static_cast<Traits::output_t>(chn.rightVol) * (1.0f / 4096.0f);
+		lVol = static_cast<typename Traits::output_t>(chn.leftVol) * (1.0f / 4096.0f);
+		rVol = static_cast<typename Traits::output_t>(chn.rightVol) * (1.0f / 4096.0f);
 	}
 };
 
@@ -184,9 +261,10 @@ struct Ramp
 template<class Traits>
 struct MixMonoFastNoRamp : public NoRamp<Traits>
 {
+	using base_t = NoRamp<Traits>;
 	MPT_FORCEINLINE void operator() (const typename Traits::outbuf_t &outSample, const ModChannel &chn, typename Traits::output_t * const outBuffer)
 	{
-		typename Traits::output_t vol = outSample[0] * lVol;
+		typename Traits::output_t vol = outSample[0] * base_t::lVol;
 		for(int i = 0; i < Traits::numChannelsOut; i++)
 		{
 			outBuffer[i] += vol;
@@ -198,10 +276,11 @@ struct MixMonoFastNoRamp : public NoRamp<Traits>
 template<class Traits>
 struct MixMonoNoRamp : public NoRamp<Traits>
 {
+	using base_t = NoRamp<Traits>;
 	MPT_FORCEINLINE void operator() (const typename Traits::outbuf_t &outSample, const ModChannel &, typename Traits::output_t * const outBuffer)
 	{
-		outBuffer[0] += outSample[0] * lVol;
-		outBuffer[1] += outSample[0] * rVol;
+		outBuffer[0] += outSample[0] * base_t::lVol;
+		outBuffer[1] += outSample[0] * base_t::rVol;
 	}
 };
 
@@ -223,10 +302,11 @@ struct MixMonoRamp : public Ramp
 template<class Traits>
 struct MixStereoNoRamp : public NoRamp<Traits>
 {
+	using base_t = NoRamp<Traits>;
 	MPT_FORCEINLINE void operator() (const typename Traits::outbuf_t &outSample, const ModChannel &, typename Traits::output_t * const outBuffer)
 	{
-		outBuffer[0] += outSample[0] * lVol;
-		outBuffer[1] += outSample[1] * rVol;
+		outBuffer[0] += outSample[0] * base_t::lVol;
+		outBuffer[1] += outSample[1] * base_t::rVol;
 	}
 };
 
@@ -276,7 +356,7 @@ struct ResonantFilter
 		}
 	}
 
-	MPT_FORCEINLINE ~ResonantFilter(ModChannel &chn)
+	MPT_FORCEINLINE ~ResonantFilter()
 	{
 		for(int i = 0; i < Traits::numChannelsIn; i++)
 		{
@@ -286,7 +366,7 @@ struct ResonantFilter
 	}
 
 	// Filter values are clipped to double the input range
-#define ClipFilter(x) Clamp(x, static_cast<Traits::output_t>(-2.0f), static_cast<Traits::output_t>(2.0f))
+#define ClipFilter(x) Clamp(x, static_cast<typename Traits::output_t>(-2.0f), static_cast<typename Traits::output_t>(2.0f))
 
 	MPT_FORCEINLINE void operator() (typename Traits::outbuf_t &outSample, const ModChannel &chn)
 	{
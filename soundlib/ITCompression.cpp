@@ -14,11 +14,17 @@
 #include "ModSample.h"
 #include "SampleCopy.h"
 #include "../common/misc_util.h"
+#include "../common/mptThreadPool.h"
+#include "mpt/base/bit.hpp"
 #include "mpt/io/base.hpp"
 #include "mpt/io/io.hpp"
 #include "mpt/io/io_stdstream.hpp"
 
+#include <array>
 #include <ostream>
+#include <type_traits>
+
+#include <cstring>
 
 
 OPENMPT_NAMESPACE_BEGIN
@@ -56,15 +62,112 @@ static constexpr int8 ITWidthChangeSize[] = { 4, 5, 6, 7, 8, 9, 7, 8, 9, 10, 11,
 // IT 2.14 compression
 
 
-ITCompression::ITCompression(const ModSample &sample, bool it215, std::ostream *f, SmpLength maxLength)
+ITCompression::ITCompression(const ModSample &sample, bool it215, std::ostream *f, SmpLength maxLength, ThreadPool *threadPool)
     : file(f)
     , mptSample(sample)
     , is215(it215)
 {
-	if(mptSample.GetElementarySampleSize() > 1)
+	if(threadPool)
+	{
+		const SampleToCompress toCompress{&sample, it215, maxLength};
+		const auto packed = CompressSamples(mpt::as_span(&toCompress, 1), threadPool);
+		if(file) mpt::IO::WriteRaw(*file, packed[0].data(), packed[0].size());
+		packedTotalLength = packed[0].size();
+	} else if(mptSample.GetElementarySampleSize() > 1)
+	{
 		Compress<IT16BitParams>(mptSample.sample16(), maxLength);
-	else
+	} else
+	{
 		Compress<IT8BitParams>(mptSample.sample8(), maxLength);
+	}
+}
+
+
+ITCompression::ITCompression(const ModSample &sample, bool it215)
+    : mptSample(sample)
+    , is215(it215)
+{
+}
+
+
+std::vector<std::vector<uint8>> ITCompression::CompressSamples(mpt::span<const SampleToCompress> samples, ThreadPool *threadPool)
+{
+	// Each block is compressed independently from all other blocks, so we can split the work at block boundaries.
+	struct Block
+	{
+		std::size_t sample;
+		uint8 chn;
+		SmpLength offset, length;
+		std::vector<uint8> packed;
+	};
+	std::vector<Block> blocks;
+	for(std::size_t smp = 0; smp < samples.size(); smp++)
+	{
+		const ModSample &sample = *samples[smp].sample;
+		SmpLength maxLength = samples[smp].maxLength;
+		if(maxLength == 0 || maxLength > sample.nLength)
+			maxLength = sample.nLength;
+		const SmpLength samplesPerBlock = static_cast<SmpLength>(blockSize / sample.GetElementarySampleSize());
+		for(uint8 chn = 0; chn < sample.GetNumChannels(); chn++)
+		{
+			for(SmpLength offset = 0; offset < maxLength; offset += samplesPerBlock)
+			{
+				blocks.push_back({smp, chn, offset, maxLength - offset, {}});
+			}
+		}
+	}
+
+	const auto compressBlock = [&blocks, samples](std::size_t b)
+	{
+		Block &block = blocks[b];
+		ITCompression compression(*samples[block.sample].sample, samples[block.sample].it215);
+		block.packed = compression.CompressSingleBlock(block.chn, block.offset, block.length);
+	};
+	if(threadPool)
+	{
+		threadPool->Run(blocks.size(), compressBlock);
+	} else
+	{
+		for(std::size_t b = 0; b < blocks.size(); b++)
+			compressBlock(b);
+	}
+
+	// Stitch the blocks back together in their original order
+	std::vector<std::vector<uint8>> result(samples.size());
+	for(auto &block : blocks)
+	{
+		result[block.sample].insert(result[block.sample].end(), block.packed.begin(), block.packed.end());
+		block.packed = {};
+	}
+	return result;
+}
+
+
+std::vector<uint8> ITCompression::CompressSingleBlock(uint8 chn, SmpLength offset, SmpLength length)
+{
+	packedData.resize(bufferSize);
+	StartBlock();
+	if(mptSample.GetElementarySampleSize() > 1)
+	{
+		std::vector<int16> sampleData(blockSize / sizeof(int16));
+		CompressBlock<IT16BitParams>(mptSample.sample16() + chn, offset, length, sampleData.data());
+	} else
+	{
+		std::vector<int8> sampleData(blockSize / sizeof(int8));
+		CompressBlock<IT8BitParams>(mptSample.sample8() + chn, offset, length, sampleData.data());
+	}
+	packedData.resize(packedLength);
+	return std::move(packedData);
+}
+
+
+// Initialise output buffer and bit writer positions
+void ITCompression::StartBlock()
+{
+	packedLength = 2;
+	bitPos = 0;
+	remBits = 8;
+	byteVal = 0;
 }
 
 
@@ -82,12 +185,7 @@ void ITCompression::Compress(const typename Properties::sample_t *mptSampleData,
 		SmpLength remain = maxLength;
 		while(remain > 0)
 		{
-			// Initialise output buffer and bit writer positions
-			packedLength = 2;
-			bitPos = 0;
-			remBits = 8;
-			byteVal = 0;
-
+			StartBlock();
 			CompressBlock<Properties>(mptSampleData + chn, offset, remain, sampleData.data());
 
 			if(file) mpt::IO::WriteRaw(*file, packedData.data(), packedLength);
@@ -129,6 +227,27 @@ void ITCompression::Deltafy(T *sampleData)
 }
 
 
+// Table of the smallest bit width whose value range contains a given sample value
+template<typename Properties>
+static const std::array<int8, 1u << (sizeof(typename Properties::sample_t) * 8)> &GetMinWidthTable()
+{
+	static const auto table = []()
+	{
+		using unsigned_t = std::make_unsigned_t<typename Properties::sample_t>;
+		std::array<int8, 1u << (sizeof(typename Properties::sample_t) * 8)> t{};
+		for(int width = Properties::defWidth - 1; width >= 0; width--)
+		{
+			for(int v = Properties::lowerTab[width]; v <= Properties::upperTab[width]; v++)
+			{
+				t[static_cast<unsigned_t>(v)] = static_cast<int8>(width);
+			}
+		}
+		return t;
+	}();
+	return table;
+}
+
+
 template<typename Properties>
 void ITCompression::CompressBlock(const typename Properties::sample_t *data, SmpLength offset, SmpLength actualLength, typename Properties::sample_t *sampleData)
 {
@@ -144,9 +263,16 @@ void ITCompression::CompressBlock(const typename Properties::sample_t *data, Smp
 
 	// Initialise bit width table with initial values
 	bwt.assign(baseLength, Properties::defWidth);
+	// Looking up the required width of each sampling point once is much cheaper than comparing against the value range of every width in SquishRecurse
+	const auto &minWidthTable = GetMinWidthTable<Properties>();
+	minWidth.resize(baseLength);
+	for(SmpLength i = 0; i < baseLength; i++)
+	{
+		minWidth[i] = minWidthTable[static_cast<std::make_unsigned_t<typename Properties::sample_t>>(sampleData[i])];
+	}
 
 	// Recurse!
-	SquishRecurse<Properties>(Properties::defWidth, Properties::defWidth, Properties::defWidth, Properties::defWidth - 2, 0, baseLength, sampleData);
+	SquishRecurse<Properties>(Properties::defWidth, Properties::defWidth, Properties::defWidth, Properties::defWidth - 2, 0, baseLength);
 	
 	// Write those bits!
 	const typename Properties::sample_t *p = sampleData;
@@ -197,8 +323,30 @@ int8 ITCompression::GetWidthChangeSize(int8 w, bool is16)
 }
 
 
+// Find the end of the run of sampling points starting at i that can be represented with the given width
+static SmpLength FindRunEnd(const int8 *minWidth, SmpLength i, SmpLength end, int8 width)
+{
+	// Check eight sampling points at once: All minimum widths are less than 128, so adding (127 - width) to each of them
+	// sets the top bit of a byte if and only if its width is exceeded, and never carries over into the next byte.
+	const uint64 add = static_cast<uint64>(127 - width) * 0x0101010101010101ull;
+	while(end - i >= 8)
+	{
+		uint64 widths;
+		std::memcpy(&widths, minWidth + i, sizeof(widths));
+		if((widths + add) & 0x8080808080808080ull)
+			break;
+		i += 8;
+	}
+	while(i < end && minWidth[i] <= width)
+	{
+		i++;
+	}
+	return i;
+}
+
+
 template<typename Properties>
-void ITCompression::SquishRecurse(int8 sWidth, int8 lWidth, int8 rWidth, int8 width, SmpLength offset, SmpLength length, const typename Properties::sample_t *sampleData)
+void ITCompression::SquishRecurse(int8 sWidth, int8 lWidth, int8 rWidth, int8 width, SmpLength offset, SmpLength length)
 {
 	if(width + 1 < 1)
 	{
@@ -211,18 +359,14 @@ void ITCompression::SquishRecurse(int8 sWidth, int8 lWidth, int8 rWidth, int8 wi
 
 	SmpLength i = offset;
 	SmpLength end = offset + length;
-	const typename Properties::sample_t *p = sampleData;
 
 	while(i < end)
 	{
-		if(p[i] >= Properties::lowerTab[width] && p[i] <= Properties::upperTab[width])
+		if(minWidth[i] <= width)
 		{
 			SmpLength start = i;
 			// Check for how long we can keep this bit width
-			while(i < end && p[i] >= Properties::lowerTab[width] && p[i] <= Properties::upperTab[width])
-			{
-				i++;
-			}
+			i = FindRunEnd(minWidth.data(), i, end, width);
 
 			const SmpLength blockLength = i - start;
 			const int8 xlwidth = start == offset ? lWidth : sWidth;
@@ -255,7 +399,7 @@ void ITCompression::SquishRecurse(int8 sWidth, int8 lWidth, int8 rWidth, int8 wi
 
 				comparison = (keepDown <= levelLeft);
 			}
-			SquishRecurse<Properties>(comparison ? (width + 1) : sWidth, xlwidth, xrwidth, width - 1, start, blockLength, sampleData);
+			SquishRecurse<Properties>(comparison ? (width + 1) : sWidth, xlwidth, xrwidth, width - 1, start, blockLength);
 		} else
 		{
 			bwt[i] = sWidth;
@@ -16,23 +16,40 @@
 #include <iosfwd>
 #include "Snd_defs.h"
 #include "BitReader.h"
+#include "mpt/base/span.hpp"
 
 
 OPENMPT_NAMESPACE_BEGIN
 
 struct ModSample;
+class ThreadPool;
 
 class ITCompression
 {
 public:
-	ITCompression(const ModSample &sample, bool it215, std::ostream *f, SmpLength maxLength = 0);
+	// If a thread pool is given, the blocks of the sample are compressed in parallel. The output is identical in either case.
+	ITCompression(const ModSample &sample, bool it215, std::ostream *f, SmpLength maxLength = 0, ThreadPool *threadPool = nullptr);
 	size_t GetCompressedSize() const { return packedTotalLength; }
 
+	struct SampleToCompress
+	{
+		const ModSample *sample;
+		bool it215;
+		SmpLength maxLength;
+	};
+	// Compress several samples at once, distributing the blocks of all samples over the thread pool (if any).
+	// The data returned for each sample is identical to what the constructor would write to the output stream.
+	static std::vector<std::vector<uint8>> CompressSamples(mpt::span<const SampleToCompress> samples, ThreadPool *threadPool);
+
 	static constexpr size_t bufferSize = 2 + 0xFFFF;  // Our output buffer can't be longer than this.
 	static constexpr size_t blockSize = 0x8000;       // Block size (in bytes) in which samples are being processed
 
 protected:
+	// Only sets up the compressor state, used for compressing individual blocks
+	ITCompression(const ModSample &sample, bool it215);
+
 	std::vector<int8> bwt;           // Bit width table for each sampling point
+	std::vector<int8> minWidth;      // Smallest bit width that can represent each sampling point
 	std::vector<uint8> packedData;   // Compressed data for current sample block
 	std::ostream *file = nullptr;    // File to which compressed data will be written (can be nullptr if you only want to find out the sample size)
 	const ModSample &mptSample;      // Sample that is being processed
@@ -50,6 +67,9 @@ protected:
 	template<typename Properties>
 	void Compress(const typename Properties::sample_t *mptSampleData, SmpLength maxLength);
 
+	void StartBlock();
+	std::vector<uint8> CompressSingleBlock(uint8 chn, SmpLength offset, SmpLength length);
+
 	template<typename T>
 	static void CopySample(T *target, const T *source, SmpLength offset, SmpLength length, SmpLength skip);
 
@@ -62,7 +82,7 @@ protected:
 	static int8 GetWidthChangeSize(int8 w, bool is16);
 
 	template<typename Properties>
-	void SquishRecurse(int8 sWidth, int8 lWidth, int8 rWidth, int8 width, SmpLength offset, SmpLength length, const typename Properties::sample_t *sampleData);
+	void SquishRecurse(int8 sWidth, int8 lWidth, int8 rWidth, int8 width, SmpLength offset, SmpLength length);
 
 	static int8 ConvertWidth(int8 curWidth, int8 newWidth);
 	void WriteBits(int8 width, int v);
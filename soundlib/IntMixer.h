@@ -17,6 +17,11 @@
 #include "MixerInterface.h"
 #include "Paula.h"
 
+#if defined(MPT_ENABLE_ARCH_INTRINSICS_SSE2)
+#include <cstring>
+#include <emmintrin.h>
+#endif
+
 OPENMPT_NAMESPACE_BEGIN
 
 template<int channelsOut, int channelsIn, typename out, typename in, size_t mixPrecision>
@@ -57,7 +62,7 @@ struct AmigaBlepInterpolation
 
 	MPT_FORCEINLINE AmigaBlepInterpolation(ModChannel &chn, const CResampler &resampler, unsigned int numSamples)
 		: paula{chn.paulaState}
-		, WinSincIntegral{resampler.blepTables.GetAmigaTable(resampler.m_Settings.emulateAmiga, chn.dwFlags[CHN_AMIGAFILTER])}
+		, WinSincIntegral{resampler.Tables().blepTables.GetAmigaTable(resampler.m_Settings.emulateAmiga, chn.dwFlags[CHN_AMIGAFILTER])}
 		, numSteps{chn.paulaState.numSteps}
 	{
 		if(numSteps)
@@ -169,7 +174,7 @@ struct PolyphaseInterpolation
 			MPT_UNREFERENCED_PARAMETER(resampler);
 		#endif // MODPLUG_TRACKER
 		sinc = (((chn.increment > SamplePosition(0x130000000ll)) || (chn.increment < SamplePosition(-0x130000000ll))) ?
-			(((chn.increment > SamplePosition(0x180000000ll)) || (chn.increment < SamplePosition(-0x180000000ll))) ? resampler.gDownsample2x : resampler.gDownsample13x) : resampler.gKaiserSinc);
+			(((chn.increment > SamplePosition(0x180000000ll)) || (chn.increment < SamplePosition(-0x180000000ll))) ? resampler.Tables().gDownsample2x : resampler.Tables().gDownsample13x) : resampler.Tables().gKaiserSinc);
 	}
 
 	MPT_FORCEINLINE void operator() (typename Traits::outbuf_t &outSample, const typename Traits::input_t * const MPT_RESTRICT inBuffer, const uint32 posLo)
@@ -200,7 +205,7 @@ struct FIRFilterInterpolation
 
 	MPT_FORCEINLINE FIRFilterInterpolation(const ModChannel &, const CResampler &resampler, unsigned int)
 	{
-		WFIRlut = resampler.m_WindowedFIR.lut;
+		WFIRlut = resampler.WindowedFIR().lut;
 	}
 
 	MPT_FORCEINLINE void operator() (typename Traits::outbuf_t &outSample, const typename Traits::input_t * const MPT_RESTRICT inBuffer, const uint32 posLo)
@@ -226,6 +231,135 @@ struct FIRFilterInterpolation
 };
 
 
+#if defined(MPT_ENABLE_ARCH_INTRINSICS_SSE2)
+
+//////////////////////////////////////////////////////////////////////////
+// SSE2 interpolation templates
+// These compute exactly the same results as their generic counterparts above:
+// All taps are converted to 16-bit precision and multiplied with 16-bit coefficients using pmaddwd,
+// and the final division is done on the 32-bit sums in the same way as in the generic code.
+
+namespace SSE2
+{
+
+// Load four sample frames and convert them to 16-bit precision.
+// Mono: x0 x1 x2 x3 in the lower four words, stereo: L0 R0 L1 R1 L2 R2 L3 R3
+template<class Traits>
+MPT_FORCEINLINE __m128i Load4(const typename Traits::input_t * const MPT_RESTRICT inBuffer)
+{
+	using input_t = typename Traits::input_t;
+	static_assert(std::is_same<input_t, int8>::value || std::is_same<input_t, int16>::value);
+	static_assert(Traits::Convert(input_t(1)) == (1 << (16 - sizeof(input_t) * 8)), "SSE2 interpolation requires 16-bit mix precision");
+	if constexpr(sizeof(input_t) == 1)
+	{
+		__m128i v;
+		if constexpr(Traits::numChannelsIn == 1)
+		{
+			int32 x;
+			std::memcpy(&x, inBuffer, 4);
+			v = _mm_cvtsi32_si128(x);
+		} else
+		{
+			v = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(inBuffer));
+		}
+		return _mm_unpacklo_epi8(_mm_setzero_si128(), v);
+	} else
+	{
+		if constexpr(Traits::numChannelsIn == 1)
+			return _mm_loadl_epi64(reinterpret_cast<const __m128i *>(inBuffer));
+		else
+			return _mm_loadu_si128(reinterpret_cast<const __m128i *>(inBuffer));
+	}
+}
+
+// Multiply four sample frames with four coefficients and sum up the products.
+// The result for channel n is stored in the n-th dword.
+template<class Traits>
+MPT_FORCEINLINE __m128i DotProduct4(const __m128i samples, const int16 * const lut)
+{
+	const __m128i coeffs = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(lut));
+	if constexpr(Traits::numChannelsIn == 1)
+	{
+		const __m128i sum = _mm_madd_epi16(samples, coeffs);
+		return _mm_add_epi32(sum, _mm_srli_si128(sum, 4));
+	} else
+	{
+		// L0 L1 R0 R1 L2 L3 R2 R3 * c0 c1 c0 c1 c2 c3 c2 c3
+		const __m128i ordered = _mm_shufflehi_epi16(_mm_shufflelo_epi16(samples, _MM_SHUFFLE(3, 1, 2, 0)), _MM_SHUFFLE(3, 1, 2, 0));
+		const __m128i sum = _mm_madd_epi16(ordered, _mm_unpacklo_epi32(coeffs, coeffs));
+		return _mm_add_epi32(sum, _mm_srli_si128(sum, 8));
+	}
+}
+
+template<int channel>
+MPT_FORCEINLINE int32 Extract(const __m128i v)
+{
+	return _mm_cvtsi128_si32(_mm_srli_si128(v, channel * 4));
+}
+
+} // namespace SSE2
+
+
+template<class Traits>
+struct FastSincInterpolationSSE2
+{
+	MPT_FORCEINLINE FastSincInterpolationSSE2(const ModChannel &, const CResampler &, unsigned int) { }
+
+	MPT_FORCEINLINE void operator() (typename Traits::outbuf_t &outSample, const typename Traits::input_t * const MPT_RESTRICT inBuffer, const uint32 posLo)
+	{
+		static_assert(static_cast<int>(Traits::numChannelsIn) <= static_cast<int>(Traits::numChannelsOut), "Too many input channels");
+		const int16 *lut = CResampler::FastSincTable + ((posLo >> 22) & 0x3FC);
+
+		const __m128i sum = SSE2::DotProduct4<Traits>(SSE2::Load4<Traits>(inBuffer - Traits::numChannelsIn), lut);
+		outSample[0] = SSE2::Extract<0>(sum) / 16384;
+		if constexpr(Traits::numChannelsIn == 2)
+			outSample[1] = SSE2::Extract<1>(sum) / 16384;
+	}
+};
+
+
+template<class Traits>
+struct PolyphaseInterpolationSSE2 : public PolyphaseInterpolation<Traits>
+{
+	using PolyphaseInterpolation<Traits>::PolyphaseInterpolation;
+
+	MPT_FORCEINLINE void operator() (typename Traits::outbuf_t &outSample, const typename Traits::input_t * const MPT_RESTRICT inBuffer, const uint32 posLo)
+	{
+		static_assert(static_cast<int>(Traits::numChannelsIn) <= static_cast<int>(Traits::numChannelsOut), "Too many input channels");
+		static_assert(std::is_same<SINC_TYPE, int16>::value);
+		const SINC_TYPE *lut = PolyphaseInterpolation<Traits>::sinc + ((posLo >> (32 - SINC_PHASES_BITS)) & SINC_MASK) * SINC_WIDTH;
+
+		const __m128i vol1 = SSE2::DotProduct4<Traits>(SSE2::Load4<Traits>(inBuffer - 3 * Traits::numChannelsIn), lut);
+		const __m128i vol2 = SSE2::DotProduct4<Traits>(SSE2::Load4<Traits>(inBuffer + 1 * Traits::numChannelsIn), lut + 4);
+		const __m128i sum = _mm_add_epi32(vol1, vol2);
+		outSample[0] = SSE2::Extract<0>(sum) / (1 << SINC_QUANTSHIFT);
+		if constexpr(Traits::numChannelsIn == 2)
+			outSample[1] = SSE2::Extract<1>(sum) / (1 << SINC_QUANTSHIFT);
+	}
+};
+
+
+template<class Traits>
+struct FIRFilterInterpolationSSE2 : public FIRFilterInterpolation<Traits>
+{
+	using FIRFilterInterpolation<Traits>::FIRFilterInterpolation;
+
+	MPT_FORCEINLINE void operator() (typename Traits::outbuf_t &outSample, const typename Traits::input_t * const MPT_RESTRICT inBuffer, const uint32 posLo)
+	{
+		static_assert(static_cast<int>(Traits::numChannelsIn) <= static_cast<int>(Traits::numChannelsOut), "Too many input channels");
+		const int16 * const lut = FIRFilterInterpolation<Traits>::WFIRlut + ((((posLo >> 16) + WFIR_FRACHALVE) >> WFIR_FRACSHIFT) & WFIR_FRACMASK);
+
+		const __m128i vol1 = SSE2::DotProduct4<Traits>(SSE2::Load4<Traits>(inBuffer - 3 * Traits::numChannelsIn), lut);
+		const __m128i vol2 = SSE2::DotProduct4<Traits>(SSE2::Load4<Traits>(inBuffer + 1 * Traits::numChannelsIn), lut + 4);
+		outSample[0] = ((SSE2::Extract<0>(vol1) / 2) + (SSE2::Extract<0>(vol2) / 2)) / (1 << (WFIR_16BITSHIFT - 1));
+		if constexpr(Traits::numChannelsIn == 2)
+			outSample[1] = ((SSE2::Extract<1>(vol1) / 2) + (SSE2::Extract<1>(vol2) / 2)) / (1 << (WFIR_16BITSHIFT - 1));
+	}
+};
+
+#endif // MPT_ENABLE_ARCH_INTRINSICS_SSE2
+
+
 //////////////////////////////////////////////////////////////////////////
 // Mixing templates (add sample to stereo mix)
 
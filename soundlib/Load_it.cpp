@@ -26,8 +26,13 @@
 #endif // MODPLUG_NO_FILESAVE
 #include "plugins/PlugInterface.h"
 #include <sstream>
+#include <thread>
 #include "../common/version.h"
 #include "ITTools.h"
+#ifdef MODPLUG_TRACKER
+#include "ITCompression.h"
+#include "../common/mptThreadPool.h"
+#endif // MODPLUG_TRACKER
 #include "mpt/io/base.hpp"
 #include "mpt/io/io.hpp"
 #include "mpt/io/io_stdstream.hpp"
@@ -813,7 +818,7 @@ bool CSoundFile::ReadIT(FileReader &file, ModLoadingFlags loadFlags)
 			} else if(!sample.uFlags[SMP_KEEPONDISK])
 			{
 				SampleIO sampleIO = sampleHeader.GetSampleFormat(fileHeader.cwtv);
-				if(loadFlags & loadSampleData)
+				if((loadFlags & loadSampleData) && !DeferSampleData(i + 1, sampleIO, file, loadFlags))
 				{
 					sampleIO.ReadSample(sample, file);
 				} else
@@ -1876,13 +1881,47 @@ bool CSoundFile::SaveIT(std::ostream &f, const mpt::PathString &filename, bool c
 		mpt::IO::SeekAbsolute(f, dwPos);
 	}
 	// Writing Sample Data
+#ifdef MODPLUG_TRACKER
+	const auto compressSample = [&](const ModSample &sample)
+	{
+		uint32 type = GetType() == MOD_TYPE_IT ? 1 : 4;
+		if(compatibilityExport) type = 2;
+		return ((((sample.GetNumChannels() > 1) ? TrackerSettings::Instance().MiscITCompressionStereo : TrackerSettings::Instance().MiscITCompressionMono) & type) != 0);
+	};
+
+	// Compressing samples is slow, so compress all of them in parallel before writing anything.
+	std::vector<std::vector<uint8>> compressedSamples(itHeader.smpnum);
+	{
+		std::vector<ITCompression::SampleToCompress> toCompress;
+		std::vector<SAMPLEINDEX> toCompressIndex;
+		for(SAMPLEINDEX smp = 1; smp <= itHeader.smpnum; smp++)
+		{
+			const ModSample &sample = Samples[smp];
+			ITSample compressedHeader;
+			compressedHeader.ConvertToIT(sample, GetType(), compressSample(sample), itHeader.cmwt >= 0x215, GetType() == MOD_TYPE_MPT);
+			const auto encoding = compressedHeader.GetSampleFormat().GetEncoding();
+			if(compressedHeader.cvt != ITSample::cvtExternalSample && compressedHeader.length != 0 && (encoding == SampleIO::IT214 || encoding == SampleIO::IT215))
+			{
+				toCompress.push_back({&sample, encoding == SampleIO::IT215, compressedHeader.length});
+				toCompressIndex.push_back(smp);
+			}
+		}
+		if(!toCompress.empty())
+		{
+			ThreadPool threadPool(std::max(std::thread::hardware_concurrency(), 2u) - 1);
+			auto compressed = ITCompression::CompressSamples(mpt::as_span(toCompress.data(), toCompress.size()), &threadPool);
+			for(std::size_t i = 0; i < compressed.size(); i++)
+			{
+				compressedSamples[toCompressIndex[i] - 1] = std::move(compressed[i]);
+			}
+		}
+	}
+#endif // MODPLUG_TRACKER
 	for(SAMPLEINDEX smp = 1; smp <= itHeader.smpnum; smp++)
 	{
 		const ModSample &sample = Samples[smp];
 #ifdef MODPLUG_TRACKER
-		uint32 type = GetType() == MOD_TYPE_IT ? 1 : 4;
-		if(compatibilityExport) type = 2;
-		bool compress = ((((sample.GetNumChannels() > 1) ? TrackerSettings::Instance().MiscITCompressionStereo : TrackerSettings::Instance().MiscITCompressionMono) & type) != 0);
+		bool compress = compressSample(sample);
 #else
 		bool compress = false;
 #endif // MODPLUG_TRACKER
@@ -1917,7 +1956,17 @@ bool CSoundFile::SaveIT(std::ostream &f, const mpt::PathString &filename, bool c
 				// Sample length does not fit into IT header!
 				AddToLog(LogWarning, MPT_UFORMAT("Truncating sample {}: Length exceeds exceeds 4 gigasamples.")(smp));
 			}
-			dwPos += itss.GetSampleFormat().WriteSample(f, sample, smpLength);
+#ifdef MODPLUG_TRACKER
+			if(!compressedSamples[smp - 1].empty())
+			{
+				mpt::IO::WriteRaw(f, compressedSamples[smp - 1].data(), compressedSamples[smp - 1].size());
+				dwPos += compressedSamples[smp - 1].size();
+				compressedSamples[smp - 1] = {};
+			} else
+#endif // MODPLUG_TRACKER
+			{
+				dwPos += itss.GetSampleFormat().WriteSample(f, sample, smpLength);
+			}
 		} else
 		{
 #ifdef MPT_EXTERNAL_SAMPLES
@@ -1407,14 +1407,23 @@ bool CSoundFile::ReadMO3(FileReader &file, ModLoadingFlags loadFlags)
 	}
 
 	// Now we can load Ogg samples with shared headers.
+	// The samples are decoded independently of each other (possibly in parallel), so sampleChunks must not be modified here.
 	if(loadFlags & loadSampleData)
 	{
-		for(SAMPLEINDEX smp = 1; smp <= m_nSamples; smp++)
+		struct OggSampleResult
 		{
-			MO3SampleChunk &sampleChunk = sampleChunks[smp - 1];
+			std::vector<std::pair<LogLevel, mpt::ustring>> messages;
+			bool unsupported = false;
+		};
+		std::vector<OggSampleResult> oggResults(m_nSamples);
+		RunLoadTasks(m_nSamples, [&](std::size_t task)
+		{
+			const SAMPLEINDEX smp = static_cast<SAMPLEINDEX>(task + 1);
+			OggSampleResult &result = oggResults[task];
+			MO3SampleChunk sampleChunk = sampleChunks[task];
 			// Is this an Ogg sample?
 			if(!sampleChunk.chunk.IsValid())
-				continue;
+				return;
 
 			SAMPLEINDEX sharedOggHeader = (smp + sampleChunk.sharedHeader > 0) ? static_cast<SAMPLEINDEX>(smp + sampleChunk.sharedHeader) : smp;
 			// Which chunk are we going to read the header from?
@@ -1448,8 +1457,7 @@ bool CSoundFile::ReadMO3(FileReader &file, ModLoadingFlags loadFlags)
 				std::ostringstream mergedStream(std::ios::binary);
 				mergedStream.imbue(std::locale::classic());
 
-				sampleChunks[sharedOggHeader - 1].chunk.Rewind();
-				FileReader sharedChunk = sampleChunks[sharedOggHeader - 1].chunk.ReadChunk(sampleChunk.headerSize);
+				FileReader sharedChunk = sampleChunks[sharedOggHeader - 1].chunk.GetChunkAt(0, sampleChunk.headerSize);
 				sharedChunk.Rewind();
 
 				std::vector<uint32> streamSerials;
@@ -1497,8 +1505,7 @@ bool CSoundFile::ReadMO3(FileReader &file, ModLoadingFlags loadFlags)
 				std::ostringstream mergedStream(std::ios::binary);
 				mergedStream.imbue(std::locale::classic());
 
-				sampleChunks[sharedOggHeader - 1].chunk.Rewind();
-				FileReader sharedChunk = sampleChunks[sharedOggHeader - 1].chunk.ReadChunk(sampleChunk.headerSize);
+				FileReader sharedChunk = sampleChunks[sharedOggHeader - 1].chunk.GetChunkAt(0, sampleChunk.headerSize);
 				sharedChunk.Rewind();
 
 				std::vector<uint32> dataStreamSerials;
@@ -1554,13 +1561,13 @@ bool CSoundFile::ReadMO3(FileReader &file, ModLoadingFlags loadFlags)
 
 				if(headStreamSerials.size() > 1)
 				{
-					AddToLog(LogWarning, MPT_UFORMAT("Sample {}: Ogg Vorbis data with shared header and multiple logical bitstreams in header chunk found. This may be handled incorrectly.")(smp));
+					result.messages.emplace_back(LogWarning, MPT_UFORMAT("Sample {}: Ogg Vorbis data with shared header and multiple logical bitstreams in header chunk found. This may be handled incorrectly.")(smp));
 				} else if(dataStreamSerials.size() > 1)
 				{
-					AddToLog(LogWarning, MPT_UFORMAT("Sample {}: Ogg Vorbis sample with shared header and multiple logical bitstreams found. This may be handled incorrectly.")(smp));
+					result.messages.emplace_back(LogWarning, MPT_UFORMAT("Sample {}: Ogg Vorbis sample with shared header and multiple logical bitstreams found. This may be handled incorrectly.")(smp));
 				} else if((dataStreamSerials.size() == 1) && (headStreamSerials.size() == 1) && (dataStreamSerials[0] != headStreamSerials[0]))
 				{
-					AddToLog(LogInformation, MPT_UFORMAT("Sample {}: Ogg Vorbis data with shared header and different logical bitstream serials found.")(smp));
+					result.messages.emplace_back(LogInformation, MPT_UFORMAT("Sample {}: Ogg Vorbis data with shared header and different logical bitstream serials found.")(smp));
 				}
 
 				std::string mergedStreamData = mergedStream.str();
@@ -1581,7 +1588,8 @@ bool CSoundFile::ReadMO3(FileReader &file, ModLoadingFlags loadFlags)
 #else  // !(MPT_WITH_VORBIS && MPT_WITH_VORBISFILE)
 
 			FileReader &sampleData = sampleChunk.chunk;
-			FileReader &headerChunk = sharedHeader ? sampleChunks[sharedOggHeader - 1].chunk : sampleData;
+			FileReader sharedChunk = sharedHeader ? sampleChunks[sharedOggHeader - 1].chunk : FileReader();
+			FileReader &headerChunk = sharedHeader ? sharedChunk : sampleData;
 #if defined(MPT_WITH_STBVORBIS)
 			std::size_t initialRead = sharedHeader ? sampleChunk.headerSize : headerChunk.GetLength();
 #endif  // MPT_WITH_STBVORBIS
@@ -1590,7 +1598,7 @@ bool CSoundFile::ReadMO3(FileReader &file, ModLoadingFlags loadFlags)
 
 			headerChunk.Rewind();
 			if(sharedHeader && !headerChunk.CanRead(sampleChunk.headerSize))
-				continue;
+				return;
 
 #if defined(MPT_WITH_VORBIS) && defined(MPT_WITH_VORBISFILE)
 
@@ -1644,17 +1652,17 @@ bool CSoundFile::ReadMO3(FileReader &file, ModLoadingFlags loadFlags)
 						}
 					} else
 					{
-						unsupportedSamples = true;
+						result.unsupported = true;
 					}
 				} else
 				{
-					AddToLog(LogWarning, MPT_UFORMAT("Sample {}: Unsupported Ogg Vorbis chained stream found.")(smp));
-					unsupportedSamples = true;
+					result.messages.emplace_back(LogWarning, MPT_UFORMAT("Sample {}: Unsupported Ogg Vorbis chained stream found.")(smp));
+					result.unsupported = true;
 				}
 				ov_clear(&vf);
 			} else
 			{
-				unsupportedSamples = true;
+				result.unsupported = true;
 			}
 
 #elif defined(MPT_WITH_STBVORBIS)
@@ -1717,14 +1725,21 @@ bool CSoundFile::ReadMO3(FileReader &file, ModLoadingFlags loadFlags)
 				stb_vorbis_close(vorb);
 			} else
 			{
-				unsupportedSamples = true;
+				result.unsupported = true;
 			}
 
 #else  // !VORBIS
 
-			unsupportedSamples = true;
+			result.unsupported = true;
 
 #endif  // VORBIS
+		});
+		for(const auto &result : oggResults)
+		{
+			for(const auto &[level, message] : result.messages)
+				AddToLog(level, message);
+			if(result.unsupported)
+				unsupportedSamples = true;
 		}
 	}
 
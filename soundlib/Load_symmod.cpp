@@ -250,7 +250,12 @@ struct SymVirtualInst
 				if(chn.position.GetUInt() >= chn.nLength)
 					chn.pCurrentSample = nullptr;
 			}
-			CopySample<SC::ConversionChain<SC::ConvertFixedPoint<int16, mixsample_t, 27>, SC::DecodeIdentity<mixsample_t>>>(target.sample16() + writeOffset, writeCount, 1, buffer.data(), sizeof(buffer), 2);
+#ifdef MPT_INTMIXER
+			using MixToInt16 = SC::ConvertFixedPoint<int16, mixsample_t, MIXING_FRACTIONAL_BITS>;
+#else
+			using MixToInt16 = SC::Convert<int16, mixsample_t>;
+#endif // MPT_INTMIXER
+			CopySample<SC::ConversionChain<MixToInt16, SC::DecodeIdentity<mixsample_t>>>(target.sample16() + writeOffset, writeCount, 1, buffer.data(), sizeof(buffer), 2);
 			writeOffset += writeCount;
 		}
 
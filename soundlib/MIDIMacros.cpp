@@ -398,4 +398,88 @@ void MIDIMacroConfig::Macro::UpgradeLegacyMacro() noexcept
 }
 
 
+CompiledMIDIMacro::CompiledMIDIMacro(const MIDIMacroConfigData::Macro &macro) noexcept
+	: m_source{macro}
+{
+	const mpt::span<const char> str = m_source;
+	m_sourceLength = static_cast<uint8>(str.size());
+	bool previousIsNibble = false;  // Can the previous instruction be merged with another constant nibble?
+	for(const char c : str)
+	{
+		Instruction instr{Op::Nibble, 0};
+		// See CSoundFile::ParseMIDIMacro for the meaning of each variable
+		if(c >= '0' && c <= '9')
+			instr.value = static_cast<uint8>(c - '0');
+		else if(c >= 'A' && c <= 'F')
+			instr.value = static_cast<uint8>(c - 'A' + 0x0A);
+		else if(c == 'c')
+			instr.op = Op::MIDIChannel;
+		else if(c == 'n')
+			instr.op = Op::LastNote;
+		else if(c == 'v')
+			instr.op = Op::Velocity;
+		else if(c == 'u')
+			instr.op = Op::CalcVolume;
+		else if(c == 'x')
+			instr.op = Op::Pan;
+		else if(c == 'y')
+			instr.op = Op::CalcPan;
+		else if(c == 'a')
+			instr.op = Op::BankHigh;
+		else if(c == 'b')
+			instr.op = Op::BankLow;
+		else if(c == 'o')
+			instr.op = Op::Offset;
+		else if(c == 'h')
+			instr.op = Op::HostChannel;
+		else if(c == 'm')
+			instr.op = Op::LoopDirection;
+		else if(c == 'p')
+			instr.op = Op::Program;
+		else if(c == 'z')
+			instr.op = Op::Parameter;
+		else if(c == 's')
+			instr.op = Op::Checksum;
+		else
+			continue;  // Unrecognized byte (e.g. space char)
+
+		if(instr.op == Op::Nibble && previousIsNibble)
+		{
+			Instruction &prev = m_instructions[m_numInstructions - 1];
+			prev.op = Op::NibblePair;
+			prev.value = static_cast<uint8>((prev.value << 4) | instr.value);
+			previousIsNibble = false;
+		} else
+		{
+			m_instructions[m_numInstructions++] = instr;
+			previousIsNibble = (instr.op == Op::Nibble);
+		}
+	}
+}
+
+
+void CompiledMIDIMacroConfig::Update(const MIDIMacroConfigData &config) noexcept
+{
+	static_assert(std::tuple_size<decltype(m_macros)>::value * sizeof(MIDIMacroConfigData::Macro) == sizeof(MIDIMacroConfigData));
+	auto compiled = m_macros.begin();
+	for(const auto &macro : config)
+	{
+		if(compiled->Source() != macro)
+			*compiled = CompiledMIDIMacro{macro};
+		++compiled;
+	}
+}
+
+
+const CompiledMIDIMacro *CompiledMIDIMacroConfig::Find(const MIDIMacroConfigData &config, const MIDIMacroConfigData::Macro &macro) const noexcept
+{
+	if(std::less<const MIDIMacroConfigData::Macro *>{}(&macro, config.begin()) || !std::less<const MIDIMacroConfigData::Macro *>{}(&macro, config.end()))
+		return nullptr;
+	const CompiledMIDIMacro &compiled = m_macros[static_cast<size_t>(&macro - config.begin())];
+	if(compiled.Source() != macro)
+		return nullptr;
+	return &compiled;
+}
+
+
 OPENMPT_NAMESPACE_END
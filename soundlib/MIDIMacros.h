@@ -227,4 +227,67 @@ public:
 static_assert(sizeof(MIDIMacroConfig) == sizeof(MIDIMacroConfigData)); // this is directly written to files, so the size must be correct!
 
 
+// Pre-parsed form of a MIDI macro string, so that the string does not have to be interpreted every time the macro is executed.
+// Characters that are ignored by the parser are dropped, macro variables are resolved to opcodes and pairs of constant nibbles are merged.
+class CompiledMIDIMacro
+{
+public:
+	enum class Op : uint8
+	{
+		Nibble,         // Constant nibble
+		NibblePair,     // Two constant nibbles, behaves exactly like two Nibble instructions
+		MIDIChannel,    // c
+		LastNote,       // n
+		Velocity,       // v
+		CalcVolume,     // u
+		Pan,            // x
+		CalcPan,        // y
+		BankHigh,       // a
+		BankLow,        // b
+		Offset,         // o
+		HostChannel,    // h
+		LoopDirection,  // m
+		Program,        // p
+		Parameter,      // z
+		Checksum,       // s
+	};
+
+	struct Instruction
+	{
+		Op op;
+		uint8 value;
+	};
+
+	CompiledMIDIMacro() = default;
+	explicit CompiledMIDIMacro(const MIDIMacroConfigData::Macro &macro) noexcept;
+
+	const MIDIMacroConfigData::Macro &Source() const noexcept { return m_source; }
+	mpt::span<const Instruction> Instructions() const noexcept { return mpt::as_span(m_instructions).first(m_numInstructions); }
+	// Upper bound of the number of bytes produced by the macro
+	size_t MaxOutputSize() const noexcept { return m_sourceLength; }
+
+private:
+	MIDIMacroConfigData::Macro m_source{};
+	std::array<Instruction, kMacroLength> m_instructions{};
+	uint8 m_numInstructions = 0;
+	uint8 m_sourceLength = 0;
+};
+
+
+// Compiled versions of all macros in a MIDI macro configuration
+class CompiledMIDIMacroConfig
+{
+public:
+	// Compile all macros of the given configuration.
+	void Update(const MIDIMacroConfigData &config) noexcept;
+
+	// Returns the compiled version of a macro that is part of the given configuration,
+	// or nullptr if the macro is not part of it or has been modified since the last call to Update().
+	const CompiledMIDIMacro *Find(const MIDIMacroConfigData &config, const MIDIMacroConfigData::Macro &macro) const noexcept;
+
+private:
+	std::array<CompiledMIDIMacro, kGlobalMacros + kSFxMacros + kZxxMacros> m_macros;
+};
+
+
 OPENMPT_NAMESPACE_END
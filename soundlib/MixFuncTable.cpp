@@ -22,6 +22,9 @@
 #else
 #include "FloatMixer.h"
 #endif // MPT_INTMIXER
+#if defined(MPT_INTMIXER) && defined(MPT_ENABLE_ARCH_INTRINSICS_SSE2)
+#include "../common/mptCPU.h"
+#endif
 
 OPENMPT_NAMESPACE_BEGIN
 
@@ -66,11 +69,36 @@ const MixFuncInterface Functions[6 * 16] =
 	BuildMixFuncTable(AmigaBlepInterpolation), // Amiga emulation
 };
 
+#if defined(MPT_INTMIXER) && defined(MPT_ENABLE_ARCH_INTRINSICS_SSE2)
+const MixFuncInterface FunctionsSSE2[6 * 16] =
+{
+	BuildMixFuncTable(NoInterpolation),            // No SRC
+	BuildMixFuncTable(LinearInterpolation),        // Linear SRC
+	BuildMixFuncTable(FastSincInterpolationSSE2),  // Fast Sinc (Cubic Spline) SRC
+	BuildMixFuncTable(PolyphaseInterpolationSSE2), // Kaiser SRC
+	BuildMixFuncTable(FIRFilterInterpolationSSE2), // FIR SRC
+	BuildMixFuncTable(AmigaBlepInterpolation),     // Amiga emulation
+};
+#endif // MPT_INTMIXER && MPT_ENABLE_ARCH_INTRINSICS_SSE2
+
 #undef BuildMixFuncTableRamp
 #undef BuildMixFuncTableFilter
 #undef BuildMixFuncTable
 
 
+const MixFuncInterface *GetFunctions()
+{
+#if defined(MPT_INTMIXER) && defined(MPT_ENABLE_ARCH_INTRINSICS_SSE2)
+	static const bool useSSE2 = CPU::HasFeatureSet(CPU::feature::sse2) && CPU::HasModesEnabled(CPU::mode::xmm128sse);
+	if(useSSE2)
+	{
+		return FunctionsSSE2;
+	}
+#endif // MPT_INTMIXER && MPT_ENABLE_ARCH_INTRINSICS_SSE2
+	return Functions;
+}
+
+
 ResamplingIndex ResamplingModeToMixFlags(ResamplingMode resamplingMode)
 {
 	switch(resamplingMode)
@@ -16,7 +16,13 @@
 
 OPENMPT_NAMESPACE_BEGIN
 
+// The fixed point mixer is used by default.
+// Define MPT_FLOATMIXER (e.g. with FLOAT_MIXER=1 in the Makefile build) to use the floating point mixer instead.
+// This is a build-time choice only: mixsample_t is also the type of the channel filter and click removal state,
+// the plugin send buffers and the DSP state, so a run-time switch would need two instances of the whole mixing pipeline.
+#ifndef MPT_FLOATMIXER
 #define MPT_INTMIXER
+#endif
 
 #ifdef MPT_INTMIXER
 using mixsample_t = MixSampleIntTraits::sample_type;
@@ -41,7 +47,7 @@ static_assert(MIXING_SCALEF == 134217728.0f);
 static_assert(sizeof(mixsample_t) == 4);
 #endif
 
-#define MIXBUFFERSIZE 512
+#define MIXBUFFERSIZE 512  // Default mix chunk size (see MixerSettings::MixChunkSize), and maximum block size passed to plugins
 #define NUMMIXINPUTBUFFERS 4
 
 #define VOLUMERAMPPRECISION 12	// Fractional bits in volume ramp variables
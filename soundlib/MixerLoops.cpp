@@ -13,6 +13,12 @@
 #include "MixerLoops.h"
 #include "Snd_defs.h"
 #include "ModChannel.h"
+#include "openmpt/soundbase/SampleConvertFixedPoint.hpp"
+
+#if defined(MPT_ENABLE_ARCH_INTRINSICS_SSE2)
+#include "../common/mptCPU.h"
+#include <emmintrin.h>
+#endif
 
 
 OPENMPT_NAMESPACE_BEGIN
@@ -166,4 +172,195 @@ void DeinterleaveStereo(const mixsample_t * MPT_RESTRICT input, mixsample_t * MP
 
 
 
+// Output conversion. The SSE2 code paths produce bit-identical results to the generic code.
+
+static_assert(MIXING_FRACTIONAL_BITS == 27);
+
+using ConvertMixSampleToInt16 = SC::ConvertFixedPoint<int16, int32, MIXING_FRACTIONAL_BITS>;
+using ConvertMixSampleToFloat = SC::ConvertFixedPoint<float32, int32, MIXING_FRACTIONAL_BITS>;
+
+#if defined(MPT_ENABLE_ARCH_INTRINSICS_SSE2)
+
+static bool UseSSE2ForOutputConversion() noexcept
+{
+	return CPU::HasFeatureSet(CPU::feature::sse2) && CPU::HasModesEnabled(CPU::mode::xmm128sse);
+}
+
+// Same as ConvertMixSampleToInt16, minus the saturation which is done by _mm_packs_epi32
+static MPT_FORCEINLINE __m128i RoundMixToInt16SSE2(__m128i x) noexcept
+{
+	constexpr int shift = ConvertMixSampleToInt16::shiftBits;
+	return _mm_srai_epi32(_mm_add_epi32(x, _mm_set1_epi32(1 << (shift - 1))), shift);
+}
+
+static MPT_FORCEINLINE __m128 ConvertMixToFloatSSE2(__m128i x, __m128 gain) noexcept
+{
+	return _mm_mul_ps(_mm_mul_ps(_mm_cvtepi32_ps(x), _mm_set1_ps(1.0f / static_cast<float>(1 << MIXING_FRACTIONAL_BITS))), gain);
+}
+
+static MPT_FORCEINLINE __m128i LoadMixSSE2(const int32 *input) noexcept
+{
+	return _mm_loadu_si128(reinterpret_cast<const __m128i *>(input));
+}
+
+// Gather even and odd elements of two vectors
+static MPT_FORCEINLINE __m128i EvenSSE2(__m128i a, __m128i b) noexcept
+{
+	return _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b), _MM_SHUFFLE(2, 0, 2, 0)));
+}
+static MPT_FORCEINLINE __m128i OddSSE2(__m128i a, __m128i b) noexcept
+{
+	return _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b), _MM_SHUFFLE(3, 1, 3, 1)));
+}
+
+static MPT_FORCEINLINE void Transpose4x4SSE2(__m128i &a, __m128i &b, __m128i &c, __m128i &d) noexcept
+{
+	const __m128i ab0 = _mm_unpacklo_epi32(a, b), ab1 = _mm_unpackhi_epi32(a, b);
+	const __m128i cd0 = _mm_unpacklo_epi32(c, d), cd1 = _mm_unpackhi_epi32(c, d);
+	a = _mm_unpacklo_epi64(ab0, cd0);
+	b = _mm_unpackhi_epi64(ab0, cd0);
+	c = _mm_unpacklo_epi64(ab1, cd1);
+	d = _mm_unpackhi_epi64(ab1, cd1);
+}
+
+#endif // MPT_ENABLE_ARCH_INTRINSICS_SSE2
+
+
+void ConvertMixToInt16(const int32 *input, int16 *output, size_t numSamples)
+{
+	size_t i = 0;
+#if defined(MPT_ENABLE_ARCH_INTRINSICS_SSE2)
+	if(UseSSE2ForOutputConversion())
+	{
+		for(; i + 8 <= numSamples; i += 8)
+		{
+			const __m128i a = RoundMixToInt16SSE2(LoadMixSSE2(input + i));
+			const __m128i b = RoundMixToInt16SSE2(LoadMixSSE2(input + i + 4));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(output + i), _mm_packs_epi32(a, b));
+		}
+	}
+#endif // MPT_ENABLE_ARCH_INTRINSICS_SSE2
+	ConvertMixSampleToInt16 conv;
+	for(; i < numSamples; i++)
+	{
+		output[i] = conv(input[i]);
+	}
+}
+
+
+void ConvertMixToInt16Planar(const int32 *input, int16 * const *outputs, size_t numChannels, size_t numFrames, size_t outputOffset)
+{
+	if(numChannels == 1)
+	{
+		ConvertMixToInt16(input, outputs[0] + outputOffset, numFrames);
+		return;
+	}
+	size_t frame = 0;
+#if defined(MPT_ENABLE_ARCH_INTRINSICS_SSE2)
+	if(UseSSE2ForOutputConversion() && numChannels == 2)
+	{
+		int16 *outL = outputs[0] + outputOffset, *outR = outputs[1] + outputOffset;
+		for(; frame + 8 <= numFrames; frame += 8)
+		{
+			const int32 *in = input + frame * 2;
+			const __m128i a = RoundMixToInt16SSE2(LoadMixSSE2(in)), b = RoundMixToInt16SSE2(LoadMixSSE2(in + 4));
+			const __m128i c = RoundMixToInt16SSE2(LoadMixSSE2(in + 8)), d = RoundMixToInt16SSE2(LoadMixSSE2(in + 12));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(outL + frame), _mm_packs_epi32(EvenSSE2(a, b), EvenSSE2(c, d)));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(outR + frame), _mm_packs_epi32(OddSSE2(a, b), OddSSE2(c, d)));
+		}
+	} else if(UseSSE2ForOutputConversion() && numChannels == 4)
+	{
+		for(; frame + 8 <= numFrames; frame += 8)
+		{
+			const int32 *in = input + frame * 4;
+			__m128i a0 = RoundMixToInt16SSE2(LoadMixSSE2(in)), b0 = RoundMixToInt16SSE2(LoadMixSSE2(in + 4));
+			__m128i c0 = RoundMixToInt16SSE2(LoadMixSSE2(in + 8)), d0 = RoundMixToInt16SSE2(LoadMixSSE2(in + 12));
+			__m128i a1 = RoundMixToInt16SSE2(LoadMixSSE2(in + 16)), b1 = RoundMixToInt16SSE2(LoadMixSSE2(in + 20));
+			__m128i c1 = RoundMixToInt16SSE2(LoadMixSSE2(in + 24)), d1 = RoundMixToInt16SSE2(LoadMixSSE2(in + 28));
+			Transpose4x4SSE2(a0, b0, c0, d0);
+			Transpose4x4SSE2(a1, b1, c1, d1);
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(outputs[0] + outputOffset + frame), _mm_packs_epi32(a0, a1));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(outputs[1] + outputOffset + frame), _mm_packs_epi32(b0, b1));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(outputs[2] + outputOffset + frame), _mm_packs_epi32(c0, c1));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(outputs[3] + outputOffset + frame), _mm_packs_epi32(d0, d1));
+		}
+	}
+#endif // MPT_ENABLE_ARCH_INTRINSICS_SSE2
+	ConvertMixSampleToInt16 conv;
+	for(; frame < numFrames; frame++)
+	{
+		for(size_t channel = 0; channel < numChannels; channel++)
+		{
+			outputs[channel][outputOffset + frame] = conv(input[frame * numChannels + channel]);
+		}
+	}
+}
+
+
+void ConvertMixToFloat(const int32 *input, float *output, size_t numSamples, float gain)
+{
+	size_t i = 0;
+#if defined(MPT_ENABLE_ARCH_INTRINSICS_SSE2)
+	if(UseSSE2ForOutputConversion())
+	{
+		const __m128 gainVec = _mm_set1_ps(gain);
+		for(; i + 4 <= numSamples; i += 4)
+		{
+			_mm_storeu_ps(output + i, ConvertMixToFloatSSE2(LoadMixSSE2(input + i), gainVec));
+		}
+	}
+#endif // MPT_ENABLE_ARCH_INTRINSICS_SSE2
+	ConvertMixSampleToFloat conv;
+	for(; i < numSamples; i++)
+	{
+		output[i] = conv(input[i]) * gain;
+	}
+}
+
+
+void ConvertMixToFloatPlanar(const int32 *input, float * const *outputs, size_t numChannels, size_t numFrames, size_t outputOffset, float gain)
+{
+	if(numChannels == 1)
+	{
+		ConvertMixToFloat(input, outputs[0] + outputOffset, numFrames, gain);
+		return;
+	}
+	size_t frame = 0;
+#if defined(MPT_ENABLE_ARCH_INTRINSICS_SSE2)
+	const __m128 gainVec = _mm_set1_ps(gain);
+	if(UseSSE2ForOutputConversion() && numChannels == 2)
+	{
+		for(; frame + 4 <= numFrames; frame += 4)
+		{
+			const int32 *in = input + frame * 2;
+			const __m128i a = LoadMixSSE2(in), b = LoadMixSSE2(in + 4);
+			_mm_storeu_ps(outputs[0] + outputOffset + frame, ConvertMixToFloatSSE2(EvenSSE2(a, b), gainVec));
+			_mm_storeu_ps(outputs[1] + outputOffset + frame, ConvertMixToFloatSSE2(OddSSE2(a, b), gainVec));
+		}
+	} else if(UseSSE2ForOutputConversion() && numChannels == 4)
+	{
+		for(; frame + 4 <= numFrames; frame += 4)
+		{
+			const int32 *in = input + frame * 4;
+			__m128i a = LoadMixSSE2(in), b = LoadMixSSE2(in + 4), c = LoadMixSSE2(in + 8), d = LoadMixSSE2(in + 12);
+			Transpose4x4SSE2(a, b, c, d);
+			_mm_storeu_ps(outputs[0] + outputOffset + frame, ConvertMixToFloatSSE2(a, gainVec));
+			_mm_storeu_ps(outputs[1] + outputOffset + frame, ConvertMixToFloatSSE2(b, gainVec));
+			_mm_storeu_ps(outputs[2] + outputOffset + frame, ConvertMixToFloatSSE2(c, gainVec));
+			_mm_storeu_ps(outputs[3] + outputOffset + frame, ConvertMixToFloatSSE2(d, gainVec));
+		}
+	}
+#endif // MPT_ENABLE_ARCH_INTRINSICS_SSE2
+	ConvertMixSampleToFloat conv;
+	for(; frame < numFrames; frame++)
+	{
+		for(size_t channel = 0; channel < numChannels; channel++)
+		{
+			outputs[channel][outputOffset + frame] = conv(input[frame * numChannels + channel]) * gain;
+		}
+	}
+}
+
+
+
 OPENMPT_NAMESPACE_END
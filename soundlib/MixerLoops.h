@@ -30,6 +30,14 @@ void InterleaveStereo(const mixsample_t * MPT_RESTRICT inputL, const mixsample_t
 void DeinterleaveStereo(const mixsample_t * MPT_RESTRICT input, mixsample_t * MPT_RESTRICT outputL, mixsample_t * MPT_RESTRICT outputR, size_t numSamples);
 #endif
 
+// Convert interleaved fixed-point mix samples to the output format. Rounding and saturation are identical to SC::ConvertFixedPoint.
+// Planar variants write numFrames frames to each output buffer, starting at frame outputOffset.
+// The float variants additionally apply a gain factor.
+void ConvertMixToInt16(const int32 *input, int16 *output, size_t numSamples);
+void ConvertMixToInt16Planar(const int32 *input, int16 * const *outputs, size_t numChannels, size_t numFrames, size_t outputOffset);
+void ConvertMixToFloat(const int32 *input, float *output, size_t numSamples, float gain);
+void ConvertMixToFloatPlanar(const int32 *input, float * const *outputs, size_t numChannels, size_t numFrames, size_t outputOffset, float gain);
+
 void EndChannelOfs(ModChannel &chn, mixsample_t *pBuffer, uint32 nSamples);
 void StereoFill(mixsample_t *pBuffer, uint32 nSamples, mixsample_t &rofs, mixsample_t &lofs);
 
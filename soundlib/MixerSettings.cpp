@@ -10,6 +10,7 @@
 #include "stdafx.h"
 #include "MixerSettings.h"
 #include "Snd_defs.h"
+#include "Mixer.h"
 #include "../common/misc_util.h"
 
 OPENMPT_NAMESPACE_BEGIN
@@ -35,6 +36,10 @@ MixerSettings::MixerSettings()
 
 	NumInputChannels = 0;
 
+	NumMixThreads = 1;
+
+	MixChunkSize = MIXBUFFERSIZE;
+
 }
 
 int32 MixerSettings::GetVolumeRampUpSamples() const
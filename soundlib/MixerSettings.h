@@ -28,6 +28,10 @@ struct MixerSettings
 	uint32 gnChannels;
 	uint32 m_nPreAmp;
 	std::size_t NumInputChannels;
+	uint32 NumMixThreads;  // Number of threads used for mixing sample voices (0 or 1 = only mix on the calling thread)
+	uint32 MixChunkSize;   // Maximum number of frames that are rendered in one go
+	enum : uint32 { MinMixChunkSize = 16, MaxMixChunkSize = 16384 };
+	enum : uint32 { MaxMixThreads = 64 };  // Every thread mixes at least four of at most 256 voices, so more threads would never have anything to do
 
 	int32 VolumeRampUpMicroseconds;
 	int32 VolumeRampDownMicroseconds;
@@ -44,7 +48,7 @@ struct MixerSettings
 	
 	bool IsValid() const
 	{
-		return (gdwMixingFreq > 0) && (gnChannels == 1 || gnChannels == 2 || gnChannels == 4) && (NumInputChannels == 0 || NumInputChannels == 1 || NumInputChannels == 2 || NumInputChannels == 4);
+		return (gdwMixingFreq > 0) && (gnChannels == 1 || gnChannels == 2 || gnChannels == 4) && (NumInputChannels == 0 || NumInputChannels == 1 || NumInputChannels == 2 || NumInputChannels == 4) && (MixChunkSize >= MinMixChunkSize && MixChunkSize <= MaxMixChunkSize);
 	}
 	
 	MixerSettings();
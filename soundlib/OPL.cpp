@@ -11,6 +11,7 @@
 #include "stdafx.h"
 #include "../common/misc_util.h"
 #include "OPL.h"
+#include "Mixer.h"
 
 #include <cstdint>
 #if MPT_COMPILER_GCC
@@ -60,13 +61,39 @@ void OPL::Mix(int32 *target, size_t count, uint32 volumeFactorQ16)
 
 	// This factor causes a sample voice to be more or less as loud as an OPL voice
 	const int32 factor = Util::muldiv_unsigned(volumeFactorQ16, 6169, (1 << 16));
-	while(count--)
+	std::array<int16, 2 * 256> buffer;
+	while(count)
 	{
-		int16 l, r;
-		m_opl->Sample(&l, &r);
-		target[0] += l * factor;
-		target[1] += r * factor;
-		target += 2;
+		const size_t block = std::min(count, buffer.size() / 2);
+		m_opl->SampleBlock(buffer.data(), block);
+		for(size_t i = 0; i < block * 2; i++)
+		{
+			target[i] += buffer[i] * factor;
+		}
+		target += block * 2;
+		count -= block;
+	}
+}
+
+
+void OPL::Mix(float *target, size_t count, uint32 volumeFactorQ16)
+{
+	if(!m_isActive)
+		return;
+
+	// Same gain as the fixed point version, with 1.0 corresponding to a full scale mix sample
+	const float factor = static_cast<float>(Util::muldiv_unsigned(volumeFactorQ16, 6169, (1 << 16))) * (1.0f / MIXING_SCALEF);
+	std::array<int16, 2 * 256> buffer;
+	while(count)
+	{
+		const size_t block = std::min(count, buffer.size() / 2);
+		m_opl->SampleBlock(buffer.data(), block);
+		for(size_t i = 0; i < block * 2; i++)
+		{
+			target[i] += buffer[i] * factor;
+		}
+		target += block * 2;
+		count -= block;
 	}
 }
 
@@ -80,6 +80,7 @@ public:
 
 	void Initialize(uint32 samplerate);
 	void Mix(int32 *buffer, size_t count, uint32 volumeFactorQ16);
+	void Mix(float *buffer, size_t count, uint32 volumeFactorQ16);
 
 	void NoteOff(CHANNELINDEX c);
 	void NoteCut(CHANNELINDEX c, bool unassign = true);
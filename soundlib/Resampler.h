@@ -17,6 +17,8 @@
 #include "MixerSettings.h"
 #include "Paula.h"
 
+#include <memory>
+
 
 OPENMPT_NAMESPACE_BEGIN
 
@@ -25,8 +27,9 @@ OPENMPT_NAMESPACE_BEGIN
 // All these optimizations are not applicable to the tracker
 // because cutoff and firtype are configurable there.
 
-// Cache resampler tables across resampler object creation.
-// A C++11-style function-static singleton is holding the cached values.
+// Share the windowed FIR table for the default settings across all resampler objects.
+// A C++11-style function-static singleton is holding the cached table.
+// The settings-independent tables are always shared.
 #define MPT_RESAMPLER_TABLES_CACHED
 
 // Prime the tables cache when the library is loaded.
@@ -78,53 +81,46 @@ public:
 };
 
 
-class CResampler
+// Resampler tables that do not depend on the resampler settings.
+// A single instance of these tables is shared by all resamplers.
+struct ResamplerTables
 {
-public:
-	CResamplerSettings m_Settings;
-	CWindowedFIR m_WindowedFIR;
-	static const int16 FastSincTable[256 * 4];
-
-#ifdef MODPLUG_TRACKER
-	static bool StaticTablesInitialized;
-	#define RESAMPLER_TABLE static
-#else
-	// no global data which has to be initialized by hand in the library
-	#define RESAMPLER_TABLE 
-#endif // MODPLUG_TRACKER
-
-	RESAMPLER_TABLE SINC_TYPE gKaiserSinc[SINC_PHASES * 8];     // Upsampling
-	RESAMPLER_TABLE SINC_TYPE gDownsample13x[SINC_PHASES * 8];  // Downsample 1.333x
-	RESAMPLER_TABLE SINC_TYPE gDownsample2x[SINC_PHASES * 8];   // Downsample 2x
-	RESAMPLER_TABLE Paula::BlepTables blepTables;               // Amiga BLEP resampler
+	SINC_TYPE gKaiserSinc[SINC_PHASES * 8];     // Upsampling
+	SINC_TYPE gDownsample13x[SINC_PHASES * 8];  // Downsample 1.333x
+	SINC_TYPE gDownsample2x[SINC_PHASES * 8];   // Downsample 2x
+	Paula::BlepTables blepTables;               // Amiga BLEP resampler
 
 #ifndef MPT_INTMIXER
-	RESAMPLER_TABLE mixsample_t FastSincTablef[256 * 4];	// Cubic spline LUT
-	RESAMPLER_TABLE mixsample_t LinearTablef[256];		// Linear interpolation LUT
+	mixsample_t FastSincTablef[256 * 4];  // Cubic spline LUT
 #endif // !defined(MPT_INTMIXER)
 
-#undef RESAMPLER_TABLE
+	void InitTables();
+};
+
+
+class CResampler
+{
+public:
+	CResamplerSettings m_Settings;
+	static const int16 FastSincTable[256 * 4];
 
 private:
+	std::shared_ptr<const ResamplerTables> m_Tables;
+	std::shared_ptr<const CWindowedFIR> m_WindowedFIR;
 	CResamplerSettings m_OldSettings;
+
 public:
-	CResampler(bool fresh_generate=false)
+	CResampler()
 	{
-		if(fresh_generate)
-		{
-			InitializeTablesFromScratch(true);
-		} else
-		{
-			InitializeTables();
-		}
+		InitializeTables();
 	}
+
+	const ResamplerTables &Tables() const noexcept { return *m_Tables; }
+	const CWindowedFIR &WindowedFIR() const noexcept { return *m_WindowedFIR; }
+
 	void InitializeTables()
 	{
-		#if defined(MPT_RESAMPLER_TABLES_CACHED)
-			InitializeTablesFromCache();
-		#else
-			InitializeTablesFromScratch(true);
-		#endif
+		InitializeTablesFromScratch(true);
 	}
 	void UpdateTables()
 	{
@@ -132,11 +128,7 @@ public:
 	}
 
 private:
-	void InitFloatmixerTables();
 	void InitializeTablesFromScratch(bool force=false);
-#ifdef MPT_RESAMPLER_TABLES_CACHED
-	void InitializeTablesFromCache();
-#endif
 };
 
 
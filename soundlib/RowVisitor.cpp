@@ -69,6 +69,33 @@ void RowVisitor::MoveVisitedRowsFrom(RowVisitor &other) noexcept
 }
 
 
+void RowVisitor::CopyVisitedRowsFrom(const RowVisitor &other)
+{
+	m_visitedRows.resize(other.m_visitedRows.size());
+	for(size_t ord = 0; ord < m_visitedRows.size(); ord++)
+	{
+		m_visitedRows[ord] = other.m_visitedRows[ord];
+	}
+	m_visitedLoopStates = other.m_visitedLoopStates;
+	m_rowsSpentInLoops = other.m_rowsSpentInLoops;
+}
+
+
+size_t RowVisitor::GetMemoryUsage() const noexcept
+{
+	size_t size = sizeof(*this) + m_visitedRows.capacity() * sizeof(m_visitedRows[0]);
+	for(const auto &rows : m_visitedRows)
+	{
+		size += (rows.capacity() + 7) / 8u;
+	}
+	for(const auto &[pos, loopStates] : m_visitedLoopStates)
+	{
+		size += sizeof(pos) + sizeof(loopStates) + loopStates.capacity() * sizeof(LoopState) + 4 * sizeof(void *);
+	}
+	return size;
+}
+
+
 const ModSequence &RowVisitor::Order() const
 {
 	if(m_sequence >= m_sndFile.Order.GetNumSequences())
@@ -83,6 +83,8 @@ public:
 	RowVisitor(const CSoundFile &sndFile, SEQUENCEINDEX sequence = SEQUENCEINDEX_INVALID);
 	
 	void MoveVisitedRowsFrom(RowVisitor &other) noexcept;
+	// Copy the visited rows from another visitor of the same module and sequence, reusing the already allocated memory where possible.
+	void CopyVisitedRowsFrom(const RowVisitor &other);
 
 	// Resize / Clear the row vector.
 	// If reset is true, the vector is not only resized to the required dimensions, but also completely cleared (i.e. all visited rows are unset).
@@ -102,6 +104,9 @@ public:
 	[[nodiscard]] bool ModuleTooComplex(ROWINDEX threshold) const noexcept { return m_rowsSpentInLoops >= threshold; }
 	void ResetComplexity() { m_rowsSpentInLoops = 0; }
 
+	// Approximate amount of memory occupied by the visited rows state, in bytes.
+	[[nodiscard]] size_t GetMemoryUsage() const noexcept;
+
 protected:
 	// Get the needed vector size for a given pattern.
 	[[nodiscard]] ROWINDEX VisitedRowsVectorSize(PATTERNINDEX pattern) const noexcept;
@@ -0,0 +1,170 @@
+/*
+ * SharedSamples.cpp
+ * -----------------
+ * Purpose: Decoded sample data that is shared between all instances of the same module (see CSoundFile::shareSampleData).
+ * Notes  : Shared sample data is read-only. It is only freed once the last module instance using it is destroyed.
+ *          Modules are looked up by a hash of the file contents. A copy of the file is kept to confirm that a match really is the same file.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#include "stdafx.h"
+#include "SharedSamples.h"
+
+#include "mpt/crc/crc.hpp"
+#include "mpt/mutex/mutex.hpp"
+
+#include <algorithm>
+#include <map>
+
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+namespace
+{
+
+struct SharedSampleRegistry
+{
+	mpt::mutex mutex;
+	std::map<SharedSamples::Key, std::weak_ptr<const SharedSamples>> modules;
+};
+
+SharedSampleRegistry &GetRegistry()
+{
+	static SharedSampleRegistry registry;
+	return registry;
+}
+
+}  // namespace
+
+
+SharedSamples::Key SharedSamples::GetKey(FileReader file)
+{
+	file.Rewind();
+	const auto view = file.GetPinnedView();
+	Key key;
+	key.hash = mpt::crc64_jones{}(view.span().begin(), view.span().end()).result();
+	key.size = view.size();
+	return key;
+}
+
+
+std::shared_ptr<const SharedSamples> SharedSamples::Find(const Key &key, FileReader file)
+{
+	std::shared_ptr<const SharedSamples> shared;
+	{
+		SharedSampleRegistry &registry = GetRegistry();
+		mpt::lock_guard<mpt::mutex> lock(registry.mutex);
+		if(auto it = registry.modules.find(key); it != registry.modules.end())
+			shared = it->second.lock();
+	}
+	if(!shared)
+		return nullptr;
+	// CRC-64 is not collision-resistant, so make sure that this really is the same file
+	file.Rewind();
+	const auto view = file.GetPinnedView();
+	if(!std::equal(view.span().begin(), view.span().end(), shared->m_fileData.begin(), shared->m_fileData.end()))
+		return nullptr;
+	return shared;
+}
+
+
+std::shared_ptr<const SharedSamples> SharedSamples::Publish(const Key &key, std::vector<std::byte> fileData, SampleArray &samples, SAMPLEINDEX numSamples)
+{
+	auto shared = std::make_shared<const SharedSamples>(std::move(fileData), samples, numSamples);
+	SharedSampleRegistry &registry = GetRegistry();
+	mpt::lock_guard<mpt::mutex> lock(registry.mutex);
+	// Forget about modules that are no longer loaded
+	for(auto it = registry.modules.begin(); it != registry.modules.end();)
+	{
+		if(it->second.expired())
+			it = registry.modules.erase(it);
+		else
+			++it;
+	}
+	registry.modules[key] = shared;
+	return shared;
+}
+
+
+SharedSamples::SharedSamples(std::vector<std::byte> fileData, SampleArray &samples, SAMPLEINDEX numSamples)
+    : m_fileData{std::move(fileData)}
+{
+	m_samples.reserve(numSamples);
+	for(SAMPLEINDEX smp = 1; smp <= numSamples; smp++)
+	{
+		m_samples.emplace_back(samples[smp]);
+	}
+}
+
+
+SharedSamples::~SharedSamples()
+{
+	for(auto &sample : m_samples)
+	{
+		ModSample::FreeSample(sample.data);
+	}
+}
+
+
+bool SharedSamples::Attach(SAMPLEINDEX smp, ModSample &sample) const
+{
+	if(smp < 1 || smp > m_samples.size() || !m_samples[smp - 1].Matches(sample))
+		return false;
+	if(sample.samplev() != m_samples[smp - 1].data)
+	{
+		sample.FreeSample();
+		sample.pData.pSample = m_samples[smp - 1].data;
+	}
+	return true;
+}
+
+
+void SharedSamples::Detach(SampleArray &samples) const
+{
+	samples.ForEachAllocated([this](ModSample &sample)
+	{
+		if(Contains(sample.samplev()))
+			sample.pData.pSample = nullptr;
+	});
+}
+
+
+bool SharedSamples::Contains(const void *sampleData) const noexcept
+{
+	if(!sampleData)
+		return false;
+	for(const auto &sample : m_samples)
+	{
+		if(sample.data == sampleData)
+			return true;
+	}
+	return false;
+}
+
+
+SharedSamples::Sample::Sample(const ModSample &sample)
+    : data{sample.HasSampleData() ? const_cast<void *>(sample.samplev()) : nullptr}
+    , length{sample.nLength}
+    , loopStart{sample.nLoopStart}
+    , loopEnd{sample.nLoopEnd}
+    , sustainStart{sample.nSustainStart}
+    , sustainEnd{sample.nSustainEnd}
+    , flags{sample.uFlags & LayoutFlags}
+{
+}
+
+
+bool SharedSamples::Sample::Matches(const ModSample &sample) const noexcept
+{
+	return data != nullptr
+		&& length == sample.nLength
+		&& loopStart == sample.nLoopStart && loopEnd == sample.nLoopEnd
+		&& sustainStart == sample.nSustainStart && sustainEnd == sample.nSustainEnd
+		&& flags == (sample.uFlags & LayoutFlags);
+}
+
+
+OPENMPT_NAMESPACE_END
@@ -0,0 +1,86 @@
+/*
+ * SharedSamples.h
+ * ---------------
+ * Purpose: Decoded sample data that is shared between all instances of the same module (see CSoundFile::shareSampleData).
+ * Notes  : Shared sample data is read-only. It is only freed once the last module instance using it is destroyed.
+ *          Modules are looked up by a hash of the file contents. A copy of the file is kept to confirm that a match really is the same file.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+
+#pragma once
+
+#include "openmpt/all/BuildSettings.hpp"
+
+#include "../common/FileReader.h"
+#include "ChunkedArray.h"
+#include "ModSample.h"
+#include "Snd_defs.h"
+
+#include <memory>
+#include <vector>
+
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+class SharedSamples
+{
+public:
+	struct Key
+	{
+		uint64 hash = 0;
+		uint64 size = 0;
+
+		friend bool operator<(const Key &l, const Key &r) noexcept { return l.hash < r.hash || (l.hash == r.hash && l.size < r.size); }
+	};
+
+	using SampleArray = ChunkedArray<ModSample, MAX_SAMPLES>;
+
+	// Compute the cache key for a module file.
+	static Key GetKey(FileReader file);
+
+	// Get the sample data of a module that is currently loaded by another instance, or nullptr if there is none.
+	// file must be the file that key was computed from. It is compared to the file of the other instance, as the hash may collide.
+	static std::shared_ptr<const SharedSamples> Find(const Key &key, FileReader file);
+	// Make the sample data of a freshly loaded module available to other instances.
+	// fileData must contain the complete file that key was computed from.
+	// The returned object takes ownership of the sample data, but the samples keep pointing to it.
+	static std::shared_ptr<const SharedSamples> Publish(const Key &key, std::vector<std::byte> fileData, SampleArray &samples, SAMPLEINDEX numSamples);
+
+	SharedSamples(std::vector<std::byte> fileData, SampleArray &samples, SAMPLEINDEX numSamples);
+	~SharedSamples();
+
+	SharedSamples(const SharedSamples &) = delete;
+	SharedSamples &operator=(const SharedSamples &) = delete;
+
+	// If the sample header set up by a loader matches the shared sample, free any sample data it has and let it point to the shared data instead.
+	// Returns false and leaves the sample untouched if it does not match or if there is no shared data for this sample.
+	bool Attach(SAMPLEINDEX smp, ModSample &sample) const;
+	// Make sure that the samples do not free the shared sample data.
+	void Detach(SampleArray &samples) const;
+	bool Contains(const void *sampleData) const noexcept;
+
+protected:
+	static constexpr ChannelFlags LayoutFlags = (CHN_16BIT | CHN_STEREO | CHN_LOOP | CHN_PINGPONGLOOP | CHN_SUSTAINLOOP | CHN_PINGPONGSUSTAIN | CHN_ADLIB).as_enum();
+
+	// Everything that affects the size and contents of a sample buffer, including the pre-computed loop wrap-around buffers
+	struct Sample
+	{
+		void *data = nullptr;
+		SmpLength length = 0;
+		SmpLength loopStart = 0, loopEnd = 0;
+		SmpLength sustainStart = 0, sustainEnd = 0;
+		SampleFlags flags;
+
+		explicit Sample(const ModSample &sample);
+		bool Matches(const ModSample &sample) const noexcept;
+	};
+
+	std::vector<std::byte> m_fileData;  // The file this sample data was decoded from
+	std::vector<Sample> m_samples;      // Index 0 = sample 1
+};
+
+
+OPENMPT_NAMESPACE_END
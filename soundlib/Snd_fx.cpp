@@ -70,11 +70,23 @@ public:
 
 	GetLengthMemory(const CSoundFile &sf)
 		: sndFile(sf)
-		, state(std::make_unique<CSoundFile::PlayState>(sf.m_PlayState))
+		, state(sf.AcquireLengthPlayState())
 	{
+		// Background channels are not touched by the simulation, so only the pattern channels are needed
+		state->AssignPatternState(sf.m_PlayState, sf.GetNumChannels());
 		Reset();
 	}
 
+	GetLengthMemory(const CSoundFile &sf, const SeekIndex::Checkpoint &checkpoint);
+
+	~GetLengthMemory()
+	{
+		sndFile.ReleaseLengthPlayState(std::move(state));
+	}
+
+	GetLengthMemory(const GetLengthMemory &) = delete;
+	GetLengthMemory &operator=(const GetLengthMemory &) = delete;
+
 	void Reset()
 	{
 		if(state->m_midiMacroEvaluationResults)
@@ -277,6 +289,153 @@ public:
 };
 
 
+// Snapshot of everything that is carried over from one row to the next in GetLength()
+struct SeekIndex::Checkpoint
+{
+	CSoundFile::PlayState::Snapshot state;
+	std::vector<GetLengthMemory::ChnSettings> chnSettings;
+	RowVisitor visitedRows;
+	GetLengthType retval;
+	double elapsedTime;
+	uint32 oldTickDuration;
+	ROWINDEX allowedPatternLoopComplexity;
+	bool breakToRow;
+
+	Checkpoint(const GetLengthMemory &memory, const RowVisitor &visitedRows, const GetLengthType &retval, uint32 oldTickDuration, ROWINDEX allowedPatternLoopComplexity, bool breakToRow)
+		: chnSettings(memory.chnSettings)
+		, visitedRows(visitedRows)
+		, retval(retval)
+		, elapsedTime(memory.elapsedTime)
+		, oldTickDuration(oldTickDuration)
+		, allowedPatternLoopComplexity(allowedPatternLoopComplexity)
+		, breakToRow(breakToRow)
+	{
+		// Background channels are not touched by the simulation, so only the pattern channels are needed
+		memory.state->Save(state, static_cast<CHANNELINDEX>(memory.chnSettings.size()), false);
+	}
+
+	size_t GetMemoryUsage() const noexcept
+	{
+		return sizeof(*this) + chnSettings.capacity() * sizeof(GetLengthMemory::ChnSettings) + state.GetMemoryUsage() + visitedRows.GetMemoryUsage();
+	}
+};
+
+
+GetLengthMemory::GetLengthMemory(const CSoundFile &sf, const SeekIndex::Checkpoint &checkpoint)
+	: sndFile(sf)
+	, state(sf.AcquireLengthPlayState())
+	, chnSettings(checkpoint.chnSettings)
+	, elapsedTime(checkpoint.elapsedTime)
+{
+	state->Restore(checkpoint.state);
+}
+
+
+std::unique_ptr<CSoundFile::PlayState> CSoundFile::AcquireLengthPlayState() const
+{
+	{
+		mpt::lock_guard<mpt::mutex> lock(m_lengthPlayStatesMutex);
+		if(!m_lengthPlayStates.empty())
+		{
+			std::unique_ptr<PlayState> state = std::move(m_lengthPlayStates.back());
+			m_lengthPlayStates.pop_back();
+			return state;
+		}
+	}
+	return std::make_unique<PlayState>();
+}
+
+
+void CSoundFile::ReleaseLengthPlayState(std::unique_ptr<PlayState> state) const
+{
+	if(!state)
+		return;
+	mpt::lock_guard<mpt::mutex> lock(m_lengthPlayStatesMutex);
+	m_lengthPlayStates.push_back(std::move(state));
+}
+
+
+SeekIndex::SeekIndex(double interval, size_t maxMemory)
+	: m_interval(interval)
+	, m_maxMemory(maxMemory)
+{
+}
+
+
+SeekIndex::~SeekIndex() = default;
+
+
+void SeekIndex::SetInterval(double interval)
+{
+	if(interval != m_interval)
+	{
+		m_interval = interval;
+		Clear();
+	}
+}
+
+
+void SeekIndex::SetMaxMemory(size_t maxMemory)
+{
+	m_maxMemory = maxMemory;
+	while(m_memoryUsage > m_maxMemory && !m_checkpoints.empty())
+	{
+		m_memoryUsage -= m_checkpoints.back()->GetMemoryUsage();
+		m_checkpoints.pop_back();
+	}
+}
+
+
+void SeekIndex::Clear() noexcept
+{
+	m_checkpoints.clear();
+	m_memoryUsage = 0;
+	m_key = Key{};
+}
+
+
+void SeekIndex::Prepare(const Key &key) noexcept
+{
+	if(key != m_key)
+	{
+		Clear();
+		m_key = key;
+	}
+}
+
+
+const SeekIndex::Checkpoint *SeekIndex::FindCheckpoint(double time) const noexcept
+{
+	auto it = std::lower_bound(m_checkpoints.begin(), m_checkpoints.end(), time, [](const std::unique_ptr<Checkpoint> &checkpoint, double t) { return checkpoint->elapsedTime < t; });
+	if(it == m_checkpoints.begin())
+		return nullptr;
+	return (it - 1)->get();
+}
+
+
+bool SeekIndex::WantCheckpoint(double time) const noexcept
+{
+	if(m_interval <= 0.0 || m_memoryUsage >= m_maxMemory)
+		return false;
+	const double lastTime = m_checkpoints.empty() ? 0.0 : m_checkpoints.back()->elapsedTime;
+	return time >= lastTime + m_interval;
+}
+
+
+void SeekIndex::AddCheckpoint(std::unique_ptr<Checkpoint> checkpoint)
+{
+	const size_t size = checkpoint->GetMemoryUsage();
+	if(m_memoryUsage + size > m_maxMemory)
+	{
+		// Don't try again in this subsong
+		m_memoryUsage = m_maxMemory;
+		return;
+	}
+	m_memoryUsage += size;
+	m_checkpoints.push_back(std::move(checkpoint));
+}
+
+
 // Get mod length in various cases. Parameters:
 // [in]  adjustMode: See enmGetLengthResetMode for possible adjust modes.
 // [in]  target: Time or position target which should be reached, or no target to get length of the first sub song. Use GetLengthTarget::StartPos to also specify a position from where the seeking should begin.
@@ -294,20 +453,35 @@ std::vector<GetLengthType> CSoundFile::GetLength(enmGetLengthResetMode adjustMod
 	if(sequence >= Order.GetNumSequences()) sequence = Order.GetCurrentSequenceIndex();
 	const ModSequence &orderList = Order(sequence);
 
-	GetLengthMemory memory(*this);
+	// When seeking to a time target, resume from the closest snapshot if we have been here before
+	SeekIndex *seekIndex = (target.mode == GetLengthTarget::SeekSeconds) ? target.seekIndex : nullptr;
+	const SeekIndex::Checkpoint *checkpoint = nullptr;
+	if(seekIndex)
+	{
+		seekIndex->Prepare({sequence, target.startOrder, target.startRow, adjustMode, m_MixerSettings.gdwMixingFreq, m_nTempoFactor});
+		checkpoint = seekIndex->FindCheckpoint(target.time);
+	}
+
+	GetLengthMemory memory = checkpoint ? GetLengthMemory(*this, *checkpoint) : GetLengthMemory(*this);
 	CSoundFile::PlayState &playState = *memory.state;
 	// Temporary visited rows vector (so that GetLength() won't interfere with the player code if the module is playing at the same time)
-	RowVisitor visitedRows(*this, sequence);
-	ROWINDEX allowedPatternLoopComplexity = 32768;
+	RowVisitor visitedRows = checkpoint ? RowVisitor(checkpoint->visitedRows) : RowVisitor(*this, sequence);
+	ROWINDEX allowedPatternLoopComplexity = checkpoint ? checkpoint->allowedPatternLoopComplexity : 32768;
 
-	// If sequence starts with some non-existent patterns, find a better start
-	while(target.startOrder < orderList.size() && !orderList.IsValidPat(target.startOrder))
+	if(checkpoint)
+	{
+		retval = checkpoint->retval;
+	} else
 	{
-		target.startOrder++;
-		target.startRow = 0;
+		// If sequence starts with some non-existent patterns, find a better start
+		while(target.startOrder < orderList.size() && !orderList.IsValidPat(target.startOrder))
+		{
+			target.startOrder++;
+			target.startRow = 0;
+		}
+		retval.startRow = playState.m_nNextRow = playState.m_nRow = target.startRow;
+		retval.startOrder = playState.m_nNextOrder = playState.m_nCurrentOrder = target.startOrder;
 	}
-	retval.startRow = playState.m_nNextRow = playState.m_nRow = target.startRow;
-	retval.startOrder = playState.m_nNextOrder = playState.m_nCurrentOrder = target.startOrder;
 
 	// Fast LUTs for commands that are too weird / complicated / whatever to emulate in sample position adjust mode.
 	std::bitset<MAX_EFFECTS> forbiddenCommands;
@@ -335,15 +509,24 @@ std::vector<GetLengthType> CSoundFile::GetLength(enmGetLengthResetMode adjustMod
 		}
 	}
 
-	if(adjustMode & eAdjust)
+	if((adjustMode & eAdjust) && !checkpoint)
 		playState.m_midiMacroEvaluationResults.emplace();
 
 	// If samples are being synced, force them to resync if tick duration changes
-	uint32 oldTickDuration = 0;
-	bool breakToRow = false;
+	uint32 oldTickDuration = checkpoint ? checkpoint->oldTickDuration : 0;
+	bool breakToRow = checkpoint ? checkpoint->breakToRow : false;
 
 	for (;;)
 	{
+		if(target.cancel && target.cancel->load(std::memory_order_relaxed))
+			break;
+
+		// Snapshots are only valid as long as we are still in the first subsong that we encounter, as memory.elapsedTime is reset for all following ones.
+		if(seekIndex && results.empty() && seekIndex->WantCheckpoint(memory.elapsedTime))
+		{
+			seekIndex->AddCheckpoint(std::make_unique<SeekIndex::Checkpoint>(memory, visitedRows, retval, oldTickDuration, allowedPatternLoopComplexity, breakToRow));
+		}
+
 		const bool ignoreRow = NextRow(playState, breakToRow).first;
 
 		// Time target reached.
@@ -1277,7 +1460,8 @@ std::vector<GetLengthType> CSoundFile::GetLength(enmGetLengthResetMode adjustMod
 			const auto midiMacroEvaluationResults = std::move(playState.m_midiMacroEvaluationResults);
 			playState.m_midiMacroEvaluationResults.reset();
 			// Target found, or there is no target (i.e. play whole song)...
-			m_PlayState = std::move(playState);
+			// Background channels have not been simulated, so the ones that are currently playing are kept.
+			m_PlayState.AssignPatternState(playState, GetNumChannels());
 			m_PlayState.ResetGlobalVolumeRamping();
 			m_PlayState.m_nNextRow = m_PlayState.m_nRow;
 			m_PlayState.m_nFrameDelay = m_PlayState.m_nPatternDelay = 0;
@@ -4936,6 +5120,10 @@ void CSoundFile::InvertLoop(ModChannel &chn)
 		return;
 	chn.nEFxDelay = 0;
 
+	// Other instances of this module may play the same sample data
+	if(!MakeSampleDataWritable(*pModSample))
+		return;
+
 	const SmpLength loopStart = pModSample->uFlags[CHN_LOOP] ? pModSample->nLoopStart : pModSample->nSustainStart;
 	const SmpLength loopEnd = pModSample->uFlags[CHN_LOOP] ? pModSample->nLoopEnd : pModSample->nSustainEnd;
 
@@ -4963,10 +5151,16 @@ void CSoundFile::InvertLoop(ModChannel &chn)
 // plugin: Plugin to send MIDI message to (if not specified but needed, it is autodetected)
 void CSoundFile::ProcessMIDIMacro(PlayState &playState, CHANNELINDEX nChn, bool isSmooth, const MIDIMacroConfigData::Macro &macro, uint8 param, PLUGINDEX plugin)
 {
-	playState.m_midiMacroScratchSpace.resize(macro.Length() + 1);
+	// Macros of m_MidiCfg are normally pre-parsed. If the macro has been changed since then (or is not part of m_MidiCfg), we have to parse it here.
+	std::optional<CompiledMIDIMacro> uncachedMacro;
+	const CompiledMIDIMacro *compiledMacro = m_compiledMidiCfg.Find(m_MidiCfg, macro);
+	if(!compiledMacro)
+		compiledMacro = &uncachedMacro.emplace(macro);
+
+	playState.m_midiMacroScratchSpace.resize(compiledMacro->MaxOutputSize() + 1);
 	auto out = mpt::as_span(playState.m_midiMacroScratchSpace);
 
-	ParseMIDIMacro(playState, nChn, isSmooth, macro, out, param, plugin);
+	ParseMIDIMacro(playState, nChn, isSmooth, *compiledMacro, out, param, plugin);
 
 	// Macro string has been parsed and translated, now send the message(s)...
 	uint32 outSize = static_cast<uint32>(out.size());
@@ -5034,7 +5228,7 @@ void CSoundFile::ProcessMIDIMacro(PlayState &playState, CHANNELINDEX nChn, bool
 }
 
 
-void CSoundFile::ParseMIDIMacro(PlayState &playState, CHANNELINDEX nChn, bool isSmooth, const mpt::span<const char> macro, mpt::span<uint8> &out, uint8 param, PLUGINDEX plugin) const
+void CSoundFile::ParseMIDIMacro(PlayState &playState, CHANNELINDEX nChn, bool isSmooth, const CompiledMIDIMacro &macro, mpt::span<uint8> &out, uint8 param, PLUGINDEX plugin) const
 {
 	ModChannel &chn = playState.Chn[nChn];
 	const ModInstrument *pIns = chn.pModInstrument;
@@ -5042,30 +5236,41 @@ void CSoundFile::ParseMIDIMacro(PlayState &playState, CHANNELINDEX nChn, bool is
 	const uint8 lastZxxParam = chn.lastZxxParam;  // always interpolate based on original value in case z appears multiple times in macro string
 	uint8 updateZxxParam = 0xFF;                  // avoid updating lastZxxParam immediately if macro contains both internal and external MIDI message
 
+	MPT_ASSERT(out.size() > macro.MaxOutputSize());
 	bool firstNibble = true;
 	size_t outPos = 0;  // output buffer position, which also equals the number of complete bytes
-	for(size_t pos = 0; pos < macro.size() && outPos < out.size(); pos++)
+	for(const auto &instr : macro.Instructions())
 	{
 		bool isNibble = false;  // did we parse a nibble or a byte value?
 		uint8 data = 0;         // data that has just been parsed
 
-		// Parse next macro byte... See Impulse Tracker's MIDI.TXT for detailed information on each possible character.
-		if(macro[pos] >= '0' && macro[pos] <= '9')
+		// Evaluate next macro instruction... See Impulse Tracker's MIDI.TXT for detailed information on each possible variable.
+		switch(instr.op)
 		{
+		case CompiledMIDIMacro::Op::Nibble:
 			isNibble = true;
-			data = static_cast<uint8>(macro[pos] - '0');
-		} else if(macro[pos] >= 'A' && macro[pos] <= 'F')
-		{
-			isNibble = true;
-			data = static_cast<uint8>(macro[pos] - 'A' + 0x0A);
-		} else if(macro[pos] == 'c')
-		{
+			data = instr.value;
+			break;
+
+		case CompiledMIDIMacro::Op::NibblePair:
+			// Same as two consecutive nibbles
+			if(firstNibble)
+			{
+				out[outPos++] = instr.value;
+			} else
+			{
+				out[outPos] = static_cast<uint8>((out[outPos] << 4) | (instr.value >> 4));
+				outPos++;
+				out[outPos] = instr.value & 0x0F;
+			}
+			continue;
+
+		case CompiledMIDIMacro::Op::MIDIChannel:
 			// MIDI channel
 			isNibble = true;
 			data = 0xFF;
 #ifndef NO_PLUGINS
-			const PLUGINDEX plug = (plugin != 0) ? plugin : GetBestPlugin(playState, nChn, PrioritiseChannel, EvenIfMuted);
-			if(plug > 0 && plug <= MAX_MIXPLUGINS)
+			if(const PLUGINDEX plug = (plugin != 0) ? plugin : GetBestPlugin(playState, nChn, PrioritiseChannel, EvenIfMuted); plug > 0 && plug <= MAX_MIXPLUGINS)
 			{
 				auto midiPlug = dynamic_cast<const IMidiPlugin *>(m_MixPlugins[plug - 1u].pMixPlugin);
 				if(midiPlug)
@@ -5080,71 +5285,87 @@ void CSoundFile::ParseMIDIMacro(PlayState &playState, CHANNELINDEX nChn, bool is
 				else
 					data = 0;
 			}
-		} else if(macro[pos] == 'n')
-		{
+			break;
+
+		case CompiledMIDIMacro::Op::LastNote:
 			// Last triggered note
 			if(ModCommand::IsNote(chn.nLastNote))
 			{
 				data = chn.nLastNote - NOTE_MIN;
 			}
-		} else if(macro[pos] == 'v')
-		{
-			// Velocity
-			// This is "almost" how IT does it - apparently, IT seems to lag one row behind on global volume or channel volume changes.
-			const int swing = (m_playBehaviour[kITSwingBehaviour] || m_playBehaviour[kMPTOldSwingBehaviour]) ? chn.nVolSwing : 0;
-			const int vol = Util::muldiv((chn.nVolume + swing) * m_PlayState.m_nGlobalVolume, chn.nGlobalVol * chn.nInsVol, 1 << 20);
-			data = static_cast<uint8>(Clamp(vol / 2, 1, 127));
-			//data = (unsigned char)std::min((chn.nVolume * chn.nGlobalVol * m_nGlobalVolume) >> (1 + 6 + 8), 127);
-		} else if(macro[pos] == 'u')
-		{
-			// Calculated volume
-			// Same note as with velocity applies here, but apparently also for instrument / sample volumes?
-			const int vol = Util::muldiv(chn.nCalcVolume * m_PlayState.m_nGlobalVolume, chn.nGlobalVol * chn.nInsVol, 1 << 26);
-			data = static_cast<uint8>(Clamp(vol / 2, 1, 127));
-			//data = (unsigned char)std::min((chn.nCalcVolume * chn.nGlobalVol * m_nGlobalVolume) >> (7 + 6 + 8), 127);
-		} else if(macro[pos] == 'x')
-		{
+			break;
+
+		case CompiledMIDIMacro::Op::Velocity:
+			{
+				// Velocity
+				// This is "almost" how IT does it - apparently, IT seems to lag one row behind on global volume or channel volume changes.
+				const int swing = (m_playBehaviour[kITSwingBehaviour] || m_playBehaviour[kMPTOldSwingBehaviour]) ? chn.nVolSwing : 0;
+				const int vol = Util::muldiv((chn.nVolume + swing) * m_PlayState.m_nGlobalVolume, chn.nGlobalVol * chn.nInsVol, 1 << 20);
+				data = static_cast<uint8>(Clamp(vol / 2, 1, 127));
+				//data = (unsigned char)std::min((chn.nVolume * chn.nGlobalVol * m_nGlobalVolume) >> (1 + 6 + 8), 127);
+			}
+			break;
+
+		case CompiledMIDIMacro::Op::CalcVolume:
+			{
+				// Calculated volume
+				// Same note as with velocity applies here, but apparently also for instrument / sample volumes?
+				const int vol = Util::muldiv(chn.nCalcVolume * m_PlayState.m_nGlobalVolume, chn.nGlobalVol * chn.nInsVol, 1 << 26);
+				data = static_cast<uint8>(Clamp(vol / 2, 1, 127));
+				//data = (unsigned char)std::min((chn.nCalcVolume * chn.nGlobalVol * m_nGlobalVolume) >> (7 + 6 + 8), 127);
+			}
+			break;
+
+		case CompiledMIDIMacro::Op::Pan:
 			// Pan set
 			data = static_cast<uint8>(std::min(static_cast<int>(chn.nPan / 2), 127));
-		} else if(macro[pos] == 'y')
-		{
+			break;
+
+		case CompiledMIDIMacro::Op::CalcPan:
 			// Calculated pan
 			data = static_cast<uint8>(std::min(static_cast<int>(chn.nRealPan / 2), 127));
-		} else if(macro[pos] == 'a')
-		{
+			break;
+
+		case CompiledMIDIMacro::Op::BankHigh:
 			// High byte of bank select
 			if(pIns && pIns->wMidiBank)
 			{
 				data = static_cast<uint8>(((pIns->wMidiBank - 1) >> 7) & 0x7F);
 			}
-		} else if(macro[pos] == 'b')
-		{
+			break;
+
+		case CompiledMIDIMacro::Op::BankLow:
 			// Low byte of bank select
 			if(pIns && pIns->wMidiBank)
 			{
 				data = static_cast<uint8>((pIns->wMidiBank - 1) & 0x7F);
 			}
-		} else if(macro[pos] == 'o')
-		{
+			break;
+
+		case CompiledMIDIMacro::Op::Offset:
 			// Offset (ignoring high offset)
 			data = static_cast<uint8>((chn.oldOffset >> 8) & 0xFF);
-		} else if(macro[pos] == 'h')
-		{
+			break;
+
+		case CompiledMIDIMacro::Op::HostChannel:
 			// Host channel number
 			data = static_cast<uint8>((nChn >= GetNumChannels() ? (chn.nMasterChn - 1) : nChn) & 0x7F);
-		} else if(macro[pos] == 'm')
-		{
+			break;
+
+		case CompiledMIDIMacro::Op::LoopDirection:
 			// Loop direction (on sample channels - MIDI note on MIDI channels)
 			data = chn.dwFlags[CHN_PINGPONGFLAG] ? 1 : 0;
-		} else if(macro[pos] == 'p')
-		{
+			break;
+
+		case CompiledMIDIMacro::Op::Program:
 			// Program select
 			if(pIns && pIns->nMidiProgram)
 			{
 				data = static_cast<uint8>((pIns->nMidiProgram - 1) & 0x7F);
 			}
-		} else if(macro[pos] == 'z')
-		{
+			break;
+
+		case CompiledMIDIMacro::Op::Parameter:
 			// Zxx parameter
 			data = param;
 			if(isSmooth && chn.lastZxxParam < 0x80
@@ -5159,24 +5380,24 @@ void CSoundFile::ParseMIDIMacro(PlayState &playState, CHANNELINDEX nChn, bool is
 			{
 				updateZxxParam = data;
 			}
-		} else if(macro[pos] == 's')
-		{
-			// SysEx Checksum (not an original Impulse Tracker macro variable, but added for convenience)
-			auto startPos = outPos;
-			while(startPos > 0 && out[--startPos] != 0xF0);
-			if(outPos - startPos < 5 || out[startPos] != 0xF0)
-			{
-				continue;
-			}
-			for(auto p = startPos + 5u; p != outPos; p++)
+			break;
+
+		case CompiledMIDIMacro::Op::Checksum:
 			{
-				data += out[p];
+				// SysEx Checksum (not an original Impulse Tracker macro variable, but added for convenience)
+				auto startPos = outPos;
+				while(startPos > 0 && out[--startPos] != 0xF0);
+				if(outPos - startPos < 5 || out[startPos] != 0xF0)
+				{
+					continue;
+				}
+				for(auto p = startPos + 5u; p != outPos; p++)
+				{
+					data += out[p];
+				}
+				data = (~data + 1) & 0x7F;
 			}
-			data = (~data + 1) & 0x7F;
-		} else
-		{
-			// Unrecognized byte (e.g. space char)
-			continue;
+			break;
 		}
 
 		// Append parsed data
@@ -12,6 +12,8 @@
 #include "stdafx.h"
 #include "Sndfile.h"
 #include "Container.h"
+#include "DeferredSamples.h"
+#include "SharedSamples.h"
 #include "mod_specifications.h"
 #include "OPL.h"
 #include "Tables.h"
@@ -20,12 +22,16 @@
 #include "plugins/PlugInterface.h"
 #include "../common/FileReader.h"
 #include "../common/mptStringBuffer.h"
+#include "../common/mptThreadPool.h"
 #include "../common/serialization_utils.h"
 #include "../common/version.h"
 #include "../soundlib/AudioCriticalSection.h"
 #include "mpt/io/io.hpp"
 #include "mpt/io/io_stdstream.hpp"
 
+#include <bitset>
+#include <optional>
+
 #ifdef MODPLUG_TRACKER
 #include "../mptrack/Mainfrm.h"
 #include "../mptrack/Moddoc.h"
@@ -109,6 +115,105 @@ CSoundFile::PlayState::PlayState()
 }
 
 
+void CSoundFile::PlayState::Save(Snapshot &snapshot, CHANNELINDEX numPatternChannels, bool includeBackgroundChannels) const
+{
+	LimitMax(numPatternChannels, MAX_BASECHANNELS);
+	snapshot.m_global = *this;
+	snapshot.m_numPatternChannels = numPatternChannels;
+	snapshot.m_hasBackgroundChannels = includeBackgroundChannels;
+	snapshot.m_channels.assign(std::begin(Chn), std::begin(Chn) + numPatternChannels);
+	snapshot.m_backgroundChannels.clear();
+	if(!includeBackgroundChannels)
+		return;
+	for(CHANNELINDEX chn = numPatternChannels; chn < MAX_CHANNELS; chn++)
+	{
+		if(IsBackgroundChannelInUse(Chn[chn]))
+		{
+			snapshot.m_backgroundChannels.push_back(chn);
+			snapshot.m_channels.push_back(Chn[chn]);
+		}
+	}
+}
+
+
+void CSoundFile::PlayState::Restore(const Snapshot &snapshot)
+{
+	// Note: Assigning the scratch space keeps its reserved capacity
+	static_cast<GlobalPlayState &>(*this) = snapshot.m_global;
+	std::copy(snapshot.m_channels.begin(), snapshot.m_channels.begin() + snapshot.m_numPatternChannels, std::begin(Chn));
+	if(!snapshot.m_hasBackgroundChannels)
+		return;
+	auto savedIndex = snapshot.m_backgroundChannels.begin();
+	auto savedChn = snapshot.m_channels.begin() + snapshot.m_numPatternChannels;
+	for(CHANNELINDEX chn = snapshot.m_numPatternChannels; chn < MAX_CHANNELS; chn++)
+	{
+		if(savedIndex != snapshot.m_backgroundChannels.end() && *savedIndex == chn)
+		{
+			Chn[chn] = *savedChn;
+			++savedIndex;
+			++savedChn;
+		} else if(IsBackgroundChannelInUse(Chn[chn]))
+		{
+			Chn[chn] = ModChannel{};
+		}
+	}
+}
+
+
+void CSoundFile::PlayState::AssignPatternState(const PlayState &other, CHANNELINDEX numPatternChannels)
+{
+	LimitMax(numPatternChannels, MAX_BASECHANNELS);
+	static_cast<GlobalPlayState &>(*this) = other;
+	std::copy(std::begin(other.Chn), std::begin(other.Chn) + numPatternChannels, std::begin(Chn));
+}
+
+
+bool CSoundFile::PlayState::IsBackgroundChannelInUse(const ModChannel &chn) noexcept
+{
+	// Channels that are no longer playing may still need to finish their click removal ramp
+	return chn.nLength != 0 || chn.HasMIDIOutput() || chn.dwFlags[CHN_ADLIB] || chn.nROfs != 0 || chn.nLOfs != 0;
+}
+
+
+size_t CSoundFile::PlayState::Snapshot::GetMemoryUsage() const noexcept
+{
+	return sizeof(*this) + m_channels.capacity() * sizeof(ModChannel) + m_backgroundChannels.capacity() * sizeof(CHANNELINDEX) + m_global.m_midiMacroScratchSpace.capacity();
+}
+
+
+void CSoundFile::SaveResumeState(ResumeState &state) const
+{
+	state.numMixChannels = m_nMixChannels;
+	std::copy(std::begin(m_PlayState.ChnMix), std::begin(m_PlayState.ChnMix) + m_nMixChannels, state.mixChannels.begin());
+	state.dryLOfsVol = m_dryLOfsVol;
+	state.dryROfsVol = m_dryROfsVol;
+	state.surroundLOfsVol = m_surroundLOfsVol;
+	state.surroundROfsVol = m_surroundROfsVol;
+	state.mixStat = m_nMixStat;
+	if(state.visitedRows)
+		state.visitedRows->CopyVisitedRowsFrom(m_visitedRows);
+	else
+		state.visitedRows = std::make_unique<RowVisitor>(m_visitedRows);
+	state.prng = m_PRNG;
+}
+
+
+void CSoundFile::RestoreResumeState(const ResumeState &state)
+{
+	m_nMixChannels = state.numMixChannels;
+	std::copy(state.mixChannels.begin(), state.mixChannels.begin() + state.numMixChannels, std::begin(m_PlayState.ChnMix));
+	m_dryLOfsVol = state.dryLOfsVol;
+	m_dryROfsVol = state.dryROfsVol;
+	m_surroundLOfsVol = state.surroundLOfsVol;
+	m_surroundROfsVol = state.surroundROfsVol;
+	m_nMixStat = state.mixStat;
+	if(state.visitedRows)
+		m_visitedRows.CopyVisitedRowsFrom(*state.visitedRows);
+	if(state.prng)
+		m_PRNG = *state.prng;
+}
+
+
 //////////////////////////////////////////////////////////
 // CSoundFile
 
@@ -130,9 +235,7 @@ CSoundFile::CSoundFile() :
 	, m_MIDIMapper(*this)
 #endif
 {
-	MemsetZero(MixSoundBuffer);
-	MemsetZero(MixRearBuffer);
-	MemsetZero(MixFloatBuffer);
+	UpdateMixBuffers();
 
 #ifdef MODPLUG_TRACKER
 	m_bChannelMuteTogglePending.reset();
@@ -145,7 +248,6 @@ CSoundFile::CSoundFile() :
 #endif // MODPLUG_TRACKER
 
 	MemsetZero(Instruments);
-	Clear(m_szNames);
 
 	m_pTuningsTuneSpecific = new CTuningCollection();
 }
@@ -246,83 +348,152 @@ void CSoundFile::InitializeChannels()
 }
 
 
+// Magic bytes that a format loader requires at a fixed offset from the start of the file.
+struct FileFormatMagic
+{
+	uint16 offset = 0;
+	std::string_view bytes;
+};
+
 struct FileFormatLoader
 {
 	decltype(CSoundFile::ProbeFileHeaderXM) *prober;
 	decltype(&CSoundFile::ReadXM) loader;
+	uint16 minSize = 0;                         // The loader rejects all files shorter than this
+	std::array<FileFormatMagic, 2> magic = {};  // If any magic bytes are specified, the loader rejects all files that contain none of them
 };
 
 #ifdef MODPLUG_TRACKER
-#define MPT_DECLARE_FORMAT(format) { nullptr, &CSoundFile::Read ## format }
+#define MPT_DECLARE_FORMAT(format, ...) { nullptr, &CSoundFile::Read ## format, __VA_ARGS__ }
 #else
-#define MPT_DECLARE_FORMAT(format) { CSoundFile::ProbeFileHeader ## format, &CSoundFile::Read ## format }
+#define MPT_DECLARE_FORMAT(format, ...) { CSoundFile::ProbeFileHeader ## format, &CSoundFile::Read ## format, __VA_ARGS__ }
 #endif
+#define MPT_FORMAT_MAGIC(offset, magic) FileFormatMagic{offset, std::string_view{magic, sizeof(magic) - 1}}
 
 // All module format loaders, in the order they should be executed.
 // This order matters, depending on the format, due to some unfortunate
 // clashes or lack of magic bytes that can lead to mis-detection of some formats.
 // Apart from that, more common formats with sane magic bytes are also found
 // at the top of the list to match the most common cases more quickly.
+// The minimum sizes and magic bytes must be necessary conditions for the loader to succeed,
+// as they are used to skip loaders that would reject the file anyway (see GetFormatCandidates).
 static constexpr FileFormatLoader ModuleFormatLoaders[] =
 {
-	MPT_DECLARE_FORMAT(XM),
-	MPT_DECLARE_FORMAT(IT),
-	MPT_DECLARE_FORMAT(S3M),
-	MPT_DECLARE_FORMAT(STM),
-	MPT_DECLARE_FORMAT(MED),
-	MPT_DECLARE_FORMAT(MTM),
-	MPT_DECLARE_FORMAT(MDL),
-	MPT_DECLARE_FORMAT(DBM),
-	MPT_DECLARE_FORMAT(FAR),
-	MPT_DECLARE_FORMAT(AMS),
-	MPT_DECLARE_FORMAT(AMS2),
-	MPT_DECLARE_FORMAT(OKT),
-	MPT_DECLARE_FORMAT(PTM),
-	MPT_DECLARE_FORMAT(ULT),
-	MPT_DECLARE_FORMAT(DMF),
-	MPT_DECLARE_FORMAT(DSM),
-	MPT_DECLARE_FORMAT(AMF_Asylum),
-	MPT_DECLARE_FORMAT(AMF_DSMI),
-	MPT_DECLARE_FORMAT(PSM),
-	MPT_DECLARE_FORMAT(PSM16),
-	MPT_DECLARE_FORMAT(MT2),
-	MPT_DECLARE_FORMAT(ITP),
+	MPT_DECLARE_FORMAT(XM, 0, {MPT_FORMAT_MAGIC(0, "Extended Module: ")}),
+	MPT_DECLARE_FORMAT(IT, 0, {MPT_FORMAT_MAGIC(0, "IMPM"), MPT_FORMAT_MAGIC(0, "tpm.")}),
+	MPT_DECLARE_FORMAT(S3M, 0, {MPT_FORMAT_MAGIC(44, "SCRM")}),
+	MPT_DECLARE_FORMAT(STM, 48),
+	MPT_DECLARE_FORMAT(MED, 0, {MPT_FORMAT_MAGIC(0, "MMD")}),
+	MPT_DECLARE_FORMAT(MTM, 0, {MPT_FORMAT_MAGIC(0, "MTM")}),
+	MPT_DECLARE_FORMAT(MDL, 0, {MPT_FORMAT_MAGIC(0, "DMDL")}),
+	MPT_DECLARE_FORMAT(DBM, 0, {MPT_FORMAT_MAGIC(0, "DBM0")}),
+	MPT_DECLARE_FORMAT(FAR, 0, {MPT_FORMAT_MAGIC(0, "FAR\xFE")}),
+	MPT_DECLARE_FORMAT(AMS, 0, {MPT_FORMAT_MAGIC(0, "Extreme")}),
+	MPT_DECLARE_FORMAT(AMS2, 0, {MPT_FORMAT_MAGIC(0, "AMShdr\x1A")}),
+	MPT_DECLARE_FORMAT(OKT, 0, {MPT_FORMAT_MAGIC(0, "OKTASONG")}),
+	MPT_DECLARE_FORMAT(PTM, 0, {MPT_FORMAT_MAGIC(44, "PTMF")}),
+	MPT_DECLARE_FORMAT(ULT, 0, {MPT_FORMAT_MAGIC(0, "MAS_UTrack_V00")}),
+	MPT_DECLARE_FORMAT(DMF, 0, {MPT_FORMAT_MAGIC(0, "DDMF")}),
+	MPT_DECLARE_FORMAT(DSM, 0, {MPT_FORMAT_MAGIC(0, "RIFF"), MPT_FORMAT_MAGIC(0, "DSMF")}),
+	MPT_DECLARE_FORMAT(AMF_Asylum, 0, {MPT_FORMAT_MAGIC(0, "ASYLUM Music Format V1.0\0")}),
+	MPT_DECLARE_FORMAT(AMF_DSMI, 0, {MPT_FORMAT_MAGIC(0, "AMF"), MPT_FORMAT_MAGIC(0, "DMF")}),
+	MPT_DECLARE_FORMAT(PSM, 0, {MPT_FORMAT_MAGIC(0, "PSM "), MPT_FORMAT_MAGIC(0, "QUP$")}),
+	MPT_DECLARE_FORMAT(PSM16, 0, {MPT_FORMAT_MAGIC(0, "PSM\xFE")}),
+	MPT_DECLARE_FORMAT(MT2, 0, {MPT_FORMAT_MAGIC(0, "MT20")}),
+	MPT_DECLARE_FORMAT(ITP, 0, {MPT_FORMAT_MAGIC(0, "pti.")}),
 #if defined(MODPLUG_TRACKER) || defined(MPT_FUZZ_TRACKER)
 	// These make little sense for a module player library
 	MPT_DECLARE_FORMAT(UAX),
 	MPT_DECLARE_FORMAT(WAV),
 	MPT_DECLARE_FORMAT(MID),
 #endif // MODPLUG_TRACKER || MPT_FUZZ_TRACKER
-	MPT_DECLARE_FORMAT(GDM),
-	MPT_DECLARE_FORMAT(IMF),
-	MPT_DECLARE_FORMAT(DIGI),
-	MPT_DECLARE_FORMAT(DTM),
-	MPT_DECLARE_FORMAT(PLM),
-	MPT_DECLARE_FORMAT(AM),
-	MPT_DECLARE_FORMAT(J2B),
-	MPT_DECLARE_FORMAT(GT2),
-	MPT_DECLARE_FORMAT(GTK),
-	MPT_DECLARE_FORMAT(PT36),
-	MPT_DECLARE_FORMAT(SymMOD),
+	MPT_DECLARE_FORMAT(GDM, 0, {MPT_FORMAT_MAGIC(0, "GDM\xFE")}),
+	MPT_DECLARE_FORMAT(IMF, 0, {MPT_FORMAT_MAGIC(60, "IM10")}),
+	MPT_DECLARE_FORMAT(DIGI, 0, {MPT_FORMAT_MAGIC(0, "DIGI Booster module\0")}),
+	MPT_DECLARE_FORMAT(DTM, 0, {MPT_FORMAT_MAGIC(0, "D.T.")}),
+	MPT_DECLARE_FORMAT(PLM, 0, {MPT_FORMAT_MAGIC(0, "PLM\x1A")}),
+	MPT_DECLARE_FORMAT(AM, 0, {MPT_FORMAT_MAGIC(0, "RIFF")}),
+	MPT_DECLARE_FORMAT(J2B, 0, {MPT_FORMAT_MAGIC(0, "MUSE")}),
+	MPT_DECLARE_FORMAT(GT2, 0, {MPT_FORMAT_MAGIC(0, "GT2")}),
+	MPT_DECLARE_FORMAT(GTK, 0, {MPT_FORMAT_MAGIC(0, "GTK")}),
+	MPT_DECLARE_FORMAT(PT36, 0, {MPT_FORMAT_MAGIC(0, "FORM")}),
+	MPT_DECLARE_FORMAT(SymMOD, 0, {MPT_FORMAT_MAGIC(0, "SymM")}),
 	MPT_DECLARE_FORMAT(MUS_KM),
-	MPT_DECLARE_FORMAT(FMT),
-	MPT_DECLARE_FORMAT(SFX),
-	MPT_DECLARE_FORMAT(STP),
-	MPT_DECLARE_FORMAT(DSym),
-	MPT_DECLARE_FORMAT(STX),
-	MPT_DECLARE_FORMAT(MOD),
-	MPT_DECLARE_FORMAT(ICE),
-	MPT_DECLARE_FORMAT(669),
-	MPT_DECLARE_FORMAT(667),
+	MPT_DECLARE_FORMAT(FMT, 0, {MPT_FORMAT_MAGIC(0, "FMTracker\x01\x01")}),
+	MPT_DECLARE_FORMAT(SFX, 0, {MPT_FORMAT_MAGIC(0x3C, "SONG"), MPT_FORMAT_MAGIC(0x7C, "SO31")}),
+	MPT_DECLARE_FORMAT(STP, 0, {MPT_FORMAT_MAGIC(0, "STP3")}),
+	MPT_DECLARE_FORMAT(DSym, 0, {MPT_FORMAT_MAGIC(0, "\x02\x01\x13\x13\x14\x12\x01\x0B")}),
+	MPT_DECLARE_FORMAT(STX, 0, {MPT_FORMAT_MAGIC(60, "SCRM")}),
+	MPT_DECLARE_FORMAT(MOD, 1084),
+	MPT_DECLARE_FORMAT(ICE, 0, {MPT_FORMAT_MAGIC(1464, "MTN\0"), MPT_FORMAT_MAGIC(1464, "IT10")}),
+	MPT_DECLARE_FORMAT(669, 0, {MPT_FORMAT_MAGIC(0, "if"), MPT_FORMAT_MAGIC(0, "JN")}),
+	MPT_DECLARE_FORMAT(667, 0, {MPT_FORMAT_MAGIC(0, "gf")}),
 	MPT_DECLARE_FORMAT(C67),
-	MPT_DECLARE_FORMAT(MO3),
-	MPT_DECLARE_FORMAT(DSm),
-	MPT_DECLARE_FORMAT(M15),
+	MPT_DECLARE_FORMAT(MO3, 0, {MPT_FORMAT_MAGIC(0, "MO3")}),
+	MPT_DECLARE_FORMAT(DSm, 0, {MPT_FORMAT_MAGIC(0, "DSm\x1A")}),
+	MPT_DECLARE_FORMAT(M15, 600),
 	MPT_DECLARE_FORMAT(XMF),
 };
 
+#undef MPT_FORMAT_MAGIC
 #undef MPT_DECLARE_FORMAT
 
+using FormatCandidates = std::bitset<std::size(ModuleFormatLoaders)>;
+
+
+// Number of bytes at the start of a file that are required to evaluate all minimum sizes and magic bytes of the format loaders
+static constexpr std::size_t GetFormatSignatureSize()
+{
+	std::size_t size = 0;
+	for(const auto &format : ModuleFormatLoaders)
+	{
+		size = std::max(size, static_cast<std::size_t>(format.minSize));
+		for(const auto &magic : format.magic)
+		{
+			size = std::max(size, magic.offset + magic.bytes.size());
+		}
+	}
+	return size;
+}
+
+
+// Determine which format loaders could possibly accept a file, based on their minimum size and magic bytes.
+// This is done on a single read of the file start, so that the (possibly expensive) header parsing of all other loaders can be skipped.
+// Formats without any magic bytes (e.g. M15, ICE) are always candidates if the file is large enough.
+// If fileComplete is false (i.e. the file may continue beyond the available data, e.g. while probing),
+// formats whose minimum size or magic bytes lie beyond the available data are kept as candidates.
+template <typename TFileCursor>
+static FormatCandidates GetFormatCandidates(TFileCursor file, bool fileComplete)
+{
+	std::array<std::byte, GetFormatSignatureSize()> header;
+	file.Rewind();
+	const std::size_t available = file.GetRaw(mpt::as_span(header)).size();
+
+	FormatCandidates candidates;
+	for(std::size_t i = 0; i < std::size(ModuleFormatLoaders); i++)
+	{
+		const FileFormatLoader &format = ModuleFormatLoaders[i];
+		if(format.minSize > available)
+		{
+			candidates[i] = !fileComplete;
+			continue;
+		}
+		bool hasMagic = false, mayMatch = false;
+		for(const auto &magic : format.magic)
+		{
+			if(magic.bytes.empty())
+				continue;
+			hasMagic = true;
+			if(magic.offset + magic.bytes.size() > available)
+				mayMatch = mayMatch || !fileComplete;
+			else if(!std::memcmp(header.data() + magic.offset, magic.bytes.data(), magic.bytes.size()))
+				mayMatch = true;
+		}
+		candidates[i] = !hasMagic || mayMatch;
+	}
+	return candidates;
+}
+
 
 CSoundFile::ProbeResult CSoundFile::ProbeAdditionalSize(MemoryFileReader &file, const uint64 *pfilesize, uint64 minimumAdditionalSize)
 {
@@ -387,11 +558,12 @@ CSoundFile::ProbeResult CSoundFile::Probe(ProbeFlags flags, mpt::span<const std:
 	}
 	if(flags & ProbeModules)
 	{
-		for(const auto &format : ModuleFormatLoaders)
+		const FormatCandidates candidates = GetFormatCandidates(file, pfilesize && mpt::saturate_cast<std::size_t>(*pfilesize) <= data.size());
+		for(std::size_t i = 0; i < std::size(ModuleFormatLoaders); i++)
 		{
-			if(format.prober != nullptr)
+			if(ModuleFormatLoaders[i].prober != nullptr && candidates[i])
 			{
-				MPT_DO_PROBE(result, format.prober(file, pfilesize));
+				MPT_DO_PROBE(result, ModuleFormatLoaders[i].prober(file, pfilesize));
 			}
 		}
 	}
@@ -418,6 +590,9 @@ CSoundFile::ProbeResult CSoundFile::Probe(ProbeFlags flags, mpt::span<const std:
 
 bool CSoundFile::Create(FileReader file, ModLoadingFlags loadFlags, CModDoc *pModDoc)
 {
+	if(!(loadFlags & loadSampleData))
+		loadFlags = static_cast<ModLoadingFlags>(loadFlags & ~shareSampleData);
+
 	m_nMixChannels = 0;
 #ifdef MODPLUG_TRACKER
 	m_pModDoc = pModDoc;
@@ -426,7 +601,7 @@ bool CSoundFile::Create(FileReader file, ModLoadingFlags loadFlags, CModDoc *pMo
 	m_nFreqFactor = m_nTempoFactor = 65536;
 #endif  // MODPLUG_TRACKER
 
-	Clear(m_szNames);
+	m_szNames.reset();
 #ifndef NO_PLUGINS
 	std::fill(std::begin(m_MixPlugins), std::end(m_MixPlugins), SNDMIXPLUGIN());
 #endif  // NO_PLUGINS
@@ -438,9 +613,14 @@ bool CSoundFile::Create(FileReader file, ModLoadingFlags loadFlags, CModDoc *pMo
 	if(!(loadFlags & skipContainer) && file.IsValid())
 	{
 		CUnarchiver unarchiver(file);
-		if(unarchiver.ExtractBestFile(GetSupportedExtensions(true)))
+		FileReader outputFile;
+		// When only probing, there is no need to decompress more than the headers (and to verify the CRC of the whole file).
+		if(loadFlags == onlyVerifyHeader)
+			outputFile = unarchiver.GetBestFileStreaming(GetSupportedExtensions(true));
+		else if(unarchiver.ExtractBestFile(GetSupportedExtensions(true)))
+			outputFile = unarchiver.GetOutputFile();
+		if(outputFile.IsValid())
 		{
-			FileReader outputFile = unarchiver.GetOutputFile();
 #if defined(MPT_WITH_ANCIENT)
 			// Special case for MMCMP/PP20/XPK/etc. inside ZIP/RAR/LHA
 			std::unique_ptr<CAncientArchive> ancientArchive;
@@ -471,6 +651,8 @@ bool CSoundFile::Create(FileReader file, ModLoadingFlags loadFlags, CModDoc *pMo
 
 bool CSoundFile::CreateInternal(FileReader file, ModLoadingFlags loadFlags)
 {
+	std::optional<SharedSamples::Key> sharedSamplesKey;
+	std::vector<std::byte> sharedSamplesFileData;
 	if(file.IsValid())
 	{
 		std::vector<ContainerItem> containerItems;
@@ -504,13 +686,57 @@ bool CSoundFile::CreateInternal(FileReader file, ModLoadingFlags loadFlags)
 			return false;
 		}
 
-		// Try all module format loaders
+		if(loadFlags & shareSampleData)
+		{
+			// Sample data is only shared once it has been completely decoded
+			loadFlags = static_cast<ModLoadingFlags>(loadFlags & ~deferSampleData);
+			sharedSamplesKey = SharedSamples::GetKey(file);
+			m_sharedSamples = SharedSamples::Find(*sharedSamplesKey, file);
+			if(!m_sharedSamples)
+			{
+				// Other instances need the file contents to confirm that they are loading the same file
+				file.Rewind();
+				sharedSamplesFileData.resize(mpt::saturate_cast<std::size_t>(file.GetLength()));
+				file.ReadRaw(mpt::as_span(sharedSamplesFileData));
+				file.Rewind();
+			}
+		}
+
+		// Unpacked container data is owned by containerItems, which goes out of scope before deferred samples are decoded
+		std::unique_ptr<std::vector<char>> unpackedData;
+		if(packedContainerType != ModContainerType::None && !containerItems.empty())
+			unpackedData = std::move(containerItems[0].data_cache);
+
+		if((loadFlags & (loadSampleData | deferSampleData)) == (loadSampleData | deferSampleData))
+		{
+			// The file data must stay valid until all samples have been decoded (see deferSampleData)
+			if(!m_deferredSamples)
+				m_deferredSamples = std::make_unique<DeferredSamples>();
+			file = m_deferredSamples->PinFile(file, std::move(unpackedData));
+		} else if((loadFlags & loadSampleData) && ((loadFlags & decodeSamplesInParallel) || m_sharedSamples))
+		{
+			// If another instance has already decoded the sample data, deferring the samples allows us to skip decoding them.
+			if(!m_deferredSamples)
+				m_deferredSamples = std::make_unique<DeferredSamples>();
+			file = m_deferredSamples->PinFile(file, std::move(unpackedData));
+#if MPT_THREADPOOL_THREADS
+			if(loadFlags & decodeSamplesInParallel)
+			{
+				// The loading thread also decodes samples
+				const std::size_t numWorkers = std::max(std::thread::hardware_concurrency(), 1u) - 1u;
+				if(numWorkers > 0)
+					m_loadThreadPool = std::make_unique<ThreadPool>(numWorkers);
+			}
+#endif // MPT_THREADPOOL_THREADS
+		}
+
+		// Try all module format loaders that could possibly accept this file
+		const FormatCandidates candidates = GetFormatCandidates(file, true);
 		bool loaderSuccess = false;
-		for(const auto &format : ModuleFormatLoaders)
+		for(std::size_t i = 0; i < std::size(ModuleFormatLoaders) && !loaderSuccess; i++)
 		{
-			loaderSuccess = (this->*(format.loader))(file, loadFlags);
-			if(loaderSuccess)
-				break;
+			if(candidates[i])
+				loaderSuccess = (this->*(ModuleFormatLoaders[i].loader))(file, loadFlags);
 		}
 
 		if(!loaderSuccess)
@@ -518,6 +744,28 @@ bool CSoundFile::CreateInternal(FileReader file, ModLoadingFlags loadFlags)
 			m_nType = MOD_TYPE_NONE;
 			m_ContainerType = ModContainerType::None;
 		}
+		if(m_deferredSamples && (!loaderSuccess || m_deferredSamples->empty()))
+		{
+			m_deferredSamples.reset();
+		} else if(m_deferredSamples && !(loadFlags & deferSampleData))
+		{
+			if(m_sharedSamples)
+			{
+				for(SAMPLEINDEX smp = 1; smp <= GetNumSamples(); smp++)
+				{
+					if(m_deferredSamples->Contains(smp) && m_sharedSamples->Attach(smp, Samples[smp]))
+						m_deferredSamples->Remove(smp);
+				}
+			}
+			DecodeDeferredSamples();
+		}
+		m_loadThreadPool.reset();
+		if(!loaderSuccess)
+		{
+			m_sharedSamples.reset();
+			sharedSamplesKey.reset();
+			sharedSamplesFileData.clear();
+		}
 		if(loadFlags == onlyVerifyHeader)
 		{
 			return loaderSuccess;
@@ -621,9 +869,15 @@ bool CSoundFile::CreateInternal(FileReader file, ModLoadingFlags loadFlags)
 		}
 #endif // MPT_EXTERNAL_SAMPLES
 
-		if(sample.HasSampleData())
+		if(m_sharedSamples && m_sharedSamples->Contains(sample.samplev()))
+		{
+			// Shared sample data is read-only and already contains the pre-computed loops
+		} else if(sample.HasSampleData())
 		{
 			sample.PrecomputeLoops(*this, false);
+		} else if(IsSampleDataDeferred(nSmp))
+		{
+			sample.SanitizeLoops();
 		} else if(!sample.uFlags[SMP_KEEPONDISK])
 		{
 			sample.nLength = 0;
@@ -714,6 +968,21 @@ bool CSoundFile::CreateInternal(FileReader file, ModLoadingFlags loadFlags)
 		UpgradeModule();
 	}
 
+	UpdateCompiledMIDIMacros();
+
+	if(m_sharedSamples)
+	{
+		// Samples that could not be deferred had to be decoded again, but we don't need to keep a copy of them.
+		for(SAMPLEINDEX smp = 1; smp <= GetNumSamples(); smp++)
+		{
+			if(Samples[smp].HasSampleData())
+				m_sharedSamples->Attach(smp, Samples[smp]);
+		}
+	} else if(sharedSamplesKey)
+	{
+		m_sharedSamples = SharedSamples::Publish(*sharedSamplesKey, std::move(sharedSamplesFileData), Samples, GetNumSamples());
+	}
+
 #ifndef NO_PLUGINS
 	// Load plugins
 #ifdef MODPLUG_TRACKER
@@ -818,10 +1087,14 @@ bool CSoundFile::Destroy()
 	m_samplePaths.clear();
 #endif // MPT_EXTERNAL_SAMPLES
 
-	for(auto &smp : Samples)
+	m_deferredSamples.reset();
+	m_loadThreadPool.reset();
+	if(m_sharedSamples)
 	{
-		smp.FreeSample();
+		m_sharedSamples->Detach(Samples);
+		m_sharedSamples.reset();
 	}
+	Samples.ForEachAllocated([](ModSample &smp) { smp.FreeSample(); });
 	for(auto &ins : Instruments)
 	{
 		delete ins;
@@ -866,7 +1139,7 @@ void CSoundFile::SetPreAmp(uint32 nVol)
 }
 
 
-double CSoundFile::GetCurrentBPM() const
+double CSoundFile::GetCurrentBPM(const GlobalPlayState &playState) const
 {
 	double bpm;
 
@@ -874,12 +1147,12 @@ double CSoundFile::GetCurrentBPM() const
 	{
 		// With modern mode, we trust that true bpm is close enough to what user chose.
 		// This avoids oscillation due to tick-to-tick corrections.
-		bpm = m_PlayState.m_nMusicTempo.ToDouble();
+		bpm = playState.m_nMusicTempo.ToDouble();
 	} else
 	{
 		//with other modes, we calculate it:
-		double ticksPerBeat = m_PlayState.m_nMusicSpeed * m_PlayState.m_nCurrentRowsPerBeat; //ticks/beat = ticks/row * rows/beat
-		double samplesPerBeat = m_PlayState.m_nSamplesPerTick * ticksPerBeat;                //samps/beat = samps/tick * ticks/beat
+		double ticksPerBeat = playState.m_nMusicSpeed * playState.m_nCurrentRowsPerBeat;     //ticks/beat = ticks/row * rows/beat
+		double samplesPerBeat = playState.m_nSamplesPerTick * ticksPerBeat;                  //samps/beat = samps/tick * ticks/beat
 		bpm =  m_MixerSettings.gdwMixingFreq / samplesPerBeat * 60;                          //beats/sec  = samps/sec  / samps/beat
 	}	                                                                                     //beats/min  =  beats/sec * 60
 
@@ -1563,7 +1836,10 @@ bool CSoundFile::DestroySample(SAMPLEINDEX nSample)
 	{
 		return false;
 	}
-	if(!Samples[nSample].HasSampleData())
+	if(IsSampleDataDeferred(nSample))
+	{
+		m_deferredSamples->Remove(nSample);
+	} else if(!Samples[nSample].HasSampleData())
 	{
 		return true;
 	}
@@ -1580,6 +1856,8 @@ bool CSoundFile::DestroySample(SAMPLEINDEX nSample)
 		}
 	}
 
+	if(m_sharedSamples && m_sharedSamples->Contains(sample.samplev()))
+		sample.pData.pSample = nullptr;
 	sample.FreeSample();
 	sample.nLength = 0;
 	sample.uFlags.reset(CHN_16BIT | CHN_STEREO);
@@ -1599,6 +1877,26 @@ bool CSoundFile::DestroySampleThreadsafe(SAMPLEINDEX nSample)
 }
 
 
+bool CSoundFile::MakeSampleDataWritable(ModSample &sample)
+{
+	if(!m_sharedSamples || !m_sharedSamples->Contains(sample.samplev()))
+		return true;
+	void *newData = ModSample::AllocateSample(sample.nLength, sample.GetBytesPerSample());
+	if(newData == nullptr)
+		return false;
+	const void *oldData = sample.samplev();
+	std::memcpy(newData, oldData, sample.GetSampleSizeInBytes());
+	sample.pData.pSample = newData;
+	sample.PrecomputeLoops(*this, false);
+	for(auto &chn : m_PlayState.Chn)
+	{
+		if(chn.pCurrentSample == oldData)
+			chn.pCurrentSample = newData;
+	}
+	return true;
+}
+
+
 std::unique_ptr<CTuning> CSoundFile::CreateTuning12TET(const mpt::ustring &name)
 {
 	std::unique_ptr<CTuning> pT = CTuning::CreateGeometric(name, 12, 2, 15);
@@ -1787,14 +2085,59 @@ double CSoundFile::GetPlaybackTimeAt(ORDERINDEX ord, ROWINDEX row, bool updateVa
 }
 
 
-std::vector<SubSong> CSoundFile::GetAllSubSongs()
+std::vector<SubSong> CSoundFile::GetAllSubSongs(bool parallel)
+{
+	return *GetAllSubSongs(nullptr, parallel);
+}
+
+
+std::optional<std::vector<SubSong>> CSoundFile::GetAllSubSongs(const SubSongProgressFunc &progress, bool parallel)
 {
+	const SEQUENCEINDEX numSequences = Order.GetNumSequences();
+	std::vector<std::vector<GetLengthType>> lengths(numSequences);
+	std::atomic<bool> cancel = false;
+	mpt::mutex progressMutex;
+	SEQUENCEINDEX numFinished = 0;
+
+	// Without adjusting the playback state, GetLength() does not modify the CSoundFile, so sequences can be evaluated concurrently.
+	const auto evaluateSequence = [&](std::size_t seq)
+	{
+		lengths[seq] = GetLength(eNoAdjust, GetLengthTarget(true).StartPos(static_cast<SEQUENCEINDEX>(seq), 0, 0).CancelOn(cancel));
+		if(progress)
+		{
+			mpt::lock_guard<mpt::mutex> lock(progressMutex);
+			numFinished++;
+			if(!cancel && !progress(numFinished, numSequences))
+				cancel = true;
+		}
+	};
+
+	std::size_t numThreads = 1;
+#if MPT_THREADPOOL_THREADS
+	if(parallel)
+		numThreads = std::min(static_cast<std::size_t>(std::max(std::thread::hardware_concurrency(), 1u)), static_cast<std::size_t>(numSequences));
+#else
+	MPT_UNUSED(parallel);
+#endif // MPT_THREADPOOL_THREADS
+	if(numThreads > 1)
+	{
+		// The calling thread also evaluates sequences
+		ThreadPool(numThreads - 1).Run(numSequences, evaluateSequence);
+	} else
+	{
+		for(SEQUENCEINDEX seq = 0; seq < numSequences && !cancel; seq++)
+		{
+			evaluateSequence(seq);
+		}
+	}
+	if(cancel)
+		return std::nullopt;
+
 	std::vector<SubSong> subSongs;
-	for(SEQUENCEINDEX seq = 0; seq < Order.GetNumSequences(); seq++)
+	for(SEQUENCEINDEX seq = 0; seq < numSequences; seq++)
 	{
-		const auto subSongsSeq = GetLength(eNoAdjust, GetLengthTarget(true).StartPos(seq, 0, 0));
-		subSongs.reserve(subSongs.size() + subSongsSeq.size());
-		for(const auto &song : subSongsSeq)
+		subSongs.reserve(subSongs.size() + lengths[seq].size());
+		for(const auto &song : lengths[seq])
 		{
 			subSongs.push_back({song.duration, song.startRow, song.endRow, song.lastRow, song.startOrder, song.endOrder, song.lastOrder, seq});
 		}
@@ -2059,6 +2402,101 @@ void CSoundFile::PrecomputeSampleLoops(bool updateChannels)
 }
 
 
+bool CSoundFile::DeferSampleData(SAMPLEINDEX smp, const SampleIO &sampleIO, const FileReader &file, ModLoadingFlags loadFlags)
+{
+	if(!(loadFlags & (deferSampleData | decodeSamplesInParallel | shareSampleData)) || !m_deferredSamples || smp == 0 || smp >= MAX_SAMPLES)
+		return false;
+	ModSample &sample = Samples[smp];
+	if(sample.nLength == 0 || sample.nLength > MAX_SAMPLE_LENGTH)
+		return false;
+
+	// Only defer samples whose length we already know, i.e. if ReadSample would not have to shorten them due to missing data.
+	FileReader sampleData;
+	if(sampleIO.GetEncoding() == SampleIO::IT214 || sampleIO.GetEncoding() == SampleIO::IT215)
+	{
+		// Same estimate of the maximum sample length as in SampleIO::ReadSample
+		const uint8 maxSamplesPerByte = 8 / sampleIO.GetNumChannels();
+		if((sample.nLength + maxSamplesPerByte - 1u) / maxSamplesPerByte > file.BytesLeft())
+			return false;
+		sampleData = file.GetChunkAt(file.GetPosition(), file.BytesLeft());
+	} else if(!sampleIO.UsesFileReaderForDecoding() && !sampleIO.IsVariableLengthEncoded())
+	{
+		const std::size_t encodedSize = sampleIO.CalculateEncodedSize(sample.nLength);
+		if(!file.CanRead(encodedSize))
+			return false;
+		sampleData = file.GetChunkAt(file.GetPosition(), encodedSize);
+	} else
+	{
+		return false;
+	}
+
+	sample.FreeSample();
+	sample.uFlags.set(CHN_16BIT, sampleIO.GetBitDepth() >= 16);
+	sample.uFlags.set(CHN_STEREO, sampleIO.GetChannelFormat() != SampleIO::mono);
+	m_deferredSamples->Add(smp, sampleIO, std::move(sampleData));
+	return true;
+}
+
+
+bool CSoundFile::IsSampleDataDeferred(SAMPLEINDEX smp) const
+{
+	return m_deferredSamples && m_deferredSamples->Contains(smp);
+}
+
+
+// Take over the decoded sample data. Waits for the background thread if it is still decoding the sample, or decodes it right now if it has not been started yet.
+void CSoundFile::LoadDeferredSample(SAMPLEINDEX smp)
+{
+	ModSample &sample = Samples[smp];
+	const ModSample decoded = m_deferredSamples->Decode(smp, sample);
+	if(!decoded.HasSampleData())
+	{
+		// Same as for samples that could not be read while loading
+		sample.nLength = 0;
+		for(auto &chn : m_PlayState.Chn)
+		{
+			if(chn.pModSample == &sample)
+				chn.nLength = 0;
+		}
+	} else
+	{
+		MPT_ASSERT(decoded.nLength == sample.nLength);
+		sample.pData.pSample = decoded.pData.pSample;
+		sample.PrecomputeLoops(*this, false);
+	}
+	// Once everything has been decoded, the copy of the module file is no longer needed
+	if(m_deferredSamples->empty())
+		m_deferredSamples.reset();
+}
+
+
+// Decode all deferred samples at the end of loading, possibly in parallel.
+// Samples that could not be decoded are treated like samples whose data could not be read by the loader.
+void CSoundFile::DecodeDeferredSamples()
+{
+	m_deferredSamples->DecodeAll(Samples, m_loadThreadPool.get());
+	for(SAMPLEINDEX smp = 1; smp < MAX_SAMPLES; smp++)
+	{
+		if(m_deferredSamples->Contains(smp))
+			Samples[smp].pData.pSample = m_deferredSamples->Decode(smp, Samples[smp]).pData.pSample;
+	}
+	m_deferredSamples.reset();
+}
+
+
+void CSoundFile::RunLoadTasks(std::size_t numTasks, const std::function<void(std::size_t)> &func)
+{
+	if(m_loadThreadPool)
+	{
+		m_loadThreadPool->Run(numTasks, func);
+	} else
+	{
+		for(std::size_t task = 0; task < numTasks; task++)
+			func(task);
+	}
+}
+
+
 #ifdef MPT_EXTERNAL_SAMPLES
 // Load external waveform, but keep sample properties like frequency, panning, etc...
 // Returns true if the file could be loaded.
@@ -19,8 +19,13 @@
 #include "../common/mptFileType.h"
 #include "../common/mptRandom.h"
 #include "../common/version.h"
+#include <array>
 #include <vector>
+#include <atomic>
 #include <bitset>
+#include <chrono>
+#include <functional>
+#include <optional>
 #include <set>
 #include "Snd_defs.h"
 #include "tuningbase.h"
@@ -46,6 +51,7 @@
 
 #include "modcommand.h"
 #include "ModSample.h"
+#include "ChunkedArray.h"
 #include "ModInstrument.h"
 #include "ModChannel.h"
 #include "plugins/PluginStructs.h"
@@ -88,6 +94,11 @@ class CVstPluginManager;
 #endif
 #endif
 
+class ThreadPool;
+class DeferredSamples;
+class SharedSamples;
+class SampleIO;
+
 
 using PlayBehaviourSet = std::bitset<kMaxPlayBehaviours>;
 
@@ -127,12 +138,17 @@ struct SubSong
 };
 
 
+class SeekIndex;
+
+
 // Target seek mode for GetLength()
 struct GetLengthTarget
 {
 	ROWINDEX startRow;
 	ORDERINDEX startOrder;
 	SEQUENCEINDEX sequence;
+	SeekIndex *seekIndex = nullptr;
+	const std::atomic<bool> *cancel = nullptr;
 	
 	struct pos_type
 	{
@@ -200,6 +216,20 @@ struct GetLengthTarget
 		startRow = row;
 		return *this;
 	}
+
+	// Use and extend the given seek index when seeking to a time target.
+	GetLengthTarget &UseSeekIndex(SeekIndex *index)
+	{
+		seekIndex = index;
+		return *this;
+	}
+
+	// Stop as soon as possible once the given flag is set. The results are incomplete in that case.
+	GetLengthTarget &CancelOn(const std::atomic<bool> &flag)
+	{
+		cancel = &flag;
+		return *this;
+	}
 };
 
 
@@ -219,6 +249,66 @@ enum enmGetLengthResetMode
 };
 
 
+// Snapshots of the GetLength() simulation state, taken at regular time intervals while seeking to a time target.
+// Subsequent seeks into the same subsong resume from the closest preceding snapshot instead of simulating everything from the subsong start.
+class SeekIndex
+{
+public:
+	struct Checkpoint;  // Defined in Snd_fx.cpp
+
+	SeekIndex(double interval = 10.0, size_t maxMemory = 16 * 1024 * 1024);
+	~SeekIndex();
+
+	// Minimum distance between two snapshots, in seconds
+	void SetInterval(double interval);
+	double GetInterval() const noexcept { return m_interval; }
+	// Upper bound for the memory held by all snapshots, in bytes. No new snapshots are taken once it is reached.
+	void SetMaxMemory(size_t maxMemory);
+	size_t GetMaxMemory() const noexcept { return m_maxMemory; }
+
+	size_t GetMemoryUsage() const noexcept { return m_memoryUsage; }
+	size_t GetNumCheckpoints() const noexcept { return m_checkpoints.size(); }
+
+	// Must be called whenever something that influences GetLength() changes without being part of the key below (e.g. pattern data or channel mute status).
+	void Clear() noexcept;
+
+protected:
+	friend class CSoundFile;
+
+	// Everything that is passed to GetLength() or influences the timing of the simulation. Snapshots taken with a different key cannot be reused.
+	struct Key
+	{
+		SEQUENCEINDEX sequence = SEQUENCEINDEX_INVALID;
+		ORDERINDEX startOrder = 0;
+		ROWINDEX startRow = 0;
+		enmGetLengthResetMode adjustMode = eNoAdjust;
+		uint32 mixingFreq = 0;
+		uint32 tempoFactor = 0;
+
+		bool operator==(const Key &other) const noexcept
+		{
+			return sequence == other.sequence && startOrder == other.startOrder && startRow == other.startRow
+				&& adjustMode == other.adjustMode && mixingFreq == other.mixingFreq && tempoFactor == other.tempoFactor;
+		}
+		bool operator!=(const Key &other) const noexcept { return !(*this == other); }
+	};
+
+	// Discards all snapshots if they were taken with a different key
+	void Prepare(const Key &key) noexcept;
+	// Returns the latest snapshot taken strictly before the given time, or nullptr if there is none
+	const Checkpoint *FindCheckpoint(double time) const noexcept;
+	// Returns true if a snapshot should be taken at the given point in time
+	bool WantCheckpoint(double time) const noexcept;
+	void AddCheckpoint(std::unique_ptr<Checkpoint> checkpoint);
+
+	std::vector<std::unique_ptr<Checkpoint>> m_checkpoints;  // Sorted by elapsed time
+	Key m_key;
+	double m_interval;
+	size_t m_maxMemory;
+	size_t m_memoryUsage = 0;
+};
+
+
 // Delete samples assigned to instrument
 enum deleteInstrumentSamples
 {
@@ -280,6 +370,35 @@ struct TimingInfo
 };
 
 
+// Statistics about the work done in CSoundFile::Read(), for profiling.
+// Only collected if CSoundFile::m_collectRenderStats is set. Nothing is collected in builds with NO_RENDER_STATS.
+struct RenderStats
+{
+	enum Stage
+	{
+		ReadNote,          // Pattern and channel processing (ReadNote)
+		Mix,               // Sample voice mixing (CreateStereoMix)
+		OPL,               // OPL synthesis
+		Reverb,            // Built-in reverb
+		Plugins,           // Mix plugins
+		GlobalVolume,      // Master global volume
+		StereoSeparation,  // Stereo separation
+		DSP,               // Built-in DSP effects
+		Output,            // Conversion to the output format and dithering
+		NumStages
+	};
+
+	using duration = std::chrono::steady_clock::duration;
+	std::array<duration, NumStages> time{};  // Accumulated time spent in every stage
+	std::array<uint64, NumStages> calls{};   // Number of times every stage was executed. calls[Mix] is the number of rendered chunks.
+
+	uint64 mixedVoices = 0;           // Number of mixed voices, summed up over all chunks
+	uint64 skippedVoices = 0;         // Number of voices that were not mixed because of MixerSettings::m_nMaxMixChannels, summed up over all chunks
+	uint64 skippedFrames = 0;         // Number of sample frames that were not mixed because of MixerSettings::m_nMaxMixChannels
+	CHANNELINDEX maxMixedVoices = 0;  // Highest number of voices mixed in a single chunk
+};
+
+
 enum class ModMessageHeuristicOrder
 {
 	Instruments,
@@ -387,7 +506,13 @@ public:
 	// If updateSamplePos is also true, the sample positions of samples still playing from previous patterns will be kept in sync.
 	double GetPlaybackTimeAt(ORDERINDEX ord, ROWINDEX row, bool updateVars, bool updateSamplePos);
 
-	std::vector<SubSong> GetAllSubSongs();
+	// Called after each sequence has been evaluated, with the number of finished and total sequences.
+	// Return false to cancel. May be called from any thread, but never concurrently.
+	using SubSongProgressFunc = std::function<bool(SEQUENCEINDEX finished, SEQUENCEINDEX total)>;
+	// Length and position of all sub songs in all sequences. If parallel is true, sequences are evaluated on multiple threads.
+	std::vector<SubSong> GetAllSubSongs(bool parallel = false);
+	// Same as above, but reports progress and returns std::nullopt if the progress callback cancelled the search.
+	std::optional<std::vector<SubSong>> GetAllSubSongs(const SubSongProgressFunc &progress, bool parallel = false);
 
 	//Tuning-->
 public:
@@ -423,22 +548,71 @@ private: //Misc data
 	const CModSpecifications *m_pModSpecs;
 
 private:
+	// Mix buffers are allocated to fit MixerSettings::MixChunkSize frames
 	// Interleaved Front Mix Buffer (Also room for interleaved rear mix)
-	mixsample_t MixSoundBuffer[MIXBUFFERSIZE * 4];
-	mixsample_t MixRearBuffer[MIXBUFFERSIZE * 2];
+	std::vector<mixsample_t> MixSoundBuffer;
+	std::vector<mixsample_t> MixRearBuffer;
 	// Non-interleaved plugin processing buffer
-	float MixFloatBuffer[2][MIXBUFFERSIZE];
-	mixsample_t MixInputBuffer[NUMMIXINPUTBUFFERS][MIXBUFFERSIZE];
+	std::array<std::vector<float>, 2> MixFloatBuffer;
+	std::array<std::vector<mixsample_t>, NUMMIXINPUTBUFFERS> MixInputBuffer;
 
 	// End-of-sample pop reduction tail level
 	mixsample_t m_dryLOfsVol = 0, m_dryROfsVol = 0;
 	mixsample_t m_surroundLOfsVol = 0, m_surroundROfsVol = 0;
 
+	// Buffer and end-of-sample pop reduction levels that a sample voice is mixed into
+	struct MixTarget
+	{
+		mixsample_t *buffer;
+		mixsample_t *ofsR, *ofsL;
+		PLUGINDEX plugin;  // 1-based index of the plugin the voice is routed to, or 0
+	};
+	struct MixVoice
+	{
+		ModChannel *chn;
+		PLUGINDEX plugin;
+		uint16 target;  // Index into m_mixTargets
+		bool mixed;
+	};
+
+	// Multi-threaded voice mixing (see MixerSettings::NumMixThreads)
+	std::unique_ptr<ThreadPool> m_mixThreadPool;
+	std::vector<MixTarget> m_mixTargets;
+	std::vector<MixVoice> m_mixVoices;
+	std::vector<mixsample_t> m_mixThreadBuffer;  // Private mix buffer for each task and target
+	std::vector<mixsample_t> m_mixThreadOfs;     // Private end-of-sample pop reduction levels for each task and target
+	std::vector<uint8> m_mixThreadTargetUsed;
+
+#ifndef NO_PLUGINS
+	// Plugin processing order, compiled from the plugin routing (see UpdatePluginSchedule)
+	struct PluginScheduleEntry
+	{
+		IMixPlugin *plugin;     // Plugin in this slot when the schedule was compiled, nullptr if the slot is only routed into another plugin
+		uint32 outputRouting;   // SNDMIXPLUGININFO::dwOutputRouting when the schedule was compiled
+		PLUGINDEX slot;
+		bool masterEffect;
+		bool hasPluginInput;    // A plugin in a lower slot is routed into this plugin
+		bool inParallelChain;   // Processed by ProcessPluginChains instead of in slot order
+	};
+	std::vector<PluginScheduleEntry> m_pluginSchedule;
+	// Independent plugin chains, each of which can be processed on a different thread.
+	// Chain i consists of the schedule entries m_pluginChainEntries[m_pluginChainStart[i]] to m_pluginChainEntries[m_pluginChainStart[i + 1] - 1].
+	std::vector<uint16> m_pluginChainEntries;
+	std::vector<uint16> m_pluginChainStart;
+#endif // NO_PLUGINS
+
+	// Sample data that has not been decoded yet (see deferSampleData)
+	std::unique_ptr<DeferredSamples> m_deferredSamples;
+	// Threads for decoding sample data while loading (see decodeSamplesInParallel)
+	std::unique_ptr<ThreadPool> m_loadThreadPool;
+	// Read-only sample data shared with other instances of the same module (see shareSampleData)
+	std::shared_ptr<const SharedSamples> m_sharedSamples;
+
 public:
 	MixerSettings m_MixerSettings;
 	CResampler m_Resampler;
 #ifndef NO_REVERB
-	mixsample_t ReverbSendBuffer[MIXBUFFERSIZE * 2];
+	std::vector<mixsample_t> ReverbSendBuffer;
 	mixsample_t m_RvbROfsVol = 0, m_RvbLOfsVol = 0;
 	CReverb m_Reverb;
 #endif
@@ -513,15 +687,19 @@ public:
 	CPatternContainer Patterns;
 	ModSequenceSet Order;  // Pattern sequences (order lists)
 protected:
-	ModSample Samples[MAX_SAMPLES];
+	ChunkedArray<ModSample, MAX_SAMPLES> Samples;  // Only the chunks containing samples that are actually used are allocated
 public:
 	ModInstrument *Instruments[MAX_INSTRUMENTS];  // Instrument Headers
 	MIDIMacroConfig m_MidiCfg;                    // MIDI Macro config table
+protected:
+	CompiledMIDIMacroConfig m_compiledMidiCfg;  // Pre-parsed version of m_MidiCfg, see UpdateCompiledMIDIMacros()
+public:
 #ifndef NO_PLUGINS
 	std::array<SNDMIXPLUGIN, MAX_MIXPLUGINS> m_MixPlugins;  // Mix plugins
 	uint32 m_loadedPlugins = 0;                             // Not a PLUGINDEX because number of loaded plugins may exceed MAX_MIXPLUGINS during MIDI conversion
+	bool m_pluginScheduleDirty = true;                      // Plugins have been created or destroyed since the plugin schedule was compiled
 #endif
-	mpt::charbuf<MAX_SAMPLENAME> m_szNames[MAX_SAMPLES];  // Sample names
+	ChunkedArray<mpt::charbuf<MAX_SAMPLENAME>, MAX_SAMPLES> m_szNames;  // Sample names
 
 	Version m_dwCreatedWithVersion;
 	Version m_dwLastSavedWithVersion;
@@ -540,7 +718,8 @@ protected:
 	MixLevels m_nMixLevels;
 
 public:
-	struct PlayState
+	// The part of PlayState that does not belong to any channel
+	struct GlobalPlayState
 	{
 		friend class CSoundFile;
 
@@ -589,10 +768,6 @@ public:
 	public:
 		bool m_bPositionChanged = true; // Report to plugins that we jumped around in the module
 
-	public:
-		CHANNELINDEX ChnMix[MAX_CHANNELS]; // Index of channels in Chn to be actually mixed
-		ModChannel Chn[MAX_CHANNELS];      // Mixing channels... First m_nChannels channels are master channels (i.e. they are never NNA channels)!
-
 		struct MIDIMacroEvaluationResults
 		{
 			std::map<PLUGINDEX, float> pluginDryWetRatio;
@@ -603,8 +778,6 @@ public:
 		std::optional<MIDIMacroEvaluationResults> m_midiMacroEvaluationResults;
 
 	public:
-		PlayState();
-
 		void ResetGlobalVolumeRamping()
 		{
 			m_lHighResRampingGlobalVolume = m_nGlobalVolume << VOLUMERAMPPRECISION;
@@ -619,12 +792,79 @@ public:
 		}
 	};
 
+	struct PlayState : public GlobalPlayState
+	{
+		friend class CSoundFile;
+
+	public:
+		CHANNELINDEX ChnMix[MAX_CHANNELS]; // Index of channels in Chn to be actually mixed
+		ModChannel Chn[MAX_CHANNELS];      // Mixing channels... First m_nChannels channels are master channels (i.e. they are never NNA channels)!
+
+		// Copy of a PlayState that only contains the channels that are actually in use, see Save() and Restore().
+		class Snapshot
+		{
+			friend struct PlayState;
+
+		public:
+			[[nodiscard]] size_t GetMemoryUsage() const noexcept;
+
+			const GlobalPlayState &GetGlobalState() const noexcept { return m_global; }
+			CHANNELINDEX GetNumPatternChannels() const noexcept { return m_numPatternChannels; }
+			// Only pattern channels can be accessed, i.e. chn must be less than GetNumPatternChannels().
+			const ModChannel &GetPatternChannel(CHANNELINDEX chn) const noexcept { return m_channels[chn]; }
+
+		protected:
+			GlobalPlayState m_global;
+			std::vector<ModChannel> m_channels;            // Pattern channels, followed by the saved background channels
+			std::vector<CHANNELINDEX> m_backgroundChannels;  // Indices of the saved background channels
+			CHANNELINDEX m_numPatternChannels = 0;
+			bool m_hasBackgroundChannels = false;
+		};
+
+	public:
+		PlayState();
+
+		// Save the global state and the first numPatternChannels channels into the snapshot, reusing its memory.
+		// If includeBackgroundChannels is true, all background (NNA) channels that are still playing are saved as well.
+		void Save(Snapshot &snapshot, CHANNELINDEX numPatternChannels, bool includeBackgroundChannels) const;
+		// Restore a previously saved state.
+		// If the snapshot contains background channels, all other background channels are stopped. Otherwise, they are left untouched.
+		void Restore(const Snapshot &snapshot);
+		// Copy the global state and the first numPatternChannels channels of another play state. All other channels are left untouched.
+		void AssignPatternState(const PlayState &other, CHANNELINDEX numPatternChannels);
+
+		// Background channels that are not in use do not need to be saved.
+		static bool IsBackgroundChannelInUse(const ModChannel &chn) noexcept;
+	};
+
 	PlayState m_PlayState;
 
+	// Rendering state that is not part of the PlayState but is carried over from one rendered chunk to the next.
+	// Saving it together with a PlayState snapshot allows to continue rendering from the same sample position later.
+	struct ResumeState
+	{
+		std::array<CHANNELINDEX, MAX_CHANNELS> mixChannels;
+		CHANNELINDEX numMixChannels = 0;
+		mixsample_t dryLOfsVol = 0, dryROfsVol = 0;
+		mixsample_t surroundLOfsVol = 0, surroundROfsVol = 0;
+		CHANNELINDEX mixStat = 0;  // Number of voices mixed by the last Read() call
+		std::unique_ptr<RowVisitor> visitedRows;
+		std::optional<mpt::fast_prng> prng;  // Random waveforms, random volume / panning variation, etc.
+	};
+	void SaveResumeState(ResumeState &state) const;
+	void RestoreResumeState(const ResumeState &state);
+
 protected:
 	// For handling backwards jumps and stuff to prevent infinite loops when counting the mod length or rendering to wav.
 	RowVisitor m_visitedRows;
 
+	// Play states used by GetLength(), so that seeking does not have to allocate and initialize a complete PlayState every time.
+	// There is more than one if GetLength() is called concurrently (see GetAllSubSongs).
+	std::unique_ptr<PlayState> AcquireLengthPlayState() const;
+	void ReleaseLengthPlayState(std::unique_ptr<PlayState> state) const;
+	mutable mpt::mutex m_lengthPlayStatesMutex;
+	mutable std::vector<std::unique_ptr<PlayState>> m_lengthPlayStates;
+
 public:
 #ifdef MODPLUG_TRACKER
 	std::bitset<MAX_BASECHANNELS> m_bChannelMuteTogglePending;
@@ -681,6 +921,11 @@ public:
 	bool m_bIsRendering = false;
 	TimingInfo m_TimingInfo; // only valid if !m_bIsRendering
 
+#ifndef NO_RENDER_STATS
+	bool m_collectRenderStats = false;
+	RenderStats m_renderStats;  // Accumulated by Read() if m_collectRenderStats is set
+#endif // !NO_RENDER_STATS
+
 private:
 	// logging
 	ILog *m_pCustomLog = nullptr;
@@ -707,6 +952,9 @@ public:
 		loadPluginInstance = 0x08, // If unset, plugins are not instanciated.
 		skipContainer      = 0x10,
 		skipModules        = 0x20,
+		deferSampleData    = 0x40, // If set together with loadSampleData, supported loaders only remember where the sample data is stored, and it is decoded when the sample is first played. If the file is in memory, the memory must stay valid for as long as the CSoundFile exists.
+		decodeSamplesInParallel = 0x80, // If set together with loadSampleData, supported loaders decode sample data on several threads. Ignored if deferSampleData is set.
+		shareSampleData    = 0x100, // If set together with loadSampleData, decoded sample data is shared with other instances that loaded the same file. The sample data must not be modified. Overrides deferSampleData.
 
 		// Shortcuts
 		loadCompleteModule = loadSampleData | loadPatternData | loadPluginData | loadPluginInstance,
@@ -808,7 +1056,8 @@ protected:
 #endif  // MODPLUG_TRACKER
 
 public:
-	double GetCurrentBPM() const;
+	double GetCurrentBPM() const { return GetCurrentBPM(m_PlayState); }
+	double GetCurrentBPM(const GlobalPlayState &playState) const;
 	void DontLoopPattern(PATTERNINDEX nPat, ROWINDEX nRow = 0);
 	CHANNELINDEX GetMixStat() const { return m_nMixStat; }
 	void ResetMixStat() { m_nMixStat = 0; }
@@ -1020,11 +1269,23 @@ public:
 	samplecount_t ReadOneTick();
 private:
 	void CreateStereoMix(int count);
+	CHANNELINDEX CreateStereoMixParallel(int count, CHANNELINDEX &numSkipped);
+	MixTarget GetMixTarget(CHANNELINDEX nChn, int count);
+	bool MixChannel(ModChannel &chn, mixsample_t *pbuffer, mixsample_t &ofsR, mixsample_t &ofsL, int count, bool tooManyChannels) const;
+	void UpdateMixThreads();
+	void UpdateMixBuffers();
+	samplecount_t GetMixChunkSize() const;
 public:
 	bool FadeSong(uint32 msec);
 private:
 	void ProcessDSP(uint32 countChunk);
 	void ProcessPlugins(uint32 nCount);
+#ifndef NO_PLUGINS
+	bool IsPluginScheduleValid() const;
+	void UpdatePluginSchedule();
+	void ProcessPluginChains(uint32 nCount, bool positionChanged);
+	void ProcessPlugin(const PluginScheduleEntry &entry, float *&pMixL, float *&pMixR, uint32 nCount, bool masterHasInput, bool positionChanged);
+#endif // NO_PLUGINS
 	void ProcessInputChannels(IAudioSource &source, std::size_t countChunk);
 public:
 	samplecount_t GetTotalSampleCount() const { return m_PlayState.m_lTotalSampleCount; }
@@ -1032,8 +1293,24 @@ public:
 	bool IsRenderingToDisc() const { return m_bIsRendering; }
 
 	void PrecomputeSampleLoops(bool updateChannels = false);
+
+	// Loaders: Remember where the sample data is stored instead of decoding it right away, if the loading flags allow for it.
+	// Returns false if the sample data has to be decoded by the caller.
+	bool DeferSampleData(SAMPLEINDEX smp, const SampleIO &sampleIO, const FileReader &file, ModLoadingFlags loadFlags);
+	bool IsSampleDataDeferred(SAMPLEINDEX smp) const;
+	// Loaders: Calls func(task) for each task in [0, numTasks), on several threads if the loading flags allow for it.
+	// Tasks must not access any shared state, including the log.
+	void RunLoadTasks(std::size_t numTasks, const std::function<void(std::size_t)> &func);
+private:
+	void LoadDeferredSample(SAMPLEINDEX smp);
+	void DecodeDeferredSamples();
+	void PrefetchDeferredSamples();
+public:
 	void UpdateInstrumentFilter(const ModInstrument &ins, bool updateMode, bool updateCutoff, bool updateResonance);
 
+	// Pre-parse the MIDI macros after m_MidiCfg has been changed. Macros that have been changed since the last update still work, but are parsed every time they are executed.
+	void UpdateCompiledMIDIMacros() { m_compiledMidiCfg.Update(m_MidiCfg); }
+
 public:
 	// Mixer Config
 	void SetMixerSettings(const MixerSettings &mixersettings);
@@ -1158,7 +1435,7 @@ protected:
 
 	void ProcessMacroOnChannel(CHANNELINDEX nChn);
 	void ProcessMIDIMacro(PlayState &playState, CHANNELINDEX nChn, bool isSmooth, const MIDIMacroConfigData::Macro &macro, uint8 param = 0, PLUGINDEX plugin = 0);
-	void ParseMIDIMacro(PlayState &playState, CHANNELINDEX nChn, bool isSmooth, const mpt::span<const char> macro, mpt::span<uint8> &out, uint8 param = 0, PLUGINDEX plugin = 0) const;
+	void ParseMIDIMacro(PlayState &playState, CHANNELINDEX nChn, bool isSmooth, const CompiledMIDIMacro &macro, mpt::span<uint8> &out, uint8 param = 0, PLUGINDEX plugin = 0) const;
 	static float CalculateSmoothParamChange(const PlayState &playState, float currentValue, float param);
 	void SendMIDIData(PlayState &playState, CHANNELINDEX nChn, bool isSmooth, const mpt::span<const uint8> macro, PLUGINDEX plugin);
 	void SendMIDINote(CHANNELINDEX chn, uint16 note, uint16 volume);
@@ -1204,6 +1481,9 @@ public:
 
 	bool DestroySample(SAMPLEINDEX nSample);
 	bool DestroySampleThreadsafe(SAMPLEINDEX nSample);
+	// Give a sample its own copy of its sample data if it is shared with other instances (see shareSampleData), so that it can be modified.
+	// Returns false if the sample data is shared and could not be copied.
+	bool MakeSampleDataWritable(ModSample &sample);
 
 	// Find an unused sample slot. If it is going to be assigned to an instrument, targetInstrument should be specified.
 	// SAMPLEINDEX_INVLAID is returned if no free sample slot could be found.
@@ -1280,8 +1560,12 @@ public:
 	uint32 GetPeriodFromNote(uint32 note, int32 nFineTune, uint32 nC5Speed) const;
 	uint32 GetFreqFromPeriod(uint32 period, uint32 c5speed, int32 nPeriodFrac = 0) const;
 	// Misc functions
-	ModSample &GetSample(SAMPLEINDEX sample) { MPT_ASSERT(sample <= m_nSamples && sample < std::size(Samples)); return Samples[sample]; }
-	const ModSample &GetSample(SAMPLEINDEX sample) const { MPT_ASSERT(sample <= m_nSamples && sample < std::size(Samples)); return Samples[sample]; }
+	ModSample &GetSample(SAMPLEINDEX sample) { MPT_ASSERT(sample <= m_nSamples && sample < Samples.size()); return Samples[sample]; }
+	const ModSample &GetSample(SAMPLEINDEX sample) const { MPT_ASSERT(sample <= m_nSamples && sample < Samples.size()); return Samples[sample]; }
+	// Memory allocated for sample headers and sample names (not including the sample data itself)
+	std::size_t GetSampleHeaderMemoryUsage() const noexcept { return Samples.GetAllocatedSize() + m_szNames.GetAllocatedSize(); }
+	// Returns the index of a sample slot of this module, or MAX_SAMPLES if the sample does not belong to this module.
+	SAMPLEINDEX GetSampleIndex(const ModSample *sample) const noexcept { return static_cast<SAMPLEINDEX>(Samples.IndexOf(sample)); }
 
 	// Resolve note/instrument combination to real sample index. Return value is guaranteed to be in [0, GetNumSamples()].
 	SAMPLEINDEX GetSampleIndex(ModCommand::NOTE note, uint32 instr) const noexcept;
@@ -12,9 +12,11 @@
 #include "stdafx.h"
 
 #include "Sndfile.h"
+#include "DeferredSamples.h"
 #include "MixerLoops.h"
 #include "MIDIEvents.h"
 #include "Tables.h"
+#include "../common/mptThreadPool.h"
 #ifdef MODPLUG_TRACKER
 #include "../mptrack/TrackerSettings.h"
 #endif // MODPLUG_TRACKER
@@ -23,6 +25,8 @@
 #endif // NO_PLUGINS
 #include "OPL.h"
 
+#include <system_error>
+
 OPENMPT_NAMESPACE_BEGIN
 
 // Log tables for pre-amp
@@ -59,10 +63,74 @@ void CSoundFile::SetMixerSettings(const MixerSettings &mixersettings)
 		(mixersettings.MixerFlags != m_MixerSettings.MixerFlags))
 		reset = true;
 	m_MixerSettings = mixersettings;
+	UpdateMixBuffers();
+	UpdateMixThreads();
 	InitPlayer(reset);
 }
 
 
+void CSoundFile::UpdateMixBuffers()
+{
+	const std::size_t chunkSize = m_MixerSettings.MixChunkSize;
+	if(MixSoundBuffer.size() == chunkSize * 4)
+		return;
+	MixSoundBuffer.assign(chunkSize * 4, 0);
+	MixRearBuffer.assign(chunkSize * 2, 0);
+	for(auto &buffer : MixFloatBuffer)
+		buffer.assign(chunkSize, 0.0f);
+	for(auto &buffer : MixInputBuffer)
+		buffer.assign(chunkSize, 0);
+#ifndef NO_REVERB
+	ReverbSendBuffer.assign(chunkSize * 2, 0);
+#endif
+}
+
+
+// Maximum number of frames that can be rendered in one go
+CSoundFile::samplecount_t CSoundFile::GetMixChunkSize() const
+{
+#ifndef NO_PLUGINS
+	// Plugin buffers and block sizes are fixed
+	if(m_loadedPlugins)
+		return std::min(m_MixerSettings.MixChunkSize, samplecount_t(MIXBUFFERSIZE));
+#endif // NO_PLUGINS
+	return m_MixerSettings.MixChunkSize;
+}
+
+
+void CSoundFile::UpdateMixThreads()
+{
+#if MPT_THREADPOOL_THREADS
+	const std::size_t numWorkers = std::clamp(m_MixerSettings.NumMixThreads, uint32(1), uint32(MixerSettings::MaxMixThreads)) - 1u;
+#else
+	const std::size_t numWorkers = 0;
+#endif
+	if(numWorkers == 0)
+	{
+		m_mixThreadPool.reset();
+		return;
+	}
+	if(m_mixThreadPool && m_mixThreadPool->GetNumThreads() == numWorkers)
+		return;
+	m_mixThreadPool.reset();
+	try
+	{
+		m_mixThreadPool = std::make_unique<ThreadPool>(numWorkers);
+	} catch(const std::system_error &)
+	{
+		// Could not create the threads, mix everything on the calling thread instead
+		return;
+	}
+	// Avoid allocations in the mixer for the most common cases
+	const std::size_t numTasks = numWorkers + 1;
+	m_mixTargets.reserve(MAX_MIXPLUGINS + 3);
+	m_mixVoices.reserve(MAX_CHANNELS);
+	m_mixThreadBuffer.reserve(numTasks * 3 * m_MixerSettings.MixChunkSize * 2);
+	m_mixThreadOfs.reserve(numTasks * (MAX_MIXPLUGINS + 3) * 2);
+	m_mixThreadTargetUsed.reserve(numTasks * (MAX_MIXPLUGINS + 3));
+}
+
+
 void CSoundFile::SetResamplerSettings(const CResamplerSettings &resamplersettings)
 {
 	m_Resampler.m_Settings = resamplersettings;
@@ -184,12 +252,12 @@ void CSoundFile::ProcessInputChannels(IAudioSource &source, std::size_t countChu
 {
 	for(std::size_t channel = 0; channel < NUMMIXINPUTBUFFERS; ++channel)
 	{
-		std::fill(&(MixInputBuffer[channel][0]), &(MixInputBuffer[channel][countChunk]), 0);
+		std::fill(MixInputBuffer[channel].begin(), MixInputBuffer[channel].begin() + countChunk, 0);
 	}
 	mixsample_t * buffers[NUMMIXINPUTBUFFERS];
 	for(std::size_t channel = 0; channel < NUMMIXINPUTBUFFERS; ++channel)
 	{
-		buffers[channel] = MixInputBuffer[channel];
+		buffers[channel] = MixInputBuffer[channel].data();
 	}
 	source.Process(mpt::audio_span_planar(buffers, m_MixerSettings.NumInputChannels, countChunk));
 }
@@ -200,13 +268,20 @@ CSoundFile::samplecount_t CSoundFile::ReadOneTick()
 {
 	const auto origMaxMixChannels = m_MixerSettings.m_nMaxMixChannels;
 	m_MixerSettings.m_nMaxMixChannels = 0;
+#ifndef NO_RENDER_STATS
+	// Nothing is actually rendered here, so don't count all voices as skipped
+	const bool origCollectRenderStats = std::exchange(m_collectRenderStats, false);
+#endif // !NO_RENDER_STATS
 	while(m_PlayState.m_nBufferCount)
 	{
-		auto framesToRender = std::min(m_PlayState.m_nBufferCount, samplecount_t(MIXBUFFERSIZE));
+		auto framesToRender = std::min(m_PlayState.m_nBufferCount, GetMixChunkSize());
 		CreateStereoMix(framesToRender);
 		m_PlayState.m_nBufferCount -= framesToRender;
 		m_PlayState.m_lTotalSampleCount += framesToRender;
 	}
+#ifndef NO_RENDER_STATS
+	m_collectRenderStats = origCollectRenderStats;
+#endif // !NO_RENDER_STATS
 	m_MixerSettings.m_nMaxMixChannels = origMaxMixChannels;
 	if(ReadNote())
 		return m_PlayState.m_nBufferCount;
@@ -215,10 +290,54 @@ CSoundFile::samplecount_t CSoundFile::ReadOneTick()
 }
 
 
+#ifndef NO_RENDER_STATS
+
+// Adds the time since the previous lap to one of the render stages, if enabled.
+class RenderStageTimer
+{
+	using clock = std::chrono::steady_clock;
+	RenderStats *const m_stats;
+	clock::time_point m_lastLap;
+
+public:
+	explicit RenderStageTimer(RenderStats *stats)
+		: m_stats{stats}
+	{
+		if(m_stats)
+			m_lastLap = clock::now();
+	}
+
+	void Lap(RenderStats::Stage stage)
+	{
+		if(!m_stats)
+			return;
+		const clock::time_point now = clock::now();
+		m_stats->time[stage] += now - m_lastLap;
+		m_stats->calls[stage]++;
+		m_lastLap = now;
+	}
+};
+
+#else
+
+class RenderStageTimer
+{
+public:
+	void Lap(RenderStats::Stage) { }
+};
+
+#endif // NO_RENDER_STATS
+
+
 CSoundFile::samplecount_t CSoundFile::Read(samplecount_t count, IAudioTarget &target, IAudioSource &source, std::optional<std::reference_wrapper<IMonitorOutput>> outputMonitor, std::optional<std::reference_wrapper<IMonitorInput>> inputMonitor)
 {
 	MPT_ASSERT_ALWAYS(m_MixerSettings.IsValid());
 
+#ifndef NO_RENDER_STATS
+	RenderStageTimer timer{m_collectRenderStats ? &m_renderStats : nullptr};
+#else
+	RenderStageTimer timer;
+#endif // NO_RENDER_STATS
 	samplecount_t countRendered = 0;
 	samplecount_t countToRender = count;
 
@@ -274,7 +393,7 @@ CSoundFile::samplecount_t CSoundFile::Read(samplecount_t count, IAudioTarget &ta
 					}
 				}
 			}
-
+			timer.Lap(RenderStats::ReadNote);
 		}
 
 		if(m_SongFlags[SONG_ENDREACHED])
@@ -290,7 +409,7 @@ CSoundFile::samplecount_t CSoundFile::Read(samplecount_t count, IAudioTarget &ta
 
 		MPT_ASSERT(m_PlayState.m_nBufferCount > 0); // assert that we have actually something to do
 
-		const samplecount_t countChunk = std::min({ static_cast<samplecount_t>(MIXBUFFERSIZE), static_cast<samplecount_t>(m_PlayState.m_nBufferCount), static_cast<samplecount_t>(countToRender) });
+		const samplecount_t countChunk = std::min({ GetMixChunkSize(), static_cast<samplecount_t>(m_PlayState.m_nBufferCount), static_cast<samplecount_t>(countToRender) });
 
 		if(m_MixerSettings.NumInputChannels > 0)
 		{
@@ -302,60 +421,68 @@ CSoundFile::samplecount_t CSoundFile::Read(samplecount_t count, IAudioTarget &ta
 			mixsample_t *buffers[NUMMIXINPUTBUFFERS];
 			for(std::size_t channel = 0; channel < NUMMIXINPUTBUFFERS; ++channel)
 			{
-				buffers[channel] = MixInputBuffer[channel];
+				buffers[channel] = MixInputBuffer[channel].data();
 			}
 			inputMonitor->get().Process(mpt::audio_span_planar<const mixsample_t>(buffers, m_MixerSettings.NumInputChannels, countChunk));
 		}
 
 		CreateStereoMix(countChunk);
+		timer.Lap(RenderStats::Mix);
 
 		if(m_opl)
 		{
-			m_opl->Mix(MixSoundBuffer, countChunk, m_OPLVolumeFactor * m_nVSTiVolume / 48);
+			m_opl->Mix(MixSoundBuffer.data(), countChunk, m_OPLVolumeFactor * m_nVSTiVolume / 48);
+			timer.Lap(RenderStats::OPL);
 		}
 
 #ifndef NO_REVERB
-		m_Reverb.Process(MixSoundBuffer, ReverbSendBuffer, m_RvbROfsVol, m_RvbLOfsVol, countChunk);
+		m_Reverb.Process(MixSoundBuffer.data(), ReverbSendBuffer.data(), m_RvbROfsVol, m_RvbLOfsVol, countChunk);
+		timer.Lap(RenderStats::Reverb);
 #endif  // NO_REVERB
 
 #ifndef NO_PLUGINS
 		if(m_loadedPlugins)
 		{
 			ProcessPlugins(countChunk);
+			timer.Lap(RenderStats::Plugins);
 		}
 #endif  // NO_PLUGINS
 
 		if(m_MixerSettings.gnChannels == 1)
 		{
-			MonoFromStereo(MixSoundBuffer, countChunk);
+			MonoFromStereo(MixSoundBuffer.data(), countChunk);
 		}
 
 		if(m_PlayConfig.getGlobalVolumeAppliesToMaster())
 		{
 			ProcessGlobalVolume(countChunk);
+			timer.Lap(RenderStats::GlobalVolume);
 		}
 
 		if(m_MixerSettings.m_nStereoSeparation != MixerSettings::StereoSeparationScale)
 		{
 			ProcessStereoSeparation(countChunk);
+			timer.Lap(RenderStats::StereoSeparation);
 		}
 
 		if(m_MixerSettings.DSPMask)
 		{
 			ProcessDSP(countChunk);
+			timer.Lap(RenderStats::DSP);
 		}
 
 		if(m_MixerSettings.gnChannels == 4)
 		{
-			InterleaveFrontRear(MixSoundBuffer, MixRearBuffer, countChunk);
+			InterleaveFrontRear(MixSoundBuffer.data(), MixRearBuffer.data(), countChunk);
 		}
 
 		if(outputMonitor)
 		{
-			outputMonitor->get().Process(mpt::audio_span_interleaved<const mixsample_t>(MixSoundBuffer, m_MixerSettings.gnChannels, countChunk));
+			outputMonitor->get().Process(mpt::audio_span_interleaved<const mixsample_t>(MixSoundBuffer.data(), m_MixerSettings.gnChannels, countChunk));
 		}
 
-		target.Process(mpt::audio_span_interleaved<mixsample_t>(MixSoundBuffer, m_MixerSettings.gnChannels, countChunk));
+		target.Process(mpt::audio_span_interleaved<mixsample_t>(MixSoundBuffer.data(), m_MixerSettings.gnChannels, countChunk));
+		timer.Lap(RenderStats::Output);
 
 		// Buffer ready
 		countRendered += countChunk;
@@ -392,35 +519,35 @@ void CSoundFile::ProcessDSP(uint32 countChunk)
 	#ifndef NO_DSP
 		if(m_MixerSettings.DSPMask & SNDDSP_SURROUND)
 		{
-			m_Surround.Process(MixSoundBuffer, MixRearBuffer, countChunk, m_MixerSettings.gnChannels);
+			m_Surround.Process(MixSoundBuffer.data(), MixRearBuffer.data(), countChunk, m_MixerSettings.gnChannels);
 		}
 	#endif // NO_DSP
 
 	#ifndef NO_DSP
 		if(m_MixerSettings.DSPMask & SNDDSP_MEGABASS)
 		{
-			m_MegaBass.Process(MixSoundBuffer, MixRearBuffer, countChunk, m_MixerSettings.gnChannels);
+			m_MegaBass.Process(MixSoundBuffer.data(), MixRearBuffer.data(), countChunk, m_MixerSettings.gnChannels);
 		}
 	#endif // NO_DSP
 
 	#ifndef NO_EQ
 		if(m_MixerSettings.DSPMask & SNDDSP_EQ)
 		{
-			m_EQ.Process(MixSoundBuffer, MixRearBuffer, countChunk, m_MixerSettings.gnChannels);
+			m_EQ.Process(MixSoundBuffer.data(), MixRearBuffer.data(), countChunk, m_MixerSettings.gnChannels);
 		}
 	#endif // NO_EQ
 
 	#ifndef NO_AGC
 		if(m_MixerSettings.DSPMask & SNDDSP_AGC)
 		{
-			m_AGC.Process(MixSoundBuffer, MixRearBuffer, countChunk, m_MixerSettings.gnChannels);
+			m_AGC.Process(MixSoundBuffer.data(), MixRearBuffer.data(), countChunk, m_MixerSettings.gnChannels);
 		}
 	#endif // NO_AGC
 
 	#ifndef NO_DSP
 		if(m_MixerSettings.DSPMask & SNDDSP_BITCRUSH)
 		{
-			m_BitCrush.Process(MixSoundBuffer, MixRearBuffer, countChunk, m_MixerSettings.gnChannels);
+			m_BitCrush.Process(MixSoundBuffer.data(), MixRearBuffer.data(), countChunk, m_MixerSettings.gnChannels);
 		}
 	#endif // NO_DSP
 
@@ -725,6 +852,8 @@ bool CSoundFile::ProcessRow()
 			m_PlayState.m_nTickCount = m_PlayState.m_nMusicSpeed;
 			continue;
 		}
+		if(m_deferredSamples && !m_deferredSamples->empty())
+			PrefetchDeferredSamples();
 		break;
 	}
 	// Should we process tick0 effects?
@@ -767,6 +896,57 @@ bool CSoundFile::ProcessRow()
 }
 
 
+// Decode the deferred samples that are triggered on the current row, and start decoding the samples of the upcoming rows in the background.
+// The samples of the current row have usually been decoded in the background while the previous rows were playing, so this rarely has to wait.
+// As this happens once per row, the mixer never has to wait for sample data in the middle of a tick.
+void CSoundFile::PrefetchDeferredSamples()
+{
+	constexpr ROWINDEX prefetchRows = 8;
+	ORDERINDEX ord = m_PlayState.m_nCurrentOrder;
+	PATTERNINDEX pat = m_PlayState.m_nPattern;
+	ROWINDEX row = m_PlayState.m_nRow;
+	for(ROWINDEX i = 0; i < prefetchRows; i++, row++)
+	{
+		if(!Patterns.IsValidPat(pat))
+			return;
+		if(row >= Patterns[pat].GetNumRows())
+		{
+			// Continue with the next pattern in the order list
+			const ORDERINDEX nextOrd = Order().GetNextOrderIgnoringSkips(ord);
+			if(nextOrd == ord || !Order().IsValidPat(nextOrd))
+				return;
+			ord = nextOrd;
+			pat = Order()[ord];
+			row = 0;
+		}
+		const ModCommand *m = Patterns[pat].GetpModCommand(row, 0);
+		for(CHANNELINDEX chn = 0; chn < GetNumChannels(); chn++, m++)
+		{
+			if(!m->IsNote())
+				continue;
+			const uint32 instr = m->instr ? m->instr : m_PlayState.Chn[chn].nNewIns;
+			SAMPLEINDEX smp = 0;
+			if(!GetNumInstruments())
+				smp = static_cast<SAMPLEINDEX>(instr);
+			else if(instr <= GetNumInstruments() && Instruments[instr] != nullptr)
+				smp = Instruments[instr]->Keyboard[m->note - NOTE_MIN];
+			if(smp == 0 || smp > GetNumSamples() || !m_deferredSamples->Contains(smp))
+				continue;
+			if(i == 0)
+			{
+				LoadDeferredSample(smp);
+				// Everything has been decoded
+				if(!m_deferredSamples)
+					return;
+			} else
+			{
+				m_deferredSamples->Prefetch(smp, Samples[smp]);
+			}
+		}
+	}
+}
+
+
 std::pair<bool, bool> CSoundFile::NextRow(PlayState &playState, const bool breakRow) const
 {
 	// When having an EEx effect on the same row as a Dxx jump, the target row is not played in ProTracker.
@@ -2435,6 +2615,14 @@ bool CSoundFile::ReadNote()
 		chn.nRightVU = (chn.nRightVU > VUMETER_DECAY) ? (chn.nRightVU - VUMETER_DECAY) : 0;
 
 		chn.newLeftVol = chn.newRightVol = 0;
+		if(m_deferredSamples && chn.pModSample && !chn.pModSample->HasSampleData() && chn.nLength && chn.IsSamplePlaying())
+		{
+			// Samples triggered by pattern notes have already been decoded by PrefetchDeferredSamples().
+			// Anything else (e.g. a sample that keeps playing after seeking) is decoded in the background, and the channel stays silent until the sample is ready.
+			const SAMPLEINDEX smp = GetSampleIndex(chn.pModSample);
+			if(smp < MAX_SAMPLES && m_deferredSamples->Contains(smp) && (m_deferredSamples->IsDecoded(smp) || !m_deferredSamples->Prefetch(smp, *chn.pModSample)))
+				LoadDeferredSample(smp);
+		}
 		chn.pCurrentSample = (chn.pModSample && chn.pModSample->HasSampleData() && chn.nLength && chn.IsSamplePlaying()) ? chn.pModSample->samplev() : nullptr;
 		if(chn.pCurrentSample || (chn.HasMIDIOutput() && !chn.dwFlags[CHN_KEYOFF | CHN_NOTEFADE]))
 		{
@@ -2708,8 +2896,19 @@ void CSoundFile::ProcessMidiOut(CHANNELINDEX nChn)
 #endif // NO_PLUGINS
 
 
+static MPT_FORCEINLINE MixSampleInt ApplyGlobalVolume(MixSampleInt sample, int32 volume, int32 maxVolume)
+{
+	return Util::muldiv(sample, volume, maxVolume);
+}
+
+static MPT_FORCEINLINE MixSampleFloat ApplyGlobalVolume(MixSampleFloat sample, int32 volume, int32 maxVolume)
+{
+	return sample * (static_cast<MixSampleFloat>(volume) / static_cast<MixSampleFloat>(maxVolume));
+}
+
+
 template<int channels>
-MPT_FORCEINLINE void ApplyGlobalVolumeWithRamping(int32 *SoundBuffer, int32 *RearBuffer, uint32 lCount, int32 m_nGlobalVolume, int32 step, int32 &m_nSamplesToGlobalVolRampDest, int32 &m_lHighResRampingGlobalVolume)
+MPT_FORCEINLINE void ApplyGlobalVolumeWithRamping(mixsample_t *SoundBuffer, mixsample_t *RearBuffer, uint32 lCount, int32 m_nGlobalVolume, int32 step, int32 &m_nSamplesToGlobalVolRampDest, int32 &m_lHighResRampingGlobalVolume)
 {
 	const bool isStereo = (channels >= 2);
 	const bool hasRear = (channels >= 4);
@@ -2719,17 +2918,17 @@ MPT_FORCEINLINE void ApplyGlobalVolumeWithRamping(int32 *SoundBuffer, int32 *Rea
 		{
 			// Ramping required
 			m_lHighResRampingGlobalVolume += step;
-			                          SoundBuffer[0] = Util::muldiv(SoundBuffer[0], m_lHighResRampingGlobalVolume, MAX_GLOBAL_VOLUME << VOLUMERAMPPRECISION);
-			if constexpr(isStereo) SoundBuffer[1] = Util::muldiv(SoundBuffer[1], m_lHighResRampingGlobalVolume, MAX_GLOBAL_VOLUME << VOLUMERAMPPRECISION);
-			if constexpr(hasRear)  RearBuffer[0]  = Util::muldiv(RearBuffer[0] , m_lHighResRampingGlobalVolume, MAX_GLOBAL_VOLUME << VOLUMERAMPPRECISION); else MPT_UNUSED_VARIABLE(RearBuffer);
-			if constexpr(hasRear)  RearBuffer[1]  = Util::muldiv(RearBuffer[1] , m_lHighResRampingGlobalVolume, MAX_GLOBAL_VOLUME << VOLUMERAMPPRECISION); else MPT_UNUSED_VARIABLE(RearBuffer);
+			                          SoundBuffer[0] = ApplyGlobalVolume(SoundBuffer[0], m_lHighResRampingGlobalVolume, MAX_GLOBAL_VOLUME << VOLUMERAMPPRECISION);
+			if constexpr(isStereo) SoundBuffer[1] = ApplyGlobalVolume(SoundBuffer[1], m_lHighResRampingGlobalVolume, MAX_GLOBAL_VOLUME << VOLUMERAMPPRECISION);
+			if constexpr(hasRear)  RearBuffer[0]  = ApplyGlobalVolume(RearBuffer[0] , m_lHighResRampingGlobalVolume, MAX_GLOBAL_VOLUME << VOLUMERAMPPRECISION); else MPT_UNUSED_VARIABLE(RearBuffer);
+			if constexpr(hasRear)  RearBuffer[1]  = ApplyGlobalVolume(RearBuffer[1] , m_lHighResRampingGlobalVolume, MAX_GLOBAL_VOLUME << VOLUMERAMPPRECISION); else MPT_UNUSED_VARIABLE(RearBuffer);
 			m_nSamplesToGlobalVolRampDest--;
 		} else
 		{
-			                          SoundBuffer[0] = Util::muldiv(SoundBuffer[0], m_nGlobalVolume, MAX_GLOBAL_VOLUME);
-			if constexpr(isStereo) SoundBuffer[1] = Util::muldiv(SoundBuffer[1], m_nGlobalVolume, MAX_GLOBAL_VOLUME);
-			if constexpr(hasRear)  RearBuffer[0]  = Util::muldiv(RearBuffer[0] , m_nGlobalVolume, MAX_GLOBAL_VOLUME); else MPT_UNUSED_VARIABLE(RearBuffer);
-			if constexpr(hasRear)  RearBuffer[1]  = Util::muldiv(RearBuffer[1] , m_nGlobalVolume, MAX_GLOBAL_VOLUME); else MPT_UNUSED_VARIABLE(RearBuffer);
+			                          SoundBuffer[0] = ApplyGlobalVolume(SoundBuffer[0], m_nGlobalVolume, MAX_GLOBAL_VOLUME);
+			if constexpr(isStereo) SoundBuffer[1] = ApplyGlobalVolume(SoundBuffer[1], m_nGlobalVolume, MAX_GLOBAL_VOLUME);
+			if constexpr(hasRear)  RearBuffer[0]  = ApplyGlobalVolume(RearBuffer[0] , m_nGlobalVolume, MAX_GLOBAL_VOLUME); else MPT_UNUSED_VARIABLE(RearBuffer);
+			if constexpr(hasRear)  RearBuffer[1]  = ApplyGlobalVolume(RearBuffer[1] , m_nGlobalVolume, MAX_GLOBAL_VOLUME); else MPT_UNUSED_VARIABLE(RearBuffer);
 			m_lHighResRampingGlobalVolume = m_nGlobalVolume << VOLUMERAMPPRECISION;
 		}
 		SoundBuffer += isStereo ? 2 : 1;
@@ -2789,13 +2988,13 @@ void CSoundFile::ProcessGlobalVolume(samplecount_t lCount)
 	// apply volume and ramping
 	if(m_MixerSettings.gnChannels == 1)
 	{
-		ApplyGlobalVolumeWithRamping<1>(MixSoundBuffer, MixRearBuffer, lCount, m_PlayState.m_nGlobalVolume, step, m_PlayState.m_nSamplesToGlobalVolRampDest, m_PlayState.m_lHighResRampingGlobalVolume);
+		ApplyGlobalVolumeWithRamping<1>(MixSoundBuffer.data(), MixRearBuffer.data(), lCount, m_PlayState.m_nGlobalVolume, step, m_PlayState.m_nSamplesToGlobalVolRampDest, m_PlayState.m_lHighResRampingGlobalVolume);
 	} else if(m_MixerSettings.gnChannels == 2)
 	{
-		ApplyGlobalVolumeWithRamping<2>(MixSoundBuffer, MixRearBuffer, lCount, m_PlayState.m_nGlobalVolume, step, m_PlayState.m_nSamplesToGlobalVolRampDest, m_PlayState.m_lHighResRampingGlobalVolume);
+		ApplyGlobalVolumeWithRamping<2>(MixSoundBuffer.data(), MixRearBuffer.data(), lCount, m_PlayState.m_nGlobalVolume, step, m_PlayState.m_nSamplesToGlobalVolRampDest, m_PlayState.m_lHighResRampingGlobalVolume);
 	} else if(m_MixerSettings.gnChannels == 4)
 	{
-		ApplyGlobalVolumeWithRamping<4>(MixSoundBuffer, MixRearBuffer, lCount, m_PlayState.m_nGlobalVolume, step, m_PlayState.m_nSamplesToGlobalVolRampDest, m_PlayState.m_lHighResRampingGlobalVolume);
+		ApplyGlobalVolumeWithRamping<4>(MixSoundBuffer.data(), MixRearBuffer.data(), lCount, m_PlayState.m_nGlobalVolume, step, m_PlayState.m_nSamplesToGlobalVolRampDest, m_PlayState.m_lHighResRampingGlobalVolume);
 	}
 
 }
@@ -2803,7 +3002,7 @@ void CSoundFile::ProcessGlobalVolume(samplecount_t lCount)
 
 void CSoundFile::ProcessStereoSeparation(samplecount_t countChunk)
 {
-	ApplyStereoSeparation(MixSoundBuffer, MixRearBuffer, m_MixerSettings.gnChannels, countChunk, m_MixerSettings.m_nStereoSeparation);
+	ApplyStereoSeparation(MixSoundBuffer.data(), MixRearBuffer.data(), m_MixerSettings.gnChannels, countChunk, m_MixerSettings.m_nStereoSeparation);
 }
 
 
@@ -740,19 +740,7 @@ static void getsinc(SINC_TYPE *psinc, double beta, double cutoff)
 }
 
 
-#ifdef MODPLUG_TRACKER
-bool CResampler::StaticTablesInitialized = false;
-SINC_TYPE CResampler::gKaiserSinc[SINC_PHASES * 8];     // Upsampling
-SINC_TYPE CResampler::gDownsample13x[SINC_PHASES * 8];  // Downsample 1.333x
-SINC_TYPE CResampler::gDownsample2x[SINC_PHASES * 8];   // Downsample 2x
-Paula::BlepTables CResampler::blepTables;               // Amiga BLEP resampler
-#ifndef MPT_INTMIXER
-mixsample_t CResampler::FastSincTablef[256 * 4];        // Cubic spline LUT
-#endif // !defined(MPT_INTMIXER)
-#endif // MODPLUG_TRACKER
-
-
-void CResampler::InitFloatmixerTables()
+void ResamplerTables::InitTables()
 {
 #ifdef MPT_BUILD_FUZZER
 	// Creating resampling tables can take a little while which we really should not spend
@@ -762,72 +750,90 @@ void CResampler::InitFloatmixerTables()
 #endif // MPT_BUILD_FUZZER
 #ifndef MPT_INTMIXER
 	// Prepare fast sinc coefficients for floating point mixer
-	for(std::size_t i = 0; i < std::size(FastSincTable); i++)
+	for(std::size_t i = 0; i < std::size(CResampler::FastSincTable); i++)
 	{
-		FastSincTablef[i] = static_cast<mixsample_t>(FastSincTable[i] * mixsample_t(1.0f / 16384.0f));
+		FastSincTablef[i] = static_cast<mixsample_t>(CResampler::FastSincTable[i] * mixsample_t(1.0f / 16384.0f));
 	}
 #endif // !defined(MPT_INTMIXER)
+
+	blepTables.InitTables();
+
+	getsinc(gKaiserSinc, 9.6377, 0.97);
+	getsinc(gDownsample13x, 8.5, 0.5);
+	getsinc(gDownsample2x, 7.0, 0.425);
 }
 
 
-void CResampler::InitializeTablesFromScratch(bool force)
+static std::shared_ptr<const ResamplerTables> GetSharedResamplerTables()
 {
-	bool initParameterIndependentTables = false;
-	if(force)
-	{
-		initParameterIndependentTables = true;
-	}
-#ifdef MODPLUG_TRACKER
-	initParameterIndependentTables = !StaticTablesInitialized;
-#endif  // MODPLUG_TRACKER
-
-	MPT_MAYBE_CONSTANT_IF(initParameterIndependentTables)
+	static const std::shared_ptr<const ResamplerTables> s_Tables = []()
 	{
-		InitFloatmixerTables();
-
-		blepTables.InitTables();
+		auto tables = std::make_shared<ResamplerTables>();
+		tables->InitTables();
+		return tables;
+	}();
+	return s_Tables;
+}
 
-		getsinc(gKaiserSinc, 9.6377, 0.97);
-		getsinc(gDownsample13x, 8.5, 0.5);
-		getsinc(gDownsample2x, 7.0, 0.425);
 
-#ifdef MODPLUG_TRACKER
-		StaticTablesInitialized = true;
-#endif  // MODPLUG_TRACKER
-	}
+static std::shared_ptr<const CWindowedFIR> CreateWindowedFIR(double cutoff, uint8 type)
+{
+	auto windowedFIR = std::make_shared<CWindowedFIR>();
+	windowedFIR->InitTable(cutoff, type);
+	return windowedFIR;
+}
 
-	if((m_OldSettings == m_Settings) && !force)
-	{
-		return;
-	}
 
-	m_WindowedFIR.InitTable(m_Settings.gdWFIRCutoff, m_Settings.gbWFIRType);
+#ifdef MPT_RESAMPLER_TABLES_CACHED
 
-	m_OldSettings = m_Settings;
+static std::shared_ptr<const CWindowedFIR> GetCachedWindowedFIR()
+{
+	static constexpr CResamplerSettings defaultSettings;
+	static const std::shared_ptr<const CWindowedFIR> s_WindowedFIR = CreateWindowedFIR(defaultSettings.gdWFIRCutoff, defaultSettings.gbWFIRType);
+	return s_WindowedFIR;
 }
 
+#endif // MPT_RESAMPLER_TABLES_CACHED
 
-#ifdef MPT_RESAMPLER_TABLES_CACHED
 
-static const CResampler & GetCachedResampler()
+static bool HaveSameWindowedFIR(const CResamplerSettings &l, const CResamplerSettings &r)
 {
-	static CResampler s_CachedResampler(true);
-	return s_CachedResampler;
+#if MPT_COMPILER_CLANG
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wfloat-equal"
+#endif // MPT_COMPILER_CLANG
+	return l.gdWFIRCutoff == r.gdWFIRCutoff && l.gbWFIRType == r.gbWFIRType;
+#if MPT_COMPILER_CLANG
+#pragma clang diagnostic pop
+#endif // MPT_COMPILER_CLANG
 }
 
 
-void CResampler::InitializeTablesFromCache()
+void CResampler::InitializeTablesFromScratch(bool force)
 {
-	const CResampler & s_CachedResampler = GetCachedResampler();
-	InitFloatmixerTables();
-	std::copy(s_CachedResampler.gKaiserSinc, s_CachedResampler.gKaiserSinc + SINC_PHASES*8, gKaiserSinc);
-	std::copy(s_CachedResampler.gDownsample13x, s_CachedResampler.gDownsample13x + SINC_PHASES*8, gDownsample13x);
-	std::copy(s_CachedResampler.gDownsample2x, s_CachedResampler.gDownsample2x + SINC_PHASES*8, gDownsample2x);
-	std::copy(s_CachedResampler.m_WindowedFIR.lut, s_CachedResampler.m_WindowedFIR.lut + WFIR_LUTLEN*WFIR_WIDTH, m_WindowedFIR.lut);
-	blepTables = s_CachedResampler.blepTables;
-}
+	if(!m_Tables)
+	{
+		m_Tables = GetSharedResamplerTables();
+	}
 
+	if(m_WindowedFIR && HaveSameWindowedFIR(m_OldSettings, m_Settings) && !force)
+	{
+		m_OldSettings = m_Settings;
+		return;
+	}
+
+#ifdef MPT_RESAMPLER_TABLES_CACHED
+	if(HaveSameWindowedFIR(m_Settings, CResamplerSettings{}))
+	{
+		m_WindowedFIR = GetCachedWindowedFIR();
+	} else
 #endif // MPT_RESAMPLER_TABLES_CACHED
+	{
+		m_WindowedFIR = CreateWindowedFIR(m_Settings.gdWFIRCutoff, m_Settings.gbWFIRType);
+	}
+
+	m_OldSettings = m_Settings;
+}
 
 
 #ifdef MPT_RESAMPLER_TABLES_CACHED_ONSTARTUP
@@ -836,7 +842,8 @@ struct ResampleCacheInitializer
 {
 	ResampleCacheInitializer()
 	{
-		GetCachedResampler();
+		GetSharedResamplerTables();
+		GetCachedWindowedFIR();
 	}
 };
 #if MPT_COMPILER_CLANG
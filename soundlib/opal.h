@@ -2,6 +2,7 @@
 // It was released by Shayde/Reality into the public domain.
 // Minor modifications to silence some warnings and fix a bug in the envelope generator have been applied.
 // Additional fixes by JP Cimalando.
+// Block rendering and skipping of silent channels added by OpenMPT Devs.
 
 /*
 
@@ -22,6 +23,7 @@
 
 
 #include <cstdint>
+#include <vector>
 
 
 
@@ -58,6 +60,7 @@ class Opal {
             int16_t         Output(uint16_t keyscalenum, uint32_t phase_step, int16_t vibrato, int16_t mod = 0, int16_t fbshift = 0);
 
             void            SetKeyOn(bool on);
+            bool            IsSilent() const {  return EnvelopeStage == EnvOff;  }
             void            SetTremoloEnable(bool on);
             void            SetVibratoEnable(bool on);
             void            SetSustainMode(bool on);
@@ -131,6 +134,7 @@ class Opal {
             }
 
             void            Output(int16_t &left, int16_t &right);
+            bool            IsSilent() const;
             void            SetEnable(bool on) {  Enable = on;  }
             void            SetChannelPair(Channel *pair) {  ChannelPair = pair;  }
 
@@ -177,14 +181,17 @@ class Opal {
         void                SetSampleRate(int sample_rate);
         void                Port(uint16_t reg_num, uint8_t val);
         void                Sample(int16_t *left, int16_t *right);
+        void                SampleBlock(int16_t *buffer, size_t frames);
 
     protected:
         void                Init(int sample_rate);
         void                Output(int16_t &left, int16_t &right);
+        void                OutputBlock(int16_t *buffer, size_t frames);
 
         int32_t             SampleRate;
         int32_t             SampleAccum;
         int16_t             LastOutput[2], CurrOutput[2];
+        std::vector<int16_t> NativeBuffer;      // Interleaved stereo output at the OPL3 sample rate for SampleBlock
         Channel             Chan[NumChannels];
         Operator            Op[NumOperators];
 //      uint16_t            ExpTable[256];
@@ -579,6 +586,68 @@ void Opal::Sample(int16_t *left, int16_t *right) {
 
 
 
+//==================================================================================================
+// Generate a block of interleaved stereo samples.  The result is identical to calling Sample() for
+// each frame, but all frames at the OPL3 sample rate are generated in one go first and are then
+// resampled to the destination sample rate in a single pass.
+//==================================================================================================
+void Opal::SampleBlock(int16_t *buffer, size_t frames) {
+
+    // Find out how many frames we need at the OPL3 sample rate
+    size_t native_frames = 0;
+    int32_t accum = SampleAccum;
+    for (size_t i = 0; i < frames; i++) {
+        while (accum >= SampleRate) {
+            native_frames++;
+            accum -= SampleRate;
+        }
+        accum += OPL3SampleRate;
+    }
+
+    if (NativeBuffer.size() < native_frames * 2)
+        NativeBuffer.resize(native_frames * 2);
+    OutputBlock(NativeBuffer.data(), native_frames);
+
+    // Resample to the destination sample rate
+    const int16_t *native = NativeBuffer.data();
+    for (size_t i = 0; i < frames; i++) {
+
+        while (SampleAccum >= SampleRate) {
+
+            LastOutput[0] = CurrOutput[0];
+            LastOutput[1] = CurrOutput[1];
+
+            CurrOutput[0] = native[0];
+            CurrOutput[1] = native[1];
+            native += 2;
+
+            SampleAccum -= SampleRate;
+        }
+
+        int32_t omblend = SampleRate - SampleAccum;
+        buffer[0] = static_cast<uint16_t>((LastOutput[0] * omblend + CurrOutput[0] * SampleAccum) / SampleRate);
+        buffer[1] = static_cast<uint16_t>((LastOutput[1] * omblend + CurrOutput[1] * SampleAccum) / SampleRate);
+        buffer += 2;
+
+        SampleAccum += OPL3SampleRate;
+    }
+}
+
+
+
+//==================================================================================================
+// Produce a block of interleaved stereo output at the OPL3 sample-rate.
+//==================================================================================================
+void Opal::OutputBlock(int16_t *buffer, size_t frames) {
+
+    for (size_t i = 0; i < frames; i++) {
+        Output(buffer[0], buffer[1]);
+        buffer += 2;
+    }
+}
+
+
+
 //==================================================================================================
 // Produce final output from the chip.  This is at the OPL3 sample-rate.
 //==================================================================================================
@@ -589,6 +658,11 @@ void Opal::Output(int16_t &left, int16_t &right) {
     // Sum the output of each channel
     for (int i = 0; i < NumChannels; i++) {
 
+        // Silent channels would only advance the phase of their operators, which is reset anyway
+        // when they are keyed on again
+        if (Chan[i].IsSilent())
+            continue;
+
         int16_t chanleft, chanright;
         Chan[i].Output(chanleft, chanright);
 
@@ -653,6 +727,24 @@ Opal::Channel::Channel() {
 
 
 
+//==================================================================================================
+// Check if the channel is not producing any output because all of its operators are off.
+//==================================================================================================
+bool Opal::Channel::IsSilent() const {
+
+    if (!Enable)
+        return true;
+
+    const int num_ops = ChannelPair ? 4 : 2;
+    for (int i = 0; i < num_ops; i++) {
+        if (!Op[i]->IsSilent())
+            return false;
+    }
+    return true;
+}
+
+
+
 //==================================================================================================
 // Produce output from channel.
 //==================================================================================================
@@ -58,6 +58,7 @@ IMixPlugin::IMixPlugin(VSTPluginLib &factory, CSoundFile &sndFile, SNDMIXPLUGIN
 	, m_pMixStruct(&mixStruct)
 {
 	m_SndFile.m_loadedPlugins++;
+	m_SndFile.m_pluginScheduleDirty = true;
 	m_MixState.pMixBuffer = mpt::align_bytes<8, MIXBUFFERSIZE * 2>(m_MixBuffer);
 	while(m_pMixStruct != &(m_SndFile.m_MixPlugins[m_nSlot]) && m_nSlot < MAX_MIXPLUGINS - 1)
 	{
@@ -74,6 +75,7 @@ IMixPlugin::~IMixPlugin()
 #endif // MODPLUG_TRACKER
 	m_pMixStruct->pMixPlugin = nullptr;
 	m_SndFile.m_loadedPlugins--;
+	m_SndFile.m_pluginScheduleDirty = true;
 	m_pMixStruct = nullptr;
 }
 
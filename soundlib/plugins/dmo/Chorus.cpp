@@ -13,6 +13,7 @@
 #ifndef NO_PLUGINS
 #include "../../Sndfile.h"
 #include "Chorus.h"
+#include "DMOUtils.h"
 #include "mpt/base/numbers.hpp"
 #endif // !NO_PLUGINS
 
@@ -60,6 +61,8 @@ void Chorus::Process(float *pOutL, float *pOutR, uint32 numFrames)
 	if(!m_bufSize || !m_mixBuffer.Ok())
 		return;
 
+	DenormalsAreZero daz;
+
 	const float *in[2] = { m_mixBuffer.GetInputBuffer(0), m_mixBuffer.GetInputBuffer(1) };
 	float *out[2] = { m_mixBuffer.GetOutputBuffer(0), m_mixBuffer.GetOutputBuffer(1) };
 
@@ -52,6 +52,8 @@ void Compressor::Process(float *pOutL, float *pOutR, uint32 numFrames)
 	if(!m_bufSize || !m_mixBuffer.Ok())
 		return;
 
+	DenormalsAreZero daz;
+
 	const float *in[2] = { m_mixBuffer.GetInputBuffer(0), m_mixBuffer.GetInputBuffer(1) };
 	float *out[2] = { m_mixBuffer.GetOutputBuffer(0), m_mixBuffer.GetOutputBuffer(1) };
 
@@ -8,6 +8,17 @@
  */
 
 
+#pragma once
+
+#include "openmpt/all/BuildSettings.hpp"
+
+#ifndef NO_PLUGINS
+#if defined(MPT_ENABLE_ARCH_INTRINSICS_SSE)
+#include "../../../common/mptCPU.h"
+#include <xmmintrin.h>
+#endif
+#endif // !NO_PLUGINS
+
 OPENMPT_NAMESPACE_BEGIN
 
 #ifndef NO_PLUGINS
@@ -18,6 +29,45 @@ namespace DMO
 // Computes (log2(x) + 1) * 2 ^ (shiftL - shiftR) (x = -2^31...2^31)
 float logGain(float x, int32 shiftL, int32 shiftR);
 
+
+// Enables flush-to-zero and denormals-are-zero mode for the lifetime of the object.
+// Without it, feedback paths that decay towards silence (reverb tails, delay lines, filter states) end up in the denormal range, which is very slow on x86.
+// DAZ is not supported by some early SSE CPUs, hence the check for SSE2.
+class DenormalsAreZero
+{
+public:
+	DenormalsAreZero() noexcept
+	{
+#if defined(MPT_ENABLE_ARCH_INTRINSICS_SSE)
+		if(CPU::HasFeatureSet(CPU::feature::sse2) && CPU::HasModesEnabled(CPU::mode::xmm128sse))
+		{
+			constexpr unsigned int mask = mpt::arch::x86::floating_point::MXCSR_DAZ | mpt::arch::x86::floating_point::MXCSR_FTZ;
+			m_oldCSR = _mm_getcsr();
+			m_restore = true;
+			if((m_oldCSR & mask) != mask)
+				_mm_setcsr(m_oldCSR | mask);
+		}
+#endif
+	}
+
+	~DenormalsAreZero()
+	{
+#if defined(MPT_ENABLE_ARCH_INTRINSICS_SSE)
+		if(m_restore && _mm_getcsr() != m_oldCSR)
+			_mm_setcsr(m_oldCSR);
+#endif
+	}
+
+	DenormalsAreZero(const DenormalsAreZero &) = delete;
+	DenormalsAreZero &operator=(const DenormalsAreZero &) = delete;
+
+private:
+#if defined(MPT_ENABLE_ARCH_INTRINSICS_SSE)
+	unsigned int m_oldCSR = 0;
+	bool m_restore = false;
+#endif
+};
+
 }
 
 #endif // !NO_PLUGINS
@@ -13,6 +13,7 @@
 #ifndef NO_PLUGINS
 #include "../../Sndfile.h"
 #include "Echo.h"
+#include "DMOUtils.h"
 #endif // !NO_PLUGINS
 
 OPENMPT_NAMESPACE_BEGIN
@@ -49,6 +50,8 @@ void Echo::Process(float *pOutL, float *pOutR, uint32 numFrames)
 {
 	if(!m_bufferSize || !m_mixBuffer.Ok())
 		return;
+
+	DenormalsAreZero daz;
 	const float wetMix = m_param[kEchoWetDry], dryMix = 1 - wetMix;
 	const float *in[2] = { m_mixBuffer.GetInputBuffer(0), m_mixBuffer.GetInputBuffer(1) };
 	float *out[2] = { m_mixBuffer.GetOutputBuffer(0), m_mixBuffer.GetOutputBuffer(1) };
@@ -13,6 +13,7 @@
 #ifndef NO_PLUGINS
 #include "../../Sndfile.h"
 #include "I3DL2Reverb.h"
+#include "DMOUtils.h"
 #ifdef MODPLUG_TRACKER
 #include "../../../sounddsp/Reverb.h"
 #endif // MODPLUG_TRACKER
@@ -31,7 +32,7 @@ void I3DL2Reverb::DelayLine::Init(int32 ms, int32 padding, uint32 sampleRate, in
 	m_length = Util::muldiv(sampleRate, ms, 1000) + padding;
 	m_position = 0;
 	SetDelayTap(delayTap);
-	assign(m_length, 0.0f);
+	m_data.assign(m_length, 0.0f);
 }
 
 
@@ -42,7 +43,7 @@ void I3DL2Reverb::DelayLine::SetDelayTap(int32 delayTap)
 }
 
 
-void I3DL2Reverb::DelayLine::Advance()
+MPT_FORCEINLINE void I3DL2Reverb::DelayLine::Advance()
 {
 	if(--m_position < 0)
 		m_position += m_length;
@@ -53,22 +54,31 @@ void I3DL2Reverb::DelayLine::Advance()
 
 MPT_FORCEINLINE void I3DL2Reverb::DelayLine::Set(float value)
 {
-	at(m_position) = value;
+	MPT_ASSERT(m_position >= 0 && m_position < m_length);
+	m_data[m_position] = value;
 }
 
 
-float I3DL2Reverb::DelayLine::Get(int32 offset) const
+MPT_FORCEINLINE float I3DL2Reverb::DelayLine::Get(int32 offset) const
 {
-	offset = (offset + m_position) % m_length;
-	if(offset < 0)
-		offset += m_length;
-	return at(offset);
+	// The early reflection taps are always shorter than the delay line, so the modulo is only needed in theory
+	offset += m_position;
+	if(offset >= m_length)
+		offset -= m_length;
+	if(static_cast<uint32>(offset) >= static_cast<uint32>(m_length))
+	{
+		offset %= m_length;
+		if(offset < 0)
+			offset += m_length;
+	}
+	return m_data[offset];
 }
 
 
 MPT_FORCEINLINE float I3DL2Reverb::DelayLine::Get() const
 {
-	return at(m_delayPosition);
+	MPT_ASSERT(m_delayPosition >= 0 && m_delayPosition < m_length);
+	return m_data[m_delayPosition];
 }
 
 
@@ -115,6 +125,8 @@ void I3DL2Reverb::Process(float *pOutL, float *pOutR, uint32 numFrames)
 	if(!m_ok || !m_mixBuffer.Ok())
 		return;
 
+	DenormalsAreZero daz;
+
 	const float *in[2] = { m_mixBuffer.GetInputBuffer(0), m_mixBuffer.GetInputBuffer(1) };
 	float *out[2] = { m_mixBuffer.GetOutputBuffer(0), m_mixBuffer.GetOutputBuffer(1) };
 
@@ -48,11 +48,12 @@ protected:
 		kFullSampleRate = 0x02,
 	};
 
-	class DelayLine : private std::vector<float>
+	class DelayLine
 	{
-		int32 m_length;
-		int32 m_position;
-		int32 m_delayPosition;
+		std::vector<float> m_data;
+		int32 m_length = 0;
+		int32 m_position = 0;
+		int32 m_delayPosition = 0;
 
 	public:
 		void Init(int32 ms, int32 padding, uint32 sampleRate, int32 delayTap = 0);
@@ -13,7 +13,12 @@
 #ifndef NO_PLUGINS
 #include "../../Sndfile.h"
 #include "ParamEq.h"
+#include "DMOUtils.h"
 #include "mpt/base/numbers.hpp"
+#if defined(MPT_ENABLE_ARCH_INTRINSICS_SSE)
+#include "../../../common/mptCPU.h"
+#include <xmmintrin.h>
+#endif
 #endif // !NO_PLUGINS
 
 OPENMPT_NAMESPACE_BEGIN
@@ -55,26 +60,81 @@ void ParamEq::Process(float *pOutL, float *pOutR, uint32 numFrames)
 		memcpy(out[1], in[1], numFrames * sizeof(float));
 	} else
 	{
-		for(uint32 i = numFrames; i != 0; i--)
+		DenormalsAreZero daz;
+#if defined(MPT_ENABLE_ARCH_INTRINSICS_SSE)
+		if(m_allowSIMD && CPU::HasFeatureSet(CPU::feature::sse) && CPU::HasModesEnabled(CPU::mode::xmm128sse))
+			ProcessFramesSSE(in[0], in[1], out[0], out[1], numFrames);
+		else
+#endif
+			ProcessFrames(in[0], in[1], out[0], out[1], numFrames);
+	}
+
+	ProcessMixOps(pOutL, pOutR, m_mixBuffer.GetOutputBuffer(0), m_mixBuffer.GetOutputBuffer(1), numFrames);
+}
+
+
+void ParamEq::ProcessFrames(const float *inL, const float *inR, float *outL, float *outR, uint32 numFrames)
+{
+	const float *in[2] = { inL, inR };
+	float *out[2] = { outL, outR };
+	for(uint32 i = numFrames; i != 0; i--)
+	{
+		for(uint8 channel = 0; channel < 2; channel++)
 		{
-			for(uint8 channel = 0; channel < 2; channel++)
-			{
-				float x = *(in[channel])++;
-				float y = b0DIVa0 * x + b1DIVa0 * x1[channel] + b2DIVa0 * x2[channel] - a1DIVa0 * y1[channel] - a2DIVa0 * y2[channel];
-
-				x2[channel] = x1[channel];
-				x1[channel] = x;
-				y2[channel] = y1[channel];
-				y1[channel] = y;
-
-				*(out[channel])++ = y;
-			}
+			float x = *(in[channel])++;
+			float y = b0DIVa0 * x + b1DIVa0 * x1[channel] + b2DIVa0 * x2[channel] - a1DIVa0 * y1[channel] - a2DIVa0 * y2[channel];
+
+			x2[channel] = x1[channel];
+			x1[channel] = x;
+			y2[channel] = y1[channel];
+			y1[channel] = y;
+
+			*(out[channel])++ = y;
 		}
 	}
+}
 
-	ProcessMixOps(pOutL, pOutR, m_mixBuffer.GetOutputBuffer(0), m_mixBuffer.GetOutputBuffer(1), numFrames);
+
+#if defined(MPT_ENABLE_ARCH_INTRINSICS_SSE)
+
+// Same as ProcessFrames, but filters both channels at once, one channel per vector lane.
+// The arithmetic operations are performed in the same order as in ProcessFrames, so the results are identical.
+void ParamEq::ProcessFramesSSE(const float *inL, const float *inR, float *outL, float *outR, uint32 numFrames)
+{
+	const __m128 b0 = _mm_set1_ps(b0DIVa0), b1 = _mm_set1_ps(b1DIVa0), b2 = _mm_set1_ps(b2DIVa0);
+	const __m128 a1 = _mm_set1_ps(a1DIVa0), a2 = _mm_set1_ps(a2DIVa0);
+	__m128 vx1 = _mm_setr_ps(x1[0], x1[1], 0.0f, 0.0f), vx2 = _mm_setr_ps(x2[0], x2[1], 0.0f, 0.0f);
+	__m128 vy1 = _mm_setr_ps(y1[0], y1[1], 0.0f, 0.0f), vy2 = _mm_setr_ps(y2[0], y2[1], 0.0f, 0.0f);
+	for(uint32 i = 0; i < numFrames; i++)
+	{
+		const __m128 x = _mm_unpacklo_ps(_mm_load_ss(inL + i), _mm_load_ss(inR + i));
+		__m128 y = _mm_add_ps(_mm_mul_ps(b0, x), _mm_mul_ps(b1, vx1));
+		y = _mm_add_ps(y, _mm_mul_ps(b2, vx2));
+		y = _mm_sub_ps(y, _mm_mul_ps(a1, vy1));
+		y = _mm_sub_ps(y, _mm_mul_ps(a2, vy2));
+		vx2 = vx1;
+		vx1 = x;
+		vy2 = vy1;
+		vy1 = y;
+		_mm_store_ss(outL + i, y);
+		_mm_store_ss(outR + i, _mm_shuffle_ps(y, y, _MM_SHUFFLE(1, 1, 1, 1)));
+	}
+	alignas(16) float state[4][4];
+	_mm_store_ps(state[0], vx1);
+	_mm_store_ps(state[1], vx2);
+	_mm_store_ps(state[2], vy1);
+	_mm_store_ps(state[3], vy2);
+	for(uint8 channel = 0; channel < 2; channel++)
+	{
+		x1[channel] = state[0][channel];
+		x2[channel] = state[1][channel];
+		y1[channel] = state[2][channel];
+		y2[channel] = state[3][channel];
+	}
 }
 
+#endif // MPT_ENABLE_ARCH_INTRINSICS_SSE
+
 
 PlugParamValue ParamEq::GetParameter(PlugParamIndex index)
 {
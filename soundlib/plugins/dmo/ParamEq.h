@@ -36,6 +36,7 @@ protected:
 	float x1[2], x2[2];
 	float y1[2], y2[2];
 	float m_maxFreqParam;
+	bool m_allowSIMD = true;
 
 public:
 	static IMixPlugin* Create(VSTPluginLib &factory, CSoundFile &sndFile, SNDMIXPLUGIN &mixStruct);
@@ -48,6 +49,9 @@ public:
 
 	void Process(float *pOutL, float *pOutR, uint32 numFrames) override;
 
+	// Allow or disallow the use of SIMD instructions (for testing)
+	void AllowSIMD(bool allow) noexcept { m_allowSIMD = allow; }
+
 	float RenderSilence(uint32) override { return 0.0f; }
 
 	int32 GetNumPrograms() const override { return 0; }
@@ -87,6 +91,11 @@ protected:
 	float BandwidthInSemitones() const { return 1.0f + m_param[kEqBandwidth] * 35.0f; }
 	float FreqInHertz() const { return 80.0f + m_param[kEqCenter] * 15920.0f; }
 	float GainInDecibel() const { return (m_param[kEqGain] - 0.5f) * 30.0f; }
+
+	void ProcessFrames(const float *inL, const float *inR, float *outL, float *outR, uint32 numFrames);
+#if defined(MPT_ENABLE_ARCH_INTRINSICS_SSE)
+	void ProcessFramesSSE(const float *inL, const float *inR, float *outL, float *outR, uint32 numFrames);
+#endif
 	void RecalculateEqParams();
 };
 
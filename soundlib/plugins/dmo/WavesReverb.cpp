@@ -13,6 +13,7 @@
 #ifndef NO_PLUGINS
 #include "../../Sndfile.h"
 #include "WavesReverb.h"
+#include "DMOUtils.h"
 #endif // !NO_PLUGINS
 
 OPENMPT_NAMESPACE_BEGIN
@@ -45,6 +46,8 @@ void WavesReverb::Process(float *pOutL, float *pOutR, uint32 numFrames)
 	if(!m_mixBuffer.Ok())
 		return;
 
+	DenormalsAreZero daz;
+
 	const float *in[2] = { m_mixBuffer.GetInputBuffer(0), m_mixBuffer.GetInputBuffer(1) };
 	float *out[2] = { m_mixBuffer.GetOutputBuffer(0), m_mixBuffer.GetOutputBuffer(1) };
 
@@ -0,0 +1,166 @@
+/* SPDX-License-Identifier: BSL-1.0 OR BSD-3-Clause */
+
+#ifndef MPT_IO_FILE_FILEMAPPING_HPP
+#define MPT_IO_FILE_FILEMAPPING_HPP
+
+
+
+#include "mpt/base/detect.hpp"
+#include "mpt/base/memory.hpp"
+#include "mpt/base/namespace.hpp"
+#include "mpt/base/span.hpp"
+#include "mpt/base/utility.hpp"
+#include "mpt/path/os_path.hpp"
+
+#include <utility>
+
+#include <cstddef>
+
+#if MPT_OS_WINDOWS || MPT_OS_DJGPP || MPT_OS_EMSCRIPTEN || MPT_OS_UNKNOWN
+#define MPT_IO_FILE_FILEMAPPING_POSIX 0
+#else
+#define MPT_IO_FILE_FILEMAPPING_POSIX 1
+#endif
+
+#if MPT_IO_FILE_FILEMAPPING_POSIX
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif // MPT_IO_FILE_FILEMAPPING_POSIX
+
+
+
+namespace mpt {
+inline namespace MPT_INLINE_NS {
+
+
+
+namespace IO {
+
+
+
+// Read-only memory mapping of a complete regular file.
+// The mapping stays valid independently of the file descriptor it was created from.
+// If the file cannot be mapped (not a regular file, smaller than minimumSize, empty file, or unsupported platform), IsValid() returns false,
+// and callers are expected to fall back to reading the file through a stream.
+// Accessing the mapping after the file has been truncated by another process raises SIGBUS,
+// so callers should only keep the mapping alive for as long as they actually need it.
+class FileMapping {
+
+public:
+	// Smaller files are cheaper to read into memory than to map.
+	static constexpr std::size_t DefaultMinimumSize = 1024 * 1024;
+
+private:
+	const std::byte * m_Data = nullptr;
+	std::size_t m_Size = 0;
+
+public:
+	FileMapping() = default;
+
+	explicit FileMapping(const mpt::os_path & filename, std::size_t minimumSize = DefaultMinimumSize) {
+#if MPT_IO_FILE_FILEMAPPING_POSIX
+		int fd = -1;
+		do {
+			fd = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+		} while ((fd == -1) && (errno == EINTR));
+		if (fd == -1) {
+			return;
+		}
+		Map(fd, minimumSize);
+		::close(fd);
+#else  // !MPT_IO_FILE_FILEMAPPING_POSIX
+		static_cast<void>(filename);
+		static_cast<void>(minimumSize);
+#endif // MPT_IO_FILE_FILEMAPPING_POSIX
+	}
+
+#if MPT_IO_FILE_FILEMAPPING_POSIX
+	// Does not take ownership of fd.
+	explicit FileMapping(int fd, std::size_t minimumSize = DefaultMinimumSize) {
+		Map(fd, minimumSize);
+	}
+#endif // MPT_IO_FILE_FILEMAPPING_POSIX
+
+	FileMapping(const FileMapping &) = delete;
+	FileMapping & operator=(const FileMapping &) = delete;
+
+	FileMapping(FileMapping && other) noexcept
+		: m_Data(std::exchange(other.m_Data, nullptr))
+		, m_Size(std::exchange(other.m_Size, 0)) {
+	}
+
+	FileMapping & operator=(FileMapping && other) noexcept {
+		if (this != &other) {
+			Unmap();
+			m_Data = std::exchange(other.m_Data, nullptr);
+			m_Size = std::exchange(other.m_Size, 0);
+		}
+		return *this;
+	}
+
+	~FileMapping() {
+		Unmap();
+	}
+
+	bool IsValid() const noexcept {
+		return m_Data != nullptr;
+	}
+
+	mpt::const_byte_span GetView() const noexcept {
+		return mpt::as_span(m_Data, m_Size);
+	}
+
+private:
+#if MPT_IO_FILE_FILEMAPPING_POSIX
+	void Map(int fd, std::size_t minimumSize) {
+		struct stat st = {};
+		if (::fstat(fd, &st) != 0) {
+			return;
+		}
+		if (!S_ISREG(st.st_mode) || (st.st_size <= 0) || !mpt::in_range<std::size_t>(st.st_size)) {
+			return;
+		}
+		const std::size_t size = static_cast<std::size_t>(st.st_size);
+		if (size < minimumSize) {
+			return;
+		}
+		void * data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (data == MAP_FAILED) {
+			return;
+		}
+#if defined(POSIX_MADV_SEQUENTIAL)
+		// Most loaders read the file front to back
+		::posix_madvise(data, size, POSIX_MADV_SEQUENTIAL);
+#endif // POSIX_MADV_SEQUENTIAL
+		m_Data = static_cast<const std::byte *>(data);
+		m_Size = size;
+	}
+#endif // MPT_IO_FILE_FILEMAPPING_POSIX
+
+	void Unmap() noexcept {
+#if MPT_IO_FILE_FILEMAPPING_POSIX
+		if (m_Data) {
+			::munmap(const_cast<std::byte *>(m_Data), m_Size);
+		}
+#endif // MPT_IO_FILE_FILEMAPPING_POSIX
+		m_Data = nullptr;
+		m_Size = 0;
+	}
+};
+
+
+
+} // namespace IO
+
+
+
+} // namespace MPT_INLINE_NS
+} // namespace mpt
+
+
+
+#endif // MPT_IO_FILE_FILEMAPPING_HPP
@@ -11,11 +11,13 @@
 #include "mpt/base/span.hpp"
 #include "mpt/io/io.hpp"
 #include "mpt/io/io_stdstream.hpp"
+#include "mpt/io_file/filemapping.hpp"
 #include "mpt/io_file/fstream.hpp"
 #include "mpt/path/os_path.hpp"
 
 #include <ios>
 #include <istream>
+#include <optional>
 #include <variant>
 #include <vector>
 
@@ -69,7 +71,8 @@ class CachedInputFile {
 
 private:
 	mpt::os_path m_Filename;
-	mpt::IO::ifstream m_File;
+	FileMapping m_Mapping;
+	std::optional<mpt::IO::ifstream> m_File;
 	bool m_IsValid;
 	bool m_IsCached;
 	std::vector<std::byte> m_Cache;
@@ -77,29 +80,36 @@ private:
 public:
 	CachedInputFile(const mpt::os_path & filename)
 		: m_Filename(filename)
-		, m_File(m_Filename, std::ios::binary | std::ios::in)
+		, m_Mapping(m_Filename)
 		, m_IsValid(false)
 		, m_IsCached(false) {
 		assert(!filename.empty());
-		if (mpt::IO::IsReadSeekable(m_File)) {
-			if (!mpt::IO::SeekEnd(m_File)) {
-				m_File.close();
+		if (m_Mapping.IsValid()) {
+			// Use the mapped file directly instead of copying it, the file does not need to be opened again
+			m_IsCached = true;
+			m_IsValid = true;
+			return;
+		}
+		m_File.emplace(m_Filename, std::ios::binary | std::ios::in);
+		if (mpt::IO::IsReadSeekable(*m_File)) {
+			if (!mpt::IO::SeekEnd(*m_File)) {
+				m_File->close();
 				return;
 			}
-			mpt::IO::Offset filesize = mpt::IO::TellRead(m_File);
-			if (!mpt::IO::SeekBegin(m_File)) {
-				m_File.close();
+			mpt::IO::Offset filesize = mpt::IO::TellRead(*m_File);
+			if (!mpt::IO::SeekBegin(*m_File)) {
+				m_File->close();
 				return;
 			}
 			if (mpt::in_range<std::size_t>(filesize)) {
 				std::size_t buffersize = mpt::saturate_cast<std::size_t>(filesize);
 				m_Cache.resize(buffersize);
-				if (mpt::IO::ReadRaw(m_File, mpt::as_span(m_Cache)).size() != mpt::saturate_cast<std::size_t>(filesize)) {
-					m_File.close();
+				if (mpt::IO::ReadRaw(*m_File, mpt::as_span(m_Cache)).size() != mpt::saturate_cast<std::size_t>(filesize)) {
+					m_File->close();
 					return;
 				}
-				if (!mpt::IO::SeekBegin(m_File)) {
-					m_File.close();
+				if (!mpt::IO::SeekBegin(*m_File)) {
+					m_File->close();
 					return;
 				}
 				m_IsCached = true;
@@ -114,7 +124,7 @@ public:
 	~CachedInputFile() = default;
 
 	bool IsValid() const {
-		return m_IsValid && m_File.good();
+		return m_IsValid && (m_Mapping.IsValid() || m_File->good());
 	}
 
 	bool IsCached() const {
@@ -127,11 +137,14 @@ public:
 
 	std::istream & GetStream() {
 		assert(!m_IsCached);
-		return m_File;
+		return *m_File;
 	}
 
 	mpt::const_byte_span GetCache() {
 		assert(m_IsCached);
+		if (m_Mapping.IsValid()) {
+			return m_Mapping.GetView();
+		}
 		return mpt::as_span(m_Cache);
 	}
 };
@@ -0,0 +1,66 @@
+/* SPDX-License-Identifier: BSL-1.0 OR BSD-3-Clause */
+
+#ifndef MPT_IO_FILE_READ_FILEMAPPING_FILECURSOR_HPP
+#define MPT_IO_FILE_READ_FILEMAPPING_FILECURSOR_HPP
+
+
+
+#include "mpt/base/namespace.hpp"
+#include "mpt/io_file/filemapping.hpp"
+#include "mpt/io_read/filecursor.hpp"
+#include "mpt/io_read/filecursor_filename_traits.hpp"
+#include "mpt/io_read/filecursor_traits_filedata.hpp"
+#include "mpt/io_read/filedata.hpp"
+#include "mpt/io_read/filedata_memory.hpp"
+
+#include <memory>
+#include <utility>
+
+
+
+namespace mpt {
+inline namespace MPT_INLINE_NS {
+
+
+
+namespace IO {
+
+
+
+// Memory-backed file data that owns the file mapping it refers to,
+// so that pinned views and chunks remain valid for as long as any FileCursor uses them.
+class FileDataFileMapping
+	: public FileDataMemory {
+
+private:
+	FileMapping m_Mapping;
+
+public:
+	FileDataFileMapping(FileMapping && mapping)
+		: FileDataMemory(mapping.GetView())
+		, m_Mapping(std::move(mapping)) { }
+};
+
+
+
+// Initialize file reader object with a file mapping, taking ownership of the mapping.
+template <typename Tpath>
+inline FileCursor<FileCursorTraitsFileData, FileCursorFilenameTraits<Tpath>> make_FileCursor(FileMapping && mapping, std::shared_ptr<Tpath> filename = nullptr) {
+	if (!mapping.IsValid()) {
+		return FileCursor<FileCursorTraitsFileData, FileCursorFilenameTraits<Tpath>>();
+	}
+	return FileCursor<FileCursorTraitsFileData, FileCursorFilenameTraits<Tpath>>(std::static_pointer_cast<IFileData>(std::make_shared<FileDataFileMapping>(std::move(mapping))), std::move(filename));
+}
+
+
+
+} // namespace IO
+
+
+
+} // namespace MPT_INLINE_NS
+} // namespace mpt
+
+
+
+#endif // MPT_IO_FILE_READ_FILEMAPPING_FILECURSOR_HPP
@@ -43,6 +43,7 @@
 #include "../common/version.h"
 #include "../common/misc_util.h"
 #include "../common/mptStringBuffer.h"
+#include "../common/mptThreadPool.h"
 #include "../common/serialization_utils.h"
 #include "../soundlib/Sndfile.h"
 #include "../common/FileReader.h"
@@ -58,6 +59,16 @@
 #include "../soundlib/SampleNormalize.h"
 #include "../soundlib/ModSampleCopy.h"
 #include "../soundlib/ITCompression.h"
+#include "../soundlib/MixFuncTable.h"
+#include "../soundlib/OPL.h"
+#include "../soundlib/AudioReadTarget.h"
+#include "../soundlib/Resampler.h"
+#include "../soundlib/SharedSamples.h"
+#if defined(MPT_ENABLE_ARCH_INTRINSICS)
+#include "../common/mptCPU.h"
+#endif
+#include "../sounddsp/EQ.h"
+#include "../sounddsp/Reverb.h"
 #include "../soundlib/tuningcollection.h"
 #include "../soundlib/tuning.h"
 #include "openmpt/soundbase/Dither.hpp"
@@ -72,7 +83,9 @@
 #include "mpt/io_file/fileref.hpp"
 #include "mpt/io_file/inputfile.hpp"
 #include "mpt/io_file/outputfile.hpp"
+#include "mpt/io_file/filemapping.hpp"
 #include "mpt/io_file_read/inputfile_filecursor.hpp"
+#include "mpt/io_file_read/filemapping_filecursor.hpp"
 #include "../common/mptFileIO.h"
 #ifdef MODPLUG_TRACKER
 #include "mpt/crypto/hash.hpp"
@@ -80,10 +93,15 @@
 #include "mpt/uuid_namespace/uuid_namespace.hpp"
 #endif // MODPLUG_TRACKER
 #ifdef LIBOPENMPT_BUILD
+#include "../libopenmpt/libopenmpt.hpp"
+#include "../libopenmpt/libopenmpt_ext.hpp"
 #include "../libopenmpt/libopenmpt_version.h"
 #endif // LIBOPENMPT_BUILD
 #ifndef NO_PLUGINS
 #include "../soundlib/plugins/PlugInterface.h"
+#include "../soundlib/plugins/PluginManager.h"
+#include "../soundlib/plugins/dmo/DMOUtils.h"
+#include "../soundlib/plugins/dmo/ParamEq.h"
 #endif
 #include <sstream>
 #include <limits>
@@ -96,6 +114,8 @@
 #include <stdexcept>
 #ifdef LIBOPENMPT_BUILD
 #include <cfenv>
+#include <chrono>
+#include <thread>
 #endif // LIBOPENMPT_BUILD
 #if MPT_COMPILER_MSVC
 #include <tchar.h>
@@ -141,10 +161,17 @@ static MPT_NOINLINE void TestSettings();
 static MPT_NOINLINE void TestStringIO();
 static MPT_NOINLINE void TestMIDIEvents();
 static MPT_NOINLINE void TestSampleConversion();
+static MPT_NOINLINE void TestMixFunctions();
+static MPT_NOINLINE void TestDSP();
+static MPT_NOINLINE void TestOPL();
 static MPT_NOINLINE void TestITCompression();
 static MPT_NOINLINE void TestPCnoteSerialization();
 static MPT_NOINLINE void TestLoadSaveFile();
 static MPT_NOINLINE void TestEditing();
+#ifdef LIBOPENMPT_BUILD
+static MPT_NOINLINE void TestRenderAhead();
+static MPT_NOINLINE void TestMixChunkSize();
+#endif // LIBOPENMPT_BUILD
 
 
 
@@ -438,12 +465,19 @@ void DoTests()
 	DO_TEST(TestStringIO);
 	DO_TEST(TestMIDIEvents);
 	DO_TEST(TestSampleConversion);
+	DO_TEST(TestMixFunctions);
+	DO_TEST(TestDSP);
+	DO_TEST(TestOPL);
 	DO_TEST(TestITCompression);
 
 	// slower tests, require opening a CModDoc
 	DO_TEST(TestPCnoteSerialization);
 	DO_TEST(TestLoadSaveFile);
 	DO_TEST(TestEditing);
+#ifdef LIBOPENMPT_BUILD
+	DO_TEST(TestRenderAhead);
+	DO_TEST(TestMixChunkSize);
+#endif // LIBOPENMPT_BUILD
 
 	delete s_PRNG;
 	s_PRNG = nullptr;
@@ -1501,6 +1535,34 @@ static MPT_NOINLINE void TestMisc2()
 
 #endif // MODPLUG_TRACKER
 
+	{
+		ThreadPool pool(3);
+		std::vector<uint32> results(100, 0);
+		for(uint32 run = 0; run < 10; run++)
+		{
+			pool.Run(results.size(), [&results, run](std::size_t task) { results[task] += static_cast<uint32>(task) * run; });
+		}
+		for(std::size_t task = 0; task < results.size(); task++)
+		{
+			VERIFY_EQUAL_QUIET_NONCONT(results[task], static_cast<uint32>(task) * 45u);
+		}
+
+		bool caught = false;
+		try
+		{
+			pool.Run(8, [](std::size_t task) { if(task == 5) throw std::runtime_error("task"); });
+		} catch(const std::runtime_error &)
+		{
+			caught = true;
+		}
+		VERIFY_EQUAL(caught, true);
+
+		// Pool must still be usable after an exception
+		std::vector<uint8> done(4, 0);
+		pool.Run(done.size(), [&done](std::size_t task) { done[task] = 1; });
+		VERIFY_EQUAL(std::count(done.begin(), done.end(), uint8(1)), 4);
+	}
+
 	// https://github.com/kripken/emscripten/issues/4251
 	#if MPT_OS_EMSCRIPTEN
 		volatile int transpose = 32;
@@ -2680,6 +2742,45 @@ static MPT_NOINLINE void TestMIDIEvents()
 	VERIFY_EQUAL_NONCONT(MIDIEvents::GetChannelFromEvent(midiEvent), MIDIEvents::sysStart);
 	VERIFY_EQUAL_NONCONT(MIDIEvents::GetDataByte1FromEvent(midiEvent), 0);
 	VERIFY_EQUAL_NONCONT(MIDIEvents::GetDataByte2FromEvent(midiEvent), 0);
+
+	// Compiled MIDI macros
+	{
+		using Op = CompiledMIDIMacro::Op;
+		const auto verifyMacro = [](const char *str, std::vector<std::pair<Op, uint8>> expected)
+		{
+			MIDIMacroConfigData::Macro macro{};
+			macro = str;
+			const CompiledMIDIMacro compiled{macro};
+			VERIFY_EQUAL_NONCONT(compiled.MaxOutputSize(), std::strlen(str));
+			VERIFY_EQUAL_NONCONT(compiled.Instructions().size(), expected.size());
+			for(size_t i = 0; i < std::min(compiled.Instructions().size(), expected.size()); i++)
+			{
+				VERIFY_EQUAL_NONCONT(static_cast<int>(compiled.Instructions()[i].op), static_cast<int>(expected[i].first));
+				VERIFY_EQUAL_NONCONT(compiled.Instructions()[i].value, expected[i].second);
+			}
+		};
+		verifyMacro("F0F000z", {{Op::NibblePair, 0xF0}, {Op::NibblePair, 0xF0}, {Op::NibblePair, 0x00}, {Op::Parameter, 0}});
+		verifyMacro("9c n v", {{Op::Nibble, 0x09}, {Op::MIDIChannel, 0}, {Op::LastNote, 0}, {Op::Velocity, 0}});
+		// Constant nibbles are only merged if they are adjacent in the instruction stream, but blanks are ignored
+		verifyMacro("A B Cz D", {{Op::NibblePair, 0xAB}, {Op::Nibble, 0x0C}, {Op::Parameter, 0}, {Op::Nibble, 0x0D}});
+		verifyMacro("F0 43 10 s F7 ?", {{Op::NibblePair, 0xF0}, {Op::NibblePair, 0x43}, {Op::NibblePair, 0x10}, {Op::Checksum, 0}, {Op::NibblePair, 0xF7}});
+		verifyMacro("uxyabohmp", {{Op::CalcVolume, 0}, {Op::Pan, 0}, {Op::CalcPan, 0}, {Op::BankHigh, 0}, {Op::BankLow, 0}, {Op::Offset, 0}, {Op::HostChannel, 0}, {Op::LoopDirection, 0}, {Op::Program, 0}});
+		verifyMacro("", {});
+
+		MIDIMacroConfig config;
+		auto compiledConfigPtr = std::make_unique<CompiledMIDIMacroConfig>();  // Too large for the stack
+		CompiledMIDIMacroConfig &compiledConfig = *compiledConfigPtr;
+		compiledConfig.Update(config);
+		VERIFY_EQUAL_NONCONT(compiledConfig.Find(config, config.SFx[0]) != nullptr, true);
+		VERIFY_EQUAL_NONCONT(compiledConfig.Find(config, config.Zxx[127]) != nullptr, true);
+		VERIFY_EQUAL_NONCONT(compiledConfig.Find(config, MIDIMacroConfigData::Macro{}) == nullptr, true);
+		// Modified macros must not be found until the compiled config is updated
+		config.SFx[0] = "F0F001z";
+		VERIFY_EQUAL_NONCONT(compiledConfig.Find(config, config.SFx[0]) == nullptr, true);
+		compiledConfig.Update(config);
+		VERIFY_EQUAL_NONCONT(compiledConfig.Find(config, config.SFx[0]) != nullptr, true);
+		VERIFY_EQUAL_NONCONT(compiledConfig.Find(config, config.SFx[0])->Source() == config.SFx[0], true);
+	}
 }
 
 
@@ -3264,6 +3365,44 @@ static void TestLoadMPTMFile(const CSoundFile &sndFile)
 }
 
 
+// Check that all sub-songs are found, and that they do not depend on whether the sequences are evaluated in parallel
+static void TestGetAllSubSongs(CSoundFile &sndFile)
+{
+	const auto subSongs = sndFile.GetAllSubSongs();
+	const auto subSongsParallel = sndFile.GetAllSubSongs(true);
+	VERIFY_EQUAL_NONCONT(subSongs.size(), 2);
+	VERIFY_EQUAL_NONCONT(subSongsParallel.size(), subSongs.size());
+	for(std::size_t i = 0; i < std::min(subSongs.size(), subSongsParallel.size()); i++)
+	{
+		VERIFY_EQUAL_NONCONT(subSongsParallel[i].duration, subSongs[i].duration);
+		VERIFY_EQUAL_NONCONT(subSongsParallel[i].sequence, subSongs[i].sequence);
+		VERIFY_EQUAL_NONCONT(subSongsParallel[i].startOrder, subSongs[i].startOrder);
+		VERIFY_EQUAL_NONCONT(subSongsParallel[i].startRow, subSongs[i].startRow);
+		VERIFY_EQUAL_NONCONT(subSongsParallel[i].endOrder, subSongs[i].endOrder);
+		VERIFY_EQUAL_NONCONT(subSongsParallel[i].endRow, subSongs[i].endRow);
+	}
+
+	for(bool parallel : {false, true})
+	{
+		SEQUENCEINDEX lastFinished = 0;
+		const auto progressSubSongs = sndFile.GetAllSubSongs([&](SEQUENCEINDEX finished, SEQUENCEINDEX total)
+		{
+			VERIFY_EQUAL_NONCONT(finished, lastFinished + 1);
+			VERIFY_EQUAL_NONCONT(total, sndFile.Order.GetNumSequences());
+			lastFinished = finished;
+			return true;
+		}, parallel);
+		VERIFY_EQUAL_NONCONT(lastFinished, sndFile.Order.GetNumSequences());
+		VERIFY_EQUAL_NONCONT(progressSubSongs.has_value(), true);
+		if(progressSubSongs)
+			VERIFY_EQUAL_NONCONT(progressSubSongs->size(), subSongs.size());
+
+		const auto cancelledSubSongs = sndFile.GetAllSubSongs([](SEQUENCEINDEX, SEQUENCEINDEX) { return false; }, parallel);
+		VERIFY_EQUAL_NONCONT(cancelledSubSongs.has_value(), false);
+	}
+}
+
+
 // Check if our test file was loaded correctly.
 static void TestLoadS3MFile(const CSoundFile &sndFile, bool resaved)
 {
@@ -3616,6 +3755,98 @@ static void SaveMOD(const TSoundFileContainer &sndFile, const mpt::PathString &f
 #endif // MODPLUG_TRACKER
 
 
+#if MPT_THREADPOOL_THREADS
+
+// Collects up to maxNotes notes that play different looped samples of the module's instruments.
+static std::vector<ModCommand> FindLoopedSampleNotes(const CSoundFile &sndFile, std::size_t maxNotes)
+{
+	std::vector<ModCommand> notes;
+	for(INSTRUMENTINDEX ins = 1; ins <= sndFile.GetNumInstruments() && notes.size() < maxNotes; ins++)
+	{
+		if(sndFile.Instruments[ins] == nullptr)
+			continue;
+		const auto &keyboard = sndFile.Instruments[ins]->Keyboard;
+		for(std::size_t key = 0; key < std::size(keyboard) && notes.size() < maxNotes; key++)
+		{
+			if(keyboard[key] == 0 || keyboard[key] > sndFile.GetNumSamples())
+				continue;
+			const ModSample &sample = sndFile.GetSample(keyboard[key]);
+			if(!sample.HasSampleData() || !sample.uFlags[CHN_LOOP] || !sample.nVolume)
+				continue;
+			ModCommand note;
+			note.note = static_cast<ModCommand::NOTE>(NOTE_MIN + key);
+			note.instr = static_cast<ModCommand::INSTR>(ins);
+			notes.push_back(note);
+			key += 5;  // Spread the voices across different pitches
+		}
+	}
+	return notes;
+}
+
+// Renders the test module on the given number of mixer threads, with only the first numVoices channels audible.
+// All randomness and plugin routing is removed before prepare(CSoundFile &) gets to set up the patterns and plugins.
+template <typename Tprepare>
+static std::vector<double> RenderWithMixThreads(const mpt::PathString &filename, uint32 numThreads, CHANNELINDEX numVoices, Tprepare prepare)
+{
+	class CaptureAudioTarget : public IAudioTarget
+	{
+	public:
+		std::vector<double> samples;
+		void Process(mpt::audio_span_interleaved<MixSampleInt> buffer) override { samples.insert(samples.end(), buffer.data(), buffer.data() + buffer.size_frames() * buffer.size_channels()); }
+		void Process(mpt::audio_span_interleaved<MixSampleFloat> buffer) override { samples.insert(samples.end(), buffer.data(), buffer.data() + buffer.size_frames() * buffer.size_channels()); }
+	};
+
+	auto sndFile = std::make_unique<CSoundFile>();
+	{
+		mpt::ifstream stream(filename, std::ios::binary);
+		FileReader file = mpt::IO::make_FileCursor<mpt::PathString>(stream);
+		VERIFY_EQUAL(sndFile->Create(file, CSoundFile::loadCompleteModule), true);
+	}
+	VERIFY_EQUAL(sndFile->GetNumChannels() >= numVoices, true);
+
+	// Avoid any randomness and plugins
+	for(INSTRUMENTINDEX ins = 1; ins <= sndFile->GetNumInstruments(); ins++)
+	{
+		if(ModInstrument *instr = sndFile->Instruments[ins]; instr != nullptr)
+		{
+			instr->nMixPlug = 0;
+			instr->nPanSwing = instr->nVolSwing = instr->nCutSwing = instr->nResSwing = 0;
+		}
+	}
+	for(CHANNELINDEX chn = 0; chn < sndFile->GetNumChannels(); chn++)
+		sndFile->ChnSettings[chn].nMixPlugin = 0;
+
+	prepare(*sndFile);
+
+	sndFile->ResetPlayPos();
+	for(CHANNELINDEX chn = 0; chn < sndFile->GetNumChannels(); chn++)
+	{
+		sndFile->m_PlayState.Chn[chn].dwFlags.reset(CHN_SYNCMUTE);
+		sndFile->m_PlayState.Chn[chn].dwFlags.set(CHN_MUTE, chn >= numVoices);
+	}
+	MixerSettings mixerSettings = sndFile->m_MixerSettings;
+	mixerSettings.NumMixThreads = numThreads;
+	sndFile->SetMixerSettings(mixerSettings);
+
+	CaptureAudioTarget target;
+	for(int i = 0; i < 8; i++)
+		sndFile->Read(4096, target);
+	VERIFY_EQUAL(sndFile->GetMixStat() >= numVoices, true);
+	return target.samples;
+}
+
+// Mixing on several threads must sound exactly the same as mixing everything on one thread.
+template <typename Tprepare>
+static void VerifyMixThreadsIdentical(const mpt::PathString &filename, CHANNELINDEX numVoices, Tprepare prepare)
+{
+	const std::vector<double> singleThreaded = RenderWithMixThreads(filename, 1, numVoices, prepare), multiThreaded = RenderWithMixThreads(filename, 3, numVoices, prepare);
+	VERIFY_EQUAL(singleThreaded.size(), 8u * 4096u * 2u);
+	VERIFY_EQUAL(singleThreaded == multiThreaded, true);
+	VERIFY_EQUAL(std::count(singleThreaded.begin(), singleThreaded.end(), 0.0) < static_cast<std::ptrdiff_t>(singleThreaded.size()), true);
+}
+
+#endif // MPT_THREADPOOL_THREADS
+
 
 // Test file loading and saving
 static MPT_NOINLINE void TestLoadSaveFile()
@@ -3642,6 +3873,7 @@ static MPT_NOINLINE void TestLoadSaveFile()
 #endif
 
 		TestLoadMPTMFile(GetSoundFile(sndFileContainer));
+		TestGetAllSubSongs(GetSoundFile(sndFileContainer));
 
 		#ifndef MODPLUG_NO_FILESAVE
 			// Test file saving
@@ -3656,6 +3888,421 @@ static MPT_NOINLINE void TestLoadSaveFile()
 		DestroySoundFileContainer(sndFileContainer);
 	}
 
+	// Test probing: Skipping format loaders based on their magic bytes must not reject valid files,
+	// not even when only the start of the file is available.
+	{
+#if MPT_OS_DJGPP
+		const mpt::PathString extensions[] = {P_("mpt"), P_("xm"), P_("s3m"), P_("mod")};
+#else
+		const mpt::PathString extensions[] = {P_("mptm"), P_("xm"), P_("s3m"), P_("mod")};
+#endif
+		for(const auto &extension : extensions)
+		{
+			mpt::ifstream stream(filenameBaseSrc + extension, std::ios::binary);
+			FileReader file = mpt::IO::make_FileCursor<mpt::PathString>(stream);
+			const std::vector<std::byte> data = file.ReadRawDataAsByteVector();
+			const uint64 fileSize = data.size();
+			VERIFY_EQUAL(CSoundFile::Probe(CSoundFile::ProbeModules, mpt::as_span(data), &fileSize), CSoundFile::ProbeSuccess);
+			VERIFY_EQUAL(CSoundFile::Probe(CSoundFile::ProbeModules, mpt::as_span(data), nullptr), CSoundFile::ProbeSuccess);
+			for(std::size_t size : {std::size_t(16), std::size_t(64), std::size_t(1024)})
+			{
+				VERIFY_EQUAL_NONCONT(CSoundFile::Probe(CSoundFile::ProbeModules, mpt::as_span(data).first(std::min(size, data.size())), &fileSize) != CSoundFile::ProbeFailure, true);
+			}
+		}
+
+		std::vector<std::byte> garbage(4096, std::byte{0x55});
+		const uint64 garbageSize = garbage.size();
+		VERIFY_EQUAL(CSoundFile::Probe(CSoundFile::ProbeModules, mpt::as_span(garbage), &garbageSize), CSoundFile::ProbeFailure);
+		VERIFY_EQUAL(CSoundFile::Probe(CSoundFile::ProbeModules, mpt::as_span(garbage).first(8), &garbageSize), CSoundFile::ProbeWantMoreData);
+	}
+
+	// Test memory footprint: Sample slots must only be allocated for the samples that the module actually uses.
+	{
+#if MPT_OS_DJGPP
+		const std::pair<mpt::PathString, const char *> files[] = {{P_("mpt"), "MPTM"}, {P_("xm"), "XM"}, {P_("s3m"), "S3M"}, {P_("mod"), "MOD"}};
+#else
+		const std::pair<mpt::PathString, const char *> files[] = {{P_("mptm"), "MPTM"}, {P_("xm"), "XM"}, {P_("s3m"), "S3M"}, {P_("mod"), "MOD"}};
+#endif
+		for(const auto &[extension, name] : files)
+		{
+			TSoundFileContainer sndFileContainer = CreateSoundFileContainer(filenameBaseSrc + extension);
+			const CSoundFile &sndFile = GetSoundFile(sndFileContainer);
+			const std::size_t sampleHeaderMemory = sndFile.GetSampleHeaderMemoryUsage();
+			std::cout << std::dec << "Memory usage of " << name << " module: sizeof(CSoundFile) = " << sizeof(CSoundFile) << " bytes, sample headers = " << sampleHeaderMemory << " bytes" << std::endl;
+			VERIFY_EQUAL(sampleHeaderMemory > 0, true);
+			VERIFY_EQUAL(sampleHeaderMemory <= (sndFile.GetNumSamples() + 64u) * (sizeof(ModSample) + MAX_SAMPLENAME), true);
+			DestroySoundFileContainer(sndFileContainer);
+		}
+		VERIFY_EQUAL(sizeof(CSoundFile) < MAX_SAMPLES * sizeof(ModSample), true);
+	}
+
+	// Test deferred sample decoding: Samples must be decoded when they are played, even though the file is gone by then,
+	// and the decoded data must be identical to what is decoded while loading.
+	// The module is also wrapped in an uncompressed MMCMP container, whose unpacked data is only owned by the loader.
+	for(const bool packed : {false, true})
+	{
+#if MPT_OS_DJGPP
+		const mpt::PathString filename = filenameBaseSrc + P_("mpt");
+#else
+		const mpt::PathString filename = filenameBaseSrc + P_("mptm");
+#endif
+		auto eagerSndFile = std::make_unique<CSoundFile>();
+		auto lazySndFile = std::make_unique<CSoundFile>();
+		{
+			mpt::ifstream stream(filename, std::ios::binary);
+			FileReader file = mpt::IO::make_FileCursor<mpt::PathString>(stream);
+			std::vector<std::byte> packedData;
+			if(packed)
+			{
+				const auto write16 = [&packedData](uint16 value) { packedData.push_back(static_cast<std::byte>(value & 0xFF)); packedData.push_back(static_cast<std::byte>(value >> 8)); };
+				const auto write32 = [&write16](uint32 value) { write16(static_cast<uint16>(value & 0xFFFF)); write16(static_cast<uint16>(value >> 16)); };
+				const uint32 size = mpt::saturate_cast<uint32>(file.GetLength());
+				for(char c : std::string_view{"ziRCONia"})
+					packedData.push_back(static_cast<std::byte>(c));
+				write16(14);  // hdrsize
+				write16(0);  // version
+				write16(1);  // nblocks
+				write32(size);  // filesize
+				write32(24);  // blktable
+				write16(0);  // glb_comp, fmt_comp
+				write32(28);  // offset of first block
+				write32(size);  // unpk_size
+				write32(size);  // pk_size
+				write32(0);  // xor_chk
+				write16(1);  // sub_blk
+				write16(0);  // flags: not compressed
+				write16(0);  // tt_entries
+				write16(0);  // num_bits
+				write32(0);  // sub-block position
+				write32(size);  // sub-block size
+				const auto view = file.GetPinnedView();
+				packedData.insert(packedData.end(), view.span().begin(), view.span().end());
+				file = FileReader(mpt::as_span(packedData));
+			}
+			VERIFY_EQUAL(eagerSndFile->Create(file, CSoundFile::loadCompleteModule), true);
+			VERIFY_EQUAL(lazySndFile->Create(file, static_cast<CSoundFile::ModLoadingFlags>(CSoundFile::loadCompleteModule | CSoundFile::deferSampleData)), true);
+			if(packed)
+				VERIFY_EQUAL(lazySndFile->GetContainerType() == ModContainerType::MMCMP, true);
+			// Overwrite the file data so that reading from it after it has been freed cannot go unnoticed
+			std::fill(packedData.begin(), packedData.end(), std::byte{0x55});
+		}
+		VERIFY_EQUAL(lazySndFile->GetNumSamples(), eagerSndFile->GetNumSamples());
+
+		std::vector<SAMPLEINDEX> deferredSamples;
+		for(SAMPLEINDEX smp = 1; smp <= lazySndFile->GetNumSamples(); smp++)
+		{
+			VERIFY_EQUAL_NONCONT(lazySndFile->GetSample(smp).nLength, eagerSndFile->GetSample(smp).nLength);
+			if(lazySndFile->IsSampleDataDeferred(smp))
+			{
+				VERIFY_EQUAL_NONCONT(lazySndFile->GetSample(smp).HasSampleData(), false);
+				deferredSamples.push_back(smp);
+			}
+		}
+		VERIFY_EQUAL(deferredSamples.empty(), false);
+
+		// The test file does not play the deferred samples, so write some notes that do into the first row of each pattern.
+		CHANNELINDEX noteChn = 0;
+		for(SAMPLEINDEX smp : deferredSamples)
+		{
+			for(INSTRUMENTINDEX ins = 1; ins <= lazySndFile->GetNumInstruments() && noteChn < lazySndFile->GetNumChannels(); ins++)
+			{
+				if(lazySndFile->Instruments[ins] == nullptr)
+					continue;
+				const auto &keyboard = lazySndFile->Instruments[ins]->Keyboard;
+				const auto key = std::find(std::begin(keyboard), std::end(keyboard), smp);
+				if(key == std::end(keyboard))
+					continue;
+				for(auto &pattern : lazySndFile->Patterns)
+				{
+					if(!pattern.IsValid())
+						continue;
+					ModCommand &m = *pattern.GetpModCommand(0, noteChn);
+					m = ModCommand{};
+					m.note = static_cast<ModCommand::NOTE>(NOTE_MIN + std::distance(std::begin(keyboard), key));
+					m.instr = static_cast<ModCommand::INSTR>(ins);
+				}
+				noteChn++;
+				break;
+			}
+		}
+		VERIFY_EQUAL(noteChn > 0, true);
+
+		// The channels of the test file are muted
+		lazySndFile->ResetPlayPos();
+		for(CHANNELINDEX chn = 0; chn < lazySndFile->GetNumChannels(); chn++)
+			lazySndFile->m_PlayState.Chn[chn].dwFlags.reset(CHN_MUTE | CHN_SYNCMUTE);
+		for(int tick = 0; tick < 100 && lazySndFile->ReadOneTick(); tick++)
+		{
+		}
+
+		bool anyDecoded = false;
+		for(SAMPLEINDEX smp : deferredSamples)
+		{
+			if(lazySndFile->IsSampleDataDeferred(smp))
+				continue;
+			const ModSample &lazySample = lazySndFile->GetSample(smp), &eagerSample = eagerSndFile->GetSample(smp);
+			VERIFY_EQUAL_NONCONT(lazySample.HasSampleData(), true);
+			VERIFY_EQUAL_NONCONT(lazySample.uFlags == eagerSample.uFlags, true);
+			VERIFY_EQUAL_NONCONT(lazySample.GetSampleSizeInBytes(), eagerSample.GetSampleSizeInBytes());
+			if(lazySample.HasSampleData() && eagerSample.HasSampleData() && lazySample.GetSampleSizeInBytes() == eagerSample.GetSampleSizeInBytes())
+			{
+				VERIFY_EQUAL_NONCONT(std::memcmp(lazySample.samplev(), eagerSample.samplev(), lazySample.GetSampleSizeInBytes()), 0);
+			}
+			anyDecoded = true;
+		}
+		VERIFY_EQUAL(anyDecoded, true);
+	}
+
+	// Test parallel sample decoding: All samples must have been decoded by the time loading has finished, with the same result as without threads.
+	{
+#if MPT_OS_DJGPP
+		const mpt::PathString filename = filenameBaseSrc + P_("mpt");
+#else
+		const mpt::PathString filename = filenameBaseSrc + P_("mptm");
+#endif
+		auto serialSndFile = std::make_unique<CSoundFile>();
+		auto parallelSndFile = std::make_unique<CSoundFile>();
+		{
+			mpt::ifstream stream(filename, std::ios::binary);
+			FileReader file = mpt::IO::make_FileCursor<mpt::PathString>(stream);
+			VERIFY_EQUAL(serialSndFile->Create(file, CSoundFile::loadCompleteModule), true);
+			VERIFY_EQUAL(parallelSndFile->Create(file, static_cast<CSoundFile::ModLoadingFlags>(CSoundFile::loadCompleteModule | CSoundFile::decodeSamplesInParallel)), true);
+		}
+		VERIFY_EQUAL(parallelSndFile->GetNumSamples(), serialSndFile->GetNumSamples());
+		for(SAMPLEINDEX smp = 1; smp <= parallelSndFile->GetNumSamples(); smp++)
+		{
+			const ModSample &parallelSample = parallelSndFile->GetSample(smp), &serialSample = serialSndFile->GetSample(smp);
+			VERIFY_EQUAL_NONCONT(parallelSndFile->IsSampleDataDeferred(smp), false);
+			VERIFY_EQUAL_NONCONT(parallelSample.nLength, serialSample.nLength);
+			VERIFY_EQUAL_NONCONT(parallelSample.HasSampleData(), serialSample.HasSampleData());
+			VERIFY_EQUAL_NONCONT(parallelSample.uFlags == serialSample.uFlags, true);
+			VERIFY_EQUAL_NONCONT(parallelSample.GetSampleSizeInBytes(), serialSample.GetSampleSizeInBytes());
+			if(parallelSample.HasSampleData() && serialSample.HasSampleData() && parallelSample.GetSampleSizeInBytes() == serialSample.GetSampleSizeInBytes())
+			{
+				VERIFY_EQUAL_NONCONT(std::memcmp(parallelSample.samplev(), serialSample.samplev(), parallelSample.GetSampleSizeInBytes()), 0);
+			}
+		}
+	}
+
+	// Test shared sample data: Instances of the same file must use the same sample data, which must stay valid as long as any of them is alive.
+	{
+#if MPT_OS_DJGPP
+		const mpt::PathString filename = filenameBaseSrc + P_("mpt");
+#else
+		const mpt::PathString filename = filenameBaseSrc + P_("mptm");
+#endif
+		const auto shareFlags = static_cast<CSoundFile::ModLoadingFlags>(CSoundFile::loadCompleteModule | CSoundFile::shareSampleData);
+		auto ownSndFile = std::make_unique<CSoundFile>();
+		auto sharedSndFile1 = std::make_unique<CSoundFile>();
+		auto sharedSndFile2 = std::make_unique<CSoundFile>();
+		{
+			mpt::ifstream stream(filename, std::ios::binary);
+			FileReader file = mpt::IO::make_FileCursor<mpt::PathString>(stream);
+			VERIFY_EQUAL(ownSndFile->Create(file, CSoundFile::loadCompleteModule), true);
+			VERIFY_EQUAL(sharedSndFile1->Create(file, shareFlags), true);
+			VERIFY_EQUAL(sharedSndFile2->Create(file, shareFlags), true);
+		}
+		VERIFY_EQUAL(sharedSndFile2->GetNumSamples(), ownSndFile->GetNumSamples());
+		bool anyShared = false;
+		for(SAMPLEINDEX smp = 1; smp <= ownSndFile->GetNumSamples(); smp++)
+		{
+			VERIFY_EQUAL_NONCONT(sharedSndFile2->GetSample(smp).samplev() == sharedSndFile1->GetSample(smp).samplev(), true);
+			if(sharedSndFile2->GetSample(smp).HasSampleData())
+				anyShared = true;
+		}
+		VERIFY_EQUAL(anyShared, true);
+
+		// A file with the same hash must only be matched if it is really the same file
+		{
+			mpt::ifstream stream(filename, std::ios::binary);
+			FileReader file = mpt::IO::make_FileCursor<mpt::PathString>(stream);
+			std::vector<std::byte> otherFileData(mpt::saturate_cast<std::size_t>(file.GetLength()));
+			file.ReadRaw(mpt::as_span(otherFileData));
+			otherFileData.back() = ~otherFileData.back();
+			const auto key = SharedSamples::GetKey(file);
+			VERIFY_EQUAL(SharedSamples::Find(key, file) != nullptr, true);
+			VERIFY_EQUAL(SharedSamples::Find(key, FileReader(mpt::as_span(otherFileData))) == nullptr, true);
+		}
+
+		// Modifying shared sample data during playback (e.g. MOD EFx) must not affect other instances
+		for(SAMPLEINDEX smp = 1; smp <= sharedSndFile2->GetNumSamples(); smp++)
+		{
+			ModSample &sample = sharedSndFile2->GetSample(smp);
+			if(!sample.HasSampleData())
+				continue;
+			const void *sharedData = sharedSndFile1->GetSample(smp).samplev();
+			VERIFY_EQUAL(sharedSndFile2->MakeSampleDataWritable(sample), true);
+			VERIFY_EQUAL(sample.samplev() != sharedData, true);
+			VERIFY_EQUAL(std::memcmp(sample.samplev(), sharedData, sample.GetSampleSizeInBytes()), 0);
+			break;
+		}
+
+		sharedSndFile1.reset();
+		for(SAMPLEINDEX smp = 1; smp <= ownSndFile->GetNumSamples(); smp++)
+		{
+			const ModSample &sharedSample = sharedSndFile2->GetSample(smp), &ownSample = ownSndFile->GetSample(smp);
+			VERIFY_EQUAL_NONCONT(sharedSample.nLength, ownSample.nLength);
+			VERIFY_EQUAL_NONCONT(sharedSample.HasSampleData(), ownSample.HasSampleData());
+			VERIFY_EQUAL_NONCONT(sharedSample.uFlags == ownSample.uFlags, true);
+			if(sharedSample.HasSampleData() && ownSample.HasSampleData() && sharedSample.GetSampleSizeInBytes() == ownSample.GetSampleSizeInBytes())
+			{
+				// Including the pre-computed loop wrap-around buffers
+				const std::size_t bufferSize = ModSample::GetRealSampleBufferSize(ownSample.nLength, ownSample.GetBytesPerSample()) - InterpolationLookaheadBufferSize * MaxSamplingPointSize;
+				VERIFY_EQUAL_NONCONT(std::memcmp(sharedSample.samplev(), ownSample.samplev(), bufferSize), 0);
+			}
+		}
+	}
+
+#ifndef NO_RENDER_STATS
+	// Test render statistics: With a voice limit of one voice, a second voice playing at the same time must be skipped.
+	{
+#if MPT_OS_DJGPP
+		const mpt::PathString filename = filenameBaseSrc + P_("mpt");
+#else
+		const mpt::PathString filename = filenameBaseSrc + P_("mptm");
+#endif
+		auto sndFile = std::make_unique<CSoundFile>();
+		{
+			mpt::ifstream stream(filename, std::ios::binary);
+			FileReader file = mpt::IO::make_FileCursor<mpt::PathString>(stream);
+			VERIFY_EQUAL(sndFile->Create(file, CSoundFile::loadCompleteModule), true);
+		}
+
+		// Play a looped sample on the first two channels
+		ModCommand note;
+		for(INSTRUMENTINDEX ins = 1; ins <= sndFile->GetNumInstruments() && note.IsEmpty(); ins++)
+		{
+			if(sndFile->Instruments[ins] == nullptr)
+				continue;
+			const auto &keyboard = sndFile->Instruments[ins]->Keyboard;
+			for(std::size_t key = 0; key < std::size(keyboard); key++)
+			{
+				if(keyboard[key] == 0 || keyboard[key] > sndFile->GetNumSamples())
+					continue;
+				const ModSample &sample = sndFile->GetSample(keyboard[key]);
+				if(!sample.HasSampleData() || !sample.uFlags[CHN_LOOP] || !sample.nVolume)
+					continue;
+				note.note = static_cast<ModCommand::NOTE>(NOTE_MIN + key);
+				note.instr = static_cast<ModCommand::INSTR>(ins);
+				break;
+			}
+		}
+		VERIFY_EQUAL(note.IsEmpty(), false);
+		for(auto &pattern : sndFile->Patterns)
+		{
+			if(!pattern.IsValid())
+				continue;
+			for(CHANNELINDEX chn = 0; chn < 2; chn++)
+				*pattern.GetpModCommand(0, chn) = note;
+		}
+
+		sndFile->ResetPlayPos();
+		for(CHANNELINDEX chn = 0; chn < sndFile->GetNumChannels(); chn++)
+			sndFile->m_PlayState.Chn[chn].dwFlags.reset(CHN_MUTE | CHN_SYNCMUTE);
+		MixerSettings mixerSettings = sndFile->m_MixerSettings;
+		mixerSettings.m_nMaxMixChannels = 1;
+		sndFile->SetMixerSettings(mixerSettings);
+		sndFile->m_collectRenderStats = true;
+
+		class NullAudioTarget : public IAudioTarget
+		{
+		public:
+			void Process(mpt::audio_span_interleaved<MixSampleInt>) override { }
+			void Process(mpt::audio_span_interleaved<MixSampleFloat>) override { }
+		};
+		NullAudioTarget target;
+		const CSoundFile::samplecount_t rendered = sndFile->Read(4096, target);
+		VERIFY_EQUAL(rendered, 4096u);
+
+		const RenderStats &stats = sndFile->m_renderStats;
+		VERIFY_EQUAL(stats.calls[RenderStats::ReadNote] > 0, true);
+		VERIFY_EQUAL(stats.calls[RenderStats::Mix] > 0, true);
+		VERIFY_EQUAL(stats.calls[RenderStats::Output], stats.calls[RenderStats::Mix]);
+		VERIFY_EQUAL(stats.maxMixedVoices, CHANNELINDEX(1));
+		VERIFY_EQUAL(stats.mixedVoices <= stats.calls[RenderStats::Mix], true);
+		VERIFY_EQUAL(stats.skippedVoices > 0, true);
+		VERIFY_EQUAL(stats.skippedFrames >= stats.skippedVoices, true);
+		VERIFY_EQUAL(stats.skippedFrames <= rendered * stats.skippedVoices, true);
+
+		// Seeking does not render anything
+		const RenderStats statsBeforeSeek = stats;
+		sndFile->ReadOneTick();
+		VERIFY_EQUAL(stats.skippedVoices, statsBeforeSeek.skippedVoices);
+		VERIFY_EQUAL(stats.calls[RenderStats::Mix], statsBeforeSeek.calls[RenderStats::Mix]);
+	}
+#endif // NO_RENDER_STATS
+
+#if MPT_THREADPOOL_THREADS
+	// Sample voices mixed on several threads must sound exactly the same as when mixed one after another.
+	{
+#if MPT_OS_DJGPP
+		const mpt::PathString filename = filenameBaseSrc + P_("mpt");
+#else
+		const mpt::PathString filename = filenameBaseSrc + P_("mptm");
+#endif
+		constexpr CHANNELINDEX numVoices = 16;
+		VerifyMixThreadsIdentical(filename, numVoices, [](CSoundFile &sndFile)
+		{
+			// Play looped samples at different pitches on the first channels, and nothing else
+			const std::vector<ModCommand> notes = FindLoopedSampleNotes(sndFile, numVoices);
+			VERIFY_EQUAL(notes.empty(), false);
+			for(auto &pattern : sndFile.Patterns)
+			{
+				if(!pattern.IsValid())
+					continue;
+				pattern.ClearCommands();
+				for(CHANNELINDEX chn = 0; chn < numVoices; chn++)
+					*pattern.GetpModCommand(0, chn) = notes[chn % notes.size()];
+			}
+		});
+	}
+#endif // MPT_THREADPOOL_THREADS
+
+#if !defined(NO_PLUGINS) && MPT_THREADPOOL_THREADS
+	// Independent plugin chains processed on several threads must sound exactly the same as when processed one after another.
+	{
+#if MPT_OS_DJGPP
+		const mpt::PathString filename = filenameBaseSrc + P_("mpt");
+#else
+		const mpt::PathString filename = filenameBaseSrc + P_("mptm");
+#endif
+		VerifyMixThreadsIdentical(filename, 2, [](CSoundFile &sndFile)
+		{
+			// Two chains of two plugins each, fed by the first two channels
+			const struct { PLUGINDEX slot; uint32 id; const char *name; } plugins[] =
+			{
+				{10, 0xEF3E932C, "Echo"}, {11, 0xEFE6629C, "Chorus"},
+				{20, 0xDAFD8210, "Gargle"}, {21, 0x87FC0268, "WavesReverb"},
+			};
+			for(const auto &plug : plugins)
+			{
+				SNDMIXPLUGIN &plugin = sndFile.m_MixPlugins[plug.slot];
+				plugin.Destroy();
+				plugin = {};
+				plugin.Info.dwPluginId1 = kDmoMagic;
+				plugin.Info.dwPluginId2 = plug.id;
+				plugin.Info.szLibraryName = plug.name;
+				if(plug.slot == 10 || plug.slot == 20)
+					plugin.SetOutputPlugin(plug.slot + 1);
+				VERIFY_EQUAL(CreateMixPluginProc(plugin, sndFile), true);
+			}
+			sndFile.ChnSettings[0].nMixPlugin = 11;
+			sndFile.ChnSettings[1].nMixPlugin = 21;
+
+			// Play a looped sample on the first two channels
+			const std::vector<ModCommand> notes = FindLoopedSampleNotes(sndFile, 1);
+			VERIFY_EQUAL(notes.empty(), false);
+			for(auto &pattern : sndFile.Patterns)
+			{
+				if(!pattern.IsValid())
+					continue;
+				for(CHANNELINDEX chn = 0; chn < 2; chn++)
+					*pattern.GetpModCommand(0, chn) = notes[0];
+			}
+		});
+	}
+#endif // !NO_PLUGINS && MPT_THREADPOOL_THREADS
+
 	// Reload the saved file and test if everything is still working correctly.
 	#ifndef MODPLUG_NO_FILESAVE
 	{
@@ -3725,6 +4372,27 @@ static MPT_NOINLINE void TestLoadSaveFile()
 	}
 	#endif
 
+#if MPT_IO_FILE_FILEMAPPING_POSIX
+	// Test loading from a memory-mapped file
+	{
+		// Small files are only mapped if explicitly requested
+		VERIFY_EQUAL(mpt::IO::FileMapping(filenameBaseSrc + P_("xm")).IsValid(), false);
+		mpt::IO::FileMapping mapping(filenameBaseSrc + P_("xm"), 0);
+		VERIFY_EQUAL(mapping.IsValid(), true);
+		const std::byte *mappedData = mapping.GetView().data();
+		FileReader file = mpt::IO::make_FileCursor<mpt::PathString>(std::move(mapping));
+		// Loaders must get a view into the mapping instead of a copy
+		VERIFY_EQUAL(file.GetPinnedView().data(), mappedData);
+		auto sndFile = std::make_unique<CSoundFile>();
+		VERIFY_EQUAL(sndFile->Create(file, CSoundFile::loadCompleteModule), true);
+		TestLoadXMFile(*sndFile);
+
+		mpt::IO::InputFile inputFile(filenameBaseSrc + P_("xm"), true);
+		VERIFY_EQUAL(inputFile.IsCached(), true);
+		VERIFY_EQUAL(mpt::IO::make_FileCursor<mpt::PathString>(inputFile).GetRawDataAsByteVector(), file.GetRawDataAsByteVector());
+	}
+#endif // MPT_IO_FILE_FILEMAPPING_POSIX
+
 	// Test S3M file loading
 	{
 		TSoundFileContainer sndFileContainer = CreateSoundFileContainer(filenameBaseSrc + P_("s3m"));
@@ -3747,6 +4415,51 @@ static MPT_NOINLINE void TestLoadSaveFile()
 		}
 		VERIFY_EQUAL_EPS(totalDuration, 3674.38, 1.0);
 
+		// Seeking with a seek index must yield the same state as seeking from the song start
+		{
+			SeekIndex seekIndex(20.0);
+			for(double seconds : {300.0, 90.0, 1500.0, 700.0, 2500.0})
+			{
+				const auto expected = sndFile.GetLength(eAdjustSamplePositions, GetLengthTarget(seconds)).back();
+				std::vector<SamplePosition::value_t> expectedPositions;
+				for(CHANNELINDEX chn = 0; chn < sndFile.GetNumChannels(); chn++)
+					expectedPositions.push_back(sndFile.m_PlayState.Chn[chn].position.GetRaw());
+
+				const auto actual = sndFile.GetLength(eAdjustSamplePositions, GetLengthTarget(seconds).UseSeekIndex(&seekIndex)).back();
+				VERIFY_EQUAL_NONCONT(actual.duration, expected.duration);
+				VERIFY_EQUAL_NONCONT(actual.targetReached, expected.targetReached);
+				VERIFY_EQUAL_NONCONT(actual.lastOrder, expected.lastOrder);
+				VERIFY_EQUAL_NONCONT(actual.lastRow, expected.lastRow);
+				for(CHANNELINDEX chn = 0; chn < sndFile.GetNumChannels(); chn++)
+					VERIFY_EQUAL_NONCONT(sndFile.m_PlayState.Chn[chn].position.GetRaw(), expectedPositions[chn]);
+			}
+			VERIFY_EQUAL_NONCONT(seekIndex.GetNumCheckpoints() > 0, true);
+			VERIFY_EQUAL_NONCONT(seekIndex.GetMemoryUsage() <= seekIndex.GetMaxMemory(), true);
+		}
+
+		// Restoring a play state snapshot must restore the saved channels and stop background channels that were not in use
+		{
+			sndFile.GetLength(eAdjustSamplePositions, GetLengthTarget(90.0));
+			CSoundFile::PlayState::Snapshot snapshot;
+			sndFile.m_PlayState.Save(snapshot, sndFile.GetNumChannels(), true);
+			VERIFY_EQUAL_NONCONT(snapshot.GetMemoryUsage() < sizeof(CSoundFile::PlayState), true);
+			const ORDERINDEX order = sndFile.m_PlayState.m_nCurrentOrder;
+			const ROWINDEX row = sndFile.m_PlayState.m_nRow;
+			std::vector<SamplePosition::value_t> positions;
+			for(CHANNELINDEX chn = 0; chn < sndFile.GetNumChannels(); chn++)
+				positions.push_back(sndFile.m_PlayState.Chn[chn].position.GetRaw());
+
+			sndFile.GetLength(eAdjustSamplePositions, GetLengthTarget(700.0));
+			ModChannel &backgroundChn = sndFile.m_PlayState.Chn[sndFile.GetNumChannels()];
+			backgroundChn.nLength = 1000;
+			sndFile.m_PlayState.Restore(snapshot);
+			VERIFY_EQUAL_NONCONT(sndFile.m_PlayState.m_nCurrentOrder, order);
+			VERIFY_EQUAL_NONCONT(sndFile.m_PlayState.m_nRow, row);
+			for(CHANNELINDEX chn = 0; chn < sndFile.GetNumChannels(); chn++)
+				VERIFY_EQUAL_NONCONT(sndFile.m_PlayState.Chn[chn].position.GetRaw(), positions[chn]);
+			VERIFY_EQUAL_NONCONT(backgroundChn.nLength, 0u);
+		}
+
 		#ifndef MODPLUG_NO_FILESAVE
 			// Test file saving
 			sndFile.ChnSettings[1].dwFlags.set(CHN_MUTE);
@@ -3848,6 +4561,193 @@ static MPT_NOINLINE void TestLoadSaveFile()
 }
 
 
+#ifdef LIBOPENMPT_BUILD
+
+// Wait until the background thread has rendered the requested amount of audio.
+// Near the end of the song, the queue does not fill up anymore, so give up after a while.
+static void WaitForRenderAhead(const openmpt::ext::render_ahead &renderAhead, std::size_t frames)
+{
+	const auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+	while(static_cast<std::size_t>(renderAhead.get_render_ahead_queued_frames()) < frames && std::chrono::steady_clock::now() < timeout)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+}
+
+
+// Read the same amount of audio from a module rendering synchronously and from a module rendering ahead. Both must produce identical output.
+// If the read position is at a block boundary of the module rendering ahead, the reported playback state must also be identical.
+static std::size_t CompareRenderAhead(openmpt::module &syncModule, openmpt::module &aheadModule, const openmpt::ext::render_ahead &renderAhead, std::size_t frames, bool compareState)
+{
+	constexpr std::int32_t samplerate = 8000;
+	std::vector<float> syncBuffer(frames * 2), aheadBuffer(frames * 2);
+	if(renderAhead.is_render_ahead_active())
+		WaitForRenderAhead(renderAhead, frames);
+	const std::size_t syncCount = syncModule.read_interleaved_stereo(samplerate, frames, syncBuffer.data());
+	const std::size_t aheadCount = aheadModule.read_interleaved_stereo(samplerate, frames, aheadBuffer.data());
+	VERIFY_EQUAL_NONCONT(aheadCount, syncCount);
+	VERIFY_EQUAL_NONCONT(std::memcmp(aheadBuffer.data(), syncBuffer.data(), std::min(aheadCount, syncCount) * 2 * sizeof(float)), 0);
+	// The position is accumulated per block instead of per read, so it may differ by rounding errors.
+	VERIFY_EQUAL_EPS(aheadModule.get_position_seconds(), syncModule.get_position_seconds(), 1e-9);
+	if(compareState)
+	{
+		VERIFY_EQUAL_NONCONT(aheadModule.get_current_order(), syncModule.get_current_order());
+		VERIFY_EQUAL_NONCONT(aheadModule.get_current_pattern(), syncModule.get_current_pattern());
+		VERIFY_EQUAL_NONCONT(aheadModule.get_current_row(), syncModule.get_current_row());
+		VERIFY_EQUAL_NONCONT(aheadModule.get_current_speed(), syncModule.get_current_speed());
+		VERIFY_EQUAL_NONCONT(aheadModule.get_current_tempo2(), syncModule.get_current_tempo2());
+		VERIFY_EQUAL_NONCONT(aheadModule.get_current_playing_channels(), syncModule.get_current_playing_channels());
+		for(std::int32_t chn = 0; chn < syncModule.get_num_channels(); chn++)
+		{
+			VERIFY_EQUAL_NONCONT(aheadModule.get_current_channel_vu_left(chn), syncModule.get_current_channel_vu_left(chn));
+			VERIFY_EQUAL_NONCONT(aheadModule.get_current_channel_vu_right(chn), syncModule.get_current_channel_vu_right(chn));
+		}
+	}
+	return syncCount;
+}
+
+
+// Test rendering ahead on a background thread against synchronous rendering
+static MPT_NOINLINE void TestRenderAhead()
+{
+	if(!ShouldRunTests())
+	{
+		return;
+	}
+
+	// With 2048 frames of queue, the block size is 512 frames
+	constexpr std::size_t blockFrames = 512;
+	const mpt::PathString filename = GetTestFilenameBase() + P_("xm");
+
+	for(const std::string atEnd : {"stop", "continue"})
+	{
+		mpt::ifstream syncStream(filename, std::ios::binary), aheadStream(filename, std::ios::binary);
+		openmpt::module_ext syncModule(syncStream), aheadModule(aheadStream);
+		auto renderAhead = static_cast<openmpt::ext::render_ahead *>(aheadModule.get_interface(openmpt::ext::render_ahead_id));
+		if(!renderAhead)
+		{
+			// Built without thread support
+			return;
+		}
+		syncModule.ctl_set_text("play.at_end", atEnd);
+		aheadModule.ctl_set_text("play.at_end", atEnd);
+
+		renderAhead->start_render_ahead(8000, 2, 2048);
+		VERIFY_EQUAL(renderAhead->is_render_ahead_active(), true);
+		for(int i = 0; i < 8; i++)
+			CompareRenderAhead(syncModule, aheadModule, *renderAhead, blockFrames, true);
+
+		// Reads that are not aligned to blocks
+		CompareRenderAhead(syncModule, aheadModule, *renderAhead, 100, false);
+		CompareRenderAhead(syncModule, aheadModule, *renderAhead, blockFrames * 2 - 100, true);
+
+		// Stopping rewinds the module to the audio that has been read, and restarting continues from there.
+		renderAhead->stop_render_ahead();
+		VERIFY_EQUAL(renderAhead->is_render_ahead_active(), false);
+		VERIFY_EQUAL(renderAhead->get_render_ahead_queued_frames(), 0);
+		for(int i = 0; i < 4; i++)
+			CompareRenderAhead(syncModule, aheadModule, *renderAhead, blockFrames, true);
+		renderAhead->start_render_ahead(8000, 2, 2048);
+		for(int i = 0; i < 4; i++)
+			CompareRenderAhead(syncModule, aheadModule, *renderAhead, blockFrames, true);
+
+		// Seeking discards all queued audio
+		VERIFY_EQUAL(aheadModule.set_position_seconds(4.0), syncModule.set_position_seconds(4.0));
+		for(int i = 0; i < 2; i++)
+			CompareRenderAhead(syncModule, aheadModule, *renderAhead, blockFrames, true);
+		VERIFY_EQUAL(aheadModule.set_position_order_row(1, 0), syncModule.set_position_order_row(1, 0));
+		for(int i = 0; i < 2; i++)
+			CompareRenderAhead(syncModule, aheadModule, *renderAhead, blockFrames, true);
+
+		// The end of the song must be reported exactly like with synchronous rendering
+		std::size_t count = blockFrames;
+		for(int i = 0; i < 1000 && count == blockFrames; i++)
+			count = CompareRenderAhead(syncModule, aheadModule, *renderAhead, blockFrames, true);
+		VERIFY_EQUAL(count < blockFrames, true);
+		if(atEnd == "stop")
+		{
+			VERIFY_EQUAL(CompareRenderAhead(syncModule, aheadModule, *renderAhead, blockFrames, false), 0u);
+			VERIFY_EQUAL(CompareRenderAhead(syncModule, aheadModule, *renderAhead, blockFrames, false), 0u);
+		} else
+		{
+			// The song restarts after the end has been reported
+			VERIFY_EQUAL(CompareRenderAhead(syncModule, aheadModule, *renderAhead, blockFrames, false), 0u);
+			for(int i = 0; i < 4; i++)
+				VERIFY_EQUAL(CompareRenderAhead(syncModule, aheadModule, *renderAhead, blockFrames, false), blockFrames);
+		}
+		VERIFY_EQUAL(renderAhead->get_render_ahead_underruns(), 0u);
+	}
+
+	// Changing a ctl keeps the block that is currently being read, so the change becomes audible at the end of that block.
+	// The state of plugins and OPL synthesis cannot be rewound, so with those, all queued audio is kept instead of rendering it again.
+	const std::pair<mpt::PathString, std::size_t> spliceTests[] =
+	{
+		{P_("mod"), 1},
+#if MPT_OS_DJGPP
+		{P_("mpt"), 4},
+#else
+		{P_("mptm"), 4},
+#endif
+		{P_("s3m"), 4},
+	};
+	for(const auto &[extension, keptBlocks] : spliceTests)
+	{
+		mpt::ifstream syncStream(GetTestFilenameBase() + extension, std::ios::binary), aheadStream(GetTestFilenameBase() + extension, std::ios::binary);
+		openmpt::module_ext syncModule(syncStream), aheadModule(aheadStream);
+		auto renderAhead = static_cast<openmpt::ext::render_ahead *>(aheadModule.get_interface(openmpt::ext::render_ahead_id));
+		renderAhead->start_render_ahead(8000, 2, 2048);
+		for(int i = 0; i < 4; i++)
+			CompareRenderAhead(syncModule, aheadModule, *renderAhead, blockFrames, true);
+
+		WaitForRenderAhead(*renderAhead, 2048);
+		aheadModule.ctl_set_floatingpoint("play.tempo_factor", 1.25);
+		VERIFY_EQUAL(static_cast<std::size_t>(renderAhead->get_render_ahead_queued_frames()), keptBlocks * blockFrames);
+		for(std::size_t i = 0; i < keptBlocks; i++)
+			CompareRenderAhead(syncModule, aheadModule, *renderAhead, blockFrames, true);
+		syncModule.ctl_set_floatingpoint("play.tempo_factor", 1.25);
+		for(int i = 0; i < 8; i++)
+			CompareRenderAhead(syncModule, aheadModule, *renderAhead, blockFrames, true);
+		VERIFY_EQUAL(renderAhead->get_render_ahead_underruns(), 0u);
+	}
+}
+
+
+// The mix chunk size must not change the rendered audio
+static MPT_NOINLINE void TestMixChunkSize()
+{
+	if(!ShouldRunTests())
+	{
+		return;
+	}
+
+	// At 48 kHz, ticks are longer than the default chunk size, so larger chunks are actually rendered in one go.
+	// test.mod uses neither plugins (which limit the chunk size to the default) nor OPL instruments, test.xm and test.s3m do.
+	constexpr std::int32_t samplerate = 48000;
+	constexpr std::size_t readFrames = 4096;
+	for(const auto extension : {P_("mod"), P_("xm"), P_("s3m")})
+	{
+		const mpt::PathString filename = GetTestFilenameBase() + extension;
+		for(const std::int64_t chunkSize : {std::int64_t(16), std::int64_t(37), std::int64_t(4096)})
+		{
+			mpt::ifstream refStream(filename, std::ios::binary), stream(filename, std::ios::binary);
+			openmpt::module refModule(refStream), module(stream);
+			module.ctl_set_integer("render.mixer.chunk_size", chunkSize);
+			VERIFY_EQUAL(module.ctl_get_integer("render.mixer.chunk_size"), chunkSize);
+			std::vector<float> refBuffer(readFrames * 2), buffer(readFrames * 2);
+			for(int i = 0; i < 24; i++)
+			{
+				const std::size_t refCount = refModule.read_interleaved_stereo(samplerate, readFrames, refBuffer.data());
+				const std::size_t count = module.read_interleaved_stereo(samplerate, readFrames, buffer.data());
+				VERIFY_EQUAL_NONCONT(count, refCount);
+				VERIFY_EQUAL_NONCONT(std::memcmp(buffer.data(), refBuffer.data(), std::min(count, refCount) * 2 * sizeof(float)), 0);
+			}
+		}
+	}
+}
+
+#endif // LIBOPENMPT_BUILD
+
+
 // Test various editing features
 static MPT_NOINLINE void TestEditing()
 {
@@ -3923,6 +4823,306 @@ static MPT_NOINLINE void TestEditing()
 }
 
 
+// Verify that the SIMD mix functions produce exactly the same output as the generic ones
+static MPT_NOINLINE void TestMixFunctions()
+{
+#if defined(MPT_INTMIXER) && defined(MPT_ENABLE_ARCH_INTRINSICS_SSE2)
+	if(!CPU::HasFeatureSet(CPU::feature::sse2) || !CPU::HasModesEnabled(CPU::mode::xmm128sse))
+		return;
+
+	mpt::default_prng &prng = *s_PRNG;
+	const auto resampler = std::make_unique<CResampler>();
+	auto randomInt = [&prng](int32 min, int32 max) { return min + static_cast<int32>(mpt::random<uint32>(prng) % static_cast<uint32>(max - min + 1)); };
+
+	// Enough room for 256 output samples at +/- 4x speed around the centre of the sample, plus interpolation taps on either side
+	constexpr unsigned int numSamples = 256;
+	constexpr int32 sampleLength = 3072;
+	constexpr std::size_t maxFrameSize = 4;
+	std::vector<std::byte> sampleData(sampleLength * maxFrameSize);
+	for(auto &b : sampleData)
+	{
+		b = mpt::byte_cast<std::byte>(mpt::random<uint8>(prng));
+	}
+	// Worst case for intermediate overflows: full-scale negative samples multiplied with negative coefficients
+	std::fill(sampleData.begin() + 512 * maxFrameSize, sampleData.begin() + 640 * maxFrameSize, mpt::byte_cast<std::byte>(uint8(0x80)));
+	std::fill(sampleData.begin() + 2432 * maxFrameSize, sampleData.begin() + 2560 * maxFrameSize, mpt::byte_cast<std::byte>(uint8(0x80)));
+
+	for(int iteration = 0; iteration < 8; iteration++)
+	{
+		ModChannel chn{};
+		chn.pCurrentSample = sampleData.data();
+		chn.nLength = sampleLength;
+		chn.position = SamplePosition(randomInt(1472, 1599), mpt::random<uint32>(prng));
+		chn.increment = SamplePosition(static_cast<SamplePosition::value_t>(mpt::random<uint64>(prng) % (8ull << 32)) - (4ll << 32));
+		chn.leftVol = randomInt(0, 4096);
+		chn.rightVol = (iteration & 1) ? chn.leftVol : randomInt(0, 4096);
+		chn.rampLeftVol = chn.leftVol << VOLUMERAMPPRECISION;
+		chn.rampRightVol = chn.rightVol << VOLUMERAMPPRECISION;
+		chn.leftRamp = randomInt(-32, 31);
+		chn.rightRamp = randomInt(-32, 31);
+		chn.nFilter_A0 = randomInt(0, (1 << 24) - 1);
+		chn.nFilter_B0 = randomInt(0, (1 << 24) - 1);
+		chn.nFilter_B1 = -randomInt(0, (1 << 23) - 1);
+		chn.nFilter_HP = (iteration & 2) ? -1 : 0;
+
+		std::vector<mixsample_t> initialMix(numSamples * 2);
+		for(auto &s : initialMix)
+		{
+			s = randomInt(-(1 << 20), 1 << 20);
+		}
+
+		for(std::size_t f = 0; f < std::size(MixFuncTable::Functions); f++)
+		{
+			ModChannel chnGeneric = chn, chnSSE2 = chn;
+			std::vector<mixsample_t> mixGeneric = initialMix, mixSSE2 = initialMix;
+			MixFuncTable::Functions[f](chnGeneric, *resampler, mixGeneric.data(), numSamples);
+			MixFuncTable::FunctionsSSE2[f](chnSSE2, *resampler, mixSSE2.data(), numSamples);
+
+			for(std::size_t i = 0; i < mixGeneric.size(); i++)
+			{
+				VERIFY_EQUAL_QUIET_NONCONT(mixSSE2[i], mixGeneric[i]);
+			}
+			VERIFY_EQUAL_NONCONT(chnSSE2.position.GetRaw(), chnGeneric.position.GetRaw());
+			VERIFY_EQUAL_NONCONT(chnSSE2.rampLeftVol, chnGeneric.rampLeftVol);
+			VERIFY_EQUAL_NONCONT(chnSSE2.rampRightVol, chnGeneric.rampRightVol);
+			VERIFY_EQUAL_NONCONT(chnSSE2.nFilter_Y[0][0], chnGeneric.nFilter_Y[0][0]);
+			VERIFY_EQUAL_NONCONT(chnSSE2.nFilter_Y[1][1], chnGeneric.nFilter_Y[1][1]);
+		}
+	}
+#endif // MPT_INTMIXER && MPT_ENABLE_ARCH_INTRINSICS_SSE2
+}
+
+
+// Verify that the SIMD reverb and EQ produce exactly the same output as the generic ones
+static MPT_NOINLINE void TestDSP()
+{
+	mpt::default_prng &prng = *s_PRNG;
+	MPT_UNUSED(prng);
+
+#if !defined(NO_REVERB) && defined(MPT_ENABLE_ARCH_INTRINSICS_SSE2)
+	if(CPU::HasFeatureSet(CPU::feature::sse2) && CPU::HasModesEnabled(CPU::mode::xmm128sse))
+	{
+		constexpr uint32 sampleRate = 44100;
+		constexpr uint32 numSamples = 1000;
+
+		for(uint32 reverbType = 0; reverbType < NUM_REVERBTYPES; reverbType += 3)
+		{
+			struct ReverbState
+			{
+				CReverb reverb;
+				mixsample_t ROfsVol = 0, LOfsVol = 0;
+				std::vector<mixsample_t> sendBuffer = std::vector<mixsample_t>(numSamples * 2);
+				std::vector<mixsample_t> outBuffer = std::vector<mixsample_t>(numSamples * 2);
+			};
+			const auto generic = std::make_unique<ReverbState>(), sse2 = std::make_unique<ReverbState>();
+			for(ReverbState *state : {generic.get(), sse2.get()})
+			{
+				state->reverb.m_Settings.m_nReverbType = reverbType;
+				state->reverb.m_Settings.m_nReverbDepth = 1 + reverbType % 16;
+				state->reverb.Initialize(true, state->ROfsVol, state->LOfsVol, sampleRate);
+			}
+
+			// Alternate between loud input (to provoke saturation), quiet input and silence (to test the decay)
+			for(int block = 0; block < 6; block++)
+			{
+				const int32 amplitude = (block % 3 == 0) ? (1 << 28) : ((block % 3 == 1) ? (1 << 16) : 0);
+				std::vector<mixsample_t> send(numSamples * 2), out(numSamples * 2);
+				for(uint32 i = 0; i < numSamples * 2; i++)
+				{
+					if(amplitude)
+						send[i] = static_cast<int32>(mpt::random<uint32>(prng) % static_cast<uint32>(2 * amplitude)) - amplitude;
+					out[i] = static_cast<int32>(mpt::random<uint32>(prng) % (1u << 20)) - (1 << 19);
+				}
+#ifndef MPT_INTMIXER
+				for(auto &s : send)
+					s *= (1.0f / MIXING_SCALEF);
+				for(auto &s : out)
+					s *= (1.0f / MIXING_SCALEF);
+#endif
+
+				for(ReverbState *state : {generic.get(), sse2.get()})
+				{
+					state->reverb.AllowSIMD(state != generic.get());
+					if(amplitude)
+					{
+						state->reverb.TouchReverbSendBuffer(state->sendBuffer.data(), state->ROfsVol, state->LOfsVol, numSamples);
+						std::copy(send.begin(), send.end(), state->sendBuffer.begin());
+					}
+					std::copy(out.begin(), out.end(), state->outBuffer.begin());
+					state->reverb.Process(state->outBuffer.data(), state->sendBuffer.data(), state->ROfsVol, state->LOfsVol, numSamples);
+				}
+
+				for(uint32 i = 0; i < numSamples * 2; i++)
+				{
+					VERIFY_EQUAL_QUIET_NONCONT(sse2->outBuffer[i], generic->outBuffer[i]);
+				}
+				VERIFY_EQUAL_NONCONT(sse2->ROfsVol, generic->ROfsVol);
+				VERIFY_EQUAL_NONCONT(sse2->LOfsVol, generic->LOfsVol);
+			}
+		}
+	}
+#endif // !NO_REVERB && MPT_ENABLE_ARCH_INTRINSICS_SSE2
+
+#if !defined(NO_EQ) && defined(MPT_ENABLE_ARCH_INTRINSICS_SSE)
+	if(CPU::HasFeatureSet(CPU::feature::sse) && CPU::HasModesEnabled(CPU::mode::xmm128sse))
+	{
+		const uint32 freqs[MAX_EQ_BANDS] = {120, 600, 1200, 3000, 6000, 10000};
+		for(std::size_t numChannels : {1, 2, 4})
+		{
+			uint32 gains[MAX_EQ_BANDS];
+			for(auto &gain : gains)
+			{
+				gain = mpt::random<uint32>(prng) % 33;
+			}
+			CEQ eqGeneric, eqSSE;
+			eqGeneric.AllowSIMD(false);
+			eqGeneric.SetEQGains(gains, freqs, true, 44100);
+			eqSSE.SetEQGains(gains, freqs, true, 44100);
+
+			constexpr std::size_t numFrames = 500;
+			std::vector<mixsample_t> front(numFrames * 2), rear(numFrames * 2);
+			for(auto &s : front)
+			{
+				s = mix_sample_cast<mixsample_t>(static_cast<int32>(mpt::random<uint32>(prng) % (1u << 28)) - (1 << 27));
+			}
+			for(auto &s : rear)
+			{
+				s = mix_sample_cast<mixsample_t>(static_cast<int32>(mpt::random<uint32>(prng) % (1u << 28)) - (1 << 27));
+			}
+			std::vector<mixsample_t> frontSSE = front, rearSSE = rear;
+			eqGeneric.Process(front.data(), rear.data(), numFrames, numChannels);
+			eqSSE.Process(frontSSE.data(), rearSSE.data(), numFrames, numChannels);
+			for(std::size_t i = 0; i < numFrames * 2; i++)
+			{
+				VERIFY_EQUAL_QUIET_NONCONT(frontSSE[i], front[i]);
+				VERIFY_EQUAL_QUIET_NONCONT(rearSSE[i], rear[i]);
+			}
+		}
+	}
+#endif // !NO_EQ && MPT_ENABLE_ARCH_INTRINSICS_SSE
+
+#if !defined(NO_PLUGINS) && defined(MPT_ENABLE_ARCH_INTRINSICS_SSE)
+	if(CPU::HasFeatureSet(CPU::feature::sse) && CPU::HasModesEnabled(CPU::mode::xmm128sse))
+	{
+		auto sndFile = std::make_unique<CSoundFile>();
+		VSTPluginLib factory(DMO::ParamEq::Create, true, {}, {});
+		const auto release = [](IMixPlugin *plugin) { plugin->Release(); };
+		std::unique_ptr<IMixPlugin, decltype(release)> eqGeneric{DMO::ParamEq::Create(factory, *sndFile, sndFile->m_MixPlugins[0]), release};
+		std::unique_ptr<IMixPlugin, decltype(release)> eqSSE{DMO::ParamEq::Create(factory, *sndFile, sndFile->m_MixPlugins[1]), release};
+		VERIFY_EQUAL_NONCONT(eqGeneric != nullptr && eqSSE != nullptr, true);
+		static_cast<DMO::ParamEq &>(*eqGeneric).AllowSIMD(false);
+		for(PlugParamIndex param = 0; param < eqGeneric->GetNumParameters(); param++)
+		{
+			const PlugParamValue value = mpt::random<uint32>(prng) % 1000 / 1000.0f;
+			eqGeneric->SetParameter(param, value);
+			eqSSE->SetParameter(param, value);
+		}
+		eqGeneric->SetParameter(2, 0.9f);  // Gain, must not be neutral
+		eqSSE->SetParameter(2, 0.9f);
+		eqGeneric->Resume();
+		eqSSE->Resume();
+
+		// Random input followed by silence, so that the filter state decays into the denormal range
+		constexpr uint32 numFrames = 500;
+		std::vector<float> outGeneric(numFrames * 2), outSSE(numFrames * 2);
+		for(uint32 block = 0; block < 20; block++)
+		{
+			for(uint32 i = 0; i < numFrames; i++)
+			{
+				const float l = (block < 2) ? (mpt::random<uint32>(prng) % 65536 / 32768.0f - 1.0f) : 0.0f;
+				const float r = (block < 2) ? (mpt::random<uint32>(prng) % 65536 / 32768.0f - 1.0f) : 0.0f;
+				eqGeneric->m_mixBuffer.GetInputBuffer(0)[i] = eqSSE->m_mixBuffer.GetInputBuffer(0)[i] = l;
+				eqGeneric->m_mixBuffer.GetInputBuffer(1)[i] = eqSSE->m_mixBuffer.GetInputBuffer(1)[i] = r;
+			}
+			std::fill(outGeneric.begin(), outGeneric.end(), 0.0f);
+			std::fill(outSSE.begin(), outSSE.end(), 0.0f);
+			const unsigned int csr = _mm_getcsr();
+			eqGeneric->Process(outGeneric.data(), outGeneric.data() + numFrames, numFrames);
+			eqSSE->Process(outSSE.data(), outSSE.data() + numFrames, numFrames);
+			// Denormal handling must not leak out of the plugin
+			VERIFY_EQUAL_NONCONT(_mm_getcsr(), csr);
+			for(uint32 i = 0; i < numFrames * 2; i++)
+			{
+				VERIFY_EQUAL_QUIET_NONCONT(outSSE[i], outGeneric[i]);
+			}
+		}
+	}
+#endif // !NO_PLUGINS && MPT_ENABLE_ARCH_INTRINSICS_SSE
+}
+
+
+// Play notes on several OPL voices, including notes that are released and cut again, and render the output in chunks of the given size.
+static std::vector<int32> RenderOPL(uint32 sampleRate, std::size_t chunkSize)
+{
+	static constexpr OPLPatch patches[] =
+	{
+		{ { 0x01, 0x01, 0x10, 0x00, 0xF2, 0xF4, 0x0F, 0x0F, 0x00, 0x00, 0x38, 0x00 } },
+		{ { 0x21, 0x02, 0x1A, 0x05, 0xC3, 0xA5, 0x48, 0x2F, 0x01, 0x02, 0x3E, 0x00 } },
+		{ { 0xC3, 0x41, 0x00, 0x00, 0xF0, 0xF0, 0x0A, 0x0C, 0x03, 0x05, 0x31, 0x00 } },
+	};
+	OPL opl(sampleRate);
+	std::vector<int32> output;
+	for(uint32 step = 0; step < 48; step++)
+	{
+		for(CHANNELINDEX chn = 0; chn < 12; chn++)
+		{
+			switch((step + chn) % 6)
+			{
+			case 0:
+				opl.Patch(chn, patches[(step / 6 + chn) % std::size(patches)]);
+				opl.Frequency(chn, 110000 + 27500 * chn + 1000 * step, false, false);
+				opl.Volume(chn, static_cast<uint8>(63 - step), false);
+				break;
+			case 2:
+				opl.Pan(chn, (step * 37 + chn * 53) % 257);
+				break;
+			case 3:
+				opl.NoteOff(chn);
+				break;
+			case 5:
+				if(chn % 3 == 0)
+					opl.NoteCut(chn);
+				break;
+			}
+		}
+		const std::size_t frames = 300 + step * 7;
+		std::vector<int32> buffer(frames * 2, 0);
+		for(std::size_t offset = 0; offset < frames; offset += chunkSize)
+			opl.Mix(buffer.data() + offset * 2, std::min(chunkSize, frames - offset), 1 << 16);
+		output.insert(output.end(), buffer.begin(), buffer.end());
+	}
+	return output;
+}
+
+
+// Verify that rendering OPL output in blocks and skipping silent OPL channels does not change the output
+static MPT_NOINLINE void TestOPL()
+{
+	// Checksums of the output of the emulator that rendered every frame separately and did not skip any channels
+	const std::pair<uint32, uint32> expectedChecksums[] =
+	{
+		{22050, 0x8BE977EFu},
+		{44100, 0x5A4E5FFDu},
+		{48000, 0x9A4317E0u},
+		{49716, 0xE136A9E1u},
+		{96000, 0x4C8498D9u},
+	};
+	for(const auto &[sampleRate, expectedChecksum] : expectedChecksums)
+	{
+		const std::vector<int32> singleFrames = RenderOPL(sampleRate, 1);
+		mpt::crc32 crc;
+		for(int32 value : singleFrames)
+		{
+			for(int b = 0; b < 4; b++)
+				crc.process(static_cast<uint8>(static_cast<uint32>(value) >> (b * 8)));
+		}
+		VERIFY_EQUAL_NONCONT(crc.result(), expectedChecksum);
+		VERIFY_EQUAL_NONCONT(RenderOPL(sampleRate, 97) == singleFrames, true);
+		VERIFY_EQUAL_NONCONT(RenderOPL(sampleRate, 1000) == singleFrames, true);
+	}
+}
+
+
 static void RunITCompressionTest(const std::vector<int8> &sampleData, FlagSet<ChannelFlags> smpFormat, bool it215)
 {
 
@@ -3937,6 +5137,24 @@ static void RunITCompressionTest(const std::vector<int8> &sampleData, FlagSet<Ch
 		std::ostringstream f;
 		ITCompression compression(smp, it215, &f);
 		data = f.str();
+		VERIFY_EQUAL_NONCONT(compression.GetCompressedSize(), data.size());
+	}
+
+	{
+		// Compressing the blocks in parallel must not change the output
+		ThreadPool threadPool(2);
+		std::ostringstream f;
+		ITCompression compression(smp, it215, &f, 0, &threadPool);
+		VERIFY_EQUAL_NONCONT(f.str(), data);
+		VERIFY_EQUAL_NONCONT(compression.GetCompressedSize(), data.size());
+
+		const ITCompression::SampleToCompress toCompress[] = {{&smp, it215, 0}, {&smp, it215, smp.nLength / 3}};
+		const auto compressed = ITCompression::CompressSamples(mpt::as_span(toCompress), &threadPool);
+		VERIFY_EQUAL_NONCONT(compressed.size(), 2u);
+		VERIFY_EQUAL_NONCONT(std::string(compressed[0].begin(), compressed[0].end()), data);
+		std::ostringstream fShort;
+		ITCompression compressionShort(smp, it215, &fShort, smp.nLength / 3);
+		VERIFY_EQUAL_NONCONT(std::string(compressed[1].begin(), compressed[1].end()), fShort.str());
 	}
 
 	{
@@ -4791,6 +6009,90 @@ static MPT_NOINLINE void TestSampleConversion()
 			VERIFY_EQUAL_QUIET_NONCONT(buffer[i], expected[i]);
 		}
 	}
+
+	// Optimized output conversion must be identical to the generic conversion, including the dither noise sequence
+	{
+		constexpr std::size_t numFrames = 37;  // Not a multiple of any vector size
+		std::vector<MixSampleInt> input(numFrames * 4);
+		for(auto &s : input)
+		{
+			s = static_cast<MixSampleInt>(mpt::random<uint32>(*s_PRNG) >> 2) - (1 << 29);  // Includes values outside the clipping range
+		}
+		input[0] = std::numeric_limits<MixSampleInt>::max() - 1000;
+		input[1] = std::numeric_limits<MixSampleInt>::min();
+
+		const auto verifyConversion = [&](auto sampleType, bool planar, std::size_t channels, std::size_t ditherMode, float gain)
+		{
+			using T = decltype(sampleType);
+			DithersOpenMPT dithers(mpt::global_random_device(), ditherMode, 4);
+			DithersOpenMPT dithersGeneric = std::as_const(dithers);
+			std::vector<MixSampleInt> mix(input.begin(), input.begin() + numFrames * channels), mixGeneric = mix;
+			std::vector<T> output(numFrames * channels), outputGeneric(numFrames * channels);
+			std::vector<T *> planes(channels), planesGeneric(channels);
+			for(std::size_t c = 0; c < channels; c++)
+			{
+				planes[c] = output.data() + c * numFrames;
+				planesGeneric[c] = outputGeneric.data() + c * numFrames;
+			}
+
+			// Render in two parts to verify that the output position is respected
+			const std::size_t split = 13;
+			const mpt::audio_span_interleaved<MixSampleInt> mixSpan{mix.data(), channels, numFrames};
+			if(planar)
+			{
+				AudioTargetBufferWithGain<mpt::audio_span_planar<T>> target{mpt::audio_span_planar<T>{planes.data(), channels, numFrames}, dithers, gain};
+				target.Process(mpt::audio_span_interleaved<MixSampleInt>{mixSpan.data(), channels, split});
+				target.Process(mpt::audio_span_interleaved<MixSampleInt>{mixSpan.data() + split * channels, channels, numFrames - split});
+			} else
+			{
+				AudioTargetBufferWithGain<mpt::audio_span_interleaved<T>> target{mpt::audio_span_interleaved<T>{output.data(), channels, numFrames}, dithers, gain};
+				target.Process(mpt::audio_span_interleaved<MixSampleInt>{mixSpan.data(), channels, split});
+				target.Process(mpt::audio_span_interleaved<MixSampleInt>{mixSpan.data() + split * channels, channels, numFrames - split});
+			}
+
+			const int32 gain16_16 = mpt::saturate_round<int32>(gain * (1 << 16));
+			if(std::is_same<T, int16>::value && gain16_16 != (1 << 16))
+			{
+				for(auto &s : mixGeneric)
+					s = Util::muldiv(s, gain16_16, 1 << 16);
+			}
+			std::visit(
+				[&](auto &dither)
+				{
+					const mpt::audio_span_interleaved<MixSampleInt> in{mixGeneric.data(), channels, numFrames};
+					if(planar)
+						ConvertBufferMixInternalFixedToBuffer<MixSampleIntTraits::mix_fractional_bits, false>(mpt::audio_span_planar<T>{planesGeneric.data(), channels, numFrames}, in, dither, channels, numFrames);
+					else
+						ConvertBufferMixInternalFixedToBuffer<MixSampleIntTraits::mix_fractional_bits, false>(mpt::audio_span_interleaved<T>{outputGeneric.data(), channels, numFrames}, in, dither, channels, numFrames);
+				},
+				dithersGeneric.Variant());
+			if(std::is_floating_point<T>::value && gain != 1.0f)
+			{
+				for(auto &s : outputGeneric)
+					s = static_cast<T>(s * gain);
+			}
+
+			for(std::size_t i = 0; i < output.size(); i++)
+			{
+				VERIFY_EQUAL_QUIET_NONCONT(output[i], outputGeneric[i]);
+			}
+		};
+
+		for(std::size_t channels = 1; channels <= 4; channels++)
+		{
+			for(std::size_t ditherMode = 0; ditherMode < DithersOpenMPT::GetNumDithers(); ditherMode++)
+			{
+				for(float gain : {1.0f, 0.3f})
+				{
+					for(bool planar : {false, true})
+					{
+						verifyConversion(int16{}, planar, channels, ditherMode, gain);
+						verifyConversion(float{}, planar, channels, ditherMode, gain);
+					}
+				}
+			}
+		}
+	}
 }
 
 
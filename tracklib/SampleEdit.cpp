@@ -1012,7 +1012,7 @@ SmpLength Resample(ModSample &smp, SmpLength start, SmpLength end, uint32 newRat
 
 	if(updatePatternCommands)
 	{
-		const SAMPLEINDEX sample = static_cast<SAMPLEINDEX>(std::distance(&sndFile.GetSample(0), &smp));
+		const SAMPLEINDEX sample = sndFile.GetSampleIndex(&smp);
 		bool patternUndoCreated = false;
 		sndFile.Patterns.ForEachModCommand([&](ModCommand &m)
 		{
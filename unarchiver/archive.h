@@ -48,6 +48,9 @@ public:
 	virtual mpt::ustring GetComment() const = 0;
 	virtual bool ExtractFile(std::size_t index) = 0;
 	virtual FileReader GetOutputFile() const = 0;
+	// Returns a file that is decompressed on demand while it is being read, or an invalid FileReader if the archive format does not support this.
+	// As opposed to ExtractFile(), the integrity of the decompressed data is not verified.
+	virtual FileReader GetStreamingFile(std::size_t index) = 0;
 	virtual std::size_t size() const = 0;
 	virtual IArchive::const_iterator begin() const = 0;
 	virtual IArchive::const_iterator end() const = 0;
@@ -73,6 +76,7 @@ public:
 		return;
 	}
 	bool ExtractFile(std::size_t index) override { MPT_UNREFERENCED_PARAMETER(index); return false; } // overwrite this
+	FileReader GetStreamingFile(std::size_t index) override { MPT_UNREFERENCED_PARAMETER(index); return FileReader(); } // overwrite this if possible
 public:
 	bool IsArchive() const override
 	{
@@ -0,0 +1,190 @@
+/*
+ * inflatefiledata.cpp
+ * -------------------
+ * Purpose: On-demand decompression of stored or deflated archive members
+ * Notes  : Data is only decompressed as far as it is read, and cached so that it can be seeked in.
+ *          The CRC of the decompressed data is not verified.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+#include "stdafx.h"
+
+#include "inflatefiledata.h"
+
+#if defined(MPT_WITH_ZLIB) || defined(MPT_WITH_MINIZ)
+
+#if defined(MPT_WITH_ZLIB)
+#include <zlib.h>
+#elif defined(MPT_WITH_MINIZ)
+#include <miniz/miniz.h>
+#endif
+
+#include <algorithm>
+#include <array>
+
+#endif // MPT_WITH_ZLIB || MPT_WITH_MINIZ
+
+
+OPENMPT_NAMESPACE_BEGIN
+
+
+#if defined(MPT_WITH_ZLIB) || defined(MPT_WITH_MINIZ)
+
+
+struct InflateFileData::Decompressor
+{
+	z_stream strm{};
+	std::array<std::byte, mpt::IO::BUFFERSIZE_SMALL> inBuffer;
+	bool initialized = false;
+
+	Decompressor()
+	{
+		strm.zalloc = Z_NULL;
+		strm.zfree = Z_NULL;
+		strm.opaque = Z_NULL;
+		strm.avail_in = 0;
+		strm.next_in = Z_NULL;
+		initialized = (inflateInit2(&strm, -15) == Z_OK);
+	}
+
+	~Decompressor()
+	{
+		if(initialized)
+			inflateEnd(&strm);
+	}
+};
+
+
+InflateFileData::InflateFileData(FileReader compressedData, Method method, std::optional<uint64> uncompressedSize)
+	: m_compressedData{compressedData}
+	, m_method{method}
+{
+	m_compressedData.Rewind();
+	if(uncompressedSize && mpt::in_range<pos_type>(*uncompressedSize))
+	{
+		// Do not trust sizes that cannot possibly be reached, so that a broken header cannot make us allocate huge amounts of memory.
+		// Deflate cannot compress data better than about 1:1032.
+		const uint64 compressedSize = m_compressedData.GetLength();
+		if((method == Method::Stored && *uncompressedSize == compressedSize)
+		   || (method == Method::Deflate && *uncompressedSize / 1032u <= compressedSize))
+		{
+			m_length = static_cast<pos_type>(*uncompressedSize);
+		}
+	}
+	if(method == Method::Deflate)
+	{
+		m_decompressor = std::make_unique<Decompressor>();
+	}
+}
+
+
+InflateFileData::~InflateFileData()
+{
+	return;
+}
+
+
+FileReader InflateFileData::Create(FileReader compressedData, Method method, std::optional<uint64> uncompressedSize)
+{
+	auto data = std::make_shared<InflateFileData>(compressedData, method, uncompressedSize);
+	if(data->m_decompressor && !data->m_decompressor->initialized)
+	{
+		return FileReader();
+	}
+	return FileReader(std::static_pointer_cast<mpt::IO::IFileData>(data));
+}
+
+
+InflateFileData::pos_type InflateFileData::GetLength() const
+{
+	if(m_length)
+	{
+		return *m_length;
+	}
+	return FileDataUnseekable::GetLength();
+}
+
+
+bool InflateFileData::InternalEof() const
+{
+	if(m_length)
+	{
+		return m_position >= *m_length;
+	}
+	return m_streamEnd;
+}
+
+
+mpt::byte_span InflateFileData::InternalReadUnseekable(mpt::byte_span dst) const
+{
+	if(m_length)
+	{
+		if(m_position >= *m_length)
+		{
+			return dst.first(0);
+		}
+		dst = dst.first(static_cast<std::size_t>(std::min(static_cast<pos_type>(dst.size()), *m_length - m_position)));
+	}
+	const std::size_t decompressed = Decompress(dst).size();
+	if(m_length && decompressed < dst.size())
+	{
+		// Stream is truncated or corrupted. Pad it to the announced length, so that the length stays consistent.
+		std::fill(dst.begin() + decompressed, dst.end(), std::byte{0});
+	} else
+	{
+		dst = dst.first(decompressed);
+	}
+	m_position += dst.size();
+	return dst;
+}
+
+
+mpt::byte_span InflateFileData::Decompress(mpt::byte_span dst) const
+{
+	if(m_streamEnd || dst.empty())
+	{
+		return dst.first(0);
+	}
+	if(m_method == Method::Stored)
+	{
+		const std::size_t readSize = m_compressedData.ReadRaw(dst).size();
+		if(readSize < dst.size())
+		{
+			m_streamEnd = true;
+		}
+		return dst.first(readSize);
+	}
+
+	z_stream &strm = m_decompressor->strm;
+	strm.next_out = mpt::byte_cast<Bytef *>(dst.data());
+	strm.avail_out = mpt::saturate_cast<uInt>(dst.size());
+	const uInt outSize = strm.avail_out;
+	while(strm.avail_out > 0 && !m_streamEnd)
+	{
+		if(strm.avail_in == 0)
+		{
+			const auto input = m_compressedData.ReadRaw(mpt::as_span(m_decompressor->inBuffer));
+			if(input.empty())
+			{
+				// Truncated stream
+				m_streamEnd = true;
+				break;
+			}
+			strm.next_in = mpt::byte_cast<Bytef *>(input.data());
+			strm.avail_in = static_cast<uInt>(input.size());
+		}
+		// Anything other than Z_OK is either the end of the stream or an error we cannot recover from
+		if(inflate(&strm, Z_NO_FLUSH) != Z_OK)
+		{
+			m_streamEnd = true;
+		}
+	}
+	return dst.first(outSize - strm.avail_out);
+}
+
+
+#endif // MPT_WITH_ZLIB || MPT_WITH_MINIZ
+
+
+OPENMPT_NAMESPACE_END
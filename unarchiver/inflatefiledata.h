@@ -0,0 +1,63 @@
+/*
+ * inflatefiledata.h
+ * -----------------
+ * Purpose: On-demand decompression of stored or deflated archive members
+ * Notes  : Data is only decompressed as far as it is read, and cached so that it can be seeked in.
+ *          The CRC of the decompressed data is not verified.
+ * Authors: OpenMPT Devs
+ * The OpenMPT source code is released under the BSD license. Read LICENSE for more details.
+ */
+
+#pragma once
+
+#include "openmpt/all/BuildSettings.hpp"
+
+#include "../common/FileReader.h"
+
+#include "mpt/io_read/filedata_base_unseekable.hpp"
+
+#include <memory>
+#include <optional>
+
+OPENMPT_NAMESPACE_BEGIN
+
+#if defined(MPT_WITH_ZLIB) || defined(MPT_WITH_MINIZ)
+
+class InflateFileData : public mpt::IO::FileDataUnseekable
+{
+public:
+	enum class Method
+	{
+		Stored,
+		Deflate,  // Raw deflate stream without zlib header
+	};
+
+	// If the uncompressed size is known and plausible, the stream is truncated or zero-padded to that size,
+	// so that GetLength() does not have to decompress the whole stream.
+	InflateFileData(FileReader compressedData, Method method, std::optional<uint64> uncompressedSize);
+	~InflateFileData() override;
+
+	// Returns a FileReader that decompresses the data on demand, or an invalid FileReader if the decompressor cannot be initialized.
+	static FileReader Create(FileReader compressedData, Method method, std::optional<uint64> uncompressedSize);
+
+	pos_type GetLength() const override;
+
+private:
+	bool InternalEof() const override;
+	mpt::byte_span InternalReadUnseekable(mpt::byte_span dst) const override;
+
+	mpt::byte_span Decompress(mpt::byte_span dst) const;
+
+	struct Decompressor;
+
+	mutable FileReader m_compressedData;
+	const Method m_method;
+	std::optional<pos_type> m_length;
+	mutable pos_type m_position = 0;
+	mutable std::unique_ptr<Decompressor> m_decompressor;
+	mutable bool m_streamEnd = false;
+};
+
+#endif // MPT_WITH_ZLIB || MPT_WITH_MINIZ
+
+OPENMPT_NAMESPACE_END
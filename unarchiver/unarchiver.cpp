@@ -121,6 +121,25 @@ bool CUnarchiver::ExtractBestFile(const std::vector<const char *> &extensions)
 }
 
 
+FileReader CUnarchiver::GetBestFileStreaming(const std::vector<const char *> &extensions)
+{
+	std::size_t bestFile = FindBestFile(extensions);
+	if(bestFile == failIndex)
+	{
+		return FileReader();
+	}
+	if(FileReader file = GetStreamingFile(bestFile); file.IsValid())
+	{
+		return file;
+	}
+	if(!ExtractFile(bestFile))
+	{
+		return FileReader();
+	}
+	return GetOutputFile();
+}
+
+
 bool CUnarchiver::IsArchive() const
 {
 	return impl->IsArchive();
@@ -145,6 +164,12 @@ FileReader CUnarchiver::GetOutputFile() const
 }
 
 
+FileReader CUnarchiver::GetStreamingFile(std::size_t index)
+{
+	return impl->GetStreamingFile(index);
+}
+
+
 std::size_t CUnarchiver::size() const
 {
 	return impl->size();
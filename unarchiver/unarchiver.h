@@ -70,6 +70,7 @@ public:
 	mpt::ustring GetComment() const override;
 	bool ExtractFile(std::size_t index) override;
 	FileReader GetOutputFile() const override;
+	FileReader GetStreamingFile(std::size_t index) override;
 	std::size_t size() const override;
 	IArchive::const_iterator begin() const override;
 	IArchive::const_iterator end() const override;
@@ -84,6 +85,9 @@ public:
 
 	std::size_t FindBestFile(const std::vector<const char *> &extensions);
 	bool ExtractBestFile(const std::vector<const char *> &extensions);
+	// Like ExtractBestFile() followed by GetOutputFile(), but the file is only decompressed as far as it is read if the archive format supports it.
+	// Returns an invalid FileReader if there is no suitable file or it cannot be extracted.
+	FileReader GetBestFileStreaming(const std::vector<const char *> &extensions);
 
 };
 
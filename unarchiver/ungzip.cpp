@@ -10,6 +10,7 @@
 #include "stdafx.h"
 
 #include "ungzip.h"
+#include "inflatefiledata.h"
 #include "../common/FileReader.h"
 
 #if defined(MPT_WITH_ZLIB) || defined(MPT_WITH_MINIZ)
@@ -74,15 +75,9 @@ CGzipArchive::~CGzipArchive()
 }
 
 
-bool CGzipArchive::ExtractFile(std::size_t index)
+void CGzipArchive::SeekToData(GZtrailer &trailer)
 {
-	if(index >= contents.size())
-	{
-		return false;
-	}
-
 	// Read trailer
-	GZtrailer trailer;
 	inFile.Seek(inFile.GetLength() - sizeof(GZtrailer));
 	inFile.ReadStruct(trailer);
 
@@ -112,6 +107,18 @@ bool CGzipArchive::ExtractFile(std::size_t index)
 	{
 		inFile.Skip(2);
 	}
+}
+
+
+bool CGzipArchive::ExtractFile(std::size_t index)
+{
+	if(index >= contents.size())
+	{
+		return false;
+	}
+
+	GZtrailer trailer;
+	SeekToData(trailer);
 
 	// Well, this is a bit small when deflated.
 	if(!inFile.CanRead(sizeof(GZtrailer)))
@@ -163,6 +170,25 @@ bool CGzipArchive::ExtractFile(std::size_t index)
 }
 
 
+FileReader CGzipArchive::GetStreamingFile(std::size_t index)
+{
+	if(index >= contents.size())
+	{
+		return FileReader();
+	}
+
+	GZtrailer trailer;
+	SeekToData(trailer);
+	if(!inFile.CanRead(sizeof(GZtrailer)))
+	{
+		return FileReader();
+	}
+
+	// The size in the trailer is only stored modulo 2^32, but files of that size are not going to be modules anyway.
+	return InflateFileData::Create(inFile.ReadChunk(inFile.BytesLeft() - sizeof(GZtrailer)), InflateFileData::Method::Deflate, trailer.isize);
+}
+
+
 #endif // MPT_WITH_ZLIB || MPT_WITH_MINIZ
 
 
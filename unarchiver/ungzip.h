@@ -58,9 +58,13 @@ protected:
 
 	GZheader header;
 
+	// Read the trailer and seek to the start of the deflate stream
+	void SeekToData(GZtrailer &trailer);
+
 public:
 
 	bool ExtractFile(std::size_t index) override;
+	FileReader GetStreamingFile(std::size_t index) override;
 
 	CGzipArchive(const FileReader &file);
 	~CGzipArchive() override;
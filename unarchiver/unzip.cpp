@@ -11,6 +11,7 @@
 
 #include "../common/FileReader.h"
 #include "unzip.h"
+#include "inflatefiledata.h"
 #include "../common/misc_util.h"
 #include <algorithm>
 #include <vector>
@@ -214,6 +215,45 @@ bool CZipArchive::ExtractFile(std::size_t index)
 }
 
 
+FileReader CZipArchive::GetStreamingFile(std::size_t index)
+{
+	if(index >= contents.size())
+	{
+		return FileReader();
+	}
+
+	unz_file_pos bestFile;
+	unz_file_info info;
+
+	bestFile.pos_in_zip_directory = static_cast<uLong>(contents[index].cookie1);
+	bestFile.num_of_file = static_cast<uLong>(contents[index].cookie2);
+
+	if(unzGoToFilePos(zipFile, &bestFile) != UNZ_OK || unzGetCurrentFileInfo(zipFile, &info, nullptr, 0, nullptr, 0, nullptr, 0) != UNZ_OK)
+	{
+		return FileReader();
+	}
+	// Encrypted files and exotic compression methods need to go through minizip
+	if((info.flag & 1) || (info.compression_method != 0 && info.compression_method != Z_DEFLATED))
+	{
+		return FileReader();
+	}
+	// Opening the file in raw mode parses the local header, after which the read position is the start of the compressed data.
+	int method = 0, level = 0;
+	if(unzOpenCurrentFile2(zipFile, &method, &level, 1) != UNZ_OK)
+	{
+		return FileReader();
+	}
+	const ZPOS64_T offset = unzGetCurrentFileZStreamPos64(zipFile);
+	unzCloseCurrentFile(zipFile);
+	if(!mpt::in_range<FileReader::pos_type>(offset) || !mpt::in_range<FileReader::pos_type>(info.compressed_size))
+	{
+		return FileReader();
+	}
+	FileReader compressedData = inFile.GetChunkAt(static_cast<FileReader::pos_type>(offset), static_cast<FileReader::pos_type>(info.compressed_size));
+	return InflateFileData::Create(compressedData, (method == 0) ? InflateFileData::Method::Stored : InflateFileData::Method::Deflate, info.uncompressed_size);
+}
+
+
 #elif defined(MPT_WITH_MINIZ)
 
 
@@ -325,6 +365,46 @@ bool CZipArchive::ExtractFile(std::size_t index)
 }
 
 
+FileReader CZipArchive::GetStreamingFile(std::size_t index)
+{
+	mz_zip_archive *zip = static_cast<mz_zip_archive*>(zipFile);
+
+	if(index >= contents.size())
+	{
+		return FileReader();
+	}
+
+	mz_zip_archive_file_stat stat = {};
+	if(!mz_zip_reader_file_stat(zip, static_cast<mz_uint>(index), &stat) || stat.m_is_encrypted || !stat.m_is_supported)
+	{
+		return FileReader();
+	}
+	if(stat.m_method != 0 && stat.m_method != MZ_DEFLATED)
+	{
+		return FileReader();
+	}
+	if(!mpt::in_range<FileReader::pos_type>(stat.m_local_header_ofs) || !mpt::in_range<FileReader::pos_type>(stat.m_comp_size))
+	{
+		return FileReader();
+	}
+
+	// The compressed data follows the local header, whose file name and extra field lengths may differ from the central directory.
+	FileReader file = inFile;
+	if(!file.Seek(static_cast<FileReader::pos_type>(stat.m_local_header_ofs)) || !file.ReadMagic("PK\x03\x04") || !file.Skip(22))
+	{
+		return FileReader();
+	}
+	const uint16 nameLength = file.ReadUint16LE();
+	const uint16 extraLength = file.ReadUint16LE();
+	if(!file.Skip(nameLength + extraLength))
+	{
+		return FileReader();
+	}
+	comment = mpt::ToUnicode(mpt::Charset::CP437, std::string(stat.m_comment, stat.m_comment + stat.m_comment_size));
+	return InflateFileData::Create(file.ReadChunk(static_cast<FileReader::pos_type>(stat.m_comp_size)), (stat.m_method == 0) ? InflateFileData::Method::Stored : InflateFileData::Method::Deflate, stat.m_uncomp_size);
+}
+
+
 #endif // MPT_WITH_ZLIB || MPT_WITH_MINIZ
 
 
@@ -24,6 +24,7 @@ public:
 	~CZipArchive() override;
 public:
 	bool ExtractFile(std::size_t index) override;
+	FileReader GetStreamingFile(std::size_t index) override;
 };
 
 OPENMPT_NAMESPACE_END